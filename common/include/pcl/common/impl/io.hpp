@@ -142,12 +142,16 @@ pcl::copyPointCloud (const pcl::PointCloud<PointT> &cloud_in, const std::vector<
     // To verify this, we would need to iterate over all points and check for NaNs
     cloud_out.is_dense = false;
 
-  // Copy all the data fields from the input cloud to the output one
-  typedef typename pcl::traits::fieldList<PointT>::type FieldList;
-  // Iterate over each point
-  for (size_t i = 0; i < indices.size (); ++i)
-    // Iterate over each dimension
-    pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointT, PointT> (cloud_in.points[indices[i]], cloud_out.points[i]));
+  // Copy the points as a whole, requesting the randomly accessed input points a few iterations ahead
+  const size_t nr_points = indices.size ();
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+#ifdef __GNUC__
+    if (i + 16 < nr_points)
+      __builtin_prefetch (&cloud_in.points[indices[i + 16]]);
+#endif
+    cloud_out.points[i] = cloud_in.points[indices[i]];
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -168,12 +172,16 @@ pcl::copyPointCloud (const pcl::PointCloud<PointT> &cloud_in,
     // To verify this, we would need to iterate over all points and check for NaNs
     cloud_out.is_dense = false;
 
-  // Copy all the data fields from the input cloud to the output one
-  typedef typename pcl::traits::fieldList<PointT>::type FieldList;
-  // Iterate over each point
-  for (size_t i = 0; i < indices.size (); ++i)
-    // Iterate over each dimension
-    pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointT, PointT> (cloud_in.points[indices[i]], cloud_out.points[i]));
+  // Copy the points as a whole, requesting the randomly accessed input points a few iterations ahead
+  const size_t nr_points = indices.size ();
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+#ifdef __GNUC__
+    if (i + 16 < nr_points)
+      __builtin_prefetch (&cloud_in.points[indices[i + 16]]);
+#endif
+    cloud_out.points[i] = cloud_in.points[indices[i]];
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -248,12 +256,16 @@ pcl::copyPointCloud (const pcl::PointCloud<PointT> &cloud_in, const pcl::PointIn
     // To verify this, we would need to iterate over all points and check for NaNs
     cloud_out.is_dense = false;
 
-  // Copy all the data fields from the input cloud to the output one
-  typedef typename pcl::traits::fieldList<PointT>::type FieldList;
-  // Iterate over each point
-  for (size_t i = 0; i < indices.indices.size (); ++i)
-    // Iterate over each dimension
-    pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointT, PointT> (cloud_in.points[indices.indices[i]], cloud_out.points[i]));
+  // Copy the points as a whole, requesting the randomly accessed input points a few iterations ahead
+  const size_t nr_points = indices.indices.size ();
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+#ifdef __GNUC__
+    if (i + 16 < nr_points)
+      __builtin_prefetch (&cloud_in.points[indices.indices[i + 16]]);
+#endif
+    cloud_out.points[i] = cloud_in.points[indices.indices[i]];
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -56,6 +56,31 @@ namespace pcl
     {
       return (fabs (val1 - val2) < eps);
     }
+
+    /** \brief Derive the seed of one of several random number streams from a common seed.
+      * Unlike seed + stream, the two values are hashed together, so that the streams of
+      * nearby seeds (e.g. seed and seed + 1) do not overlap.
+      * \param[in] seed the common seed
+      * \param[in] stream the index of the stream
+      * \return the seed of the stream
+      */
+    inline unsigned int
+    mixSeed (unsigned int seed, unsigned int stream)
+    {
+      // murmur3 finalizer, applied to the stream index and then to its combination with the seed
+      unsigned int h = stream + 0x9e3779b9u;
+      for (int round = 0; round < 2; ++round)
+      {
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        if (round == 0)
+          h ^= seed;
+      }
+      return (h);
+    }
   }
 }
 
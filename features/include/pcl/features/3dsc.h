@@ -42,6 +42,7 @@
 
 #include <pcl/point_types.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/shape_context_bins.h>
 #include <boost/random.hpp>
 
 namespace pcl
@@ -99,6 +100,7 @@ namespace pcl
          theta_divisions_(0), 
          phi_divisions_(0), 
          volume_lut_(0),
+         bins_ (),
          azimuth_bins_(12), 
          elevation_bins_(11), 
          radius_bins_(15), 
@@ -187,6 +189,21 @@ namespace pcl
       bool
       computePoint (size_t index, const pcl::PointCloud<PointNT> &normals, float rf[9], std::vector<float> &desc);
 
+      /** \brief Estimate a descriptor for a given point from its neighbors, using a previously
+        * drawn random vector to build the X axis of the reference frame.
+        * \param[in] index the index of the point to estimate a descriptor for
+        * \param[in] normals a pointer to the set of normals
+        * \param[in] nn_indices the indices of the neighbors of the point, at least one
+        * \param[in] nn_dists the squared distances to the neighbors of the point
+        * \param[in] random_axis three random values in [0, 1) used to select the X axis
+        * \param[out] rf the reference frame
+        * \param[out] desc the resultant estimated descriptor
+        */
+      void
+      computeDescriptor (size_t index, const pcl::PointCloud<PointNT> &normals,
+                         const std::vector<int> &nn_indices, const std::vector<float> &nn_dists,
+                         const Eigen::Vector3f &random_axis, float rf[9], std::vector<float> &desc) const;
+
       /** \brief Estimate the actual feature. 
         * \param[out] output the resultant feature 
         */
@@ -205,6 +222,9 @@ namespace pcl
       /** \brief Volumes look up table */
       std::vector<float> volume_lut_;
 
+      /** \brief Radial and angular bins look up */
+      ShapeContextBins bins_;
+
       /** \brief Bins along the azimuth dimension */
       size_t azimuth_bins_;
 
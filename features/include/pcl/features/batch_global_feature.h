@@ -0,0 +1,241 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_BATCH_GLOBAL_FEATURE_H_
+#define PCL_FEATURES_BATCH_GLOBAL_FEATURE_H_
+
+#include <pcl/point_types.h>
+#include <pcl/PointIndices.h>
+#include <pcl/features/feature.h>
+#include <pcl/features/esf.h>
+#include <pcl/features/gfpfh.h>
+
+namespace pcl
+{
+  /** \brief BatchClusterSetup configures a copy of a global estimator for one cluster.
+    *
+    * The default version handles estimators that honor the indices (e.g. VFHEstimation and
+    * CVFHEstimation): the estimator keeps working on the full cloud and on the shared search
+    * tree, and only the cluster indices change. Estimators that use the whole input regardless
+    * of the indices are specialized below to work on an extracted copy of the cluster.
+    */
+  template <typename EstimatorT>
+  struct BatchClusterSetup
+  {
+    template <typename PointCloudInConstPtr, typename KdTreePtr> static void
+    apply (const EstimatorT &, EstimatorT &estimator,
+           const PointCloudInConstPtr &cloud, const KdTreePtr &tree,
+           const boost::shared_ptr<std::vector<int> > &indices)
+    {
+      estimator.setInputCloud (cloud);
+      estimator.setIndices (indices);
+      estimator.setSearchMethod (tree);
+    }
+  };
+
+  /** \brief ESFEstimation samples the complete input cloud, so the cluster is extracted first. A
+    * brute force search is set to prevent the estimator from building a tree per cluster.
+    */
+  template <typename PointInT, typename PointOutT>
+  struct BatchClusterSetup<ESFEstimation<PointInT, PointOutT> >
+  {
+    typedef ESFEstimation<PointInT, PointOutT> EstimatorT;
+    typedef pcl::PointCloud<PointInT> PointCloudIn;
+    typedef typename pcl::search::Search<PointInT>::Ptr KdTreePtr;
+
+    static void
+    apply (const EstimatorT &, EstimatorT &estimator,
+           const typename PointCloudIn::ConstPtr &cloud, const KdTreePtr &,
+           const boost::shared_ptr<std::vector<int> > &indices);
+  };
+
+  /** \brief GFPFHEstimation builds an octree over the complete input cloud, so the cluster and
+    * its labels are extracted first.
+    */
+  template <typename PointInT, typename PointLT, typename PointOutT>
+  struct BatchClusterSetup<GFPFHEstimation<PointInT, PointLT, PointOutT> >
+  {
+    typedef GFPFHEstimation<PointInT, PointLT, PointOutT> EstimatorT;
+    typedef pcl::PointCloud<PointInT> PointCloudIn;
+    typedef typename pcl::search::Search<PointInT>::Ptr KdTreePtr;
+
+    static void
+    apply (const EstimatorT &prototype, EstimatorT &estimator,
+           const typename PointCloudIn::ConstPtr &cloud, const KdTreePtr &,
+           const boost::shared_ptr<std::vector<int> > &indices);
+  };
+
+  /** \brief BatchGlobalFeatureEstimation computes a global descriptor (VFH, CVFH, ESF, GFPFH, ...)
+    * for every cluster of a point cloud in one call.
+    *
+    * The estimator given through \a setEstimator is used as a prototype: it carries the
+    * parameters and the per-point data of the full cloud (normals, labels). Every cluster is
+    * computed by its own copy of it, and all of them share a single search tree built once over
+    * the full cloud, instead of setting up one tree per cluster.
+    *
+    * Usage example:
+    * \code
+    * pcl::VFHEstimation<pcl::PointXYZ, pcl::Normal, pcl::VFHSignature308>::Ptr vfh (...);
+    * vfh->setInputNormals (normals);
+    *
+    * pcl::BatchGlobalFeatureEstimation<pcl::PointXYZ, pcl::VFHSignature308,
+    *                                   pcl::VFHEstimation<pcl::PointXYZ, pcl::Normal, pcl::VFHSignature308> > batch;
+    * batch.setEstimator (vfh);
+    * batch.setInputCloud (cloud);
+    * batch.setClusters (cluster_indices);    // e.g., from EuclideanClusterExtraction
+    * batch.setNumberOfThreads (4);
+    *
+    * Eigen::MatrixXf descriptors;            // one row per descriptor
+    * std::vector<int> descriptor_clusters;   // cluster of each row
+    * batch.compute (descriptors, descriptor_clusters);
+    * \endcode
+    *
+    * \note The prototype should not have a separate search surface set: the clusters, the
+    * normals and the labels all refer to the input cloud given here.
+    * \note Descriptors are stored in cluster order. Estimators such as CVFHEstimation may
+    * return more than one descriptor per cluster (or none), which is why the cluster of every
+    * descriptor is reported as well.
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointOutT, typename EstimatorT>
+  class BatchGlobalFeatureEstimation
+  {
+    public:
+      typedef boost::shared_ptr<BatchGlobalFeatureEstimation<PointInT, PointOutT, EstimatorT> > Ptr;
+      typedef boost::shared_ptr<const BatchGlobalFeatureEstimation<PointInT, PointOutT, EstimatorT> > ConstPtr;
+
+      typedef boost::shared_ptr<EstimatorT> EstimatorPtr;
+      typedef pcl::PointCloud<PointInT> PointCloudIn;
+      typedef typename PointCloudIn::ConstPtr PointCloudInConstPtr;
+      typedef pcl::PointCloud<PointOutT> PointCloudOut;
+      typedef pcl::search::Search<PointInT> KdTree;
+      typedef typename KdTree::Ptr KdTreePtr;
+
+      /** \brief Empty constructor. */
+      BatchGlobalFeatureEstimation () :
+        estimator_ (), input_ (), clusters_ (), tree_ (), threads_ (1)
+      {
+      }
+
+      /** \brief Set the configured estimator used as a prototype for all clusters.
+        * \param[in] estimator the estimator, with its parameters and per-point data set
+        */
+      inline void
+      setEstimator (const EstimatorPtr &estimator) { estimator_ = estimator; }
+
+      /** \brief Get the prototype estimator. */
+      inline EstimatorPtr
+      getEstimator () const { return (estimator_); }
+
+      /** \brief Provide a pointer to the full input cloud the clusters refer to.
+        * \param[in] cloud the const boost shared pointer to a PointCloud message
+        */
+      inline void
+      setInputCloud (const PointCloudInConstPtr &cloud) { input_ = cloud; }
+
+      /** \brief Get a pointer to the input point cloud dataset. */
+      inline PointCloudInConstPtr
+      getInputCloud () const { return (input_); }
+
+      /** \brief Set the clusters to describe, as indices into the input cloud.
+        * \param[in] clusters the cluster indices (e.g., the output of EuclideanClusterExtraction)
+        */
+      void
+      setClusters (const std::vector<pcl::PointIndices> &clusters);
+
+      /** \brief Get the number of clusters that will be described. */
+      inline size_t
+      getNumberOfClusters () const { return (clusters_.size ()); }
+
+      /** \brief Provide a pointer to the search object shared by all clusters. If none is
+        * given, the search object of the prototype estimator is used, and if that is not set
+        * either, a default one is created. It is built once over the full input cloud.
+        * \param[in] tree a pointer to the spatial search object.
+        */
+      inline void
+      setSearchMethod (const KdTreePtr &tree) { tree_ = tree; }
+
+      /** \brief Get a pointer to the shared search object. */
+      inline KdTreePtr
+      getSearchMethod () const { return (tree_); }
+
+      /** \brief Set the number of threads used to process the clusters.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      /** \brief Compute the descriptors of all clusters.
+        * \param[out] descriptors the descriptors of all clusters, concatenated in cluster order
+        * \param[out] descriptor_clusters the index of the cluster each descriptor belongs to
+        */
+      void
+      compute (PointCloudOut &descriptors, std::vector<int> &descriptor_clusters);
+
+      /** \brief Compute the descriptors of all clusters as a contiguous matrix.
+        * \param[out] descriptors one row per descriptor, concatenated in cluster order
+        * \param[out] descriptor_clusters the index of the cluster each row belongs to
+        */
+      void
+      compute (Eigen::MatrixXf &descriptors, std::vector<int> &descriptor_clusters);
+
+    protected:
+      /** \brief The prototype estimator. */
+      EstimatorPtr estimator_;
+
+      /** \brief The full input point cloud. */
+      PointCloudInConstPtr input_;
+
+      /** \brief The indices of every cluster. */
+      std::vector<boost::shared_ptr<std::vector<int> > > clusters_;
+
+      /** \brief The search object shared by all clusters. */
+      KdTreePtr tree_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Get a string representation of the name of this class. */
+      inline const std::string
+      getClassName () const { return ("BatchGlobalFeatureEstimation"); }
+  };
+}
+
+#include <pcl/features/impl/batch_global_feature.hpp>
+
+#endif  //#ifndef PCL_FEATURES_BATCH_GLOBAL_FEATURE_H_
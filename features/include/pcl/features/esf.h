@@ -43,8 +43,8 @@
 #include <pcl/features/feature.h>
 #define GRIDSIZE 64
 #define GRIDSIZE_H GRIDSIZE/2
-//#include <boost/multi_array.hpp>
 #include <vector>
+#include <ctime>
 
 namespace pcl
 {
@@ -72,17 +72,10 @@ namespace pcl
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
 
       /** \brief Empty constructor. */
-      ESFEstimation () : lut_ (), local_cloud_ ()
+      ESFEstimation () : lut_ (GRIDSIZE * GRIDSIZE * GRIDSIZE, 0), local_cloud_ (),
+                         seed_ (static_cast<unsigned int> (time (NULL))), threads_ (1)
       {
         feature_name_ = "ESFEstimation";
-        lut_.resize (GRIDSIZE);
-        for (int i = 0; i < GRIDSIZE; ++i)
-        {
-          lut_[i].resize (GRIDSIZE);
-          for (int j = 0; j < GRIDSIZE; ++j)
-            lut_[i][j].resize (GRIDSIZE);
-        }
-        //lut_.resize (boost::extents[GRIDSIZE][GRIDSIZE][GRIDSIZE]);
         search_radius_ = 0;
         k_ = 5;
       }
@@ -93,7 +86,39 @@ namespace pcl
       void
       compute (PointCloudOut &output);
 
+      /** \brief Set the seed of the random number generators used to draw the point triplets. Two runs
+        * with the same seed on the same cloud produce the same descriptor, regardless of the number of
+        * threads used.
+        * \param[in] seed the seed
+        */
+      inline void
+      setSeed (unsigned int seed) { seed_ = seed; }
+
+      /** \brief Get the value of the internal \a seed parameter. */
+      inline unsigned int
+      getSeed () const { return (seed_); }
+
+      /** \brief Initialize the scheduler and set the number of threads to use for the sampling.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
     protected:
+      /** \brief Shape function samples and partial histograms drawn from one block of random point triplets. */
+      struct SampleBlock
+      {
+        SampleBlock () : d2v (), d3v (), wt_d2 (), wt_d3 (), h_a3_in (), h_a3_out (), h_a3_mix (), h_mix_ratio () {}
+
+        std::vector<float> d2v;
+        std::vector<float> d3v;
+        std::vector<int> wt_d2;
+        std::vector<float> wt_d3;
+        std::vector<float> h_a3_in;
+        std::vector<float> h_a3_out;
+        std::vector<float> h_a3_mix;
+        std::vector<float> h_mix_ratio;
+      };
 
       /** \brief Estimate the Ensebmel of Shape Function (ESF) descriptors at a set of points given by
         * <setInputCloud (),
@@ -106,11 +131,29 @@ namespace pcl
       int
       lci (const int x1, const int y1, const int z1, 
            const int x2, const int y2, const int z2, 
-           float &ratio, int &incnt, int &pointcount);
+           float &ratio, int &incnt, int &pointcount) const;
      
       /** \brief ... */
       void
       computeESF (PointCloudIn &pc, std::vector<float> &hist);
+
+      /** \brief Draw one block of random point triplets and accumulate their shape functions.
+        * \param[in] pc the scaled and voxelized cluster
+        * \param[in] seed the seed of the random number generator used for this block
+        * \param[in] nr_samples the number of triplets to draw
+        * \param[in] binsize the number of bins of each histogram
+        * \param[out] block the resultant samples and partial histograms
+        */
+      void
+      sampleBlock (const PointCloudIn &pc, unsigned int seed, unsigned int nr_samples, int binsize,
+                   SampleBlock &block) const;
+
+      /** \brief Get the index of a voxel in the occupancy grid. */
+      inline int
+      voxelIndex (int x, int y, int z) const
+      {
+        return ((x * GRIDSIZE + y) * GRIDSIZE + z);
+      }
       
       /** \brief ... */
       void
@@ -126,13 +169,18 @@ namespace pcl
 
     private:
 
-      /** \brief ... */
-      //boost::multi_array<int, 3> lut_;
-      std::vector<std::vector<std::vector<int> > > lut_;
+      /** \brief Voxel occupancy of the current cluster, stored as one contiguous GRIDSIZE^3 array. */
+      std::vector<unsigned char> lut_;
       
       /** \brief ... */
       PointCloudIn local_cloud_;
 
+      /** \brief Random number seed. */
+      unsigned int seed_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud
         */
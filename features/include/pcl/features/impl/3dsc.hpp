@@ -80,6 +80,8 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::initCompute ()
   for (size_t j = 0; j < radius_bins_ + 1; j++)
     radii_interval_[j] = static_cast<float> (exp (log (min_radius_) + ((static_cast<float> (j) / static_cast<float> (radius_bins_)) * log (search_radius_ / min_radius_))));
 
+  bins_.setRadiiInterval (radii_interval_);
+
   // Fill theta divisions of elevation
   theta_divisions_.resize (elevation_bins_ + 1);
   for (size_t k = 0; k < elevation_bins_ + 1; k++)
@@ -131,11 +133,6 @@ template <typename PointInT, typename PointNT, typename PointOutT> bool
 pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
     size_t index, const pcl::PointCloud<PointNT> &normals, float rf[9], std::vector<float> &desc)
 {
-  // The RF is formed as this x_axis | y_axis | normal
-  Eigen::Map<Eigen::Vector3f> x_axis (rf);
-  Eigen::Map<Eigen::Vector3f> y_axis (rf + 3);
-  Eigen::Map<Eigen::Vector3f> normal (rf + 6);
-
   // Find every point within specified search_radius_
   std::vector<int> nn_indices;
   std::vector<float> nn_dists;
@@ -149,6 +146,28 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
     return (false);
   }
 
+  // The random values are only drawn for the points that have neighbors
+  Eigen::Vector3f random_axis;
+  random_axis[0] = static_cast<float> (rnd ());
+  random_axis[1] = static_cast<float> (rnd ());
+  random_axis[2] = static_cast<float> (rnd ());
+  computeDescriptor (index, normals, nn_indices, nn_dists, random_axis, rf, desc);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computeDescriptor (
+    size_t index, const pcl::PointCloud<PointNT> &normals,
+    const std::vector<int> &nn_indices, const std::vector<float> &nn_dists,
+    const Eigen::Vector3f &random_axis, float rf[9], std::vector<float> &desc) const
+{
+  // The RF is formed as this x_axis | y_axis | normal
+  Eigen::Map<Eigen::Vector3f> x_axis (rf);
+  Eigen::Map<Eigen::Vector3f> y_axis (rf + 3);
+  Eigen::Map<Eigen::Vector3f> normal (rf + 6);
+  const size_t neighb_cnt = nn_indices.size ();
+
   float minDist = std::numeric_limits<float>::max ();
   int minIndex = -1;
   for (size_t i = 0; i < nn_indices.size (); i++)
@@ -167,9 +186,7 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
   normal = normals[minIndex].getNormalVector3fMap ();
 
   // Compute and store the RF direction
-  x_axis[0] = static_cast<float> (rnd ());
-  x_axis[1] = static_cast<float> (rnd ());
-  x_axis[2] = static_cast<float> (rnd ());
+  x_axis = random_axis;
   if (!pcl::utils::equal (normal[2], 0.0f))
     x_axis[2] = - (normal[0]*x_axis[0] + normal[1]*x_axis[1]) / normal[2];
   else if (!pcl::utils::equal (normal[1], 0.0f))
@@ -185,6 +202,10 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
   // Store the 3rd frame vector
   y_axis = normal.cross (x_axis);
 
+  // Buffers for the local point density searches, reused for all the neighbours
+  std::vector<int> neighbour_indices;
+  std::vector<float> neighbour_distances;
+
   // For each point within radius
   for (size_t ne = 0; ne < neighb_cnt; ne++)
   {
@@ -215,42 +236,12 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
     float theta = normal.dot (no);
     theta = pcl::rad2deg (acosf (std::min (1.0f, std::max (-1.0f, theta))));
 
-    // Bin (j, k, l)
-    size_t j = 0;
-    size_t k = 0;
-    size_t l = 0;
-
     // Compute the Bin(j, k, l) coordinates of current neighbour
-    for (size_t rad = 1; rad < radius_bins_+1; rad++) 
-    {
-      if (r <= radii_interval_[rad]) 
-      {
-        j = rad-1;
-        break;
-      }
-    }
-
-    for (size_t ang = 1; ang < elevation_bins_+1; ang++) 
-    {
-      if (theta <= theta_divisions_[ang]) 
-      {
-        k = ang-1;
-        break;
-      }
-    }
-
-    for (size_t ang = 1; ang < azimuth_bins_+1; ang++) 
-    {
-      if (phi <= phi_divisions_[ang]) 
-      {
-        l = ang-1;
-        break;
-      }
-    }
+    const size_t j = bins_.getRadiusBin (r);
+    const size_t k = ShapeContextBins::getAngularBin (theta, theta_divisions_);
+    const size_t l = ShapeContextBins::getAngularBin (phi, phi_divisions_);
 
     // Local point density = number of points in a sphere of radius "point_density_radius_" around the current neighbour
-    std::vector<int> neighbour_indices;
-    std::vector<float> neighbour_distances;
     int point_density = searchForNeighbors (*surface_, nn_indices[ne], point_density_radius_, neighbour_indices, neighbour_distances);
     // point_density is NOT always bigger than 0 (on error, searchForNeighbors returns 0), so we must check for that
     if (point_density == 0)
@@ -272,7 +263,6 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
 
   // 3DSC does not define a repeatable local RF, we set it to zero to signal it to the user 
   memset (rf, 0, sizeof (rf[0]) * 9);
-  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
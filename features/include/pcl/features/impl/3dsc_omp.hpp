@@ -0,0 +1,115 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_3DSC_OMP_HPP_
+#define PCL_FEATURES_IMPL_3DSC_OMP_HPP_
+
+#include <pcl/features/3dsc_omp.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const int data_size = static_cast<int> (indices_->size ());
+
+  // The serial estimator draws random values only for the points that have neighbors, so the
+  // neighborhoods must be known before the random X axes can be drawn. The points are processed
+  // in chunks: the neighborhoods of a chunk are searched in parallel and kept, the random axes are
+  // drawn sequentially in the same order as the serial estimator, then the descriptors are computed
+  // in parallel from the kept neighborhoods. Every point is searched once, the memory is bounded by
+  // the chunk size, and the descriptors do not depend on the number of threads
+  const int chunk_size = 1024 * static_cast<int> (threads_);
+  std::vector<std::vector<int> > nn_indices (std::min (chunk_size, data_size));
+  std::vector<std::vector<float> > nn_dists (nn_indices.size ());
+  std::vector<Eigen::Vector3f> random_axes (nn_indices.size ());
+
+  bool is_dense = true;
+  for (int chunk_begin = 0; chunk_begin < data_size; chunk_begin += chunk_size)
+  {
+    const int chunk_end = std::min (chunk_begin + chunk_size, data_size);
+
+    // Find the neighbors of the finite points of the chunk
+#pragma omp parallel for num_threads(threads_) schedule(dynamic, 64)
+    for (int point_index = chunk_begin; point_index < chunk_end; ++point_index)
+    {
+      const int i = point_index - chunk_begin;
+      nn_indices[i].clear ();
+      nn_dists[i].clear ();
+      if (isFinite ((*input_)[(*indices_)[point_index]]) &&
+          this->searchForNeighbors ((*indices_)[point_index], search_radius_, nn_indices[i], nn_dists[i]) == 0)
+        nn_indices[i].clear ();
+    }
+
+    // Draw the random X axes of the points that have neighbors
+    for (int i = 0; i < chunk_end - chunk_begin; ++i)
+    {
+      if (nn_indices[i].empty ())
+        continue;
+      random_axes[i][0] = static_cast<float> (rnd ());
+      random_axes[i][1] = static_cast<float> (rnd ());
+      random_axes[i][2] = static_cast<float> (rnd ());
+    }
+
+    // Compute the descriptors of the chunk
+#pragma omp parallel for num_threads(threads_) schedule(dynamic, 64) reduction(&&:is_dense)
+    for (int point_index = chunk_begin; point_index < chunk_end; ++point_index)
+    {
+      const int i = point_index - chunk_begin;
+      output[point_index].descriptor.resize (descriptor_length_);
+
+      // If the point is not finite or has no neighbors, set the descriptor to NaN and continue
+      if (nn_indices[i].empty ())
+      {
+        for (size_t d = 0; d < descriptor_length_; ++d)
+          output[point_index].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+
+        memset (output[point_index].rf, 0, sizeof (output[point_index].rf[0]) * 9);
+        is_dense = false;
+        continue;
+      }
+
+      this->computeDescriptor (point_index, *normals_, nn_indices[i], nn_dists[i], random_axes[i],
+                               output[point_index].rf, output[point_index].descriptor);
+    }
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_ShapeContext3DEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::ShapeContext3DEstimationOMP<T,NT,OutT>;
+
+#endif    // PCL_FEATURES_IMPL_3DSC_OMP_HPP_
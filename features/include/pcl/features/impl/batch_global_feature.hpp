@@ -0,0 +1,175 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_BATCH_GLOBAL_FEATURE_H_
+#define PCL_FEATURES_IMPL_BATCH_GLOBAL_FEATURE_H_
+
+#include <pcl/features/batch_global_feature.h>
+#include <pcl/common/io.h>
+#include <pcl/search/brute_force.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/search/organized.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::BatchClusterSetup<pcl::ESFEstimation<PointInT, PointOutT> >::apply (
+    const EstimatorT &, EstimatorT &estimator,
+    const typename PointCloudIn::ConstPtr &cloud, const KdTreePtr &,
+    const boost::shared_ptr<std::vector<int> > &indices)
+{
+  typename PointCloudIn::Ptr cluster (new PointCloudIn);
+  pcl::copyPointCloud (*cloud, *indices, *cluster);
+
+  estimator.setInputCloud (cluster);
+  estimator.setSearchMethod (KdTreePtr (new pcl::search::BruteForce<PointInT> ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointLT, typename PointOutT> void
+pcl::BatchClusterSetup<pcl::GFPFHEstimation<PointInT, PointLT, PointOutT> >::apply (
+    const EstimatorT &prototype, EstimatorT &estimator,
+    const typename PointCloudIn::ConstPtr &cloud, const KdTreePtr &,
+    const boost::shared_ptr<std::vector<int> > &indices)
+{
+  typename PointCloudIn::Ptr cluster (new PointCloudIn);
+  pcl::copyPointCloud (*cloud, *indices, *cluster);
+
+  // The labels of the prototype refer to the full cloud
+  typename pcl::PointCloud<PointLT>::Ptr labels (new pcl::PointCloud<PointLT>);
+  pcl::copyPointCloud (*prototype.getInputLabels (), *indices, *labels);
+
+  estimator.setInputCloud (cluster);
+  estimator.setInputLabels (labels);
+  estimator.setSearchMethod (KdTreePtr (new pcl::search::BruteForce<PointInT> ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename EstimatorT> void
+pcl::BatchGlobalFeatureEstimation<PointInT, PointOutT, EstimatorT>::setClusters (const std::vector<pcl::PointIndices> &clusters)
+{
+  clusters_.resize (clusters.size ());
+  for (size_t c = 0; c < clusters.size (); ++c)
+    clusters_[c].reset (new std::vector<int> (clusters[c].indices));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename EstimatorT> void
+pcl::BatchGlobalFeatureEstimation<PointInT, PointOutT, EstimatorT>::compute (
+    PointCloudOut &descriptors, std::vector<int> &descriptor_clusters)
+{
+  descriptors.points.clear ();
+  descriptors.width = descriptors.height = 0;
+  descriptors.is_dense = true;
+  descriptor_clusters.clear ();
+
+  if (!estimator_)
+  {
+    PCL_ERROR ("[pcl::%s::compute] No estimator given!\n", getClassName ().c_str ());
+    return;
+  }
+  if (!input_ || input_->points.empty ())
+  {
+    PCL_ERROR ("[pcl::%s::compute] No input dataset given!\n", getClassName ().c_str ());
+    return;
+  }
+
+  // Build the shared search object once, before any thread uses it
+  if (!tree_)
+    tree_ = estimator_->getSearchMethod ();
+  if (!tree_)
+  {
+    if (input_->isOrganized ())
+      tree_.reset (new pcl::search::OrganizedNeighbor<PointInT> ());
+    else
+      tree_.reset (new pcl::search::KdTree<PointInT> (false));
+  }
+  if (tree_->getInputCloud () != input_)
+    tree_->setInputCloud (input_);
+
+  const int nr_clusters = static_cast<int> (clusters_.size ());
+  std::vector<PointCloudOut> cluster_descriptors (nr_clusters);
+
+#pragma omp parallel for schedule(dynamic) num_threads(threads_)
+  for (int c = 0; c < nr_clusters; ++c)
+  {
+    if (clusters_[c]->empty ())
+      continue;
+    // A fresh copy of the prototype per cluster, so that no state of a previous cluster leaks into this one
+    EstimatorT estimator (*estimator_);
+    BatchClusterSetup<EstimatorT>::apply (*estimator_, estimator, input_, tree_, clusters_[c]);
+    estimator.compute (cluster_descriptors[c]);
+  }
+
+  // Concatenate in cluster order
+  size_t nr_descriptors = 0;
+  for (int c = 0; c < nr_clusters; ++c)
+    nr_descriptors += cluster_descriptors[c].points.size ();
+
+  descriptors.points.reserve (nr_descriptors);
+  descriptor_clusters.reserve (nr_descriptors);
+  for (int c = 0; c < nr_clusters; ++c)
+  {
+    descriptors.points.insert (descriptors.points.end (),
+                               cluster_descriptors[c].points.begin (), cluster_descriptors[c].points.end ());
+    descriptor_clusters.insert (descriptor_clusters.end (), cluster_descriptors[c].points.size (), c);
+    if (!cluster_descriptors[c].is_dense)
+      descriptors.is_dense = false;
+  }
+  descriptors.width = static_cast<uint32_t> (descriptors.points.size ());
+  descriptors.height = 1;
+  descriptors.header = input_->header;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename EstimatorT> void
+pcl::BatchGlobalFeatureEstimation<PointInT, PointOutT, EstimatorT>::compute (
+    Eigen::MatrixXf &descriptors, std::vector<int> &descriptor_clusters)
+{
+  PointCloudOut output;
+  compute (output, descriptor_clusters);
+
+  // Global signatures keep their descriptor in a fixed size float histogram[] member, which
+  // does not have to span the whole point type (padding, additional fields)
+  const int dim = static_cast<int> (sizeof (output.points[0].histogram) / sizeof (float));
+
+  descriptors.resize (output.points.size (), dim);
+  for (size_t i = 0; i < output.points.size (); ++i)
+    descriptors.row (i) = Eigen::Map<const Eigen::RowVectorXf> (output.points[i].histogram, dim);
+}
+
+#endif    // PCL_FEATURES_IMPL_BATCH_GLOBAL_FEATURE_H_
@@ -209,6 +209,7 @@ pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   }
 
   centroids_dominant_orientations_.clear ();
+  dominant_normals_.clear ();
 
   // ---[ Step 0: remove normals with high curvature
   std::vector<int> indices_out;
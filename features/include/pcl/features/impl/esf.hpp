@@ -44,40 +44,29 @@
 #include <pcl/features/esf.h>
 #include <pcl/common/common.h>
 #include <pcl/common/transforms.h>
+#include <pcl/common/utils.h>
+#include <boost/random.hpp>
 #include <vector>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
-    PointCloudIn &pc, std::vector<float> &hist)
+pcl::ESFEstimation<PointInT, PointOutT>::sampleBlock (
+    const PointCloudIn &pc, unsigned int seed, unsigned int nr_samples, int binsize, SampleBlock &block) const
 {
-  const int binsize = 64;
-  unsigned int sample_size = 20000;
-  srand (static_cast<unsigned int> (time (0)));
-  int maxindex = static_cast<int> (pc.points.size ());
+  boost::mt19937 rng (seed);
+  boost::uniform_int<int> index_distribution (0, static_cast<int> (pc.points.size ()) - 1);
+  boost::variate_generator<boost::mt19937&, boost::uniform_int<int> > random_index (rng, index_distribution);
 
   int index1, index2, index3;
-  std::vector<float> d2v, d1v, d3v, wt_d3;
-  std::vector<int> wt_d2;
-  d1v.reserve (sample_size);
-  d2v.reserve (sample_size * 3);
-  d3v.reserve (sample_size);
-  wt_d2.reserve (sample_size * 3);
-  wt_d3.reserve (sample_size);
-
-  float h_in[binsize] = {0};
-  float h_out[binsize] = {0};
-  float h_mix[binsize] = {0};
-  float h_mix_ratio[binsize] = {0};
+  block.d2v.reserve (nr_samples * 3);
+  block.d3v.reserve (nr_samples);
+  block.wt_d2.reserve (nr_samples * 3);
+  block.wt_d3.reserve (nr_samples);
 
-  float h_a3_in[binsize] = {0};
-  float h_a3_out[binsize] = {0};
-  float h_a3_mix[binsize] = {0};
-  float h_d1[binsize] = {0};
-
-  float h_d3_in[binsize] = {0};
-  float h_d3_out[binsize] = {0};
-  float h_d3_mix[binsize] = {0};
+  block.h_a3_in.assign (binsize, 0.0f);
+  block.h_a3_out.assign (binsize, 0.0f);
+  block.h_a3_mix.assign (binsize, 0.0f);
+  block.h_mix_ratio.assign (binsize, 0.0f);
 
   float ratio=0.0;
   float pih = static_cast<float>(M_PI) / 2.0f;
@@ -85,12 +74,12 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
   int th1,th2,th3;
   int vxlcnt = 0;
   int pcnt1,pcnt2,pcnt3;
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  for (unsigned int nn_idx = 0; nn_idx < nr_samples; ++nn_idx)
   {
     // get a new random point
-    index1 = rand()%maxindex;
-    index2 = rand()%maxindex;
-    index3 = rand()%maxindex;
+    index1 = random_index ();
+    index2 = random_index ();
+    index3 = random_index ();
 
     if (index1==index2 || index1 == index3 || index2 == index3)
     {
@@ -134,14 +123,10 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
       continue;
     }
 
-    //pcl::PointXYZ cog(((rand()%100)-50.0f) / 100.0f,((rand()%100)-50.0f) / 100.0f,((rand()%100)-50.0f) / 100.0f);
-    // D1
-    //                      d1v.push_back( pcl::euclideanDistance(cog, pc.points[index1]) );
-
     // D2
-    d2v.push_back (pcl::euclideanDistance (pc.points[index1], pc.points[index2]));
-    d2v.push_back (pcl::euclideanDistance (pc.points[index1], pc.points[index3]));
-    d2v.push_back (pcl::euclideanDistance (pc.points[index2], pc.points[index3]));
+    block.d2v.push_back (pcl::euclideanDistance (pc.points[index1], pc.points[index2]));
+    block.d2v.push_back (pcl::euclideanDistance (pc.points[index1], pc.points[index3]));
+    block.d2v.push_back (pcl::euclideanDistance (pc.points[index2], pc.points[index3]));
 
     int vxlcnt_sum = 0;
     int p_cnt = 0;
@@ -153,9 +138,9 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
       const int xt = p2[0] < 0.0? static_cast<int>(floor(p2[0])+GRIDSIZE_H): static_cast<int>(ceil(p2[0])+GRIDSIZE_H-1);
       const int yt = p2[1] < 0.0? static_cast<int>(floor(p2[1])+GRIDSIZE_H): static_cast<int>(ceil(p2[1])+GRIDSIZE_H-1);
       const int zt = p2[2] < 0.0? static_cast<int>(floor(p2[2])+GRIDSIZE_H): static_cast<int>(ceil(p2[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt1));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int> (pcl_round (ratio * (binsize-1)))]++;
+      block.wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt1));
+      if (block.wt_d2.back () == 2)
+        block.h_mix_ratio[static_cast<int> (pcl_round (ratio * (binsize-1)))]++;
       vxlcnt_sum += vxlcnt;
       p_cnt += pcnt1;
     }
@@ -167,9 +152,9 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
       const int xt = p3[0] < 0.0? static_cast<int>(floor(p3[0])+GRIDSIZE_H): static_cast<int>(ceil(p3[0])+GRIDSIZE_H-1);
       const int yt = p3[1] < 0.0? static_cast<int>(floor(p3[1])+GRIDSIZE_H): static_cast<int>(ceil(p3[1])+GRIDSIZE_H-1);
       const int zt = p3[2] < 0.0? static_cast<int>(floor(p3[2])+GRIDSIZE_H): static_cast<int>(ceil(p3[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt2));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int>(pcl_round (ratio * (binsize-1)))]++;
+      block.wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt2));
+      if (block.wt_d2.back () == 2)
+        block.h_mix_ratio[static_cast<int>(pcl_round (ratio * (binsize-1)))]++;
       vxlcnt_sum += vxlcnt;
       p_cnt += pcnt2;
     }
@@ -181,85 +166,126 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
       const int xt = p3[0] < 0.0? static_cast<int>(floor(p3[0])+GRIDSIZE_H): static_cast<int>(ceil(p3[0])+GRIDSIZE_H-1);
       const int yt = p3[1] < 0.0? static_cast<int>(floor(p3[1])+GRIDSIZE_H): static_cast<int>(ceil(p3[1])+GRIDSIZE_H-1);
       const int zt = p3[2] < 0.0? static_cast<int>(floor(p3[2])+GRIDSIZE_H): static_cast<int>(ceil(p3[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs,ys,zs,xt,yt,zt,ratio,vxlcnt,pcnt3));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int>(pcl_round(ratio * (binsize-1)))]++;
+      block.wt_d2.push_back (this->lci (xs,ys,zs,xt,yt,zt,ratio,vxlcnt,pcnt3));
+      if (block.wt_d2.back () == 2)
+        block.h_mix_ratio[static_cast<int>(pcl_round(ratio * (binsize-1)))]++;
       vxlcnt_sum += vxlcnt;
       p_cnt += pcnt3;
     }
 
     // D3 ( herons formula )
-    d3v.push_back (sqrt (sqrt (s * (s-a) * (s-b) * (s-c))));
+    block.d3v.push_back (sqrt (sqrt (s * (s-a) * (s-b) * (s-c))));
     if (vxlcnt_sum <= 21)
     {
-      wt_d3.push_back (0);
-      h_a3_out[th1] += static_cast<float> (pcnt3) / 32.0f;
-      h_a3_out[th2] += static_cast<float> (pcnt1) / 32.0f;
-      h_a3_out[th3] += static_cast<float> (pcnt2) / 32.0f;
+      block.wt_d3.push_back (0);
+      block.h_a3_out[th1] += static_cast<float> (pcnt3) / 32.0f;
+      block.h_a3_out[th2] += static_cast<float> (pcnt1) / 32.0f;
+      block.h_a3_out[th3] += static_cast<float> (pcnt2) / 32.0f;
     }
     else
       if (p_cnt - vxlcnt_sum < 4)
       {
-        h_a3_in[th1] += static_cast<float> (pcnt3) / 32.0f;
-        h_a3_in[th2] += static_cast<float> (pcnt1) / 32.0f;
-        h_a3_in[th3] += static_cast<float> (pcnt2) / 32.0f;
-        wt_d3.push_back (1);
+        block.h_a3_in[th1] += static_cast<float> (pcnt3) / 32.0f;
+        block.h_a3_in[th2] += static_cast<float> (pcnt1) / 32.0f;
+        block.h_a3_in[th3] += static_cast<float> (pcnt2) / 32.0f;
+        block.wt_d3.push_back (1);
       }
       else
       {
-        h_a3_mix[th1] += static_cast<float> (pcnt3) / 32.0f;
-        h_a3_mix[th2] += static_cast<float> (pcnt1) / 32.0f;
-        h_a3_mix[th3] += static_cast<float> (pcnt2) / 32.0f;
-        wt_d3.push_back (static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt));
+        block.h_a3_mix[th1] += static_cast<float> (pcnt3) / 32.0f;
+        block.h_a3_mix[th2] += static_cast<float> (pcnt1) / 32.0f;
+        block.h_a3_mix[th3] += static_cast<float> (pcnt2) / 32.0f;
+        block.wt_d3.push_back (static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt));
       }
   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
+    PointCloudIn &pc, std::vector<float> &hist)
+{
+  const int binsize = 64;
+  const unsigned int sample_size = 20000;
+  // The triplets are drawn in fixed size blocks, each with its own generator seeded from seed_ and the
+  // block index, so that the result does not depend on the number of threads nor on the scheduling
+  const unsigned int block_size = 1000;
+  const int nr_blocks = static_cast<int> (sample_size / block_size);
+
+  if (pc.points.size () < 3)
+  {
+    PCL_ERROR ("[pcl::%s::computeESF] At least 3 points are needed to compute the descriptor!\n", getClassName ().c_str ());
+    hist.assign (binsize * 10, 0.0f);
+    return;
+  }
+
+  std::vector<SampleBlock> blocks (nr_blocks);
+#pragma omp parallel for num_threads (threads_)
+  for (int b = 0; b < nr_blocks; ++b)
+    sampleBlock (pc, pcl::utils::mixSeed (seed_, static_cast<unsigned int> (b)), block_size, binsize, blocks[b]);
+
+  // Merge the blocks in order
+  std::vector<float> d2v, d3v, wt_d3;
+  std::vector<int> wt_d2;
+  d2v.reserve (sample_size * 3);
+  d3v.reserve (sample_size);
+  wt_d2.reserve (sample_size * 3);
+  wt_d3.reserve (sample_size);
+
+  float h_in[binsize] = {0};
+  float h_out[binsize] = {0};
+  float h_mix[binsize] = {0};
+  float h_mix_ratio[binsize] = {0};
+
+  float h_a3_in[binsize] = {0};
+  float h_a3_out[binsize] = {0};
+  float h_a3_mix[binsize] = {0};
+
+  float h_d3_in[binsize] = {0};
+  float h_d3_out[binsize] = {0};
+  float h_d3_mix[binsize] = {0};
+
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    const SampleBlock &block = blocks[b];
+    d2v.insert (d2v.end (), block.d2v.begin (), block.d2v.end ());
+    d3v.insert (d3v.end (), block.d3v.begin (), block.d3v.end ());
+    wt_d2.insert (wt_d2.end (), block.wt_d2.begin (), block.wt_d2.end ());
+    wt_d3.insert (wt_d3.end (), block.wt_d3.begin (), block.wt_d3.end ());
+    for (int i = 0; i < binsize; ++i)
+    {
+      h_a3_in[i] += block.h_a3_in[i];
+      h_a3_out[i] += block.h_a3_out[i];
+      h_a3_mix[i] += block.h_a3_mix[i];
+      h_mix_ratio[i] += block.h_mix_ratio[i];
+    }
+  }
+
   // Normalizing, get max
-  float maxd1 = 0;
   float maxd2 = 0;
   float maxd3 = 0;
 
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
-  {
-    // get max of Dx
-    if (d1v[nn_idx] > maxd1)
-      maxd1 = d1v[nn_idx];
+  for (size_t nn_idx = 0; nn_idx < d2v.size (); ++nn_idx)
     if (d2v[nn_idx] > maxd2)
       maxd2 = d2v[nn_idx];
-    if (d2v[sample_size + nn_idx] > maxd2)
-      maxd2 = d2v[sample_size + nn_idx];
-    if (d2v[sample_size*2 +nn_idx] > maxd2)
-      maxd2 = d2v[sample_size*2 +nn_idx];
+  for (size_t nn_idx = 0; nn_idx < d3v.size (); ++nn_idx)
     if (d3v[nn_idx] > maxd3)
       maxd3 = d3v[nn_idx];
-  }
 
   // Normalize and create histogram
   int index;
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  for (size_t nn_idx = 0; nn_idx < d3v.size (); ++nn_idx)
   {
-    h_d1[static_cast<int>(pcl_round (d1v[nn_idx] / maxd1 * (binsize-1)))]++ ;
+    index = static_cast<int>(pcl_round (d3v[nn_idx] / maxd3 * (binsize-1)));
+    if (index < 0 || index >= binsize)
+      continue;
 
     if (wt_d3[nn_idx] >= 0.999) // IN
-    {
-      index = static_cast<int>(pcl_round (d3v[nn_idx] / maxd3 * (binsize-1)));
-      if (index >= 0 && index < binsize)
-        h_d3_in[index]++;
-    }
+      h_d3_in[index]++;
+    else if (wt_d3[nn_idx] <= 0.001) // OUT
+      h_d3_out[index]++ ;
     else
-    {
-      if (wt_d3[nn_idx] <= 0.001) // OUT
-      {
-        index = static_cast<int>(pcl_round (d3v[nn_idx] / maxd3 * (binsize-1)));
-        if (index >= 0 && index < binsize)
-          h_d3_out[index]++ ;
-      }
-      else
-      {
-        index = static_cast<int>(pcl_round (d3v[nn_idx] / maxd3 * (binsize-1)));
-        if (index >= 0 && index < binsize)
-          h_d3_mix[index]++;
-      }
-    }
+      h_d3_mix[index]++;
   }
   //normalize and create histogram
   for (size_t nn_idx = 0; nn_idx < d2v.size(); ++nn_idx )
@@ -312,7 +338,7 @@ template <typename PointInT, typename PointOutT> int
 pcl::ESFEstimation<PointInT, PointOutT>::lci (
     const int x1, const int y1, const int z1, 
     const int x2, const int y2, const int z2, 
-    float &ratio, int &incnt, int &pointcount)
+    float &ratio, int &incnt, int &pointcount) const
 {
   int voxelcount = 0;
   int voxel_in = 0;
@@ -349,7 +375,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i = 1; i<l; i++)
     {
       voxelcount++;;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(lut_[voxelIndex (act_voxel[0], act_voxel[1], act_voxel[2])] == 1);
       if (err_1 > 0)
       {
         act_voxel[1] += y_inc;
@@ -372,7 +398,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i=1; i<m; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(lut_[voxelIndex (act_voxel[0], act_voxel[1], act_voxel[2])] == 1);
       if (err_1 > 0)
       {
         act_voxel[0] +=  x_inc;
@@ -395,7 +421,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i=1; i<n; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(lut_[voxelIndex (act_voxel[0], act_voxel[1], act_voxel[2])] == 1);
       if (err_1 > 0)
       {
         act_voxel[1] += y_inc;
@@ -412,7 +438,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     }
   }
   voxelcount++;
-  voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+  voxel_in +=  static_cast<int>(lut_[voxelIndex (act_voxel[0], act_voxel[1], act_voxel[2])] == 1);
   incnt = voxel_in;
   pointcount = voxelcount;
 
@@ -450,7 +476,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::voxelize9 (PointCloudIn &cluster)
             ;
           }
           else
-            this->lut_[xi][yi][zi] = 1;
+            this->lut_[voxelIndex (xi, yi, zi)] = 1;
         }
   }
 }
@@ -479,7 +505,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::cleanup9 (PointCloudIn &cluster)
             ;
           }
           else
-            this->lut_[xi][yi][zi] = 0;
+            this->lut_[voxelIndex (xi, yi, zi)] = 0;
         }
   }
 }
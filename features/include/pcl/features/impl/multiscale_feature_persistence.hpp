@@ -39,6 +39,9 @@
 #define PCL_FEATURES_IMPL_MULTISCALE_FEATURE_PERSISTENCE_H_
 
 #include <pcl/features/multiscale_feature_persistence.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/search/radius_cache.h>
+#include <algorithm>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointFeature>
@@ -47,6 +50,7 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::MultiscaleFeatureP
   alpha_ (0), 
   distance_metric_ (L1),
   feature_estimator_ (),
+  single_pass_ (false),
   features_at_scale_ (),
   features_at_scale_vectorized_ (),
   mean_feature_ (),
@@ -92,6 +96,29 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::computeFeaturesAtA
 {
   features_at_scale_.resize (scale_values_.size ());
   features_at_scale_vectorized_.resize (scale_values_.size ());
+
+  // Search the neighborhoods once at the largest scale, the smaller scales truncate them
+  typename pcl::search::Search<PointSource>::Ptr user_search;
+  bool use_cache = single_pass_ && feature_estimator_->getInputCloud ();
+  if (use_cache)
+  {
+    user_search = feature_estimator_->getSearchMethod ();
+    typename pcl::search::Search<PointSource>::Ptr search = user_search;
+    if (!search)
+      search.reset (new pcl::search::KdTree<PointSource> (false));
+
+    float max_scale = *std::max_element (scale_values_.begin (), scale_values_.end ());
+    typename pcl::search::RadiusCache<PointSource>::Ptr cache (new pcl::search::RadiusCache<PointSource> (search, max_scale));
+
+    typename pcl::PointCloud<PointSource>::ConstPtr input = feature_estimator_->getInputCloud (),
+                                                    surface = feature_estimator_->getSearchSurface ();
+    cache->setInputCloud (surface ? surface : input);
+    if (surface && surface != input)
+      cache->setQueryCloud (input, feature_estimator_->getIndices ());
+
+    feature_estimator_->setSearchMethod (cache);
+  }
+
   for (size_t scale_i = 0; scale_i < scale_values_.size (); ++scale_i)
   {
     FeatureCloudPtr feature_cloud (new FeatureCloud ());
@@ -108,6 +135,9 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::computeFeaturesAtA
     }
     features_at_scale_vectorized_[scale_i] = feature_cloud_vectorized;
   }
+
+  if (use_cache)
+    feature_estimator_->setSearchMethod (user_search);
 }
 
 
@@ -46,6 +46,7 @@
 template <typename PointInT, typename PointNT, typename PointOutT>
 pcl::PPFEstimation<PointInT, PointNT, PointOutT>::PPFEstimation ()
     : FeatureFromNormals <PointInT, PointNT, PointOutT> ()
+    , threads_ (1)
 {
   feature_name_ = "PPFEstimation";
   // Slight hack in order to pass the check for the presence of a search method in Feature::initCompute ()
@@ -62,13 +63,26 @@ pcl::PPFEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   output.points.resize (indices_->size () * input_->points.size ());
   output.height = 1;
   output.width = static_cast<uint32_t> (output.points.size ());
-  output.is_dense = true;
 
-  // Compute point pair features for every pair of points in the cloud
-  for (size_t index_i = 0; index_i < indices_->size (); ++index_i)
+  const int nr_references = static_cast<int> (indices_->size ());
+  const size_t nr_points = input_->points.size ();
+  bool is_dense = true;
+
+  // Compute point pair features for every pair of points in the cloud. Every reference point fills its own row of
+  // the output, so the reference points are spread over the threads
+#pragma omp parallel for num_threads(threads_) schedule(dynamic, 16) reduction(&&:is_dense)
+  for (int index_i = 0; index_i < nr_references; ++index_i)
   {
     size_t i = (*indices_)[index_i];
-    for (size_t j = 0 ; j < input_->points.size (); ++j)
+
+    // The transformation of the reference point onto the x axis is shared by all its pairs
+    Eigen::Vector3f model_reference_point = input_->points[i].getVector3fMap (),
+                    model_reference_normal = normals_->points[i].getNormalVector3fMap ();
+    Eigen::AngleAxisf rotation_mg (acosf (model_reference_normal.dot (Eigen::Vector3f::UnitX ())),
+                                   model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
+    Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
+
+    for (size_t j = 0 ; j < nr_points; ++j)
     {
       PointOutT p;
       if (i != j)
@@ -81,14 +95,7 @@ pcl::PPFEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
                                       p.f1, p.f2, p.f3, p.f4))
         {
           // Calculate alpha_m angle
-          Eigen::Vector3f model_reference_point = input_->points[i].getVector3fMap (),
-                          model_reference_normal = normals_->points[i].getNormalVector3fMap (),
-                          model_point = input_->points[j].getVector3fMap ();
-          Eigen::AngleAxisf rotation_mg (acosf (model_reference_normal.dot (Eigen::Vector3f::UnitX ())),
-                                         model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
-          Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
-
-          Eigen::Vector3f model_point_transformed = transform_mg * model_point;
+          Eigen::Vector3f model_point_transformed = transform_mg * input_->points[j].getVector3fMap ();
           float angle = atan2f ( -model_point_transformed(2), model_point_transformed(1));
           if (sin (angle) * model_point_transformed(2) < 0.0f)
             angle *= (-1);
@@ -98,7 +105,7 @@ pcl::PPFEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
         {
           PCL_ERROR ("[pcl::%s::computeFeature] Computing pair feature vector between points %zu and %zu went wrong.\n", getClassName ().c_str (), i, j);
           p.f1 = p.f2 = p.f3 = p.f4 = p.alpha_m = std::numeric_limits<float>::quiet_NaN ();
-          output.is_dense = false;
+          is_dense = false;
         }
       }
       // Do not calculate the feature for identity pairs (i, i) as they are not used
@@ -106,12 +113,13 @@ pcl::PPFEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
       else
       {
         p.f1 = p.f2 = p.f3 = p.f4 = p.alpha_m = std::numeric_limits<float>::quiet_NaN ();
-        output.is_dense = false;
+        is_dense = false;
       }
 
-      output.points[index_i*input_->points.size () + j] = p;
+      output.points[index_i*nr_points + j] = p;
     }
   }
+  output.is_dense = is_dense;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -123,14 +131,26 @@ pcl::PPFEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
   output.height = 1;
   output.width = static_cast<uint32_t> (indices_->size () * input_->points.size ());
 
-  output.is_dense = true;
-  // Compute point pair features for every pair of points in the cloud
-  for (size_t index_i = 0; index_i < indices_->size (); ++index_i)
+  const int nr_references = static_cast<int> (indices_->size ());
+  const size_t nr_points = input_->points.size ();
+  bool is_dense = true;
+
+  // Compute point pair features for every pair of points in the cloud, one output row block per reference point
+#pragma omp parallel for num_threads(threads_) schedule(dynamic, 16) reduction(&&:is_dense)
+  for (int index_i = 0; index_i < nr_references; ++index_i)
   {
     size_t i = (*indices_)[index_i];
-    for (size_t j = 0 ; j < input_->points.size (); ++j)
+
+    // The transformation of the reference point onto the x axis is shared by all its pairs
+    Eigen::Vector3f model_reference_point = input_->points[i].getVector3fMap (),
+                    model_reference_normal = normals_->points[i].getNormalVector3fMap ();
+    Eigen::AngleAxisf rotation_mg (acosf (model_reference_normal.dot (Eigen::Vector3f::UnitX ())),
+                                   model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
+    Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
+
+    Eigen::VectorXf p (5);
+    for (size_t j = 0 ; j < nr_points; ++j)
     {
-      Eigen::VectorXf p (5);
       if (i != j)
       {
         if (//pcl::computePPFPairFeature
@@ -141,14 +161,7 @@ pcl::PPFEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
                                       p (0), p (1), p (2), p (3)))
         {
           // Calculate alpha_m angle
-          Eigen::Vector3f model_reference_point = input_->points[i].getVector3fMap (),
-                          model_reference_normal = normals_->points[i].getNormalVector3fMap (),
-                          model_point = input_->points[j].getVector3fMap ();
-          Eigen::AngleAxisf rotation_mg (acosf (model_reference_normal.dot (Eigen::Vector3f::UnitX ())),
-                                         model_reference_normal.cross (Eigen::Vector3f::UnitX ()).normalized ());
-          Eigen::Affine3f transform_mg = Eigen::Translation3f ( rotation_mg * ((-1) * model_reference_point)) * rotation_mg;
-
-          Eigen::Vector3f model_point_transformed = transform_mg * model_point;
+          Eigen::Vector3f model_point_transformed = transform_mg * input_->points[j].getVector3fMap ();
           float angle = atan2f ( -model_point_transformed(2), model_point_transformed(1));
           if (sin (angle) * model_point_transformed(2) < 0.0f)
             angle *= (-1);
@@ -158,7 +171,7 @@ pcl::PPFEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
         {
           PCL_ERROR ("[pcl::%s::computeFeature] Computing pair feature vector between points %zu and %zu went wrong.\n", getClassName ().c_str (), i, j);
           p.setConstant (std::numeric_limits<float>::quiet_NaN ());
-          output.is_dense = false;
+          is_dense = false;
         }
       }
       // Do not calculate the feature for identity pairs (i, i) as they are not used
@@ -166,12 +179,13 @@ pcl::PPFEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEigen (pcl
       else
       {
         p.setConstant (std::numeric_limits<float>::quiet_NaN ());
-        output.is_dense = false;
+        is_dense = false;
       }
 
-      output.points.row (index_i*input_->points.size () + j) = p;
+      output.points.row (index_i*nr_points + j) = p;
     }
   }
+  output.is_dense = is_dense;
 }
 
 
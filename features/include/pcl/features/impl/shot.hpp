@@ -307,72 +307,119 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     const int nr_bins,
     Eigen::VectorXf &shot)
 {
+  if (use_float_precision_)
+    interpolateSingleChannelBatch<float> (indices, sqr_dists, index, binDistance, nr_bins, shot);
+  else
+    interpolateSingleChannelBatch<double> (indices, sqr_dists, index, binDistance, nr_bins, shot);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> template <typename Scalar> void
+pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSingleChannelBatch (
+    const std::vector<int> &indices,
+    const std::vector<float> &sqr_dists,
+    const int index,
+    std::vector<double> &binDistance,
+    const int nr_bins,
+    Eigen::VectorXf &shot)
+{
+  typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> ArrayXs;
+
+  const int nr_neighbors = static_cast<int> (indices.size ());
+  if (nr_neighbors == 0)
+    return;
+
   const Eigen::Vector4f& central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
   const PointRFT& current_frame = (*frames_)[index];
+  const Eigen::Vector4f x_axis = current_frame.x_axis.getNormalVector4fMap ();
+  const Eigen::Vector4f y_axis = current_frame.y_axis.getNormalVector4fMap ();
+  const Eigen::Vector4f z_axis = current_frame.z_axis.getNormalVector4fMap ();
 
-  for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
+  // Gather the offsets of the neighbors (structure of arrays)
+  Eigen::ArrayXf dx (nr_neighbors), dy (nr_neighbors), dz (nr_neighbors);
+  for (int i_idx = 0; i_idx < nr_neighbors; ++i_idx)
   {
-    Eigen::Vector4f delta = surface_->points[indices[i_idx]].getVector4fMap () - central_point;
-    delta[3] = 0;
-
-    // Compute the Euclidean norm
-   double distance = sqrt (sqr_dists[i_idx]);
+    const Eigen::Vector4f &point = surface_->points[indices[i_idx]].getVector4fMap ();
+    dx[i_idx] = point[0] - central_point[0];
+    dy[i_idx] = point[1] - central_point[1];
+    dz[i_idx] = point[2] - central_point[2];
+  }
 
-    if (areEquals (distance, 0.0))
+  // Project the whole neighborhood onto the local reference frame. The terms are summed in the
+  // order of the SSE 4D dot product, which keeps the output identical to the per neighbor projection
+  ArrayXs x_lrf = ((dx * x_axis[0] + dz * x_axis[2]) + dy * x_axis[1]).template cast<Scalar> ();
+  ArrayXs y_lrf = ((dx * y_axis[0] + dz * y_axis[2]) + dy * y_axis[1]).template cast<Scalar> ();
+  ArrayXs z_lrf = ((dx * z_axis[0] + dz * z_axis[2]) + dy * z_axis[1]).template cast<Scalar> ();
+
+  // To avoid numerical problems afterwards
+  const Scalar tiny = static_cast<Scalar> (1E-30);
+  x_lrf = (x_lrf.abs () < tiny).select (Scalar (0), x_lrf);
+  y_lrf = (y_lrf.abs () < tiny).select (Scalar (0), y_lrf);
+  z_lrf = (z_lrf.abs () < tiny).select (Scalar (0), z_lrf);
+
+  // Euclidean norms and inclinations of the whole neighborhood at once
+  const ArrayXs distance = Eigen::Map<const Eigen::ArrayXf> (&sqr_dists[0], nr_neighbors).sqrt ().template cast<Scalar> ();
+  ArrayXs inclination_cos = z_lrf / distance;
+  inclination_cos = (inclination_cos < Scalar (-1)).select (Scalar (-1), inclination_cos);
+  inclination_cos = (inclination_cos > Scalar (1)).select (Scalar (1), inclination_cos);
+  const ArrayXs inclination = inclination_cos.acos ();
+
+  const Scalar radius1_2 = static_cast<Scalar> (radius1_2_);
+  const Scalar radius1_4 = static_cast<Scalar> (radius1_4_);
+  const Scalar radius3_4 = static_cast<Scalar> (radius3_4_);
+  const Scalar rad_45 = static_cast<Scalar> (PST_RAD_45);
+  const Scalar rad_90 = static_cast<Scalar> (PST_RAD_90);
+  const Scalar rad_135 = static_cast<Scalar> (PST_RAD_135);
+  const Scalar rad_pi_7_8 = static_cast<Scalar> (PST_RAD_PI_7_8);
+  const Scalar half = static_cast<Scalar> (0.5);
+#ifndef NDEBUG
+  const Scalar azimuth_eps = std::numeric_limits<Scalar>::epsilon () * 16;
+#endif
+
+  for (int i_idx = 0; i_idx < nr_neighbors; ++i_idx)
+  {
+    const Scalar distance_i = distance[i_idx];
+    if (areEquals (distance_i, Scalar (0)))
       continue;
 
-    double xInFeatRef = delta.dot (current_frame.x_axis.getNormalVector4fMap ());
-    double yInFeatRef = delta.dot (current_frame.y_axis.getNormalVector4fMap ());
-    double zInFeatRef = delta.dot (current_frame.z_axis.getNormalVector4fMap ());
-
-    // To avoid numerical problems afterwards
-    if (fabs (yInFeatRef) < 1E-30)
-      yInFeatRef  = 0;
-    if (fabs (xInFeatRef) < 1E-30)
-      xInFeatRef  = 0;
-    if (fabs (zInFeatRef) < 1E-30)
-      zInFeatRef  = 0;
-
-
-    unsigned char bit4 = ((yInFeatRef > 0) || ((yInFeatRef == 0.0) && (xInFeatRef < 0))) ? 1 : 0;
-    unsigned char bit3 = static_cast<unsigned char> (((xInFeatRef > 0) || ((xInFeatRef == 0.0) && (yInFeatRef > 0))) ? !bit4 : bit4);
+    const Scalar xInFeatRef = x_lrf[i_idx];
+    const Scalar yInFeatRef = y_lrf[i_idx];
+    const Scalar zInFeatRef = z_lrf[i_idx];
 
-    assert (bit3 == 0 || bit3 == 1);
-
-    int desc_index = (bit4<<3) + (bit3<<2);
-
-    desc_index = desc_index << 1;
-
-    if ((xInFeatRef * yInFeatRef > 0) || (xInFeatRef == 0.0))
-      desc_index += (fabs (xInFeatRef) >= fabs (yInFeatRef)) ? 0 : 4;
-    else
-      desc_index += (fabs (xInFeatRef) > fabs (yInFeatRef)) ? 4 : 0;
-
-    desc_index += zInFeatRef > 0 ? 1 : 0;
+    // Sector selection: the two bits identify the quadrant in the XY plane of the local reference frame
+    const int bit4 = (yInFeatRef > 0) || ((yInFeatRef == 0) && (xInFeatRef < 0));
+    const int bit3 = bit4 ^ static_cast<int> ((xInFeatRef > 0) || ((xInFeatRef == 0) && (yInFeatRef > 0)));
+    const Scalar abs_x = std::abs (xInFeatRef);
+    const Scalar abs_y = std::abs (yInFeatRef);
+    const bool same_sign = (xInFeatRef * yInFeatRef > 0) || (xInFeatRef == 0);
 
+    int desc_index = (bit4 << 4) + (bit3 << 3);
+    desc_index += (same_sign ? (abs_x < abs_y) : (abs_x > abs_y)) << 2;
+    desc_index += (zInFeatRef > 0);
     // 2 RADII
-    desc_index += (distance > radius1_2_) ? 2 : 0;
+    desc_index += (distance_i > radius1_2) << 1;
 
-    int step_index = static_cast<int>(floor (binDistance[i_idx] +0.5));
-    int volume_index = desc_index * (nr_bins+1);
+    const Scalar bin_distance = static_cast<Scalar> (binDistance[i_idx]);
+    const int step_index = static_cast<int> (std::floor (bin_distance + half));
+    const int volume_index = desc_index * (nr_bins+1);
 
     //Interpolation on the cosine (adjacent bins in the histogram)
+    const Scalar bin_offset = bin_distance - static_cast<Scalar> (step_index);
     binDistance[i_idx] -= step_index;
-    double intWeight = (1- fabs (binDistance[i_idx]));
+    Scalar intWeight = (1 - std::abs (bin_offset));
 
-    if (binDistance[i_idx] > 0)
-      shot[volume_index + ((step_index+1) % nr_bins)] += static_cast<float> (binDistance[i_idx]);
+    if (bin_offset > 0)
+      shot[volume_index + ((step_index+1) % nr_bins)] += static_cast<float> (bin_offset);
     else
-      shot[volume_index + ((step_index - 1 + nr_bins) % nr_bins)] += - static_cast<float> (binDistance[i_idx]);
+      shot[volume_index + ((step_index - 1 + nr_bins) % nr_bins)] += - static_cast<float> (bin_offset);
 
     //Interpolation on the distance (adjacent husks)
-
-    if (distance > radius1_2_)   //external sphere
+    if (distance_i > radius1_2)   //external sphere
     {
-      double radiusDistance = (distance - radius3_4_) / radius1_2_;
+      const Scalar radiusDistance = (distance_i - radius3_4) / radius1_2;
 
-      if (distance > radius3_4_) //most external sector, votes only for itself
-        intWeight += 1 - radiusDistance;  //peso=1-d
+      if (distance_i > radius3_4) //most external sector, votes only for itself
+        intWeight += 1 - radiusDistance;  //weight=1-d
       else  //3/4 of radius, votes also for the internal sphere
       {
         intWeight += 1 + radiusDistance;
@@ -381,9 +428,9 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     }
     else    //internal sphere
     {
-      double radiusDistance = (distance - radius1_4_) / radius1_2_;
+      const Scalar radiusDistance = (distance_i - radius1_4) / radius1_2;
 
-      if (distance < radius1_4_) //most internal sector, votes only for itself
+      if (distance_i < radius1_4) //most internal sector, votes only for itself
         intWeight += 1 + radiusDistance;  //weight=1-d
       else  //3/4 of radius, votes also for the external sphere
       {
@@ -393,20 +440,14 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     }
 
     //Interpolation on the inclination (adjacent vertical volumes)
-    double inclinationCos = zInFeatRef / distance;
-    if (inclinationCos < - 1.0)
-      inclinationCos = - 1.0;
-    if (inclinationCos > 1.0)
-      inclinationCos = 1.0;
+    const Scalar inclination_i = inclination[i_idx];
 
-    double inclination = acos (inclinationCos);
+    assert (inclination_i >= 0 && inclination_i <= static_cast<Scalar> (PST_RAD_180));
 
-    assert (inclination >= 0.0 && inclination <= PST_RAD_180);
-
-    if (inclination > PST_RAD_90 || (fabs (inclination - PST_RAD_90) < 1e-30 && zInFeatRef <= 0))
+    if (inclination_i > rad_90 || (std::abs (inclination_i - rad_90) < tiny && zInFeatRef <= 0))
     {
-      double inclinationDistance = (inclination - PST_RAD_135) / PST_RAD_90;
-      if (inclination > PST_RAD_135)
+      const Scalar inclinationDistance = (inclination_i - rad_135) / rad_90;
+      if (inclination_i > rad_135)
         intWeight += 1 - inclinationDistance;
       else
       {
@@ -417,8 +458,8 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     }
     else
     {
-      double inclinationDistance = (inclination - PST_RAD_45) / PST_RAD_90;
-      if (inclination < PST_RAD_45)
+      const Scalar inclinationDistance = (inclination_i - rad_45) / rad_90;
+      if (inclination_i < rad_45)
         intWeight += 1 + inclinationDistance;
       else
       {
@@ -428,20 +469,17 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
       }
     }
 
-    if (yInFeatRef != 0.0 || xInFeatRef != 0.0)
+    if (yInFeatRef != 0 || xInFeatRef != 0)
     {
       //Interpolation on the azimuth (adjacent horizontal volumes)
-      double azimuth = atan2 (yInFeatRef, xInFeatRef);
+      const Scalar azimuth = std::atan2 (yInFeatRef, xInFeatRef);
 
-      int sel = desc_index >> 2;
-      double angularSectorSpan = PST_RAD_45;
-      double angularSectorStart = - PST_RAD_PI_7_8;
+      const int sel = desc_index >> 2;
+      Scalar azimuthDistance = (azimuth - (- rad_pi_7_8 + rad_45 * static_cast<Scalar> (sel))) / rad_45;
 
-      double azimuthDistance = (azimuth - (angularSectorStart + angularSectorSpan*sel)) / angularSectorSpan;
+      assert ((azimuthDistance < 0.5 || areEquals (azimuthDistance, half, azimuth_eps)) && (azimuthDistance > - 0.5 || areEquals (azimuthDistance, - half, azimuth_eps)));
 
-      assert ((azimuthDistance < 0.5 || areEquals (azimuthDistance, 0.5)) && (azimuthDistance > - 0.5 || areEquals (azimuthDistance, - 0.5)));
-
-      azimuthDistance = (std::max)(- 0.5, std::min (azimuthDistance, 0.5));
+      azimuthDistance = (std::max)(- half, (std::min) (azimuthDistance, half));
 
       if (azimuthDistance > 0)
       {
@@ -457,7 +495,6 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
         intWeight += 1 + azimuthDistance;
         shot[interp_index * (nr_bins+1) + step_index] -= static_cast<float> (azimuthDistance);
       }
-
     }
 
     assert (volume_index + step_index >= 0 &&  volume_index + step_index < descLength_);
@@ -44,6 +44,8 @@
 #include <boost/property_map/property_map.hpp>
 #include <boost/graph/johnson_all_pairs_shortest.hpp>
 #include <pcl/common/distances.h>
+#include <algorithm>
+#include <utility>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -108,12 +110,52 @@ pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::geodesicFixedRadiusS
                                                                                        float &radius,
                                                                                        std::vector<int> &result_indices)
 {
+  if (radius <= neighborhood_radius_ && query_index < geodesic_neighbors_.size ())
+  {
+    const std::vector<float> &distances = geodesic_neighbor_distances_[query_index];
+    size_t count = std::lower_bound (distances.begin (), distances.end (), radius) - distances.begin ();
+    size_t offset = result_indices.size ();
+    result_indices.insert (result_indices.end (), geodesic_neighbors_[query_index].begin (),
+                           geodesic_neighbors_[query_index].begin () + count);
+    // Keep the neighbors in index order, as the full scan below returns them
+    std::sort (result_indices.begin () + offset, result_indices.end ());
+    return;
+  }
+
   for (size_t i = 0; i < geodesic_distances_[query_index].size (); ++i)
     if (i != query_index && geodesic_distances_[query_index][i] < radius)
       result_indices.push_back (static_cast<int> (i));
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::computeGeodesicNeighborhoods (float radius)
+{
+  geodesic_neighbors_.resize (geodesic_distances_.size ());
+  geodesic_neighbor_distances_.resize (geodesic_distances_.size ());
+
+  std::vector<std::pair<float, int> > neighbors;
+  for (size_t point_i = 0; point_i < geodesic_distances_.size (); ++point_i)
+  {
+    neighbors.clear ();
+    for (size_t point_j = 0; point_j < geodesic_distances_[point_i].size (); ++point_j)
+      if (point_j != point_i && geodesic_distances_[point_i][point_j] < radius)
+        neighbors.push_back (std::make_pair (geodesic_distances_[point_i][point_j], static_cast<int> (point_j)));
+    std::sort (neighbors.begin (), neighbors.end ());
+
+    geodesic_neighbors_[point_i].resize (neighbors.size ());
+    geodesic_neighbor_distances_[point_i].resize (neighbors.size ());
+    for (size_t n_i = 0; n_i < neighbors.size (); ++n_i)
+    {
+      geodesic_neighbor_distances_[point_i][n_i] = neighbors[n_i].first;
+      geodesic_neighbors_[point_i][n_i] = neighbors[n_i].second;
+    }
+  }
+  neighborhood_radius_ = radius;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::computeRegionsOfInterest (std::list<IndicesPtr> &rois)
@@ -199,6 +241,10 @@ pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::extractExtrema (std:
   std::vector<std::vector<bool> > is_min (scale_values_.size ()),
       is_max (scale_values_.size ());
 
+  // scan the geodesic distances once, at the largest scale; every scale then reads a prefix of the
+  // sorted neighborhoods
+  computeGeodesicNeighborhoods (*std::max_element (scale_values_.begin (), scale_values_.end ()));
+
   // for each point, check if it is a local extrema on each scale
   for (size_t scale_i = 0; scale_i < scale_values_.size (); ++scale_i)
   {
@@ -206,10 +252,11 @@ pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::extractExtrema (std:
         is_max_scale (input_->points.size ());
     for (size_t point_i = 0; point_i < input_->points.size (); ++point_i)
     {
-      std::vector<int> nn_indices;
-      geodesicFixedRadiusSearch (point_i, scale_values_[scale_i], nn_indices);
+      const std::vector<float> &nn_distances = geodesic_neighbor_distances_[point_i];
+      std::vector<int>::const_iterator nn_begin = geodesic_neighbors_[point_i].begin (),
+          nn_end = nn_begin + (std::lower_bound (nn_distances.begin (), nn_distances.end (), scale_values_[scale_i]) - nn_distances.begin ());
       bool is_max_point = true, is_min_point = true;
-      for (std::vector<int>::iterator nn_it = nn_indices.begin (); nn_it != nn_indices.end (); ++nn_it)
+      for (std::vector<int>::const_iterator nn_it = nn_begin; nn_it != nn_end; ++nn_it)
         if (F_scales_[scale_i][point_i] < F_scales_[scale_i][*nn_it])
           is_max_point = false;
         else
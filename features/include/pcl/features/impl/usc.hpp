@@ -70,6 +70,13 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initCompute ()
     return (false);
   }
 
+  return (initBins ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> bool
+pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initBins ()
+{
   if (search_radius_< min_radius_)
   {
     PCL_ERROR ("[pcl::%s::initCompute] search_radius_ must be GREATER than min_radius_.\n", getClassName ().c_str ());
@@ -94,6 +101,8 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initCompute ()
   for (size_t j = 0; j < radius_bins_ + 1; j++)
     radii_interval_[j] = static_cast<float> (exp (log (min_radius_) + ((static_cast<float> (j) / static_cast<float> (radius_bins_)) * log (search_radius_/min_radius_))));
 
+  bins_.setRadiiInterval (radii_interval_);
+
   // Fill theta didvisions of elevation
   theta_divisions_.resize (elevation_bins_+1);
   for (size_t k = 0; k < elevation_bins_+1; k++)
@@ -140,7 +149,7 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initCompute ()
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT, typename PointRFT> void
-pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computePointDescriptor (size_t index, /*float rf[9],*/ std::vector<float> &desc)
+pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computePointDescriptor (size_t index, /*float rf[9],*/ std::vector<float> &desc) const
 {
   pcl::Vector3fMapConst origin = input_->points[(*indices_)[index]].getVector3fMap ();
 
@@ -152,6 +161,11 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computePointDescriptor (
   std::vector<int> nn_indices;
   std::vector<float> nn_dists;
   const size_t neighb_cnt = searchForNeighbors ((*indices_)[index], search_radius_, nn_indices, nn_dists);
+
+  // Buffers for the local point density searches, reused for all the neighbours
+  std::vector<int> neighbour_indices;
+  std::vector<float> neighbour_didtances;
+
   // For each point within radius
   for (size_t ne = 0; ne < neighb_cnt; ne++)
   {
@@ -183,42 +197,12 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computePointDescriptor (
     float theta = normal.dot (no);
     theta = pcl::rad2deg (acosf (std::min (1.0f, std::max (-1.0f, theta))));
 
-    /// Bin (j, k, l)
-    size_t j = 0;
-    size_t k = 0;
-    size_t l = 0;
-
     /// Compute the Bin(j, k, l) coordinates of current neighbour
-    for (size_t rad = 1; rad < radius_bins_ + 1; rad++)
-    {
-      if (r <= radii_interval_[rad])
-      {
-        j = rad - 1;
-        break;
-      }
-    }
-
-    for (size_t ang = 1; ang < elevation_bins_ + 1; ang++)
-    {
-      if (theta <= theta_divisions_[ang])
-      {
-        k = ang - 1;
-        break;
-      }
-    }
-
-    for (size_t ang = 1; ang < azimuth_bins_ + 1; ang++)
-    {
-      if (phi <= phi_divisions_[ang])
-      {
-        l = ang - 1;
-        break;
-      }
-    }
+    const size_t j = bins_.getRadiusBin (r);
+    const size_t k = ShapeContextBins::getAngularBin (theta, theta_divisions_);
+    const size_t l = ShapeContextBins::getAngularBin (phi, phi_divisions_);
 
     /// Local point density = number of points in a sphere of radius "point_density_radius_" around the current neighbour
-    std::vector<int> neighbour_indices;
-    std::vector<float> neighbour_didtances;
     float point_density = static_cast<float> (searchForNeighbors (*surface_, nn_indices[ne], point_density_radius_, neighbour_indices, neighbour_didtances));
     /// point_density is always bigger than 0 because FindPointsWithinRadius returns at least the point itself
     float w = (1.0f / point_density) * volume_lut_[(l*elevation_bins_*radius_bins_) +
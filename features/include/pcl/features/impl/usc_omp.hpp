@@ -0,0 +1,90 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_USC_OMP_HPP_
+#define PCL_FEATURES_IMPL_USC_OMP_HPP_
+
+#include <pcl/features/usc_omp.h>
+#include <pcl/features/shot_lrf_omp.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> bool
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::initCompute ()
+{
+  if (!Feature<PointInT, PointOutT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  // Default LRF estimation alg: SHOTLocalReferenceFrameEstimationOMP
+  typename boost::shared_ptr<SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT> > lrf_estimator (new SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT> ());
+  lrf_estimator->setRadiusSearch (local_radius_);
+  lrf_estimator->setInputCloud (input_);
+  lrf_estimator->setIndices (indices_);
+  lrf_estimator->setNumberOfThreads (threads_);
+  if (!fake_surface_)
+    lrf_estimator->setSearchSurface (surface_);
+
+  if (!FeatureWithLocalReferenceFrames<PointInT, PointRFT>::initLocalReferenceFrames (indices_->size (), lrf_estimator))
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  return (this->initBins ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> void
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::computeFeature (PointCloudOut &output)
+{
+#pragma omp parallel for num_threads(threads_) schedule(dynamic, 64)
+  for (int point_index = 0; point_index < static_cast<int> (indices_->size ()); ++point_index)
+  {
+    output[point_index].descriptor.resize (descriptor_length_);
+    for (int d = 0; d < 9; ++d)
+      output.points[point_index].rf[d] = frames_->points[point_index].rf[ (4*(d/3) + (d%3)) ];
+
+    this->computePointDescriptor (point_index, output[point_index].descriptor);
+  }
+}
+
+#define PCL_INSTANTIATE_UniqueShapeContextOMP(T,OutT,RFT) template class PCL_EXPORTS pcl::UniqueShapeContextOMP<T,OutT,RFT>;
+
+#endif    // PCL_FEATURES_IMPL_USC_OMP_HPP_
@@ -137,6 +137,20 @@ namespace pcl
       inline NormType
       getDistanceMetric () { return distance_metric_; }
 
+      /** \brief Enable or disable the single neighborhood pass. When enabled, the neighbors of each point are
+       * searched only once, at the largest scale, and sorted by distance; the feature estimator is then given a
+       * search object that answers the searches at all the smaller scales by truncating those neighborhoods.
+       * \param single_pass true to search the neighborhoods only once (default false)
+       * \note the results are the same as the ones of the per-scale searches, up to the order in which the
+       * neighbors are given to the feature estimator
+       */
+      inline void
+      setSingleNeighborhoodPass (bool single_pass) { single_pass_ = single_pass; }
+
+      /** \brief Returns whether the neighborhoods are searched only once, at the largest scale */
+      inline bool
+      getSingleNeighborhoodPass () { return single_pass_; }
+
 
     private:
       /** \brief Checks if all the necessary input was given and the computations can successfully start */
@@ -182,6 +196,9 @@ namespace pcl
       /** \brief the feature estimator that will be used to determine the feature set at each scale level */
       FeatureEstimatorPtr feature_estimator_;
 
+      /** \brief Whether the neighborhoods are searched once at the largest scale and truncated for the others */
+      bool single_pass_;
+
       std::vector<FeatureCloudPtr> features_at_scale_;
       std::vector<std::vector<std::vector<float> > > features_at_scale_vectorized_;
       std::vector<float> mean_feature_;
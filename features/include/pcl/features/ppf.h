@@ -88,6 +88,15 @@ namespace pcl
       /** \brief Empty Constructor. */
       PPFEstimation ();
 
+      /** \brief Set the number of threads the pairs of the reference points are computed on.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+    protected:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
 
     private:
       /** \brief The method called for actually doing the computations
@@ -126,6 +135,7 @@ namespace pcl
       using PPFEstimation<PointInT, PointNT, pcl::PPFSignature>::input_;
       using PPFEstimation<PointInT, PointNT, pcl::PPFSignature>::normals_;
       using PPFEstimation<PointInT, PointNT, pcl::PPFSignature>::indices_;
+      using PPFEstimation<PointInT, PointNT, pcl::PPFSignature>::threads_;
 
     private:
       /** \brief The method called for actually doing the computations
@@ -0,0 +1,129 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FEATURES_SHAPE_CONTEXT_BINS_H_
+#define PCL_FEATURES_SHAPE_CONTEXT_BINS_H_
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace pcl
+{
+  /** \brief ShapeContextBins finds the spherical bin of a neighbour for the shape context
+    * descriptors (ShapeContext3DEstimation, UniqueShapeContext).
+    *
+    * The radial bin is looked up in a table over the search radius, followed by a short forward
+    * scan, instead of scanning all the (logarithmically spaced) radii intervals. The angular bins
+    * are uniform, so they are computed from the division width directly.
+    * \ingroup features
+    */
+  class ShapeContextBins
+  {
+    public:
+      /** \brief Empty constructor. */
+      ShapeContextBins () : radii_interval_ (), radius_lut_ (), radius_lut_scale_ (0.0f) {}
+
+      /** \brief Set the radii intervals and fill the radial bins look up table.
+        * \param[in] radii_interval the bin limits along the radius, the last one being the search radius
+        */
+      inline void
+      setRadiiInterval (const std::vector<float> &radii_interval)
+      {
+        radii_interval_ = radii_interval;
+        const size_t radius_bins = radii_interval_.size () - 1;
+
+        // Each cell stores the first bin a distance falling in the cell (or in the previous one,
+        // to be safe against rounding) can belong to
+        radius_lut_.resize (64 * radius_bins);
+        radius_lut_scale_ = static_cast<float> (radius_lut_.size ()) / radii_interval_[radius_bins];
+        for (size_t cell = 0, j = 0; cell < radius_lut_.size (); ++cell)
+        {
+          float lower = (static_cast<float> (cell) - 1.0f) / radius_lut_scale_;
+          while (j < radius_bins - 1 && radii_interval_[j + 1] < lower)
+            ++j;
+          radius_lut_[cell] = j;
+        }
+      }
+
+      /** \brief Get the radial bin of a neighbour at distance \a r. Distances beyond the
+        * last interval fall in bin 0, as with a linear scan of the intervals.
+        * \param[in] r the distance between the neighbour and the origin
+        */
+      inline size_t
+      getRadiusBin (float r) const
+      {
+        if (!(r <= radii_interval_.back ()))
+          return (0);
+        size_t j = radius_lut_[std::min (static_cast<size_t> (r * radius_lut_scale_), radius_lut_.size () - 1)];
+        while (r > radii_interval_[j + 1])
+          ++j;
+        return (j);
+      }
+
+      /** \brief Get the bin of an angle given uniform angular divisions.
+        * \param[in] angle the angle in degrees
+        * \param[in] divisions the bin limits, starting at 0
+        */
+      static inline size_t
+      getAngularBin (float angle, const std::vector<float> &divisions)
+      {
+        const size_t bins = divisions.size () - 1;
+        if (!(angle <= divisions[bins]))
+          return (0);
+        size_t k = angle > 0.0f ? std::min (static_cast<size_t> (angle / divisions[1]), bins - 1) : 0;
+        while (k > 0 && angle <= divisions[k])
+          --k;
+        while (angle > divisions[k + 1])
+          ++k;
+        return (k);
+      }
+
+    private:
+      /** \brief Bin limits along the radius. */
+      std::vector<float> radii_interval_;
+
+      /** \brief Radial bins look up table: first bin a distance falling in each cell can belong to. */
+      std::vector<size_t> radius_lut_;
+
+      /** \brief Scale from a distance to its cell in the radial bins look up table. */
+      float radius_lut_scale_;
+  };
+}
+
+#endif  //#ifndef PCL_FEATURES_SHAPE_CONTEXT_BINS_H_
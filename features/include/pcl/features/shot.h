@@ -92,12 +92,25 @@ namespace pcl
         sqradius_ (0), radius3_4_ (0), radius1_4_ (0), radius1_2_ (0),
         nr_grid_sector_ (32),
         maxAngularSectors_ (28),
-        descLength_ (0)
+        descLength_ (0),
+        use_float_precision_ (false)
       {
         feature_name_ = "SHOTEstimation";
       };
 
     public:
+      /** \brief Set whether the binning and interpolation of the neighbors should be carried out in single
+        * precision instead of double precision. Single precision is faster, but the resulting descriptor
+        * differs slightly from the double precision one.
+        * \param[in] use_float_precision true to bin in single precision, false (default) for double precision
+        */
+      inline void
+      setUseFloatPrecision (bool use_float_precision) { use_float_precision_ = use_float_precision; }
+
+      /** \brief Get whether the binning and interpolation of the neighbors is carried out in single precision. */
+      inline bool
+      getUseFloatPrecision () const { return (use_float_precision_); }
+
        /** \brief Estimate the SHOT descriptor for a given point based on its spatial neighborhood of 3D points with normals
          * \param[in] index the index of the point in indices_
          * \param[in] indices the k-neighborhood point indices in surface_
@@ -133,6 +146,30 @@ namespace pcl
                                 const int nr_bins,
                                 Eigen::VectorXf &shot);
 
+      /** \brief Batched quadrilinear interpolation over all the neighbors of a point, templated on the
+        * precision used for the binning.
+        *
+        * The neighbor offsets are gathered into a structure of arrays. The projection onto the local
+        * reference frame, the distances, the inclinations (acos) and the clamping are evaluated with
+        * vectorized Eigen expressions over the whole neighborhood. The sector selection, the bins and
+        * weights of the four interpolations and the scattering into the histogram stay in a scalar
+        * loop per neighbor: evaluating them with masked array expressions was measured to be slower,
+        * since both sides of every branch have to be computed.
+        * \param[in] indices the neighborhood point indices
+        * \param[in] sqr_dists the neighborhood point distances
+        * \param[in] index the index of the point in indices_
+        * \param[out] binDistance the resultant distance shape histogram
+        * \param[in] nr_bins the number of bins in the shape histogram
+        * \param[out] shot the resultant SHOT histogram
+        */
+      template <typename Scalar> void
+      interpolateSingleChannelBatch (const std::vector<int> &indices,
+                                     const std::vector<float> &sqr_dists,
+                                     const int index,
+                                     std::vector<double> &binDistance,
+                                     const int nr_bins,
+                                     Eigen::VectorXf &shot);
+
       /** \brief Normalize the SHOT histogram.
         * \param[in,out] shot the SHOT histogram
         * \param[in] desc_length the length of the histogram
@@ -178,6 +215,9 @@ namespace pcl
       /** \brief One SHOT length. */
       int descLength_;
 
+      /** \brief Whether the binning is carried out in single precision. */
+      bool use_float_precision_;
+
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud
         */
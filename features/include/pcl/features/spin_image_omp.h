@@ -0,0 +1,122 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SPIN_IMAGE_OMP_H_
+#define PCL_SPIN_IMAGE_OMP_H_
+
+#include <pcl/point_types.h>
+#include <pcl/features/spin_image.h>
+
+namespace pcl
+{
+  /** \brief SpinImageEstimationOMP estimates spin-image descriptors in the given input points,
+    * in parallel, using the OpenMP standard.
+    *
+    * See SpinImageEstimation for the description of the descriptor and of its parameters.
+    * Exceptions raised while computing a spin image (e.g. too few points in the support) are
+    * rethrown from compute () once all the threads are done.
+    *
+    * \author Roman Shapovalov, Alexander Velizhev
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointNT, typename PointOutT>
+  class SpinImageEstimationOMP : public SpinImageEstimation<PointInT, PointNT, PointOutT>
+  {
+    public:
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+
+      typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+
+      typedef typename boost::shared_ptr<SpinImageEstimationOMP<PointInT, PointNT, PointOutT> > Ptr;
+      typedef typename boost::shared_ptr<const SpinImageEstimationOMP<PointInT, PointNT, PointOutT> > ConstPtr;
+
+      /** \brief Constructs empty spin image estimator.
+        *
+        * \param[in] image_width spin-image resolution, number of bins along one dimension
+        * \param[in] support_angle_cos minimal allowed cosine of the angle between
+        *   the normals of input point and search surface point for the point
+        *   to be retained in the support
+        * \param[in] min_pts_neighb min number of points in the support to correctly estimate
+        *   spin-image. If at some point the support contains less points, exception is thrown
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      SpinImageEstimationOMP (unsigned int image_width = 8,
+                              double support_angle_cos = 0.0,   // when 0, this is bogus, so not applied
+                              unsigned int min_pts_neighb = 0,
+                              unsigned int nr_threads = 1) :
+        SpinImageEstimation<PointInT, PointNT, PointOutT> (image_width, support_angle_cos, min_pts_neighb),
+        threads_ ()
+      {
+        feature_name_ = "SpinImageEstimationOMP";
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+    protected:
+      /** \brief Estimate the Spin Image descriptors at a set of points given by
+        * setInputWithNormals() using the surface in setSearchSurfaceWithNormals() and the spatial locator
+        * \param[out] output the resultant point cloud that contains the Spin Image feature estimates
+        */
+      virtual void
+      computeFeature (PointCloudOut &output);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+    private:
+      /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
+        * \param[out] output the output point cloud
+        */
+      void
+      computeFeatureEigen (pcl::PointCloud<Eigen::MatrixXf> &) {}
+  };
+}
+
+#endif  //#ifndef PCL_SPIN_IMAGE_OMP_H_
@@ -72,7 +72,8 @@ namespace pcl
 
       /** \brief Empty constructor */
       StatisticalMultiscaleInterestRegionExtraction () :
-        scale_values_ (), geodesic_distances_ (), F_scales_ ()
+        scale_values_ (), geodesic_distances_ (), F_scales_ (),
+        geodesic_neighbors_ (), geodesic_neighbor_distances_ (), neighborhood_radius_ (0.0f)
       {};
 
       /** \brief Method that generates the underlying nearest neighbor graph based on the
@@ -108,6 +109,13 @@ namespace pcl
                                  float &radius,
                                  std::vector<int> &result_indices);
 
+      /** \brief Collects, for each point, the geodesic neighbors closer than \a radius, sorted by increasing
+       * distance, so that the searches at all the scales below \a radius become prefix lookups
+       * \param radius the largest radius the neighborhoods will be queried with
+       */
+      void
+      computeGeodesicNeighborhoods (float radius);
+
       void
       computeF ();
 
@@ -119,6 +127,11 @@ namespace pcl
       std::vector<float> scale_values_;
       std::vector<std::vector<float> > geodesic_distances_;
       std::vector<std::vector<float> > F_scales_;
+
+      /** \brief The geodesic neighborhoods at the largest scale, sorted by increasing distance */
+      std::vector<std::vector<int> > geodesic_neighbors_;
+      std::vector<std::vector<float> > geodesic_neighbor_distances_;
+      float neighborhood_radius_;
   };
 }
 
@@ -42,6 +42,7 @@
 
 #include <pcl/point_types.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/shape_context_bins.h>
 
 namespace pcl
 {
@@ -87,6 +88,7 @@ namespace pcl
        /** \brief Constructor. */
        UniqueShapeContext () :
          radii_interval_(0), theta_divisions_(0), phi_divisions_(0), volume_lut_(0),
+         bins_ (),
          azimuth_bins_(12), elevation_bins_(11), radius_bins_(15),
          min_radius_(0.1), point_density_radius_(0.2), descriptor_length_ (), local_radius_ (2.5)
        {
@@ -163,12 +165,18 @@ namespace pcl
         * \param[out] desc descriptor to compute
         */
       void
-      computePointDescriptor (size_t index, std::vector<float> &desc);
+      computePointDescriptor (size_t index, std::vector<float> &desc) const;
 
-      /** \brief Initialize computation by allocating all the intervals and the volume lookup table. */
+      /** \brief Initialize computation by estimating the local reference frames and allocating all the
+        * intervals and the volume lookup table.
+        */
       virtual bool
       initCompute ();
 
+      /** \brief Allocate all the intervals and the volume lookup table. */
+      bool
+      initBins ();
+
       /** \brief The actual feature computation.
         * \param[out] output the resultant features
         */
@@ -187,6 +195,9 @@ namespace pcl
       /** \brief Volumes look up table. */
       std::vector<float> volume_lut_;
 
+      /** \brief Radial and angular bins look up. */
+      ShapeContextBins bins_;
+
       /** \brief Bins along the azimuth dimension. */
       size_t azimuth_bins_;
 
@@ -0,0 +1,117 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_USC_OMP_H_
+#define PCL_FEATURES_USC_OMP_H_
+
+#include <pcl/point_types.h>
+#include <pcl/features/usc.h>
+
+namespace pcl
+{
+  /** \brief UniqueShapeContextOMP estimates the Unique Shape Context descriptor for a given
+    * point cloud dataset, in parallel, using the OpenMP standard. The default local reference
+    * frames are estimated in parallel as well, using SHOTLocalReferenceFrameEstimationOMP.
+    *
+    * \author Alessandro Franchi, Federico Tombari, Samuele Salti (original code)
+    * \author Nizar Sallem (port to PCL)
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointOutT, typename PointRFT = pcl::ReferenceFrame>
+  class UniqueShapeContextOMP : public UniqueShapeContext<PointInT, PointOutT, PointRFT>
+  {
+    public:
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::surface_;
+      using Feature<PointInT, PointOutT>::fake_surface_;
+      using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::descriptor_length_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::local_radius_;
+
+      typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+      typedef typename Feature<PointInT, PointOutT>::PointCloudIn PointCloudIn;
+
+      /** \brief Constructor.
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      UniqueShapeContextOMP (unsigned int nr_threads = 1) : threads_ ()
+      {
+        feature_name_ = "UniqueShapeContextOMP";
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+    protected:
+      /** \brief Initialize computation by estimating the local reference frames in parallel and
+        * allocating all the intervals and the volume lookup table.
+        */
+      virtual bool
+      initCompute ();
+
+      /** \brief The actual feature computation.
+        * \param[out] output the resultant features
+        */
+      virtual void
+      computeFeature (PointCloudOut &output);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+    private:
+      /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
+        * \param[out] output the output point cloud
+        */
+      void
+      computeFeatureEigen (pcl::PointCloud<Eigen::MatrixXf> &) {}
+  };
+}
+
+#endif  //#ifndef PCL_FEATURES_USC_OMP_H_
@@ -44,6 +44,12 @@
 namespace pcl
 {
   /** \brief A bilateral filter implementation for point cloud data. Uses the intensity data channel.
+    *
+    * In approximate mode (see setApproximate ()) the neighbors are not searched: the points are splatted onto
+    * a permutohedral lattice over (x/sigma_s, y/sigma_s, z/sigma_s, intensity/sigma_r), which is blurred and
+    * sliced back at every point. This runs in linear time in the number of points, but the Gaussian window
+    * is not truncated at 2 sigma_s and the interpolation on the lattice adds an error of a few percent of the
+    * intensity variations within the window.
     * \note For more information please see 
     * <b>C. Tomasi and R. Manduchi. Bilateral Filtering for Gray and Color Images.
     * In Proceedings of the IEEE International Conference on Computer Vision,
@@ -65,7 +71,9 @@ namespace pcl
         */
       BilateralFilter () : sigma_s_ (0), 
                            sigma_r_ (std::numeric_limits<double>::max ()),
-                           tree_ ()
+                           tree_ (),
+                           approximate_ (false),
+                           threads_ (1)
       {
       }
 
@@ -126,6 +134,39 @@ namespace pcl
         tree_ = tree;
       }
 
+      /** \brief Set whether to filter on a permutohedral lattice instead of searching the neighbors of every
+        * point. The search method is not used in that case.
+        * \param[in] approximate true for the linear time approximation, false (default) for the exact filter
+        */
+      inline void
+      setApproximate (bool approximate)
+      {
+        approximate_ = approximate;
+      }
+
+      /** \brief Get whether the filter runs on a permutohedral lattice. */
+      inline bool
+      getApproximate () const
+      {
+        return (approximate_);
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = (nr_threads == 0) ? 1 : nr_threads;
+      }
+
+    protected:
+      /** \brief Filter the input data on a permutohedral lattice.
+        * \param[out] output the resultant point cloud, a copy of the input with smoothed intensities
+        */
+      void
+      applyFilterApproximate (PointCloud &output);
+
     private:
 
       /** \brief The bilateral filter Gaussian distance kernel.
@@ -145,6 +186,12 @@ namespace pcl
 
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
+
+      /** \brief Whether to filter on a permutohedral lattice. */
+      bool approximate_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
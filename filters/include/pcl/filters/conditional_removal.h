@@ -72,6 +72,20 @@ namespace pcl
         */
       int
       compare (const PointT& p, const double& val);
+
+      /** \brief Get the type of data. */
+      inline uint8_t
+      getDataType () const
+      {
+        return (datatype_);
+      }
+
+      /** \brief Get the data offset. */
+      inline uint32_t
+      getOffset () const
+      {
+        return (offset_);
+      }
     protected:
       /** \brief The type of data. */
       uint8_t datatype_;
@@ -108,6 +122,17 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const = 0;
 
+      /** \brief Evaluate a block of points at once.
+        * \details The default implementation calls evaluate () on every point. Derived classes
+        * override it to resolve the data type and the operator once per block instead of once per point.
+        * \param[in] cloud the point cloud holding the points
+        * \param[in] indices the indices of the points to evaluate
+        * \param[in] nr_points the number of indices
+        * \param[out] mask 1 for the points that satisfy the comparison, 0 for the others
+        */
+      virtual void
+      evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask) const;
+
     protected:
       /** \brief True if capable. */
       bool capable_;
@@ -171,6 +196,15 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const;
 
+      /** \brief Determine the result of this comparison for a block of points.
+        * \param[in] cloud the point cloud holding the points
+        * \param[in] indices the indices of the points to evaluate
+        * \param[in] nr_points the number of indices
+        * \param[out] mask 1 for the points that satisfy the comparison, 0 for the others
+        */
+      virtual void
+      evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask) const;
+
     protected:
       /** \brief All types (that we care about) can be represented as a double. */
       double compare_val_;
@@ -211,6 +245,15 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const;
 
+      /** \brief Determine the result of this comparison for a block of points.
+        * \param[in] cloud the point cloud holding the points
+        * \param[in] indices the indices of the points to evaluate
+        * \param[in] nr_points the number of indices
+        * \param[out] mask 1 for the points that satisfy the comparison, 0 for the others
+        */
+      virtual void
+      evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask) const;
+
     protected:
       /** \brief The name of the component. */
       std::string component_name_;
@@ -473,6 +516,24 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const = 0;
 
+      /** \brief Evaluate a block of points at once.
+        * \details The default implementation calls evaluate () on every point. Derived classes
+        * override it to resolve the data type and the operator once per block instead of once per point.
+        * \param[in] cloud the point cloud holding the points
+        * \param[in] indices the indices of the points to evaluate
+        * \param[in] nr_points the number of indices
+        * \param[out] mask 1 for the points that satisfy the condition, 0 for the others
+        * \param[in] scratch a buffer of at least getNestingDepth () * nr_points bytes, used for the
+        * results of the terms; every nesting level uses its first nr_points bytes and passes the
+        * rest on to its nested conditions
+        */
+      virtual void
+      evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask, uint8_t *scratch) const;
+
+      /** \brief Get the number of nesting levels of this condition, itself included. */
+      size_t
+      getNestingDepth () const;
+
     protected:
       /** \brief True if capable. */
       bool capable_;
@@ -510,6 +571,18 @@ namespace pcl
         */
       virtual bool
       evaluate (const PointT &point) const;
+
+      /** \brief Determine which points of a block meet this condition.
+        * \details The comparisons and nested conditions are evaluated over the whole block, and
+        * the remaining ones are skipped once no point of the block is left.
+        * \param[in] cloud the point cloud holding the points
+        * \param[in] indices the indices of the points to evaluate
+        * \param[in] nr_points the number of indices
+        * \param[out] mask 1 for the points that meet the condition, 0 for the others
+        * \param[in] scratch a buffer of at least getNestingDepth () * nr_points bytes
+        */
+      virtual void
+      evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask, uint8_t *scratch) const;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////
@@ -538,6 +611,18 @@ namespace pcl
         */
       virtual bool
       evaluate (const PointT &point) const;
+
+      /** \brief Determine which points of a block meet this condition.
+        * \details The comparisons and nested conditions are evaluated over the whole block, and
+        * the remaining ones are skipped once all points of the block are accepted.
+        * \param[in] cloud the point cloud holding the points
+        * \param[in] indices the indices of the points to evaluate
+        * \param[in] nr_points the number of indices
+        * \param[out] mask 1 for the points that meet the condition, 0 for the others
+        * \param[in] scratch a buffer of at least getNestingDepth () * nr_points bytes
+        */
+      virtual void
+      evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask, uint8_t *scratch) const;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////
@@ -568,6 +653,10 @@ namespace pcl
     *  range_filt.setCondition (range_cond);
     *  range_filt.setKeepOrganized (false);
     *
+    * With \a setBlockEvaluation (true), the condition is evaluated over blocks of points instead of
+    * point by point (see ConditionBase::evaluateBlock), which gives the same result for a fraction of
+    * the virtual calls and data type dispatches.
+    *
     * \author Louis LeGrand, Intel Labs Seattle
     * \ingroup filters
     */
@@ -598,7 +687,7 @@ namespace pcl
         */
       ConditionalRemoval (int extract_removed_indices = false) :
         Filter<PointT>::Filter (extract_removed_indices), capable_ (false), keep_organized_ (false), condition_ (),
-        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ())
+        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ()), block_evaluation_ (false)
       {
         filter_name_ = "ConditionalRemoval";
       }
@@ -610,7 +699,7 @@ namespace pcl
         */
       ConditionalRemoval (ConditionBasePtr condition, bool extract_removed_indices = false) :
         Filter<PointT>::Filter (extract_removed_indices), capable_ (false), keep_organized_ (false), condition_ (),
-        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ())
+        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ()), block_evaluation_ (false)
       {
         filter_name_ = "ConditionalRemoval";
         setCondition (condition);
@@ -656,6 +745,23 @@ namespace pcl
       void
       setCondition (ConditionBasePtr condition);
 
+      /** \brief Set whether the condition is evaluated over blocks of points (see ConditionBase::evaluateBlock)
+        * rather than point by point. Both give the same output. (default: false)
+        * \param[in] block_evaluation true to evaluate blocks of points
+        */
+      inline void
+      setBlockEvaluation (bool block_evaluation)
+      {
+        block_evaluation_ = block_evaluation;
+      }
+
+      /** \brief Get whether the condition is evaluated over blocks of points. */
+      inline bool
+      getBlockEvaluation () const
+      {
+        return (block_evaluation_);
+      }
+
     protected:
       /** \brief Filter a Point Cloud.
         * \param output the resultant point cloud message
@@ -680,6 +786,16 @@ namespace pcl
         * the correct field type. 
         */
       float user_filter_value_;
+
+      /** \brief True if the condition is evaluated over blocks of points. */
+      bool block_evaluation_;
+
+      /** \brief Evaluate the condition on a list of points, a cache sized block at a time.
+        * \param[in] indices the indices of the points to evaluate
+        * \param[out] mask 1 for the points that satisfy the condition, 0 for the others
+        */
+      void
+      evaluateCondition (const std::vector<int> &indices, std::vector<uint8_t> &mask) const;
   };
 }
 
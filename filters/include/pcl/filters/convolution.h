@@ -69,6 +69,13 @@ namespace pcl
       * - Duplicating: the missing rows or columns are obtained throug
       * duplicating
       *
+      * For PointXYZ, PointXYZI, PointXYZRGB and RGB clouds the convolved
+      * fields are first copied into one contiguous plane per field, so that
+      * the inner loops run over consecutive floats without any per point
+      * branch and rows are processed in parallel. The separable convolve ()
+      * keeps the intermediate result in these planes instead of going
+      * through a temporary point cloud.
+      *
       * \author Nizar Sallem
       * \ingroup filters
       */
@@ -162,6 +169,39 @@ namespace pcl
         convolve (PointCloudOut& output);
 
       protected:
+        /** \brief Convolve rows (\a rows is true) or columns of the input
+          * using the per field planes, then apply the borders policy.
+          * \return false if the point type has no plane layout
+          */
+        bool
+        convolveUsingPlanes (PointCloudOut& output, bool rows);
+        /** \brief Copy the convolved fields of \a cloud into one plane per field.
+          * \param[in] cloud the organized cloud to copy
+          * \param[out] planes the fields, plane after plane, in row major order
+          */
+        void
+        extractPlanes (const PointCloudIn& cloud, std::vector<float>& planes) const;
+        /** \brief Convolve the inner rows or columns of \a planes with kernel_.
+          * Borders are left untouched.
+          * \param[in] planes the input fields as returned by extractPlanes ()
+          * \param[in] rows true to convolve along rows, false along columns
+          * \param[in] dense whether the planes may hold non finite points
+          * \param[out] result the convolved fields
+          */
+        void
+        convolvePlanes (const std::vector<float>& planes, bool rows, bool dense,
+                        std::vector<float>& result) const;
+        /** \brief Fill the borders of the row convolved \a planes the same way
+          * convolveRows () fills the borders of a point cloud.
+          */
+        void
+        fillPlanesBorders (std::vector<float>& planes) const;
+        /// \brief copy the inner rows or columns of \a planes into \a output
+        void
+        copyPlanes (const std::vector<float>& planes, bool rows, PointCloudOut& output) const;
+        /// \brief fill the borders of a row or column convolved \a output according to the policy
+        void
+        fillBorders (PointCloudOut& output, bool rows);
         /// \brief convolve rows and ignore borders
         void
         convolve_rows (PointCloudOut& output);
@@ -212,6 +252,8 @@ namespace pcl
         int borders_policy_;
         /// Threshold distance between adjacent points
         float distance_threshold_;
+        /// Squared threshold distance, set by initCompute ()
+        float sqr_distance_threshold_;
         /// Pointer to the input cloud
         PointCloudInConstPtr input_;
         /// convolution kernel
@@ -220,6 +262,10 @@ namespace pcl
         int half_width_;
         /// kernel size - 1
         int kernel_width_;
+        /// per field planes of the input, kept between calls to avoid reallocations
+        std::vector<float> planes_;
+        /// per field planes of the convolution result
+        std::vector<float> convolved_planes_;
       protected:
         /** \brief The number of threads the scheduler should use. */
         int threads_;
@@ -138,6 +138,10 @@ namespace pcl
         inline void
         setSigma (float sigma) { sigma_ = sigma; }
 
+        /** \return the sigma parameter of the Gaussian */
+        inline float
+        getSigma () const { return (sigma_); }
+
         /** Set the distance threshold relative to a sigma factor i.e. points such as
           * ||pi - q|| > sigma_coefficient^2 * sigma^2 are not considered.
           */
@@ -196,6 +200,12 @@ namespace pcl
       * are only interested in convolving based on local neighborhood information.
       * The convolving kernel MUST be a radial symmetric and implement \ref ConvolvingKernel
       * interface.
+      *
+      * With a \ref GaussianKernel and PointXYZ, PointXYZI or PointXYZRGB clouds, setApproximate ()
+      * replaces the radius searches by a splat, blur and slice pass on a \ref PermutohedralLattice,
+      * which runs in linear time. The Gaussian is then neither truncated at the search radius nor at
+      * the kernel threshold, and the interpolation on the lattice adds an error of a few percent of
+      * the field variations within one sigma.
       */
     template <typename PointIn, typename PointOut, typename KernelT>
     class Convolution3D : public pcl::PCLBase <PointIn>
@@ -260,6 +270,17 @@ namespace pcl
         inline double
         getRadiusSearch () { return (search_radius_); }
 
+        /** \brief Set whether to convolve on a permutohedral lattice instead of searching the neighbors
+          * of every point. Only Gaussian kernels can be approximated, other kernels always use the search.
+          * \param[in] approximate true for the linear time approximation, false (default) for the exact convolution
+          */
+        inline void
+        setApproximate (bool approximate) { approximate_ = approximate; }
+
+        /** \brief Get whether the convolution runs on a permutohedral lattice. */
+        inline bool
+        getApproximate () const { return (approximate_); }
+
         /** Convolve point cloud.
           * \param[out] output the convolved cloud
           */
@@ -270,6 +291,13 @@ namespace pcl
         /** \brief initialize computation */
         bool initCompute ();
 
+        /** \brief Convolve the point cloud on a permutohedral lattice.
+          * \param[out] output the convolved cloud
+          * \return false if the kernel or the point types can not be approximated
+          */
+        bool
+        convolveApproximate (PointCloudOut& output);
+
         /** \brief An input point cloud describing the surface that is to be used for nearest neighbors estimation. */
         PointCloudInConstPtr surface_;
 
@@ -282,6 +310,9 @@ namespace pcl
         /** \brief number of threads */
         int threads_;
 
+        /** \brief whether to convolve on a permutohedral lattice */
+        bool approximate_;
+
         /** \brief convlving kernel */
         KernelT kernel_;
     };
@@ -0,0 +1,173 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_COVARIANCE_SAMPLING_H_
+#define PCL_FILTERS_COVARIANCE_SAMPLING_H_
+
+#include <pcl/filters/filter_indices.h>
+#include <Eigen/Core>
+#include <limits.h>
+
+namespace pcl
+{
+  /** \brief @b CovarianceSampling picks the points of a cloud that best constrain the six degrees of freedom of a
+    * point-to-plane alignment, following the stability analysis of:
+    *   Geometrically Stable Sampling for the ICP Algorithm, N. Gelfand, L. Ikemoto, S. Rusinkiewicz, M. Levoy,
+    *   3DIM 2003.
+    *
+    * Every point p with normal n constrains the alignment along the 6D vector [p x n, n], with p centered and scaled
+    * by the mean distance to the centroid. The eigenvectors of the 6x6 covariance matrix of these vectors are the
+    * principal directions of the alignment; the points are picked greedily, always for the eigenvector that is the
+    * least constrained by the points already picked, as the remaining point whose constraint is the strongest
+    * along it. The sample is deterministic.
+    * \ingroup filters
+    */
+  template<typename PointT, typename NormalT>
+  class CovarianceSampling : public FilterIndices<PointT>
+  {
+    using FilterIndices<PointT>::filter_name_;
+    using FilterIndices<PointT>::getClassName;
+    using FilterIndices<PointT>::indices_;
+    using FilterIndices<PointT>::input_;
+    using FilterIndices<PointT>::initCompute;
+
+    typedef typename FilterIndices<PointT>::PointCloud PointCloud;
+    typedef typename PointCloud::Ptr PointCloudPtr;
+    typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+    typedef typename pcl::PointCloud<NormalT>::ConstPtr NormalsConstPtr;
+
+    public:
+      typedef Eigen::Matrix<double, 6, 1> Vector6d;
+      typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+
+      /** \brief Empty constructor. */
+      CovarianceSampling () :
+        num_samples_ (UINT_MAX), input_normals_ (), threads_ (1), constraints_ ()
+      {
+        filter_name_ = "CovarianceSampling";
+      }
+
+      /** \brief Set the number of points to be sampled.
+        * \param[in] samples the number of sample indices
+        */
+      inline void
+      setNumberOfSamples (unsigned int samples)
+      {
+        num_samples_ = samples;
+      }
+
+      /** \brief Get the number of points to be sampled. */
+      inline unsigned int
+      getNumberOfSamples () const
+      {
+        return (num_samples_);
+      }
+
+      /** \brief Set the normals computed on the input point cloud
+        * \param[in] normals the normals computed for the input cloud
+        */
+      inline void
+      setNormals (const NormalsConstPtr &normals)
+      {
+        input_normals_ = normals;
+      }
+
+      /** \brief Get the normals computed on the input point cloud */
+      inline NormalsConstPtr
+      getNormals () const
+      {
+        return (input_normals_);
+      }
+
+      /** \brief Set the number of threads used to compute the constraints and to rank the points.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief Compute the 6x6 covariance matrix of the constraints of the input points.
+        * \param[out] covariance_matrix the covariance matrix
+        * \return false if the input or the normals are missing
+        */
+      bool
+      computeCovarianceMatrix (Matrix6d &covariance_matrix);
+
+      /** \brief Compute the condition number of the covariance matrix of the input points, i.e. the ratio between
+        * its largest and smallest eigenvalues. A large condition number means that the points leave the alignment
+        * poorly constrained along some direction.
+        * \return the condition number, or -1 if the input or the normals are missing
+        */
+      double
+      computeConditionNumber ();
+
+    protected:
+      /** \brief Number of points that will be returned. */
+      unsigned int num_samples_;
+
+      /** \brief The normals computed at each point in the input cloud. */
+      NormalsConstPtr input_normals_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief The 6D constraint of every input index. */
+      std::vector<Vector6d, Eigen::aligned_allocator<Vector6d> > constraints_;
+
+      /** \brief Compute the constraints of the input indices. */
+      bool
+      computeConstraints ();
+
+      /** \brief Sample of point indices into a separate PointCloud
+        * \param[out] output the resultant point cloud
+        */
+      void
+      applyFilter (PointCloud &output);
+
+      /** \brief Sample of point indices
+        * \param[out] indices the resultant point cloud indices
+        */
+      void
+      applyFilter (std::vector<int> &indices);
+  };
+}
+
+#endif  // PCL_FILTERS_COVARIANCE_SAMPLING_H_
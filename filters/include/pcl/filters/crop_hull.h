@@ -46,6 +46,11 @@ namespace pcl
 {
   /** \brief Filter points that lie inside or outside a 3D closed surface or 2D
     * closed polygon, as generated by the ConvexHull or ConcaveHull classes.
+    *
+    * The hull polygons are sorted into uniform grids over their projections
+    * the first time the filter runs after the hull changed, so that every point
+    * is only tested against the few polygons it can possibly lie in (2D) or
+    * cast a ray through (3D), instead of against all of them.
     * \author James Crosby
     * \ingroup filters
     */
@@ -66,7 +71,11 @@ namespace pcl
         hull_polygons_(),
         hull_cloud_(),
         dim_(3),
-        crop_outside_(true)
+        crop_outside_(true),
+        threads_ (1),
+        grids_valid_ (false),
+        grid_dims_ (-1, -1),
+        grids_ ()
       {
         filter_name_ = "CropHull";
       }
@@ -79,6 +88,7 @@ namespace pcl
       setHullIndices (const std::vector<Vertices>& polygons)
       {
         hull_polygons_ = polygons;
+        grids_valid_ = false;
       }
 
       /** \brief Get the vertices of the hull used to filter points.
@@ -90,12 +100,14 @@ namespace pcl
       }
       
       /** \brief Set the point cloud that the hull indices refer to
+        * \note Call it again after modifying the points, so the polygon grids get rebuilt.
         * \param[in] points the point cloud that the hull indices refer to
         */
       inline void
       setHullCloud (PointCloudPtr points)
       {
         hull_cloud_ = points;
+        grids_valid_ = false;
       }
 
       /** \brief Get the point cloud that the hull indices refer to. */
@@ -127,6 +139,15 @@ namespace pcl
         crop_outside_ = crop_outside;
       }
 
+      /** \brief Set the number of threads used to test the points against the hull.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = (nr_threads == 0) ? 1 : nr_threads;
+      }
+
     protected:
       /** \brief Filter the input points using the 2D or 3D polygon hull.
         * \param[out] output The set of points that passed the filter
@@ -148,15 +169,6 @@ namespace pcl
       Eigen::Vector3f
       getHullCloudRange ();
       
-      /** \brief Apply the two-dimensional hull filter.
-        * All points are assumed to lie in the same plane as the 2D hull, an
-        * axis-aligned 2D coordinate system using the two dimensions specified
-        * (PlaneDim1, PlaneDim2) is used for calculations.
-        * \param[out] output The set of points that pass the 2D polygon filter.
-        */
-      template<unsigned PlaneDim1, unsigned PlaneDim2> void
-      applyFilter2D (PointCloud &output); 
-
       /** \brief Apply the two-dimensional hull filter.
         * All points are assumed to lie in the same plane as the 2D hull, an
         * axis-aligned 2D coordinate system using the two dimensions specified
@@ -167,17 +179,6 @@ namespace pcl
       template<unsigned PlaneDim1, unsigned PlaneDim2> void
       applyFilter2D (std::vector<int> &indices);
 
-       /** \brief Apply the three-dimensional hull filter.
-         * Polygon-ray crossings are used for three rays cast from each point
-         * being tested, and a  majority vote of the resulting
-         * polygon-crossings is used to decide  whether the point lies inside
-         * or outside the hull.
-         * \param[out] output The set of points that pass the 3D polygon hull
-         *                    filter.
-         */
-      void
-      applyFilter3D (PointCloud &output);
-
       /** \brief Apply the three-dimensional hull filter.
         *  Polygon-ray crossings are used for three rays cast from each point
         *  being tested, and a  majority vote of the resulting
@@ -189,6 +190,76 @@ namespace pcl
       void
       applyFilter3D (std::vector<int> &indices);
 
+      /** \brief A uniform grid over the projections of the hull polygons onto
+        * a plane. A point can only lie in a 2D polygon, or cast a ray
+        * orthogonal to the plane through a 3D polygon, if its projection falls
+        * in a cell that the polygon overlaps.
+        */
+      struct PolygonGrid
+      {
+        PolygonGrid () :
+          axis1 (Eigen::Vector3f::Zero ()), axis2 (Eigen::Vector3f::Zero ()),
+          min_p (Eigen::Vector2f::Zero ()), inverse_cell_size (Eigen::Vector2f::Zero ()),
+          nr_cells (0), cell_starts (), polygons (), unbounded_polygons ()
+        {
+        }
+
+        /** \brief The axes spanning the projection plane. */
+        Eigen::Vector3f axis1, axis2;
+
+        /** \brief The lower corner of the grid in the projection plane, and the inverse cell size. */
+        Eigen::Vector2f min_p, inverse_cell_size;
+
+        /** \brief The number of cells along each axis. */
+        int nr_cells;
+
+        /** \brief The polygons overlapping cell c are polygons[cell_starts[c]] to polygons[cell_starts[c + 1] - 1]. */
+        std::vector<int> cell_starts;
+        std::vector<int> polygons;
+
+        /** \brief Polygons that have to be tested for every point, as their projection is not reliable. */
+        std::vector<int> unbounded_polygons;
+      };
+
+      /** \brief Sort the hull polygons into a PolygonGrid.
+        * \param[in] axis1 the first axis of the projection plane
+        * \param[in] axis2 the second axis of the projection plane
+        * \param[in] ray the direction of the rays to be cast through the grid
+        *                (zero for the 2D point in polygon test)
+        * \param[out] grid the resultant grid
+        */
+      void
+      buildPolygonGrid (const Eigen::Vector3f &axis1, const Eigen::Vector3f &axis2,
+                        const Eigen::Vector3f &ray, PolygonGrid &grid) const;
+
+      /** \brief Get the range in grid.polygons of the polygons overlapping the cell of a point.
+        * \param[in] grid the polygon grid
+        * \param[in] point the point
+        * \param[out] begin the start of the range
+        * \param[out] end the end of the range
+        * \return false if the point can not be projected, in which case it has to be tested against all polygons
+        */
+      static bool
+      getCellPolygons (const PolygonGrid &grid, const PointT &point, int &begin, int &end);
+
+      /** \brief Build the polygon grids needed for the current dimensionality, if they are not up to date. */
+      template<unsigned PlaneDim1, unsigned PlaneDim2> void
+      updatePolygonGrids ();
+
+      /** \brief Test whether a point lies inside the 2D hull. */
+      template<unsigned PlaneDim1, unsigned PlaneDim2> bool
+      isInside2D (const PointT &point) const;
+
+      /** \brief Get the direction of one of the three rays cast from every point by the 3D hull filter.
+        * \param[in] ray the ray (0, 1 or 2)
+        */
+      static Eigen::Vector3f
+      getRayDirection (int ray);
+
+      /** \brief Test whether a point lies inside the 3D hull, with the majority vote of three ray casts. */
+      bool
+      isInside3D (const PointT &point) const;
+
       /** \brief Test an individual point against a 2D polygon.
         * PlaneDim1 and PlaneDim2 specify the x/y/z coordinate axes to use.
         * \param[in] point Point to test against the polygon.
@@ -228,6 +299,18 @@ namespace pcl
        * false, those inside will be removed.
        */
       bool crop_outside_;
+
+      /** \brief The number of threads the points are tested with. */
+      unsigned int threads_;
+
+      /** \brief True if the polygon grids match the current hull. */
+      bool grids_valid_;
+
+      /** \brief The projection the grids were built for: the 2D plane dimensions, or (-1, -1) for 3D. */
+      std::pair<int, int> grid_dims_;
+
+      /** \brief One grid for the 2D hull, or one grid per ray direction for the 3D hull. */
+      std::vector<PolygonGrid> grids_;
   };
 
 } // namespace pcl
@@ -62,6 +62,9 @@ namespace pcl
     * eifilter.filterDirectly (cloud_in);
     * // This will directly modify cloud_in instead of creating a copy of the cloud
     * // It will overwrite all fields of the filtered points by the user value: 1337
+    * eifilter.setKeepOrganized (false);
+    * eifilter.filterInPlace (cloud_in);
+    * // This will remove the filtered points from cloud_in without allocating a second cloud
     * \endcode
     * \author Radu Bogdan Rusu
     * \ingroup filters
@@ -80,7 +83,8 @@ namespace pcl
         * \param[in] extract_removed_indices Set to true if you want to be able to extract the indices of points being removed (default = false).
         */
       ExtractIndices (bool extract_removed_indices = false) :
-        FilterIndices<PointT>::FilterIndices (extract_removed_indices)
+        FilterIndices<PointT>::FilterIndices (extract_removed_indices),
+        threads_ (1)
       {
         use_indices_ = true;
         filter_name_ = "ExtractIndices";
@@ -97,6 +101,27 @@ namespace pcl
       void
       filterDirectly (PointCloudPtr &cloud);
 
+      /** \brief Apply the filter and compact the results directly in the input cloud.
+        * \details Unlike filterDirectly(), the filtered points are removed: the kept points are moved to the front of
+        * \a cloud in the order of the resultant indices, and the cloud is shrunk to their number, so no second cloud
+        * is allocated. This is always possible in negative mode and whenever the i-th index is not smaller than i (e.g.
+        * for sorted unique indices); other index orders fall back to a gather into a temporary cloud.
+        * If setKeepOrganized() is true, this method behaves like filterDirectly().
+        * This method also automatically alters the input cloud set via setInputCloud().
+        * \param[in/out] cloud The point cloud used for input and output.
+        */
+      void
+      filterInPlace (PointCloudPtr &cloud);
+
+      /** \brief Set the number of threads to use for gathering the points into the output cloud.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -129,6 +154,17 @@ namespace pcl
         */
       void
       applyFilterIndices (std::vector<int> &indices);
+
+      /** \brief Copy the points of the input cloud referenced by \a indices into \a output.
+        * \details If \a output is the input cloud itself, the points are compacted in place when the indices allow it.
+        * \param[in] indices the indices of the points to copy
+        * \param[out] output the resultant point cloud
+        */
+      void
+      gatherPoints (const std::vector<int> &indices, PointCloud &output);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
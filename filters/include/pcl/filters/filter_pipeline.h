@@ -0,0 +1,238 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_FILTER_PIPELINE_H_
+#define PCL_FILTERS_FILTER_PIPELINE_H_
+
+#include <pcl/filters/filter_indices.h>
+#include <pcl/filters/statistical_outlier_removal.h>
+#include <pcl/filters/radius_outlier_removal.h>
+#include <boost/function.hpp>
+
+namespace pcl
+{
+  /** \brief @b FilterPipeline runs a chain of filtering stages over a point cloud as a single filter, passing
+    * indices from one stage to the next instead of intermediate point clouds.
+    *
+    * Stages are run in the order they were added:
+    * - point tests (addPointTest ()) and point transforms (addPointTransform ()) act on single points;
+    *   consecutive ones are fused into one pass over the surviving points;
+    * - \ref FilterIndices stages (PassThrough, CropBox, ...) receive the input cloud together with the
+    *   surviving indices, and return the indices they keep;
+    * - \ref FilterIndices stages that search neighborhoods over their whole input cloud
+    *   (StatisticalOutlierRemoval, RadiusOutlierRemoval) would count the points removed by the previous
+    *   stages as neighbors, so the surviving points are copied before them, unless they are all there;
+    * - any other \ref Filter (VoxelGrid, ...) needs a cloud of its own, so the surviving points are only
+    *   copied before such a stage, and its output becomes the cloud of the following stages.
+    *
+    * A point cloud is therefore only written by point transforms, by stages that are not \ref FilterIndices,
+    * before neighborhood based stages, and once at the end. The buffers are kept between calls, so filtering a stream of frames with the same
+    * pipeline does not allocate once their sizes have settled.
+    * \note The stages are given the clouds and indices of the pipeline, their input and indices are
+    * overwritten.
+    * \ingroup filters
+    */
+  template<typename PointT>
+  class FilterPipeline : public Filter<PointT>
+  {
+    using Filter<PointT>::filter_name_;
+    using Filter<PointT>::getClassName;
+    using Filter<PointT>::indices_;
+    using Filter<PointT>::input_;
+
+    typedef typename Filter<PointT>::PointCloud PointCloud;
+    typedef typename PointCloud::Ptr PointCloudPtr;
+    typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+
+    public:
+      typedef boost::shared_ptr< FilterPipeline<PointT> > Ptr;
+      typedef boost::shared_ptr< const FilterPipeline<PointT> > ConstPtr;
+
+      typedef typename Filter<PointT>::Ptr FilterPtr;
+      typedef boost::shared_ptr< FilterIndices<PointT> > FilterIndicesPtr;
+
+      /** \brief A point test: returns true to keep the point. */
+      typedef boost::function<bool (const PointT&)> PointTest;
+
+      /** \brief A point transform: modifies a point in place. */
+      typedef boost::function<void (PointT&)> PointTransform;
+
+      /** \brief Empty constructor. */
+      FilterPipeline () :
+        stages_ (), indices_buffer_ (new std::vector<int>), filtered_indices_ (), clouds_ ()
+      {
+        filter_name_ = "FilterPipeline";
+        clouds_[0].reset (new PointCloud);
+        clouds_[1].reset (new PointCloud);
+      }
+
+      /** \brief Append a test that points have to pass to be kept.
+        * \param[in] test the point test
+        */
+      inline void
+      addPointTest (const PointTest &test)
+      {
+        Stage stage;
+        stage.type = STAGE_POINT_TEST;
+        stage.test = test;
+        stages_.push_back (stage);
+      }
+
+      /** \brief Append a transform applied to every surviving point. The following stages see the
+        * transformed points.
+        * \param[in] transform the point transform
+        */
+      inline void
+      addPointTransform (const PointTransform &transform)
+      {
+        Stage stage;
+        stage.type = STAGE_POINT_TRANSFORM;
+        stage.transform = transform;
+        stages_.push_back (stage);
+      }
+
+      /** \brief Append a filter. \ref FilterIndices filters are run on indices, other filters on a copy of
+        * the surviving points. StatisticalOutlierRemoval and RadiusOutlierRemoval filters are given a copy of
+        * the surviving points as well, as they search neighbors over their whole input cloud.
+        * \param[in] filter the filter, configured except for its input and indices
+        */
+      inline void
+      addFilter (const FilterPtr &filter)
+      {
+        addFilter (filter, boost::dynamic_pointer_cast<StatisticalOutlierRemoval<PointT> > (filter) ||
+                           boost::dynamic_pointer_cast<RadiusOutlierRemoval<PointT> > (filter));
+      }
+
+      /** \brief Append a filter, stating whether it only looks at the points of its indices.
+        * \param[in] filter the filter, configured except for its input and indices
+        * \param[in] searches_input true if the filter looks at points of its input cloud outside of its indices
+        * (e.g., to search neighbors), in which case it is given a copy of the surviving points
+        */
+      inline void
+      addFilter (const FilterPtr &filter, bool searches_input)
+      {
+        Stage stage;
+        stage.filter = filter;
+        stage.filter_indices = boost::dynamic_pointer_cast<FilterIndices<PointT> > (filter);
+        stage.type = stage.filter_indices ? STAGE_FILTER_INDICES : STAGE_FILTER;
+        stage.searches_input = searches_input;
+        stages_.push_back (stage);
+      }
+
+      /** \brief Remove all the stages. */
+      inline void
+      clear ()
+      {
+        stages_.clear ();
+      }
+
+      /** \brief Get the number of stages. */
+      inline size_t
+      getNumberOfStages () const
+      {
+        return (stages_.size ());
+      }
+
+    protected:
+      /** \brief Run the stages over the input points.
+        * \param[out] output the points kept by the last stage
+        */
+      void
+      applyFilter (PointCloud &output);
+
+      /** \brief Run the point tests and transforms in [first, last) over the current points.
+        * \param[in] first the first stage of the run
+        * \param[in] last one past the last stage of the run
+        * \param[in,out] cloud the current cloud, replaced if the run holds a transform
+        * \param[in,out] indices the surviving indices of the current cloud
+        */
+      void
+      applyPointStages (size_t first, size_t last, PointCloudConstPtr &cloud, std::vector<int> &indices);
+
+      /** \brief Get the cloud buffer that is not \a cloud. */
+      inline PointCloudPtr
+      getFreeCloud (const PointCloudConstPtr &cloud)
+      {
+        return ((cloud == clouds_[0]) ? clouds_[1] : clouds_[0]);
+      }
+
+      /** \brief Replace \a cloud by a copy of its points at \a indices, and \a indices by all the points of the copy. */
+      void
+      compactPoints (PointCloudConstPtr &cloud, std::vector<int> &indices);
+
+      /** \brief Copy the points of \a cloud at \a indices into \a output. */
+      static void
+      copyPoints (const PointCloud &cloud, const std::vector<int> &indices, PointCloud &output);
+
+    private:
+      enum StageType
+      {
+        STAGE_POINT_TEST,
+        STAGE_POINT_TRANSFORM,
+        STAGE_FILTER_INDICES,
+        STAGE_FILTER
+      };
+
+      struct Stage
+      {
+        Stage () : type (STAGE_POINT_TEST), test (), transform (), filter (), filter_indices (), searches_input (false) {}
+
+        StageType type;
+        PointTest test;
+        PointTransform transform;
+        FilterPtr filter;
+        FilterIndicesPtr filter_indices;
+        bool searches_input;
+      };
+
+      /** \brief The stages, in order. */
+      std::vector<Stage> stages_;
+
+      /** \brief The surviving indices handed to the stages. */
+      IndicesPtr indices_buffer_;
+
+      /** \brief The indices returned by a FilterIndices stage. */
+      std::vector<int> filtered_indices_;
+
+      /** \brief Two point cloud buffers, used alternately as input and output of the stages. */
+      PointCloudPtr clouds_[2];
+  };
+}
+
+#endif  // PCL_FILTERS_FILTER_PIPELINE_H_
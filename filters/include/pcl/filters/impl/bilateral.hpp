@@ -39,6 +39,7 @@
 #define PCL_FILTERS_BILATERAL_IMPL_H_
 
 #include <pcl/filters/bilateral.h>
+#include <pcl/filters/permutohedral_lattice.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> double
@@ -76,6 +77,11 @@ pcl::BilateralFilter<PointT>::applyFilter (PointCloud &output)
     PCL_ERROR ("[pcl::BilateralFilter::applyFilter] Need a sigma_s value given before continuing.\n");
     return;
   }
+  if (approximate_)
+  {
+    applyFilterApproximate (output);
+    return;
+  }
   // In case a search method has not been given, initialize it using some defaults
   if (!tree_)
   {
@@ -95,7 +101,10 @@ pcl::BilateralFilter<PointT>::applyFilter (PointCloud &output)
   output = *input_;
 
   // For all the indices given (equal to the entire cloud if none given)
-  for (size_t i = 0; i < indices_->size (); ++i)
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (output) private (k_indices, k_distances) num_threads (threads_)
+#endif
+  for (int i = 0; i < static_cast<int> (indices_->size ()); ++i)
   {
     // Perform a radius search to find the nearest neighbors
     tree_->radiusSearch ((*indices_)[i], sigma_s_ * 2, k_indices, k_distances);
@@ -104,6 +113,41 @@ pcl::BilateralFilter<PointT>::applyFilter (PointCloud &output)
     output.points[(*indices_)[i]].intensity = computePointWeight ((*indices_)[i], k_indices, k_distances);
   }
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::BilateralFilter<PointT>::applyFilterApproximate (PointCloud &output)
+{
+  const float inverse_sigma_s = static_cast<float> (1.0 / sigma_s_);
+  const float inverse_sigma_r = static_cast<float> (1.0 / sigma_r_);
+
+  // Splat all the finite points: the neighbors of the indices are searched in the whole cloud
+  PermutohedralLattice<4> lattice;
+  lattice.reset (1, static_cast<int> (input_->points.size ()));
+  std::vector<int> lattice_points (input_->points.size (), -1);
+  for (size_t i = 0; i < input_->points.size (); ++i)
+  {
+    const PointT &p = input_->points[i];
+    if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z) || !pcl_isfinite (p.intensity))
+      continue;
+    float feature[4] = { p.x * inverse_sigma_s, p.y * inverse_sigma_s, p.z * inverse_sigma_s, p.intensity * inverse_sigma_r };
+    lattice_points[i] = lattice.getNumberOfPoints ();
+    lattice.splat (feature, &p.intensity);
+  }
+  lattice.blur (threads_);
+
+  // Copy the input data into the output, and slice the intensities of the finite points
+  output = *input_;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (output, lattice, lattice_points) num_threads (threads_)
+#endif
+  for (int i = 0; i < static_cast<int> (indices_->size ()); ++i)
+  {
+    const int lattice_point = lattice_points[(*indices_)[i]];
+    if (lattice_point >= 0)
+      lattice.slice (lattice_point, &output.points[(*indices_)[i]].intensity);
+  }
+}
  
 #define PCL_INSTANTIATE_BilateralFilter(T) template class PCL_EXPORTS pcl::BilateralFilter<T>;
 
@@ -43,6 +43,72 @@
 #include <vector>
 #include <Eigen/Geometry>
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Compare the value of type T at a byte offset in a block of points against a constant, with the
+      * operator resolved once for the whole block. The results match those of PointDataAtOffset::compare (),
+      * including for NaN values, which compare as equal.
+      */
+    template <typename PointT, typename T> void
+    compareBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points,
+                  uint32_t offset, ComparisonOps::CompareOp op, T val, uint8_t *mask)
+    {
+      T pt_val;
+      switch (op)
+      {
+        case ComparisonOps::GT :
+          for (int i = 0; i < nr_points; ++i)
+          {
+            memcpy (&pt_val, reinterpret_cast<const uint8_t*> (&cloud.points[indices[i]]) + offset, sizeof (T));
+            mask[i] = pt_val > val;
+          }
+          break;
+        case ComparisonOps::GE :
+          for (int i = 0; i < nr_points; ++i)
+          {
+            memcpy (&pt_val, reinterpret_cast<const uint8_t*> (&cloud.points[indices[i]]) + offset, sizeof (T));
+            mask[i] = !(pt_val < val);
+          }
+          break;
+        case ComparisonOps::LT :
+          for (int i = 0; i < nr_points; ++i)
+          {
+            memcpy (&pt_val, reinterpret_cast<const uint8_t*> (&cloud.points[indices[i]]) + offset, sizeof (T));
+            mask[i] = pt_val < val;
+          }
+          break;
+        case ComparisonOps::LE :
+          for (int i = 0; i < nr_points; ++i)
+          {
+            memcpy (&pt_val, reinterpret_cast<const uint8_t*> (&cloud.points[indices[i]]) + offset, sizeof (T));
+            mask[i] = !(pt_val > val);
+          }
+          break;
+        case ComparisonOps::EQ :
+          for (int i = 0; i < nr_points; ++i)
+          {
+            memcpy (&pt_val, reinterpret_cast<const uint8_t*> (&cloud.points[indices[i]]) + offset, sizeof (T));
+            mask[i] = !(pt_val > val) && !(pt_val < val);
+          }
+          break;
+        default:
+          PCL_WARN ("[pcl::detail::compareBlock] unrecognized op!\n");
+          memset (mask, 0, nr_points);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ComparisonBase<PointT>::evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask) const
+{
+  for (int i = 0; i < nr_points; ++i)
+    mask[i] = evaluate (cloud.points[indices[i]]);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -133,6 +199,52 @@ pcl::FieldComparison<PointT>::evaluate (const PointT &point) const
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FieldComparison<PointT>::evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask) const
+{
+  if (!this->capable_)
+  {
+    PCL_WARN ("[pcl::FieldComparison::evaluateBlock] invalid compariosn!\n");
+    memset (mask, 0, nr_points);
+    return;
+  }
+
+  // Convert the value to the field type once, as PointDataAtOffset::compare () does for every point
+  uint32_t offset = point_data_->getOffset ();
+  switch (point_data_->getDataType ())
+  {
+    case sensor_msgs::PointField::INT8 :
+      detail::compareBlock (cloud, indices, nr_points, offset, op_, static_cast<int8_t> (compare_val_), mask);
+      break;
+    case sensor_msgs::PointField::UINT8 :
+      detail::compareBlock (cloud, indices, nr_points, offset, op_, static_cast<uint8_t> (compare_val_), mask);
+      break;
+    case sensor_msgs::PointField::INT16 :
+      detail::compareBlock (cloud, indices, nr_points, offset, op_, static_cast<int16_t> (compare_val_), mask);
+      break;
+    case sensor_msgs::PointField::UINT16 :
+      detail::compareBlock (cloud, indices, nr_points, offset, op_, static_cast<uint16_t> (compare_val_), mask);
+      break;
+    case sensor_msgs::PointField::INT32 :
+      detail::compareBlock (cloud, indices, nr_points, offset, op_, static_cast<int32_t> (compare_val_), mask);
+      break;
+    case sensor_msgs::PointField::UINT32 :
+      detail::compareBlock (cloud, indices, nr_points, offset, op_, static_cast<uint32_t> (compare_val_), mask);
+      break;
+    case sensor_msgs::PointField::FLOAT32 :
+      detail::compareBlock (cloud, indices, nr_points, offset, op_, static_cast<float> (compare_val_), mask);
+      break;
+    case sensor_msgs::PointField::FLOAT64 :
+      detail::compareBlock (cloud, indices, nr_points, offset, op_, compare_val_, mask);
+      break;
+    default :
+      // Unknown data types compare as equal in PointDataAtOffset::compare ()
+      PCL_WARN ("[pcl::FieldComparison::evaluateBlock] unknown data_type!\n");
+      memset (mask, op_ == ComparisonOps::GE || op_ == ComparisonOps::LE || op_ == ComparisonOps::EQ, nr_points);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -225,6 +337,43 @@ pcl::PackedRGBComparison<PointT>::evaluate (const PointT &point) const
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PackedRGBComparison<PointT>::evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask) const
+{
+  // The component is compared as a double, like in evaluate ()
+  std::vector<double> values (nr_points);
+  for (int i = 0; i < nr_points; ++i)
+    values[i] = *(reinterpret_cast<const uint8_t*> (&cloud.points[indices[i]]) + component_offset_);
+
+  switch (this->op_)
+  {
+    case pcl::ComparisonOps::GT :
+      for (int i = 0; i < nr_points; ++i)
+        mask[i] = values[i] > compare_val_;
+      break;
+    case pcl::ComparisonOps::GE :
+      for (int i = 0; i < nr_points; ++i)
+        mask[i] = values[i] >= compare_val_;
+      break;
+    case pcl::ComparisonOps::LT :
+      for (int i = 0; i < nr_points; ++i)
+        mask[i] = values[i] < compare_val_;
+      break;
+    case pcl::ComparisonOps::LE :
+      for (int i = 0; i < nr_points; ++i)
+        mask[i] = values[i] <= compare_val_;
+      break;
+    case pcl::ComparisonOps::EQ :
+      for (int i = 0; i < nr_points; ++i)
+        mask[i] = values[i] == compare_val_;
+      break;
+    default:
+      PCL_WARN ("[pcl::PackedRGBComparison::evaluateBlock] unrecognized op_!\n");
+      memset (mask, 0, nr_points);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -620,6 +769,24 @@ pcl::ConditionBase<PointT>::addCondition (Ptr condition)
   conditions_.push_back (condition);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionBase<PointT>::evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask, uint8_t *) const
+{
+  for (int i = 0; i < nr_points; ++i)
+    mask[i] = evaluate (cloud.points[indices[i]]);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> size_t
+pcl::ConditionBase<PointT>::getNestingDepth () const
+{
+  size_t nested_depth = 0;
+  for (size_t i = 0; i < conditions_.size (); ++i)
+    nested_depth = std::max (nested_depth, conditions_[i]->getNestingDepth ());
+  return (1 + nested_depth);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -637,6 +804,29 @@ pcl::ConditionAnd<PointT>::evaluate (const PointT &point) const
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionAnd<PointT>::evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask, uint8_t *scratch) const
+{
+  memset (mask, 1, nr_points);
+  // This level's results go to the front of the scratch buffer, the nested conditions use the rest
+  uint8_t *result = scratch;
+  size_t nr_terms = comparisons_.size () + conditions_.size ();
+  for (size_t t = 0; t < nr_terms; ++t)
+  {
+    if (t < comparisons_.size ())
+      comparisons_[t]->evaluateBlock (cloud, indices, nr_points, result);
+    else
+      conditions_[t - comparisons_.size ()]->evaluateBlock (cloud, indices, nr_points, result, scratch + nr_points);
+
+    uint8_t any = 0;
+    for (int i = 0; i < nr_points; ++i)
+      any |= (mask[i] &= result[i]);
+    if (!any)
+      return;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -656,6 +846,29 @@ pcl::ConditionOr<PointT>::evaluate (const PointT &point) const
   return (false);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionOr<PointT>::evaluateBlock (const PointCloud<PointT> &cloud, const int *indices, int nr_points, uint8_t *mask, uint8_t *scratch) const
+{
+  size_t nr_terms = comparisons_.size () + conditions_.size ();
+  memset (mask, nr_terms == 0, nr_points);
+  // This level's results go to the front of the scratch buffer, the nested conditions use the rest
+  uint8_t *result = scratch;
+  for (size_t t = 0; t < nr_terms; ++t)
+  {
+    if (t < comparisons_.size ())
+      comparisons_[t]->evaluateBlock (cloud, indices, nr_points, result);
+    else
+      conditions_[t - comparisons_.size ()]->evaluateBlock (cloud, indices, nr_points, result, scratch + nr_points);
+
+    uint8_t all = 1;
+    for (int i = 0; i < nr_points; ++i)
+      all &= (mask[i] |= result[i]);
+    if (all)
+      return;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -666,6 +879,24 @@ pcl::ConditionalRemoval<PointT>::setCondition (ConditionBasePtr condition)
   capable_ = condition_->isCapable ();
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionalRemoval<PointT>::evaluateCondition (const std::vector<int> &indices, std::vector<uint8_t> &mask) const
+{
+  // Small enough for the masks of a few nested conditions and the points themselves to stay in cache
+  const int block_size = 256;
+
+  // One scratch buffer for all blocks, with a block sized slice per nesting level
+  std::vector<uint8_t> scratch (block_size * condition_->getNestingDepth ());
+
+  mask.resize (indices.size ());
+  for (size_t start = 0; start < indices.size (); start += block_size)
+  {
+    int nr_points = static_cast<int> (std::min (indices.size () - start, static_cast<size_t> (block_size)));
+    condition_->evaluateBlock (*input_, &indices[start], nr_points, &mask[start], &scratch[0]);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
@@ -709,6 +940,19 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
 
   if (!keep_organized_)
   {
+    // Evaluate the condition on all the valid points up front
+    std::vector<uint8_t> passed;
+    size_t nr_valid = 0;
+    if (block_evaluation_)
+    {
+      std::vector<int> valid_indices;
+      valid_indices.reserve (Filter<PointT>::indices_->size ());
+      for (size_t cp = 0; cp < Filter<PointT>::indices_->size (); ++cp)
+        if (isFinite (input_->points[(*Filter<PointT>::indices_)[cp]]))
+          valid_indices.push_back ((*Filter<PointT>::indices_)[cp]);
+      evaluateCondition (valid_indices, passed);
+    }
+
     for (size_t cp = 0; cp < Filter<PointT>::indices_->size (); ++cp)
     {
       // Check if the point is invalid
@@ -724,7 +968,7 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
         continue;
       }
 
-      if (condition_->evaluate (input_->points[(*Filter < PointT > ::indices_)[cp]]))
+      if (block_evaluation_ ? passed[nr_valid++] : condition_->evaluate (input_->points[(*Filter < PointT > ::indices_)[cp]]))
       {
         pcl::for_each_type<FieldList> (
                                        pcl::NdConcatenateFunctor<PointT, PointT> (
@@ -749,6 +993,9 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
   {
     std::vector<int> indices = *Filter<PointT>::indices_;
     std::sort (indices.begin (), indices.end ());   //TODO: is this necessary or can we assume the indices to be sorted?
+    std::vector<uint8_t> passed;
+    if (block_evaluation_)
+      evaluateCondition (indices, passed);
     size_t ci = 0;
     for (size_t cp = 0; cp < input_->points.size (); ++cp)
     {
@@ -764,7 +1011,7 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
         // copy all the fields
         pcl::for_each_type<FieldList> (pcl::NdConcatenateFunctor<PointT, PointT> (input_->points[cp],
                                                                                   output.points[cp]));
-        if (!condition_->evaluate (input_->points[cp]))
+        if (!(block_evaluation_ ? passed[ci - 1] : condition_->evaluate (input_->points[cp])))
         {
           output.points[cp].getVector4fMap ().setConstant (user_filter_value_);
 
@@ -42,14 +42,86 @@
 
 #include <pcl/pcl_config.h>
 
+namespace pcl
+{
+  namespace filters
+  {
+    namespace detail
+    {
+      /** \brief Layout of the fields convolved for a given point type, used to
+        * copy them into contiguous planes. \a size is 0 for point types that are
+        * only handled point by point. When \a has_xyz is set the first three
+        * fields are x, y and z; fields starting at \a first_uint8 are stored as
+        * uint8_t in the point and truncated when written back.
+        */
+      template <typename PointIn, typename PointOut>
+      struct ConvolutionFields
+      {
+        enum { size = 0, has_xyz = 0, first_uint8 = 0 };
+        static void get (const PointIn&, float*) {}
+        static void set (const float*, PointOut&) {}
+      };
+
+      template <>
+      struct ConvolutionFields<pcl::PointXYZ, pcl::PointXYZ>
+      {
+        enum { size = 3, has_xyz = 1, first_uint8 = 3 };
+        static void get (const pcl::PointXYZ& p, float* f) { f[0] = p.x; f[1] = p.y; f[2] = p.z; }
+        static void set (const float* f, pcl::PointXYZ& p) { p.x = f[0]; p.y = f[1]; p.z = f[2]; }
+      };
+
+      template <>
+      struct ConvolutionFields<pcl::PointXYZI, pcl::PointXYZI>
+      {
+        enum { size = 4, has_xyz = 1, first_uint8 = 4 };
+        static void get (const pcl::PointXYZI& p, float* f) { f[0] = p.x; f[1] = p.y; f[2] = p.z; f[3] = p.intensity; }
+        static void set (const float* f, pcl::PointXYZI& p) { p.x = f[0]; p.y = f[1]; p.z = f[2]; p.intensity = f[3]; }
+      };
+
+      template <>
+      struct ConvolutionFields<pcl::PointXYZRGB, pcl::PointXYZRGB>
+      {
+        enum { size = 6, has_xyz = 1, first_uint8 = 3 };
+        static void get (const pcl::PointXYZRGB& p, float* f)
+        {
+          f[0] = p.x; f[1] = p.y; f[2] = p.z;
+          f[3] = static_cast<float> (p.r); f[4] = static_cast<float> (p.g); f[5] = static_cast<float> (p.b);
+        }
+        static void set (const float* f, pcl::PointXYZRGB& p)
+        {
+          p.x = f[0]; p.y = f[1]; p.z = f[2];
+          p.r = static_cast<pcl::uint8_t> (f[3]); p.g = static_cast<pcl::uint8_t> (f[4]); p.b = static_cast<pcl::uint8_t> (f[5]);
+        }
+      };
+
+      template <>
+      struct ConvolutionFields<pcl::RGB, pcl::RGB>
+      {
+        enum { size = 3, has_xyz = 0, first_uint8 = 0 };
+        static void get (const pcl::RGB& p, float* f)
+        {
+          f[0] = static_cast<float> (p.r); f[1] = static_cast<float> (p.g); f[2] = static_cast<float> (p.b);
+        }
+        static void set (const float* f, pcl::RGB& p)
+        {
+          p.r = static_cast<pcl::uint8_t> (f[0]); p.g = static_cast<pcl::uint8_t> (f[1]); p.b = static_cast<pcl::uint8_t> (f[2]);
+        }
+      };
+    }
+  }
+}
+
 template <typename PointIn, typename PointOut>
 pcl::filters::Convolution<PointIn, PointOut>::Convolution ()
   : borders_policy_ (BORDERS_POLICY_IGNORE)
   , distance_threshold_ (std::numeric_limits<float>::infinity ())
+  , sqr_distance_threshold_ (std::numeric_limits<float>::infinity ())
   , input_ ()
   , kernel_ ()
   , half_width_ ()
   , kernel_width_ ()
+  , planes_ ()
+  , convolved_planes_ ()
   , threads_ (1)
 {}
 
@@ -66,8 +138,8 @@ pcl::filters::Convolution<PointIn, PointOut>::initCompute (PointCloud<PointOut>&
     PCL_THROW_EXCEPTION (InitFailedException,
                          "[pcl::filters::Convolution::initCompute] convolving element width must be odd.");
 
-  if (distance_threshold_ != std::numeric_limits<float>::infinity ())
-    distance_threshold_ *= static_cast<float> (kernel_.size () % 2) * distance_threshold_;
+  // squared here rather than in place so that repeated calls see the same threshold
+  sqr_distance_threshold_ = distance_threshold_ * distance_threshold_;
 
   half_width_ = static_cast<int> (kernel_.size ()) / 2;
   kernel_width_ = static_cast<int> (kernel_.size () - 1);
@@ -90,11 +162,13 @@ pcl::filters::Convolution<PointIn, PointOut>::convolveRows (PointCloudOut& outpu
   try
   {
     initCompute (output);
+    if (convolveUsingPlanes (output, true))
+      return;
     switch (borders_policy_)
     {
-      case BORDERS_POLICY_MIRROR : convolve_rows_mirror (output);
-      case BORDERS_POLICY_DUPLICATE : convolve_rows_duplicate (output);
-      case BORDERS_POLICY_IGNORE : convolve_rows (output);
+      case BORDERS_POLICY_MIRROR : convolve_rows_mirror (output); break;
+      case BORDERS_POLICY_DUPLICATE : convolve_rows_duplicate (output); break;
+      case BORDERS_POLICY_IGNORE : convolve_rows (output); break;
     }
   }
   catch (InitFailedException& e)
@@ -110,11 +184,13 @@ pcl::filters::Convolution<PointIn, PointOut>::convolveCols (PointCloudOut& outpu
   try
   {
     initCompute (output);
+    if (convolveUsingPlanes (output, false))
+      return;
     switch (borders_policy_)
     {
-      case BORDERS_POLICY_MIRROR : convolve_cols_mirror (output);
-      case BORDERS_POLICY_DUPLICATE : convolve_cols_duplicate (output);
-      case BORDERS_POLICY_IGNORE : convolve_cols (output);
+      case BORDERS_POLICY_MIRROR : convolve_cols_mirror (output); break;
+      case BORDERS_POLICY_DUPLICATE : convolve_cols_duplicate (output); break;
+      case BORDERS_POLICY_IGNORE : convolve_cols (output); break;
     }
   }
   catch (InitFailedException& e)
@@ -131,12 +207,31 @@ pcl::filters::Convolution<PointIn, PointOut>::convolve (const Eigen::ArrayXf& h_
 {
   try
   {
+    typedef detail::ConvolutionFields<PointIn, PointOut> Fields;
+    if (Fields::size > 0)
+    {
+      // rows then columns on the planes, the output cloud is written once
+      setKernel (h_kernel);
+      initCompute (output);
+      extractPlanes (*input_, planes_);
+      convolvePlanes (planes_, true, input_->is_dense, convolved_planes_);
+      fillPlanesBorders (convolved_planes_);
+      setKernel (v_kernel);
+      initCompute (output);
+      convolvePlanes (convolved_planes_, false, input_->is_dense, planes_);
+      copyPlanes (planes_, false, output);
+      fillBorders (output, false);
+      return;
+    }
+
+    PointCloudInConstPtr input = input_;
     PointCloudInPtr tmp (new PointCloud<PointIn> ());
     setKernel (h_kernel);
     convolveRows (*tmp);
     setInputCloud (tmp);
     setKernel (v_kernel);
     convolveCols (output);
+    setInputCloud (input);
   }
   catch (InitFailedException& e)
   {
@@ -150,10 +245,8 @@ pcl::filters::Convolution<PointIn, PointOut>::convolve (PointCloud<PointOut>& ou
 {
   try
   {
-    PointCloudInPtr tmp (new PointCloud<PointIn> ());
-    convolveRows (*tmp);
-    setInputCloud (tmp);
-    convolveCols (output);
+    Eigen::ArrayXf kernel = kernel_;
+    convolve (kernel, kernel, output);
   }
   catch (InitFailedException& e)
   {
@@ -192,7 +285,7 @@ pcl::filters::Convolution<PointIn, PointOut>::convolveOneRowNonDense (int i, int
   {
     if (!isFinite ((*input_) (l,j)))
       continue;
-    if (pcl::squaredEuclideanDistance ((*input_) (i,j), (*input_) (l,j)) < distance_threshold_)
+    if (pcl::squaredEuclideanDistance ((*input_) (i,j), (*input_) (l,j)) < sqr_distance_threshold_)
     {
       result+= (*input_) (l,j) * kernel_[k];
       weight += kernel_[k];
@@ -218,7 +311,7 @@ pcl::filters::Convolution<PointIn, PointOut>::convolveOneColNonDense (int i, int
   {
     if (!isFinite ((*input_) (i,l)))
       continue;
-    if (pcl::squaredEuclideanDistance ((*input_) (i,j), (*input_) (i,l)) < distance_threshold_)
+    if (pcl::squaredEuclideanDistance ((*input_) (i,j), (*input_) (i,l)) < sqr_distance_threshold_)
     {
       result+= (*input_) (i,l) * kernel_[k];
       weight += kernel_[k];
@@ -288,7 +381,7 @@ namespace pcl
       {
         if (!isFinite ((*input_) (l,j)))
           continue;
-        if (pcl::squaredEuclideanDistance ((*input_) (i,j), (*input_) (l,j)) < distance_threshold_)
+        if (pcl::squaredEuclideanDistance ((*input_) (i,j), (*input_) (l,j)) < sqr_distance_threshold_)
         {
           result.x += (*input_) (l,j).x * kernel_[k]; result.y += (*input_) (l,j).y * kernel_[k]; result.z += (*input_) (l,j).z * kernel_[k];
           r+= kernel_[k] * static_cast<float> ((*input_) (l,j).r);
@@ -322,7 +415,7 @@ namespace pcl
       {
         if (!isFinite ((*input_) (i,l)))
           continue;
-        if (pcl::squaredEuclideanDistance ((*input_) (i,j), (*input_) (i,l)) < distance_threshold_)
+        if (pcl::squaredEuclideanDistance ((*input_) (i,j), (*input_) (i,l)) < sqr_distance_threshold_)
         {
           result.x += (*input_) (i,l).x * kernel_[k]; result.y += (*input_) (i,l).y * kernel_[k]; result.z += (*input_) (i,l).z * kernel_[k];
           r+= kernel_[k] * static_cast<float> ((*input_) (i,l).r);
@@ -668,4 +761,299 @@ pcl::filters::Convolution<PointIn, PointOut>::convolve_cols_mirror (PointCloudOu
   }
 }
 
+template <typename PointIn, typename PointOut> bool
+pcl::filters::Convolution<PointIn, PointOut>::convolveUsingPlanes (PointCloudOut& output, bool rows)
+{
+  if (detail::ConvolutionFields<PointIn, PointOut>::size == 0)
+    return (false);
+
+  extractPlanes (*input_, planes_);
+  convolvePlanes (planes_, rows, input_->is_dense, convolved_planes_);
+  copyPlanes (convolved_planes_, rows, output);
+  fillBorders (output, rows);
+  return (true);
+}
+
+template <typename PointIn, typename PointOut> void
+pcl::filters::Convolution<PointIn, PointOut>::extractPlanes (const PointCloudIn& cloud,
+                                                            std::vector<float>& planes) const
+{
+  typedef detail::ConvolutionFields<PointIn, PointOut> Fields;
+  const int nr_points = static_cast<int> (cloud.points.size ());
+  planes.resize (Fields::size * nr_points);
+  float *data = planes.empty () ? 0 : &planes[0];
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (cloud, data) num_threads (threads_)
+#endif
+  for (int idx = 0; idx < nr_points; ++idx)
+  {
+    float fields[Fields::size > 0 ? Fields::size : 1];
+    Fields::get (cloud.points[idx], fields);
+    for (int f = 0; f < Fields::size; ++f)
+      data[f * nr_points + idx] = fields[f];
+  }
+}
+
+template <typename PointIn, typename PointOut> void
+pcl::filters::Convolution<PointIn, PointOut>::convolvePlanes (const std::vector<float>& planes,
+                                                             bool rows, bool dense,
+                                                             std::vector<float>& result) const
+{
+  typedef detail::ConvolutionFields<PointIn, PointOut> Fields;
+  const int width = input_->width;
+  const int height = input_->height;
+  const int plane_size = width * height;
+  // kernel offsets are along i for rows and along j for columns
+  const int step = rows ? 1 : width;
+  const int first_j = rows ? 0 : half_width_;
+  const int last_j = rows ? height : height - half_width_;
+  const int first_i = rows ? half_width_ : 0;
+  const int last_i = rows ? width - half_width_ : width;
+  // only points with finite coordinates and close enough to the center are accounted
+  const bool weighted = !dense && Fields::has_xyz;
+
+  result.resize (planes.size ());
+  if (first_i >= last_i || first_j >= last_j)
+    return;
+
+  const float *in = &planes[0];
+  float *out = &result[0];
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (in, out) num_threads (threads_)
+#endif
+  for (int j = first_j; j < last_j; ++j)
+  {
+    // inner loops run over the n consecutive outputs of row j
+    const int row = j * width + first_i;
+    const int n = last_i - first_i;
+    std::vector<float> weights;
+    if (weighted)
+      weights.assign (n, 0.f);
+
+    for (int f = 0; f < Fields::size; ++f)
+      std::fill (out + f * plane_size + row, out + f * plane_size + row + n, 0.f);
+
+    // same accumulation order as the point by point convolution
+    for (int k = kernel_width_, t = 0; k > -1; --k, ++t)
+    {
+      const int offset = row + (t - half_width_) * step;
+      const float coefficient = kernel_[k];
+      if (!weighted)
+      {
+        for (int f = 0; f < Fields::size; ++f)
+        {
+          const float *src = in + f * plane_size + offset;
+          float *dst = out + f * plane_size + row;
+          for (int i = 0; i < n; ++i)
+            dst[i] += src[i] * coefficient;
+        }
+        continue;
+      }
+
+      const float *x = in + row, *y = in + plane_size + row, *z = in + 2 * plane_size + row;
+      const float *nx = in + offset, *ny = in + plane_size + offset, *nz = in + 2 * plane_size + offset;
+      for (int i = 0; i < n; ++i)
+      {
+        const float dx = nx[i] - x[i], dy = ny[i] - y[i], dz = nz[i] - z[i];
+        // NaN neighbors or centers fail the comparison
+        const bool accepted = (dx * dx + dy * dy + dz * dz) < sqr_distance_threshold_;
+        weights[i] += accepted ? coefficient : 0.f;
+        for (int f = 0; f < Fields::size; ++f)
+          out[f * plane_size + row + i] += accepted ? in[f * plane_size + offset + i] * coefficient : 0.f;
+      }
+    }
+
+    if (!weighted)
+      continue;
+    for (int i = 0; i < n; ++i)
+    {
+      if (weights[i] == 0)
+      {
+        out[row + i] = out[plane_size + row + i] = out[2 * plane_size + row + i] =
+          std::numeric_limits<float>::quiet_NaN ();
+        continue;
+      }
+      const float weight = 1.f / weights[i];
+      for (int f = 0; f < Fields::size; ++f)
+        out[f * plane_size + row + i] *= weight;
+    }
+  }
+}
+
+template <typename PointIn, typename PointOut> void
+pcl::filters::Convolution<PointIn, PointOut>::fillPlanesBorders (std::vector<float>& planes) const
+{
+  typedef detail::ConvolutionFields<PointIn, PointOut> Fields;
+  const int width = input_->width;
+  const int height = input_->height;
+  const int plane_size = width * height;
+  const int last = width - half_width_;
+  const int w = last - 1;
+  if (planes.empty () || last <= half_width_)
+    return;
+
+  for (int f = 0; f < Fields::size; ++f)
+  {
+    float *plane = &planes[f * plane_size];
+    // the same truncation a uint8_t field of a point cloud goes through
+    if (f >= Fields::first_uint8)
+      for (int j = 0; j < height; ++j)
+        for (int i = half_width_; i < last; ++i)
+          plane[j * width + i] = static_cast<float> (static_cast<pcl::uint8_t> (plane[j * width + i]));
+
+    // ignored borders hold default points made infinite
+    const float infinite = (Fields::has_xyz && f < 3) ? std::numeric_limits<float>::quiet_NaN () : 0.f;
+    for (int j = 0; j < height; ++j)
+    {
+      float *r = plane + j * width;
+      switch (borders_policy_)
+      {
+        case BORDERS_POLICY_MIRROR :
+        {
+          for (int i = last, l = 0; i < width; ++i, ++l)
+            r[i] = r[w-l];
+          for (int i = 0; i < half_width_; ++i)
+            r[i] = r[half_width_+1-i];
+          break;
+        }
+        case BORDERS_POLICY_DUPLICATE :
+        {
+          for (int i = last; i < width; ++i)
+            r[i] = r[w];
+          for (int i = 0; i < half_width_; ++i)
+            r[i] = r[half_width_];
+          break;
+        }
+        case BORDERS_POLICY_IGNORE :
+        {
+          for (int i = 0; i < half_width_; ++i)
+            r[i] = infinite;
+          for (int i = last; i < width; ++i)
+            r[i] = infinite;
+          break;
+        }
+      }
+    }
+  }
+}
+
+template <typename PointIn, typename PointOut> void
+pcl::filters::Convolution<PointIn, PointOut>::copyPlanes (const std::vector<float>& planes,
+                                                         bool rows, PointCloudOut& output) const
+{
+  typedef detail::ConvolutionFields<PointIn, PointOut> Fields;
+  const int width = input_->width;
+  const int height = input_->height;
+  const int plane_size = width * height;
+  const int first_j = rows ? 0 : half_width_;
+  const int last_j = rows ? height : height - half_width_;
+  const int first_i = rows ? half_width_ : 0;
+  const int last_i = rows ? width - half_width_ : width;
+  if (planes.empty ())
+    return;
+  const float *data = &planes[0];
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (output, data) num_threads (threads_)
+#endif
+  for (int j = first_j; j < last_j; ++j)
+  {
+    for (int i = first_i; i < last_i; ++i)
+    {
+      float fields[Fields::size > 0 ? Fields::size : 1];
+      for (int f = 0; f < Fields::size; ++f)
+        fields[f] = data[f * plane_size + j * width + i];
+      PointOut result;
+      Fields::set (fields, result);
+      output (i,j) = result;
+    }
+  }
+}
+
+template <typename PointIn, typename PointOut> void
+pcl::filters::Convolution<PointIn, PointOut>::fillBorders (PointCloudOut& output, bool rows)
+{
+  const int width = input_->width;
+  const int height = input_->height;
+
+  if (rows)
+  {
+    const int last = width - half_width_;
+    const int w = last - 1;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (output) num_threads (threads_)
+#endif
+    for (int j = 0; j < height; ++j)
+    {
+      switch (borders_policy_)
+      {
+        case BORDERS_POLICY_MIRROR :
+        {
+          for (int i = last, l = 0; i < width; ++i, ++l)
+            output (i,j) = output (w-l, j);
+          for (int i = 0; i < half_width_; ++i)
+            output (i,j) = output (half_width_+1-i, j);
+          break;
+        }
+        case BORDERS_POLICY_DUPLICATE :
+        {
+          for (int i = last; i < width; ++i)
+            output (i,j) = output (w, j);
+          for (int i = 0; i < half_width_; ++i)
+            output (i,j) = output (half_width_, j);
+          break;
+        }
+        case BORDERS_POLICY_IGNORE :
+        {
+          for (int i = 0; i < half_width_; ++i)
+            makeInfinite (output (i,j));
+          for (int i = last; i < width; ++i)
+            makeInfinite (output (i,j));
+          break;
+        }
+      }
+    }
+  }
+  else
+  {
+    const int last = height - half_width_;
+    const int h = last - 1;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (output) num_threads (threads_)
+#endif
+    for (int i = 0; i < width; ++i)
+    {
+      switch (borders_policy_)
+      {
+        case BORDERS_POLICY_MIRROR :
+        {
+          for (int j = last, l = 0; j < height; ++j, ++l)
+            output (i,j) = output (i,h-l);
+          for (int j = 0; j < half_width_; ++j)
+            output (i,j) = output (i,half_width_+1-j);
+          break;
+        }
+        case BORDERS_POLICY_DUPLICATE :
+        {
+          for (int j = last; j < height; ++j)
+            output (i,j) = output (i,h);
+          for (int j = 0; j < half_width_; ++j)
+            output (i,j) = output (i,half_width_);
+          break;
+        }
+        case BORDERS_POLICY_IGNORE :
+        {
+          for (int j = 0; j < half_width_; ++j)
+            makeInfinite (output (i,j));
+          for (int j = last; j < height; ++j)
+            makeInfinite (output (i,j));
+          break;
+        }
+      }
+    }
+  }
+}
+
 #endif //PCL_FILTERS_CONVOLUTION_IMPL_HPP
@@ -43,6 +43,8 @@
 #include <pcl/pcl_config.h>
 #include <pcl/point_types.h>
 #include <pcl/common/point_operators.h>
+#include <pcl/filters/convolution.h>
+#include <pcl/filters/permutohedral_lattice.h>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 namespace pcl
@@ -173,6 +175,8 @@ pcl::filters::Convolution3D<PointInT, PointOutT, KernelT>::Convolution3D ()
   , surface_ ()
   , tree_ ()
   , search_radius_ (0)
+  , threads_ (1)
+  , approximate_ (false)
 {}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -225,6 +229,9 @@ pcl::filters::Convolution3D<PointInT, PointOutT, KernelT>::initCompute ()
 template <typename PointInT, typename PointOutT, typename KernelT> void
 pcl::filters::Convolution3D<PointInT, PointOutT, KernelT>::convolve (PointCloud<PointOutT>& output)
 {
+  if (approximate_ && convolveApproximate (output))
+    return;
+
   if (!initCompute ())
   {
     PCL_ERROR ("[pcl::filters::Convlution3D::convolve] init failed!\n");
@@ -257,4 +264,75 @@ pcl::filters::Convolution3D<PointInT, PointOutT, KernelT>::convolve (PointCloud<
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename KernelT> bool
+pcl::filters::Convolution3D<PointInT, PointOutT, KernelT>::convolveApproximate (PointCloud<PointOutT>& output)
+{
+  typedef detail::ConvolutionFields<PointInT, PointOutT> Fields;
+  GaussianKernel<PointInT, PointOutT> *gaussian = dynamic_cast<GaussianKernel<PointInT, PointOutT>* > (&kernel_);
+  if (!gaussian || Fields::size == 0)
+  {
+    PCL_WARN ("[pcl::filters::Convlution3D::convolve] only Gaussian kernels on PointXYZ, PointXYZI and PointXYZRGB clouds can be approximated, using neighbor search.\n");
+    return (false);
+  }
+  if (!PCLBase<PointInT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::filters::Convlution3D::initCompute] init failed!\n");
+    return (true);
+  }
+  if (!surface_)
+    surface_ = input_;
+  kernel_.setInputCloud (surface_);
+  if (!kernel_.initCompute ())
+  {
+    PCL_ERROR ("[pcl::filters::Convlution3D::initCompute] kernel initialization failed!\n");
+    return (true);
+  }
+
+  output.resize (surface_->size ());
+  output.width = surface_->width;
+  output.height = surface_->height;
+  output.is_dense = surface_->is_dense;
+
+  // Splat the finite points with their fields, in units of sigma
+  const float inverse_sigma = 1.0f / gaussian->getSigma ();
+  const int nr_points = static_cast<int> (surface_->size ());
+  PermutohedralLattice<3> lattice;
+  lattice.reset (Fields::size, nr_points);
+  std::vector<int> lattice_points (nr_points, -1);
+  for (int point_idx = 0; point_idx < nr_points; ++point_idx)
+  {
+    const PointInT& point_in = surface_->points[point_idx];
+    if (!isFinite (point_in))
+      continue;
+    float feature[3] = { point_in.x * inverse_sigma, point_in.y * inverse_sigma, point_in.z * inverse_sigma };
+    float fields[Fields::size > 0 ? Fields::size : 1];
+    Fields::get (point_in, fields);
+    lattice_points[point_idx] = lattice.getNumberOfPoints ();
+    lattice.splat (feature, fields);
+  }
+  lattice.blur (threads_);
+
+  bool is_dense = output.is_dense;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (output, lattice, lattice_points) reduction (&& : is_dense) num_threads (threads_)
+#endif
+  for (int point_idx = 0; point_idx < nr_points; ++point_idx)
+  {
+    if (lattice_points[point_idx] < 0)
+    {
+      kernel_.makeInfinite (output[point_idx]);
+      is_dense = false;
+      continue;
+    }
+    float fields[Fields::size > 0 ? Fields::size : 1];
+    lattice.slice (lattice_points[point_idx], fields);
+    PointOutT result;
+    Fields::set (fields, result);
+    output[point_idx] = result;
+  }
+  output.is_dense = is_dense;
+  return (true);
+}
+
 #endif
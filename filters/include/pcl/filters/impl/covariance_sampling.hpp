@@ -0,0 +1,260 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_COVARIANCE_SAMPLING_HPP_
+#define PCL_FILTERS_IMPL_COVARIANCE_SAMPLING_HPP_
+
+#include <pcl/filters/covariance_sampling.h>
+#include <pcl/common/io.h>
+#include <Eigen/Eigenvalues>
+#include <algorithm>
+
+namespace pcl
+{
+  namespace filters
+  {
+    namespace detail
+    {
+      /** \brief Order the candidates of CovarianceSampling by decreasing score, then by increasing index. */
+      inline bool
+      compareSamplingCandidates (const std::pair<double, int> &a, const std::pair<double, int> &b)
+      {
+        return (a.first > b.first || (a.first == b.first && a.second < b.second));
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename NormalT> bool
+pcl::CovarianceSampling<PointT, NormalT>::computeConstraints ()
+{
+  if (!initCompute ())
+    return (false);
+  if (!input_normals_ || input_normals_->points.size () != input_->points.size ())
+  {
+    PCL_ERROR ("[pcl::%s::computeConstraints] The number of normals differs from the number of points!\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  const int nr_points = static_cast<int> (indices_->size ());
+  constraints_.resize (nr_points);
+
+  // Center the points, and scale them by their mean distance to the centroid so that the rotational and the
+  // translational constraints are comparable
+  double cx = 0, cy = 0, cz = 0;
+  int nr_valid = 0;
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const PointT &p = input_->points[(*indices_)[i]];
+    const NormalT &n = input_normals_->points[(*indices_)[i]];
+    if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z) ||
+        !pcl_isfinite (n.normal_x) || !pcl_isfinite (n.normal_y) || !pcl_isfinite (n.normal_z))
+      continue;
+    cx += p.x; cy += p.y; cz += p.z;
+    ++nr_valid;
+  }
+  if (nr_valid == 0)
+  {
+    std::fill (constraints_.begin (), constraints_.end (), Vector6d::Zero ());
+    return (true);
+  }
+  const Eigen::Vector3d centroid (cx / nr_valid, cy / nr_valid, cz / nr_valid);
+
+  std::vector<double> distances (nr_points, 0.0);
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for num_threads(threads_)
+#endif
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const PointT &p = input_->points[(*indices_)[i]];
+    const NormalT &n = input_normals_->points[(*indices_)[i]];
+    if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z) ||
+        !pcl_isfinite (n.normal_x) || !pcl_isfinite (n.normal_y) || !pcl_isfinite (n.normal_z))
+    {
+      constraints_[i].setZero ();
+      continue;
+    }
+    const Eigen::Vector3d point = Eigen::Vector3d (p.x, p.y, p.z) - centroid;
+    const Eigen::Vector3d normal (n.normal_x, n.normal_y, n.normal_z);
+    constraints_[i].template head<3> () = point.cross (normal);
+    constraints_[i].template tail<3> () = normal;
+    distances[i] = point.norm ();
+  }
+
+  // Sums are always taken in the same order, so that the sample does not depend on the number of threads
+  double distance_sum = 0;
+  for (int i = 0; i < nr_points; ++i)
+    distance_sum += distances[i];
+
+  const double scale = distance_sum > 0 ? nr_valid / distance_sum : 1.0;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for num_threads(threads_)
+#endif
+  for (int i = 0; i < nr_points; ++i)
+    constraints_[i].template head<3> () *= scale;
+
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename NormalT> bool
+pcl::CovarianceSampling<PointT, NormalT>::computeCovarianceMatrix (Matrix6d &covariance_matrix)
+{
+  if (!computeConstraints ())
+    return (false);
+
+  // The constraints are summed by blocks of fixed size, so that the sum does not depend on the number of threads
+  const int nr_points = static_cast<int> (constraints_.size ());
+  const int chunk_size = 4096;
+  const int nr_chunks = (nr_points + chunk_size - 1) / chunk_size;
+  std::vector<Matrix6d, Eigen::aligned_allocator<Matrix6d> > partial_sums (nr_chunks, Matrix6d::Zero ());
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for num_threads(threads_)
+#endif
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
+  {
+    const int begin = chunk * chunk_size;
+    const int end = std::min (begin + chunk_size, nr_points);
+    for (int i = begin; i < end; ++i)
+      partial_sums[chunk].template selfadjointView<Eigen::Lower> ().rankUpdate (constraints_[i]);
+  }
+
+  covariance_matrix.setZero ();
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
+    covariance_matrix += partial_sums[chunk];
+  covariance_matrix.template triangularView<Eigen::StrictlyUpper> () = covariance_matrix.transpose ();
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename NormalT> double
+pcl::CovarianceSampling<PointT, NormalT>::computeConditionNumber ()
+{
+  Matrix6d covariance_matrix;
+  if (!computeCovarianceMatrix (covariance_matrix))
+    return (-1.0);
+
+  Eigen::SelfAdjointEigenSolver<Matrix6d> solver (covariance_matrix, Eigen::EigenvaluesOnly);
+  const double min_eigenvalue = solver.eigenvalues () (0);
+  const double max_eigenvalue = solver.eigenvalues () (5);
+  if (min_eigenvalue <= 0)
+    return (std::numeric_limits<double>::infinity ());
+  return (max_eigenvalue / min_eigenvalue);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename NormalT> void
+pcl::CovarianceSampling<PointT, NormalT>::applyFilter (PointCloud &output)
+{
+  std::vector<int> indices;
+  applyFilter (indices);
+  copyPointCloud (*input_, indices, output);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename NormalT> void
+pcl::CovarianceSampling<PointT, NormalT>::applyFilter (std::vector<int> &indices)
+{
+  indices.clear ();
+  if (num_samples_ >= indices_->size ())
+  {
+    indices = *indices_;
+    return;
+  }
+
+  Matrix6d covariance_matrix;
+  if (!computeCovarianceMatrix (covariance_matrix))
+    return;
+  Eigen::SelfAdjointEigenSolver<Matrix6d> solver (covariance_matrix);
+  const Matrix6d &eigenvectors = solver.eigenvectors ();
+
+  std::vector<int> valid;
+  valid.reserve (constraints_.size ());
+  for (size_t i = 0; i < constraints_.size (); ++i)
+    if (!constraints_[i].isZero ())
+      valid.push_back (static_cast<int> (i));
+  const size_t nr_samples = std::min (static_cast<size_t> (num_samples_), valid.size ());
+
+  // Rank the points by the strength of their constraint along every eigenvector. A list never needs more than twice
+  // the number of samples: one for each point picked from it, and one for each point picked from the other lists
+  const size_t nr_candidates = std::min (2 * nr_samples, valid.size ());
+  std::vector<std::vector<std::pair<double, int> > > candidates (6);
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for num_threads(threads_)
+#endif
+  for (int k = 0; k < 6; ++k)
+  {
+    std::vector<std::pair<double, int> > &list = candidates[k];
+    list.resize (valid.size ());
+    for (size_t i = 0; i < valid.size (); ++i)
+      list[i] = std::make_pair (fabs (constraints_[valid[i]].dot (eigenvectors.col (k))), valid[i]);
+    std::partial_sort (list.begin (), list.begin () + nr_candidates, list.end (),
+                       pcl::filters::detail::compareSamplingCandidates);
+    list.resize (nr_candidates);
+  }
+
+  // Always pick for the least constrained eigenvector
+  std::vector<bool> picked (constraints_.size (), false);
+  size_t next[6] = {0, 0, 0, 0, 0, 0};
+  Vector6d constrained = Vector6d::Zero ();
+  indices.reserve (nr_samples);
+  while (indices.size () < nr_samples)
+  {
+    int k = -1;
+    for (int j = 0; j < 6; ++j)
+      if (next[j] < nr_candidates && (k < 0 || constrained[j] < constrained[k]))
+        k = j;
+    if (k < 0)
+      break;
+    while (next[k] < nr_candidates && picked[candidates[k][next[k]].second])
+      ++next[k];
+    if (next[k] == nr_candidates)
+      continue;
+
+    const int i = candidates[k][next[k]++].second;
+    picked[i] = true;
+    indices.push_back ((*indices_)[i]);
+    constrained += (eigenvectors.transpose () * constraints_[i]).cwiseAbs2 ();
+  }
+}
+
+#define PCL_INSTANTIATE_CovarianceSampling(T,NT) template class PCL_EXPORTS pcl::CovarianceSampling<T,NT>;
+
+#endif  // PCL_FILTERS_IMPL_COVARIANCE_SAMPLING_HPP_
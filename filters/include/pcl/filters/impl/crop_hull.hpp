@@ -39,36 +39,22 @@
 #define PCL_FILTERS_IMPL_CROP_HULL_H_
 
 #include <pcl/filters/crop_hull.h>
+#include <pcl/common/io.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
 pcl::CropHull<PointT>::applyFilter (PointCloud &output)
 {
-  if (dim_ == 2)
-  {
-    // in this case we are assuming all the points lie in the same plane as the
-    // 2D convex hull, so the choice of projection just changes the
-    // conditioning of the problem: choose to squash the XYZ component of the
-    // hull-points that has least variation - this will also give reasonable
-    // results if the points don't lie exactly in the same plane
-    const Eigen::Vector3f range = getHullCloudRange ();
-    if (range[0] <= range[1] && range[0] <= range[2])
-      applyFilter2D<1,2> (output);
-    else if (range[1] <= range[2] && range[1] <= range[0])
-      applyFilter2D<2,0> (output);
-    else
-      applyFilter2D<0,1> (output);
-  }
-  else
-  {
-    applyFilter3D (output);
-  }
+  std::vector<int> indices;
+  applyFilter (indices);
+  copyPointCloud (*input_, indices, output);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
 pcl::CropHull<PointT>::applyFilter (std::vector<int> &indices)
 {
+  indices.clear ();
   if (dim_ == 2)
   {
     // in this case we are assuming all the points lie in the same plane as the
@@ -119,118 +105,264 @@ pcl::CropHull<PointT>::getHullCloudRange ()
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void 
-pcl::CropHull<PointT>::applyFilter2D (PointCloud &output)
+pcl::CropHull<PointT>::applyFilter2D (std::vector<int> &indices)
 {
+  updatePolygonGrids<PlaneDim1, PlaneDim2> ();
+
+  std::vector<char> inside (indices_->size ());
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int index = 0; index < static_cast<int> (indices_->size ()); index++)
+    inside[index] = isInside2D<PlaneDim1, PlaneDim2> (input_->points[(*indices_)[index]]);
+
+  // If we're removing points *inside* the hull, only keep points that
+  // haven't been found inside any polygons
   for (size_t index = 0; index < indices_->size (); index++)
+    if ((inside[index] != 0) == crop_outside_)
+      indices.push_back ((*indices_)[index]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void 
+pcl::CropHull<PointT>::applyFilter3D (std::vector<int> &indices)
+{
+  updatePolygonGrids<0, 0> ();
+
+  std::vector<char> inside (indices_->size ());
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int index = 0; index < static_cast<int> (indices_->size ()); index++)
+    inside[index] = isInside3D (input_->points[(*indices_)[index]]);
+
+  for (size_t index = 0; index < indices_->size (); index++)
+    if ((inside[index] != 0) == crop_outside_)
+      indices.push_back ((*indices_)[index]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> bool
+pcl::CropHull<PointT>::isInside2D (const PointT &point) const
+{
+  const PolygonGrid &grid = grids_[0];
+  int begin, end;
+  if (!getCellPolygons (grid, point, begin, end))
   {
-    // iterate over polygons faster than points because we expect this data
-    // to be, in general, more cache-local - the point cloud might be huge
-    size_t poly;
-    for (poly = 0; poly < hull_polygons_.size (); poly++)
-    {
-      if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (
-              input_->points[(*indices_)[index]], hull_polygons_[poly], *hull_cloud_
-         ))
-      {
-        if (crop_outside_)
-          output.push_back (input_->points[(*indices_)[index]]);
-        // once a point has tested +ve for being inside one polygon, we can
-        // stop checking the others:
-        break;
-      }
-    }
-    // If we're removing points *inside* the hull, only remove points that
-    // haven't been found inside any polygons
-    if (poly == hull_polygons_.size () && !crop_outside_)
-      output.push_back (input_->points[(*indices_)[index]]);
+    for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
+      if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (point, hull_polygons_[poly], *hull_cloud_))
+        return (true);
+    return (false);
   }
+
+  // once a point has tested +ve for being inside one polygon, we can
+  // stop checking the others
+  for (size_t i = 0; i < grid.unbounded_polygons.size (); i++)
+    if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (point, hull_polygons_[grid.unbounded_polygons[i]], *hull_cloud_))
+      return (true);
+  for (int i = begin; i < end; i++)
+    if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (point, hull_polygons_[grid.polygons[i]], *hull_cloud_))
+      return (true);
+  return (false);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void 
-pcl::CropHull<PointT>::applyFilter2D (std::vector<int> &indices)
+template<typename PointT> bool
+pcl::CropHull<PointT>::isInside3D (const PointT &point) const
 {
-  // see comments in (PointCloud& output) overload
-  for (size_t index = 0; index < indices_->size (); index++)
+  // test ray-crossings for three random rays, and take vote of crossings
+  // counts to determine if each point is inside the hull: the vote avoids
+  // tricky edge and corner cases when rays might fluke through the edge
+  // between two polygons
+  // Only the polygons overlapping the cell of the point in the grid
+  // orthogonal to a ray can be crossed by it.
+  size_t crossings[3] = {0,0,0};
+  for (int ray = 0; ray < 3; ray++)
   {
-    size_t poly;
-    for (poly = 0; poly < hull_polygons_.size (); poly++)
+    const PolygonGrid &grid = grids_[ray];
+    const Eigen::Vector3f direction = getRayDirection (ray);
+    int begin, end;
+    if (!getCellPolygons (grid, point, begin, end))
     {
-      if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (
-              input_->points[(*indices_)[index]], hull_polygons_[poly], *hull_cloud_
-         ))
-      {
-        if (crop_outside_)      
-          indices.push_back ((*indices_)[index]);
-        break;
-      }
+      for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
+        crossings[ray] += rayTriangleIntersect (point, direction, hull_polygons_[poly], *hull_cloud_);
+      continue;
     }
-    if (poly == hull_polygons_.size () && !crop_outside_)
-      indices.push_back ((*indices_)[index]);
+
+    for (size_t i = 0; i < grid.unbounded_polygons.size (); i++)
+      crossings[ray] += rayTriangleIntersect (point, direction, hull_polygons_[grid.unbounded_polygons[i]], *hull_cloud_);
+    for (int i = begin; i < end; i++)
+      crossings[ray] += rayTriangleIntersect (point, direction, hull_polygons_[grid.polygons[i]], *hull_cloud_);
   }
+  return ((crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT> void 
-pcl::CropHull<PointT>::applyFilter3D (PointCloud &output)
+template<typename PointT> Eigen::Vector3f
+pcl::CropHull<PointT>::getRayDirection (int ray)
 {
-  // This algorithm could definitely be sped up using kdtree/octree
-  // information, if that is available!
+  // 'random' rays are arbitrary - basically anything that is less likely to
+  // hit the edge between polygons than coordinate-axis aligned rays would
+  // be.
+  static const float rays[3][3] =
+  {
+    {0.264882f,  0.688399f, 0.675237f},
+    {0.0145419f, 0.732901f, 0.68018f},
+    {0.856514f,  0.508771f, 0.0868081f}
+  };
+  return (Eigen::Vector3f (rays[ray][0], rays[ray][1], rays[ray][2]));
+}
 
-  for (size_t index = 0; index < indices_->size (); index++)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void
+pcl::CropHull<PointT>::updatePolygonGrids ()
+{
+  // The 3D grids are flagged with (-1, -1)
+  std::pair<int, int> dims (-1, -1);
+  if (dim_ == 2)
+    dims = std::make_pair (static_cast<int> (PlaneDim1), static_cast<int> (PlaneDim2));
+  if (grids_valid_ && grid_dims_ == dims)
+    return;
+
+  if (dim_ == 2)
+  {
+    grids_.resize (1);
+    buildPolygonGrid (Eigen::Vector3f::Unit (PlaneDim1), Eigen::Vector3f::Unit (PlaneDim2), Eigen::Vector3f::Zero (), grids_[0]);
+  }
+  else
   {
-    // test ray-crossings for three random rays, and take vote of crossings
-    // counts to determine if each point is inside the hull: the vote avoids
-    // tricky edge and corner cases when rays might fluke through the edge
-    // between two polygons
-    // 'random' rays are arbitrary - basically anything that is less likely to
-    // hit the edge between polygons than coordinate-axis aligned rays would
-    // be.
-    size_t crossings[3] = {0,0,0};
-    Eigen::Vector3f rays[3] = 
+    grids_.resize (3);
+    for (int ray = 0; ray < 3; ray++)
     {
-      Eigen::Vector3f (0.264882f,  0.688399f, 0.675237f),
-      Eigen::Vector3f (0.0145419f, 0.732901f, 0.68018f),
-      Eigen::Vector3f (0.856514f,  0.508771f, 0.0868081f)
-    };
-
-    for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
-      for (size_t ray = 0; ray < 3; ray++)
-        crossings[ray] += rayTriangleIntersect
-          (input_->points[(*indices_)[index]], rays[ray], hull_polygons_[poly], *hull_cloud_);
-
-    if (crop_outside_ && (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1)
-      output.push_back (input_->points[(*indices_)[index]]);
-    else if (!crop_outside_)
-      output.push_back (input_->points[(*indices_)[index]]);
+      const Eigen::Vector3f direction = getRayDirection (ray);
+      const Eigen::Vector3f axis1 = direction.unitOrthogonal ();
+      buildPolygonGrid (axis1, direction.cross (axis1), direction, grids_[ray]);
+    }
   }
+  grid_dims_ = dims;
+  grids_valid_ = true;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointT> void 
-pcl::CropHull<PointT>::applyFilter3D (std::vector<int> &indices)
+template<typename PointT> void
+pcl::CropHull<PointT>::buildPolygonGrid (const Eigen::Vector3f &axis1, const Eigen::Vector3f &axis2,
+                                         const Eigen::Vector3f &ray, PolygonGrid &grid) const
 {
-  // see comments in applyFilter3D (PointCloud& output)
-  for (size_t index = 0; index < indices_->size (); index++)
+  grid.axis1 = axis1;
+  grid.axis2 = axis2;
+  grid.cell_starts.clear ();
+  grid.polygons.clear ();
+  grid.unbounded_polygons.clear ();
+
+  // Project the bounding box of every polygon onto the plane
+  const size_t nr_polygons = hull_polygons_.size ();
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > boxes (nr_polygons);  // (min1, min2, max1, max2)
+  std::vector<bool> bounded (nr_polygons, false);
+  Eigen::Vector2f min_p (std::numeric_limits<float>::max (), std::numeric_limits<float>::max ());
+  Eigen::Vector2f max_p (-std::numeric_limits<float>::max (), -std::numeric_limits<float>::max ());
+  for (size_t poly = 0; poly < nr_polygons; poly++)
   {
-    size_t crossings[3] = {0,0,0};
-    Eigen::Vector3f rays[3] = 
+    const std::vector<uint32_t> &vertices = hull_polygons_[poly].vertices;
+    Eigen::Vector4f box (std::numeric_limits<float>::max (), std::numeric_limits<float>::max (),
+                         -std::numeric_limits<float>::max (), -std::numeric_limits<float>::max ());
+    bool finite = !vertices.empty ();
+    for (size_t v = 0; v < vertices.size (); v++)
     {
-      Eigen::Vector3f(0.264882f,  0.688399f, 0.675237f),
-      Eigen::Vector3f(0.0145419f, 0.732901f, 0.68018f),
-      Eigen::Vector3f(0.856514f,  0.508771f, 0.0868081f)
-    };
+      const Eigen::Vector3f p = hull_cloud_->points[vertices[v]].getVector3fMap ();
+      const float u = axis1.dot (p), w = axis2.dot (p);
+      finite = finite && pcl_isfinite (u) && pcl_isfinite (w);
+      box[0] = std::min (box[0], u); box[1] = std::min (box[1], w);
+      box[2] = std::max (box[2], u); box[3] = std::max (box[3], w);
+    }
 
-    for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
-      for (size_t ray = 0; ray < 3; ray++)
-        crossings[ray] += rayTriangleIntersect
-          (input_->points[(*indices_)[index]], rays[ray], hull_polygons_[poly], *hull_cloud_);
+    // Rays nearly in the plane of a triangle, or through a sliver triangle, are
+    // intersected with too little precision for the projection to bound the result
+    if (finite && ray != Eigen::Vector3f::Zero () && vertices.size () == 3)
+    {
+      const Eigen::Vector3f a = hull_cloud_->points[vertices[0]].getVector3fMap ();
+      const Eigen::Vector3f u = hull_cloud_->points[vertices[1]].getVector3fMap () - a;
+      const Eigen::Vector3f v = hull_cloud_->points[vertices[2]].getVector3fMap () - a;
+      const Eigen::Vector3f n = u.cross (v);
+      finite = n.squaredNorm () > 1e-6f * u.squaredNorm () * v.squaredNorm () &&
+               std::fabs (n.dot (ray)) > 1e-3f * n.norm ();
+    }
 
-    if (crop_outside_ && (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1)
-      indices.push_back ((*indices_)[index]);
-    else if (!crop_outside_)
-      indices.push_back ((*indices_)[index]);
+    if (!finite)
+    {
+      grid.unbounded_polygons.push_back (static_cast<int> (poly));
+      continue;
+    }
+
+    // Pad the box, so rounding errors in the exact tests can not put a point outside of it
+    const float pad = 1e-4f * (box[2] - box[0] + box[3] - box[1]) +
+                      1e-6f * (std::fabs (box[0]) + std::fabs (box[1]) + std::fabs (box[2]) + std::fabs (box[3]));
+    box += Eigen::Vector4f (-pad, -pad, pad, pad);
+    boxes[poly] = box;
+    bounded[poly] = true;
+    min_p = min_p.cwiseMin (box.head<2> ());
+    max_p = max_p.cwiseMax (box.tail<2> ());
   }
+
+  // About one polygon per cell for evenly spread polygons
+  const int nr_bounded = static_cast<int> (nr_polygons - grid.unbounded_polygons.size ());
+  grid.nr_cells = std::max (1, std::min (512, static_cast<int> (std::sqrt (static_cast<double> (nr_bounded)))));
+  grid.min_p = min_p;
+  grid.inverse_cell_size = Eigen::Vector2f::Zero ();
+  for (int d = 0; d < 2; d++)
+    if (max_p[d] > min_p[d])
+      grid.inverse_cell_size[d] = static_cast<float> (grid.nr_cells) / (max_p[d] - min_p[d]);
+
+  // Count the polygons per cell, then fill them in, in polygon order
+  const int nr_cells = grid.nr_cells * grid.nr_cells;
+  grid.cell_starts.assign (nr_cells + 1, 0);
+  for (int pass = 0; pass < 2; pass++)
+  {
+    std::vector<int> fill;
+    if (pass == 1)
+    {
+      for (int c = 0; c < nr_cells; c++)
+        grid.cell_starts[c + 1] += grid.cell_starts[c];
+      grid.polygons.resize (grid.cell_starts[nr_cells]);
+      fill.assign (grid.cell_starts.begin (), grid.cell_starts.end () - 1);
+    }
+
+    for (size_t poly = 0; poly < nr_polygons; poly++)
+    {
+      if (!bounded[poly])
+        continue;
+      const int min_i = std::min (grid.nr_cells - 1, static_cast<int> ((boxes[poly][0] - min_p[0]) * grid.inverse_cell_size[0]));
+      const int min_j = std::min (grid.nr_cells - 1, static_cast<int> ((boxes[poly][1] - min_p[1]) * grid.inverse_cell_size[1]));
+      const int max_i = std::min (grid.nr_cells - 1, static_cast<int> ((boxes[poly][2] - min_p[0]) * grid.inverse_cell_size[0]));
+      const int max_j = std::min (grid.nr_cells - 1, static_cast<int> ((boxes[poly][3] - min_p[1]) * grid.inverse_cell_size[1]));
+      for (int j = min_j; j <= max_j; j++)
+        for (int i = min_i; i <= max_i; i++)
+        {
+          if (pass == 0)
+            grid.cell_starts[j * grid.nr_cells + i + 1]++;
+          else
+            grid.polygons[fill[j * grid.nr_cells + i]++] = static_cast<int> (poly);
+        }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::CropHull<PointT>::getCellPolygons (const PolygonGrid &grid, const PointT &point, int &begin, int &end)
+{
+  const Eigen::Vector3f p = point.getVector3fMap ();
+  const float u = grid.axis1.dot (p), w = grid.axis2.dot (p);
+  if (!pcl_isfinite (u) || !pcl_isfinite (w))
+    return (false);
+
+  // Points outside of the grid are in no polygon's box
+  begin = end = 0;
+  const float fi = (u - grid.min_p[0]) * grid.inverse_cell_size[0];
+  const float fj = (w - grid.min_p[1]) * grid.inverse_cell_size[1];
+  const float nr_cells = static_cast<float> (grid.nr_cells);
+  if (fi < 0 || fj < 0 || fi > nr_cells || fj > nr_cells)
+    return (true);
+  const int i = std::min (grid.nr_cells - 1, static_cast<int> (fi));
+  const int j = std::min (grid.nr_cells - 1, static_cast<int> (fj));
+  begin = grid.cell_starts[j * grid.nr_cells + i];
+  end = grid.cell_starts[j * grid.nr_cells + i + 1];
+  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
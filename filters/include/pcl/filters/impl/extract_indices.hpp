@@ -66,6 +66,27 @@ pcl::ExtractIndices<PointT>::filterDirectly (PointCloudPtr &cloud)
     cloud->is_dense = false;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ExtractIndices<PointT>::filterInPlace (PointCloudPtr &cloud)
+{
+  if (keep_organized_)
+  {
+    filterDirectly (cloud);
+    return;
+  }
+
+  this->setInputCloud (cloud);
+  if (!this->initCompute ())
+    return;
+
+  std::vector<int> indices;
+  applyFilterIndices (indices);
+  gatherPoints (indices, *cloud);
+
+  this->deinitCompute ();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::ExtractIndices<PointT>::applyFilter (PointCloud &output)
@@ -93,7 +114,7 @@ pcl::ExtractIndices<PointT>::applyFilter (PointCloud &output)
   else
   {
     applyFilterIndices (indices);
-    copyPointCloud (*input_, indices, output);
+    gatherPoints (indices, output);
   }
 }
 
@@ -112,41 +133,89 @@ pcl::ExtractIndices<PointT>::applyFilterIndices (std::vector<int> &indices)
   if (!negative_)  // Normal functionality
   {
     indices = *indices_;
+    if (!extract_removed_indices_)
+      return;
+    // A previous negative run shares removed_indices_ with indices_, which must not be overwritten
+    if (removed_indices_ == indices_)
+      removed_indices_.reset (new std::vector<int>);
+  }
 
-    if (extract_removed_indices_)
+  // Mark the points referenced by indices_ in a bitmask (out of range and duplicate indices are ignored)
+  const int nr_points = static_cast<int> (input_->points.size ());
+  std::vector<bool> selected (nr_points, false);
+  int nr_selected = 0;
+  for (size_t i = 0; i < indices_->size (); ++i)
+  {
+    const int idx = (*indices_)[i];
+    if (idx >= 0 && idx < nr_points && !selected[idx])
     {
-      // Set up the full indices set
-      std::vector<int> full_indices (input_->points.size ());
-      for (int fii = 0; fii < static_cast<int> (full_indices.size ()); ++fii)  // fii = full indices iterator
-        full_indices[fii] = fii;
-
-      // Set up the sorted input indices
-      std::vector<int> sorted_input_indices = *indices_;
-      std::sort (sorted_input_indices.begin (), sorted_input_indices.end ());
-
-      // Store the difference in removed_indices
-      removed_indices_->clear ();
-      set_difference (full_indices.begin (), full_indices.end (), sorted_input_indices.begin (), sorted_input_indices.end (), inserter (*removed_indices_, removed_indices_->begin ()));
+      selected[idx] = true;
+      ++nr_selected;
     }
   }
-  else  // Inverted functionality
-  {
-    // Set up the full indices set
-    std::vector<int> full_indices (input_->points.size ());
-    for (int fii = 0; fii < static_cast<int> (full_indices.size ()); ++fii)  // fii = full indices iterator
-      full_indices[fii] = fii;
 
-    // Set up the sorted input indices
-    std::vector<int> sorted_input_indices = *indices_;
-    std::sort (sorted_input_indices.begin (), sorted_input_indices.end ());
+  // The complement is the output in negative mode and the removed indices otherwise, in ascending order in both cases
+  std::vector<int> &complement = negative_ ? indices : *removed_indices_;
+  complement.resize (nr_points - nr_selected);
+  for (int i = 0, j = 0; i < nr_points; ++i)
+    if (!selected[i])
+      complement[j++] = i;
 
-    // Store the difference in indices
-    indices.clear ();
-    set_difference (full_indices.begin (), full_indices.end (), sorted_input_indices.begin (), sorted_input_indices.end (), inserter (indices, indices.begin ()));
+  if (negative_ && extract_removed_indices_)
+    removed_indices_ = indices_;
+}
 
-    if (extract_removed_indices_)
-      removed_indices_ = indices_;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ExtractIndices<PointT>::gatherPoints (const std::vector<int> &indices, PointCloud &output)
+{
+  const int nr_indices = static_cast<int> (indices.size ());
+  const bool is_dense = input_->is_dense;
+
+  if (&output == input_.get ())
+  {
+    // Points can be moved forward in place as long as no index refers to a slot that has already been overwritten
+    bool in_place = true;
+    for (int i = 0; i < nr_indices && in_place; ++i)
+      in_place = indices[i] >= i;
+
+    if (in_place)
+    {
+      for (int i = 0; i < nr_indices; ++i)
+        if (indices[i] != i)
+          output.points[i] = output.points[indices[i]];
+      output.points.resize (nr_indices);
+    }
+    else
+    {
+      PointCloud gathered;
+      gathered.points.resize (nr_indices);
+      for (int i = 0; i < nr_indices; ++i)
+        gathered.points[i] = output.points[indices[i]];
+      output.points.swap (gathered.points);
+    }
   }
+  else
+  {
+    output.points.resize (nr_indices);
+    // Random access into the input dominates, so request the points a few iterations ahead of the copy
+    const int prefetch_distance = 16;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (output) num_threads (threads_)
+#endif
+    for (int i = 0; i < nr_indices; ++i)
+    {
+#ifdef __GNUC__
+      if (i + prefetch_distance < nr_indices)
+        __builtin_prefetch (&input_->points[indices[i + prefetch_distance]]);
+#endif
+      output.points[i] = input_->points[indices[i]];
+    }
+  }
+
+  output.width    = static_cast<uint32_t> (nr_indices);
+  output.height   = 1;
+  output.is_dense = is_dense;
 }
 
 #define PCL_INSTANTIATE_ExtractIndices(T) template class PCL_EXPORTS pcl::ExtractIndices<T>;
@@ -0,0 +1,210 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_FILTER_PIPELINE_HPP_
+#define PCL_FILTERS_IMPL_FILTER_PIPELINE_HPP_
+
+#include <pcl/filters/filter_pipeline.h>
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::FilterPipeline<PointT>::applyFilter (PointCloud &output)
+{
+  PointCloudConstPtr cloud = input_;
+  std::vector<int> &indices = *indices_buffer_;
+  indices = *indices_;
+  // Whether indices holds all the points of cloud, in order
+  bool all_points = (indices.size () == cloud->points.size ());
+  for (size_t i = 0; all_points && i < indices.size (); ++i)
+    all_points = (indices[i] == static_cast<int> (i));
+
+  size_t stage = 0;
+  while (stage < stages_.size ())
+  {
+    const Stage &current = stages_[stage];
+    switch (current.type)
+    {
+      case STAGE_POINT_TEST:
+      case STAGE_POINT_TRANSFORM:
+      {
+        size_t last = stage + 1;
+        while (last < stages_.size () &&
+               (stages_[last].type == STAGE_POINT_TEST || stages_[last].type == STAGE_POINT_TRANSFORM))
+          ++last;
+        const size_t nr_points = indices.size ();
+        applyPointStages (stage, last, cloud, indices);
+        if (indices.size () != nr_points)
+          all_points = false;
+        stage = last;
+        break;
+      }
+      case STAGE_FILTER_INDICES:
+      {
+        // Neighbors must only be searched among the surviving points
+        if (current.searches_input && !all_points)
+        {
+          compactPoints (cloud, indices);
+          all_points = true;
+        }
+        current.filter_indices->setInputCloud (cloud);
+        current.filter_indices->setIndices (indices_buffer_);
+        current.filter_indices->filter (filtered_indices_);
+        if (filtered_indices_.size () != indices.size ())
+          all_points = false;
+        indices.swap (filtered_indices_);
+        ++stage;
+        break;
+      }
+      case STAGE_FILTER:
+      {
+        // The filter needs a cloud of its own: copy the surviving points unless they are all there
+        if (!all_points)
+          compactPoints (cloud, indices);
+        PointCloudPtr filtered = getFreeCloud (cloud);
+        current.filter->setInputCloud (cloud);
+        current.filter->setIndices (indices_buffer_);
+        current.filter->filter (*filtered);
+        cloud = filtered;
+        indices.resize (cloud->points.size ());
+        for (size_t i = 0; i < indices.size (); ++i)
+          indices[i] = static_cast<int> (i);
+        all_points = true;
+        ++stage;
+        break;
+      }
+    }
+  }
+
+  if (all_points)
+  {
+    if (cloud.get () != &output)
+      output = *cloud;
+  }
+  else
+    copyPoints (*cloud, indices, output);
+  output.header = input_->header;
+  output.sensor_origin_ = input_->sensor_origin_;
+  output.sensor_orientation_ = input_->sensor_orientation_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::FilterPipeline<PointT>::applyPointStages (size_t first, size_t last,
+                                               PointCloudConstPtr &cloud, std::vector<int> &indices)
+{
+  bool transform = false;
+  for (size_t stage = first; stage < last; ++stage)
+    transform = transform || (stages_[stage].type == STAGE_POINT_TRANSFORM);
+
+  // Only tests: compact the indices in place
+  if (!transform)
+  {
+    size_t nr_kept = 0;
+    for (size_t i = 0; i < indices.size (); ++i)
+    {
+      const PointT &point = cloud->points[indices[i]];
+      bool keep = true;
+      for (size_t stage = first; keep && stage < last; ++stage)
+        keep = stages_[stage].test (point);
+      if (keep)
+        indices[nr_kept++] = indices[i];
+    }
+    indices.resize (nr_kept);
+    return;
+  }
+
+  // Transforms: write the surviving transformed points into a new cloud
+  PointCloudPtr transformed = getFreeCloud (cloud);
+  transformed->points.resize (indices.size ());
+  size_t nr_kept = 0;
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    PointT &point = transformed->points[nr_kept];
+    point = cloud->points[indices[i]];
+    bool keep = true;
+    for (size_t stage = first; keep && stage < last; ++stage)
+    {
+      if (stages_[stage].type == STAGE_POINT_TEST)
+        keep = stages_[stage].test (point);
+      else
+        stages_[stage].transform (point);
+    }
+    if (keep)
+      ++nr_kept;
+  }
+  transformed->points.resize (nr_kept);
+  transformed->width = static_cast<uint32_t> (nr_kept);
+  transformed->height = 1;
+  transformed->is_dense = cloud->is_dense;
+  transformed->header = cloud->header;
+  cloud = transformed;
+
+  indices.resize (nr_kept);
+  for (size_t i = 0; i < nr_kept; ++i)
+    indices[i] = static_cast<int> (i);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::FilterPipeline<PointT>::compactPoints (PointCloudConstPtr &cloud, std::vector<int> &indices)
+{
+  PointCloudPtr copy = getFreeCloud (cloud);
+  copyPoints (*cloud, indices, *copy);
+  cloud = copy;
+  indices.resize (cloud->points.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    indices[i] = static_cast<int> (i);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::FilterPipeline<PointT>::copyPoints (const PointCloud &cloud, const std::vector<int> &indices, PointCloud &output)
+{
+  output.points.resize (indices.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    output.points[i] = cloud.points[indices[i]];
+  output.header = cloud.header;
+  output.width = static_cast<uint32_t> (indices.size ());
+  output.height = 1;
+  output.is_dense = cloud.is_dense;
+}
+
+#define PCL_INSTANTIATE_FilterPipeline(T) template class PCL_EXPORTS pcl::FilterPipeline<T>;
+
+#endif  // PCL_FILTERS_IMPL_FILTER_PIPELINE_HPP_
@@ -40,8 +40,10 @@
 
 #include <pcl/filters/normal_space.h>
 
+#include <pcl/common/io.h>
+#include <pcl/common/utils.h>
+#include <boost/random.hpp>
 #include <vector>
-#include <list>
 
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename NormalT> void
@@ -55,165 +57,23 @@ pcl::NormalSpaceSampling<PointT, NormalT>::applyFilter (PointCloud &output)
     return;
   }
 
-  // Resize output cloud to sample size
-  output.points.resize (sample_);
-  output.width = sample_;
-  output.height = 1;
-  
-  // allocate memory for the histogram of normals.. Normals will then be sampled from each bin..
-  unsigned int n_bins = binsx_ * binsy_ * binsz_;
-  // list<int> holds the indices of points in that bin.. Using list to avoid repeated resizing of vectors.. Helps when the point cloud is
-  // large..
-  std::vector< std::list <int> > normals_hg;
-  normals_hg.reserve (n_bins);
-  for (unsigned int i = 0; i < n_bins; i++) 
-    normals_hg.push_back (std::list<int> ());
-  
-  for (unsigned int i = 0; i < input_normals_->points.size (); i++)
-  {
-    unsigned int bin_number = findBin (input_normals_->points[i].normal, n_bins);
-    normals_hg[bin_number].push_back (i);
-  }
-
-  // Setting up random access for the list created above.. Maintaining the iterators to individual elements of the list in a vector.. Using
-  // vector now as the size of the list is known..
-  std::vector< std::vector <std::list<int>::iterator> > random_access (normals_hg.size ());
-  for (unsigned int i = 0; i < normals_hg.size (); i++)
-  {
-    random_access.push_back (std::vector< std::list<int>::iterator> ());
-    random_access[i].resize (normals_hg[i].size ());
-
-    unsigned int j=0;
-    for (std::list<int>::iterator itr = normals_hg[i].begin (); itr != normals_hg[i].end (); itr++, j++)
-    {
-      random_access[i][j] = itr;
-    }
-  }
-  unsigned int* start_index = new unsigned int[normals_hg.size ()];
-  start_index[0] = 0;
-  unsigned int prev_index = start_index[0];
-  for (unsigned int i = 1; i < normals_hg.size (); i++)
-  {
-    start_index[i] = prev_index + static_cast<unsigned int> (normals_hg[i-1].size ());
-    prev_index = start_index[i];
-  }
-
-  // maintaining flags to check if a point is sampled
-  boost::dynamic_bitset<> is_sampled_flag (input_normals_->points.size ());
-  // maintaining flags to check if all points in the bin are sampled 
-  boost::dynamic_bitset<> bin_empty_flag (normals_hg.size ());
-  unsigned int i = 0;
-  while (i < sample_)
-  {
-    // iterating through every bin and picking one point at random, until the required number of points are sampled..
-    for (unsigned int j = 0; j < normals_hg.size (); j++)
-    {
-      unsigned int M = static_cast<unsigned int> (normals_hg[j].size ());
-      if (M == 0 || bin_empty_flag.test (j))// bin_empty_flag(i) is set if all points in that bin are sampled..
-      {
-        continue;
-      }
-  
-      unsigned int pos = 0;
-      unsigned int random_index = 0;
-      //picking up a sample at random from jth bin
-      do
-      {
-        random_index = std::rand () % M;
-        pos = start_index[j] + random_index;
-      } while (is_sampled_flag.test (pos));
-
-      is_sampled_flag.flip (start_index[j] + random_index);
-
-      // checking if all points in bin j are sampled..
-      if (isEntireBinSampled (is_sampled_flag, start_index[j], static_cast<unsigned int> (normals_hg[j].size ())))
-      {
-        bin_empty_flag.flip (j);
-      }
-
-      unsigned int index = *(random_access[j][random_index]);
-      output.points[i] = input_->points[index];
-      i++;
-      if (i == sample_)
-      {
-        break;
-      }
-    }
-  }
-  delete[] start_index;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename NormalT> bool 
-pcl::NormalSpaceSampling<PointT, NormalT>::isEntireBinSampled (boost::dynamic_bitset<> &array, unsigned int start_index, unsigned int length)
-{
-  bool status = true;
-  for (unsigned int i = start_index; i < start_index + length; i++)
-  {
-    status = status & array.test (i);
-  }
-  return status;
+  std::vector<int> indices;
+  applyFilter (indices);
+  copyPointCloud (*input_, indices, output);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename NormalT> unsigned int 
-pcl::NormalSpaceSampling<PointT, NormalT>::findBin (float *normal, unsigned int)
+pcl::NormalSpaceSampling<PointT, NormalT>::findBin (const float *normal) const
 {
-  unsigned int bin_number = 0;
-  // holds the bin numbers for direction cosines in x,y,z directions
-  unsigned int t[3] = {0,0,0};
-  
-  // dcos is the direction cosine.
-  float dcos = 0.0;
-  float bin_size = 0.0;
-  // max_cos and min_cos are the maximum and minimum values of cos(theta) respectively
-  float max_cos = 1.0;
-  float min_cos = -1.0;
-
-  dcos = cosf (normal[0]);
-  bin_size = (max_cos - min_cos) / static_cast<float> (binsx_);
-
-  // finding bin number for direction cosine in x direction
-  unsigned int k = 0;
-  for (float i = min_cos; (i + bin_size) < (max_cos - bin_size); i += bin_size , k++)
-  {
-    if (dcos >= i && dcos <= (i+bin_size))
-    {
-      break;
-    }
-  }
-  t[0] = k;
-
-  dcos = cosf (normal[1]);
-  bin_size = (max_cos - min_cos) / static_cast<float> (binsy_);
-
-  // finding bin number for direction cosine in y direction
-  k = 0;
-  for (float i = min_cos; (i + bin_size) < (max_cos - bin_size); i += bin_size , k++)
-  {
-    if (dcos >= i && dcos <= (i+bin_size))
-    {
-      break;
-    }
-  }
-  t[1] = k;
-    
-  dcos = cosf (normal[2]);
-  bin_size = (max_cos - min_cos) / static_cast<float> (binsz_);
-
-  // finding bin number for direction cosine in z direction
-  k = 0;
-  for (float i = min_cos; (i + bin_size) < (max_cos - bin_size); i += bin_size , k++)
-  {
-    if (dcos >= i && dcos <= (i+bin_size))
-    {
-      break;
-    }
-  }
-  t[2] = k;
-
-  bin_number = t[0] * (binsy_*binsz_) + t[1] * binsz_ + t[2];
-  return bin_number;
+  if (!pcl_isfinite (normal[0]) || !pcl_isfinite (normal[1]) || !pcl_isfinite (normal[2]))
+    return (binsx_ * binsy_ * binsz_);
+
+  // The components of a unit normal are its direction cosines
+  const unsigned int tx = findAxisBin (normal[0], binsx_);
+  const unsigned int ty = findAxisBin (normal[1], binsy_);
+  const unsigned int tz = findAxisBin (normal[2], binsz_);
+  return (tx * (binsy_ * binsz_) + ty * binsz_ + tz);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -221,99 +81,93 @@ template<typename PointT, typename NormalT>
 void
 pcl::NormalSpaceSampling<PointT, NormalT>::applyFilter (std::vector<int> &indices)
 {
+  if (!input_normals_ || input_normals_->points.size () != input_->points.size ())
+  {
+    PCL_ERROR ("[pcl::%s::applyFilter] The number of normals differs from the number of points!\n", getClassName ().c_str ());
+    indices.clear ();
+    return;
+  }
+
   // If sample size is 0 or if the sample size is greater then input cloud size
   //   then return all indices
-  if (sample_ >= input_->width * input_->height)
+  if (sample_ >= indices_->size ())
   {
     indices = *indices_;
     return;
   }
 
-  // Resize output indices to sample size
-  indices.resize (sample_);
-  
-  // allocate memory for the histogram of normals.. Normals will then be sampled from each bin..
-  unsigned int n_bins = binsx_ * binsy_ * binsz_;
-  // list<int> holds the indices of points in that bin.. Using list to avoid repeated resizing of vectors.. Helps when the point cloud is
-  // large..
-  std::vector< std::list <int> > normals_hg;
-  normals_hg.reserve (n_bins);
-  for (unsigned int i = 0; i < n_bins; i++)
-    normals_hg.push_back (std::list<int> ());
-  
-  for (unsigned int i=0; i < input_normals_->points.size (); i++)
+  const unsigned int n_bins = binsx_ * binsy_ * binsz_;
+  const int nr_points = static_cast<int> (indices_->size ());
+
+  // Bin of every point, the points with invalid normals go to an extra bin which is never sampled
+  std::vector<unsigned int> point_bins (nr_points);
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for num_threads(threads_)
+#endif
+  for (int i = 0; i < nr_points; ++i)
+    point_bins[i] = findBin (input_normals_->points[(*indices_)[i]].normal);
+
+  // Counting sort of the indices by bin
+  std::vector<unsigned int> bin_start (n_bins + 2, 0);
+  for (int i = 0; i < nr_points; ++i)
+    ++bin_start[point_bins[i] + 1];
+  for (unsigned int b = 0; b <= n_bins; ++b)
+    bin_start[b + 1] += bin_start[b];
+  std::vector<int> binned (nr_points);
   {
-    unsigned int bin_number = findBin (input_normals_->points[i].normal, n_bins);
-    normals_hg[bin_number].push_back (i);
+    std::vector<unsigned int> next (bin_start.begin (), bin_start.end () - 1);
+    for (int i = 0; i < nr_points; ++i)
+      binned[next[point_bins[i]]++] = (*indices_)[i];
   }
 
-  // Setting up random access for the list created above.. Maintaining the iterators to individual elements of the list in a vector.. Using
-  // vector now as the size of the list is known..
-  std::vector< std::vector <std::list<int>::iterator> > random_access (normals_hg.size ());
-  for (unsigned int i = 0; i < normals_hg.size (); i++)
+  // The bins are visited in turn, each giving one point, until enough points are drawn: this only depends on the
+  // bin sizes, so the bin of every sample can be decided before drawing the points themselves
+  const unsigned int nr_valid = bin_start[n_bins];
+  const unsigned int nr_samples = std::min (sample_, nr_valid);
+  std::vector<unsigned int> sample_bins (nr_samples);
+  std::vector<unsigned int> bin_samples (n_bins, 0);
+  std::vector<unsigned int> active_bins;
+  for (unsigned int b = 0; b < n_bins; ++b)
+    if (bin_start[b + 1] > bin_start[b])
+      active_bins.push_back (b);
+  for (unsigned int s = 0; s < nr_samples; )
   {
-    random_access.push_back (std::vector<std::list<int>::iterator> ());
-    random_access[i].resize (normals_hg[i].size ());
-
-    unsigned int j = 0;
-    for (std::list<int>::iterator itr = normals_hg[i].begin (); itr != normals_hg[i].end (); itr++, j++)
+    size_t nr_active = 0;
+    for (size_t a = 0; a < active_bins.size () && s < nr_samples; ++a)
     {
-      random_access[i][j] = itr;
+      const unsigned int b = active_bins[a];
+      sample_bins[s++] = b;
+      if (++bin_samples[b] < bin_start[b + 1] - bin_start[b])
+        active_bins[nr_active++] = b;
     }
-  }
-  unsigned int* start_index = new unsigned int[normals_hg.size ()];
-  start_index[0] = 0;
-  unsigned int prev_index = start_index[0];
-  for (unsigned int i = 1; i < normals_hg.size (); i++)
-  {
-    start_index[i] = prev_index + static_cast<unsigned int> (normals_hg[i-1].size ());
-    prev_index = start_index[i];
+    active_bins.resize (nr_active);
   }
 
-  // maintaining flags to check if a point is sampled
-  boost::dynamic_bitset<> is_sampled_flag (input_normals_->points.size ());
-  // maintaining flags to check if all points in the bin are sampled 
-  boost::dynamic_bitset<> bin_empty_flag (normals_hg.size ());
-  unsigned int i=0;
-  while (i < sample_)
+  // Draw the points of every bin: a partial Fisher-Yates shuffle moves them to the front of the bin
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic, 16) num_threads(threads_)
+#endif
+  for (int b = 0; b < static_cast<int> (n_bins); ++b)
   {
-    // iterating through every bin and picking one point at random, until the required number of points are sampled..
-    for (unsigned int j = 0; j < normals_hg.size (); j++)
+    const unsigned int size = bin_start[b + 1] - bin_start[b];
+    if (bin_samples[b] == 0 || bin_samples[b] == size)
+      continue;
+    int *bin = &binned[bin_start[b]];
+    boost::mt19937 rng (pcl::utils::mixSeed (seed_, static_cast<unsigned int> (b)));
+    for (unsigned int k = 0; k < bin_samples[b]; ++k)
     {
-      unsigned int M = static_cast<unsigned int> (normals_hg[j].size ());
-      if (M==0 || bin_empty_flag.test (j)) // bin_empty_flag(i) is set if all points in that bin are sampled..
-      {
-        continue;
-      }
-
-      unsigned int pos = 0;
-      unsigned int random_index = 0;
-
-      //picking up a sample at random from jth bin
-      do
-      {
-        random_index = std::rand () % M;
-        pos = start_index[j] + random_index;
-      } while (is_sampled_flag.test (pos));
-
-      is_sampled_flag.flip (start_index[j] + random_index);
-
-      // checking if all points in bin j are sampled..
-      if (isEntireBinSampled (is_sampled_flag, start_index[j], static_cast<unsigned int> (normals_hg[j].size ()))) 
-      {
-	bin_empty_flag.flip (j);
-      }
-
-      unsigned int index = *(random_access[j][random_index]);
-      indices[i] = index;
-      i++;
-      if (i == sample_)
-      {
-        break;
-      }
+      boost::uniform_int<unsigned int> distribution (k, size - 1);
+      std::swap (bin[k], bin[distribution (rng)]);
     }
   }
-  delete[] start_index;
+
+  indices.resize (nr_samples);
+  std::fill (bin_samples.begin (), bin_samples.end (), 0);
+  for (unsigned int s = 0; s < nr_samples; ++s)
+  {
+    const unsigned int b = sample_bins[s];
+    indices[s] = binned[bin_start[b] + bin_samples[b]++];
+  }
 }
 
 #define PCL_INSTANTIATE_NormalSpaceSampling(T,NT) template class PCL_EXPORTS pcl::NormalSpaceSampling<T,NT>;
@@ -42,6 +42,7 @@
 
 #include <pcl/filters/radius_outlier_removal.h>
 #include <pcl/common/io.h>
+#include <pcl/filters/neighbor_grid.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -80,28 +81,19 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices
     return;
   }
 
-  // Initialize the search class
-  if (!searcher_)
-  {
-    if (input_->isOrganized ())
-      searcher_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
-    else
-      searcher_.reset (new pcl::search::KdTree<PointT> (false));
-  }
-  searcher_->setInputCloud (input_);
+  // Count the neighbors of all the points
+  std::vector<int> counts (indices_->size ());
+  countNeighbors (counts);
 
   // The arrays to be used
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
   indices.resize (indices_->size ());
   removed_indices_->resize (indices_->size ());
   int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
 
   for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
   {
-    // Perform the radius search
     // Note: k includes the query point, so is always at least 1
-    int k = searcher_->radiusSearch ((*indices_)[iii], search_radius_, nn_indices, nn_dists);
+    int k = counts[iii];
 
     // Points having too few neighbors are outliers and are passed to removed indices
     // Unless negative was set, then it's the opposite condition
@@ -121,6 +113,90 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices
   removed_indices_->resize (rii);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RadiusOutlierRemoval<PointT>::initSearch ()
+{
+  // Initialize the search class
+  if (!searcher_)
+  {
+    if (input_->isOrganized ())
+      searcher_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+    else
+      searcher_.reset (new pcl::search::KdTree<PointT> (false));
+  }
+  searcher_->setInputCloud (input_);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RadiusOutlierRemoval<PointT>::countNeighbors (std::vector<int> &counts)
+{
+  if (search_mode_ == SEARCH_MODE_GRID && countNeighborsGrid (counts, 1))
+    return;
+  initSearch ();
+
+  // Only the neighbor count matters, and only up to min_pts_radius_ + 1
+  unsigned int max_count = min_pts_radius_ >= 0 ? static_cast<unsigned int> (min_pts_radius_) + 1 : 0;
+
+  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+    counts[iii] = searcher_->radiusSearchCount ((*indices_)[iii], search_radius_, max_count);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::RadiusOutlierRemoval<PointT>::countNeighborsGrid (std::vector<int> &counts, unsigned int nr_threads)
+{
+  NeighborGrid<PointT> grid;
+  if (!grid.setInputCloud (*input_, static_cast<float> (search_radius_)))
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] The radius %f is too small for the grid search, using the tree search instead.\n", getClassName ().c_str (), search_radius_);
+    return (false);
+  }
+  const std::vector<int> &grid_indices = grid.getIndices ();
+  const float sqr_radius = static_cast<float> (search_radius_ * search_radius_);
+
+  // Only the neighbor count matters, and only up to min_pts_radius_ + 1
+  unsigned int max_count = min_pts_radius_ >= 0 ? static_cast<unsigned int> (min_pts_radius_) + 1 : 0;
+
+  // Group the query points by cell, so that the neighboring cells are only looked up once per cell
+  std::vector<std::pair<uint64_t, int> > queries;
+  queries.reserve (indices_->size ());
+  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+  {
+    counts[iii] = 0;
+    if (isFinite (input_->points[(*indices_)[iii]]))
+      queries.push_back (std::make_pair (grid.getCellKey (input_->points[(*indices_)[iii]]), iii));
+  }
+  std::sort (queries.begin (), queries.end ());
+
+  std::vector<int> query_cells;
+  for (int q = 0; q < static_cast<int> (queries.size ()); ++q)
+    if (q == 0 || queries[q].first != queries[q - 1].first)
+      query_cells.push_back (q);
+  query_cells.push_back (static_cast<int> (queries.size ()));
+
+#pragma omp parallel for schedule (dynamic, 64) num_threads (nr_threads)
+  for (int qc = 0; qc < static_cast<int> (query_cells.size ()) - 1; ++qc)
+  {
+    std::vector<typename NeighborGrid<PointT>::CellRange> ranges;
+    grid.getNeighborCells (queries[query_cells[qc]].first, ranges);
+
+    for (int q = query_cells[qc]; q < query_cells[qc + 1]; ++q)
+    {
+      const PointT &query = input_->points[(*indices_)[queries[q].second]];
+      unsigned int count = 0;
+      for (size_t r = 0; r < ranges.size () && count != max_count; ++r)
+        for (int i = ranges[r].first; i < ranges[r].second; ++i)
+          if ((input_->points[grid_indices[i]].getVector3fMap () - query.getVector3fMap ()).squaredNorm () <= sqr_radius &&
+              ++count == max_count)  // never true if max_count = 0
+            break;
+      counts[queries[q].second] = static_cast<int> (count);
+    }
+  }
+  return (true);
+}
+
 #define PCL_INSTANTIATE_RadiusOutlierRemoval(T) template class PCL_EXPORTS pcl::RadiusOutlierRemoval<T>;
 
 #endif  // PCL_FILTERS_IMPL_RADIUS_OUTLIER_REMOVAL_H_
@@ -0,0 +1,63 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_RADIUS_OUTLIER_REMOVAL_OMP_H_
+#define PCL_FILTERS_IMPL_RADIUS_OUTLIER_REMOVAL_OMP_H_
+
+#include <pcl/filters/radius_outlier_removal_omp.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RadiusOutlierRemovalOMP<PointT>::countNeighbors (std::vector<int> &counts)
+{
+  if (search_mode_ == RadiusOutlierRemoval<PointT>::SEARCH_MODE_GRID && this->countNeighborsGrid (counts, threads_))
+    return;
+  this->initSearch ();
+
+  // Only the neighbor count matters, and only up to min_pts_radius_ + 1
+  unsigned int max_count = min_pts_radius_ >= 0 ? static_cast<unsigned int> (min_pts_radius_) + 1 : 0;
+
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+    counts[iii] = searcher_->radiusSearchCount ((*indices_)[iii], search_radius_, max_count);
+}
+
+#define PCL_INSTANTIATE_RadiusOutlierRemovalOMP(T) template class PCL_EXPORTS pcl::RadiusOutlierRemovalOMP<T>;
+
+#endif  // PCL_FILTERS_IMPL_RADIUS_OUTLIER_REMOVAL_OMP_H_
@@ -42,6 +42,7 @@
 
 #include <pcl/filters/statistical_outlier_removal.h>
 #include <pcl/common/io.h>
+#include <pcl/filters/neighbor_grid.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -72,50 +73,15 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilter (PointCloud &output)
 template <typename PointT> void
 pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices)
 {
-  // Initialize the search class
-  if (!searcher_)
-  {
-    if (input_->isOrganized ())
-      searcher_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
-    else
-      searcher_.reset (new pcl::search::KdTree<PointT> (false));
-  }
-  searcher_->setInputCloud (input_);
+  // First pass: Compute the mean distances for all points with respect to their k nearest neighbors
+  std::vector<float> distances (indices_->size ());
+  computeMeanDistances (distances);
 
   // The arrays to be used
-  std::vector<int> nn_indices (mean_k_);
-  std::vector<float> nn_dists (mean_k_);
-  std::vector<float> distances (indices_->size ());
   indices.resize (indices_->size ());
   removed_indices_->resize (indices_->size ());
   int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
 
-  // First pass: Compute the mean distances for all points with respect to their k nearest neighbors
-  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
-  {
-    if (!pcl_isfinite (input_->points[(*indices_)[iii]].x) ||
-        !pcl_isfinite (input_->points[(*indices_)[iii]].y) ||
-        !pcl_isfinite (input_->points[(*indices_)[iii]].z))
-    {
-      distances[iii] = 0.0;
-      continue;
-    }
-
-    // Perform the nearest k search
-    if (searcher_->nearestKSearch ((*indices_)[iii], mean_k_ + 1, nn_indices, nn_dists) == 0)
-    {
-      distances[iii] = 0.0;
-      PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
-      continue;
-    }
-
-    // Calculate the mean distance to its neighbors
-    double dist_sum = 0.0;
-    for (int k = 1; k < mean_k_ + 1; ++k)  // k = 0 is the query point
-      dist_sum += sqrt (nn_dists[k]);
-    distances[iii] = static_cast<float> (dist_sum / mean_k_);
-  }
-
   // Estimate the mean and the standard deviation of the distance vector
   double mean, stddev;
   getMeanStd (distances, mean, stddev);
@@ -142,6 +108,109 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &in
   removed_indices_->resize (rii);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalOutlierRemoval<PointT>::initSearch ()
+{
+  // Initialize the search class
+  if (!searcher_)
+  {
+    if (input_->isOrganized ())
+      searcher_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+    else
+      searcher_.reset (new pcl::search::KdTree<PointT> (false));
+  }
+  searcher_->setInputCloud (input_);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalOutlierRemoval<PointT>::computeMeanDistances (std::vector<float> &distances)
+{
+  if (search_mode_ == SEARCH_MODE_GRID && computeMeanDistancesGrid (distances, 1))
+    return;
+  initSearch ();
+
+  // The arrays to be used
+  std::vector<int> nn_indices (mean_k_);
+  std::vector<float> nn_dists (mean_k_);
+
+  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+    distances[iii] = computeMeanDistance (iii, nn_indices, nn_dists);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> float
+pcl::StatisticalOutlierRemoval<PointT>::computeMeanDistance (
+    int iii, std::vector<int> &nn_indices, std::vector<float> &nn_dists)
+{
+  if (!pcl_isfinite (input_->points[(*indices_)[iii]].x) ||
+      !pcl_isfinite (input_->points[(*indices_)[iii]].y) ||
+      !pcl_isfinite (input_->points[(*indices_)[iii]].z))
+    return (0.0f);
+
+  // Perform the nearest k search
+  if (searcher_->nearestKSearch ((*indices_)[iii], mean_k_ + 1, nn_indices, nn_dists) == 0)
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
+    return (0.0f);
+  }
+
+  // Calculate the mean distance to its neighbors
+  double dist_sum = 0.0;
+  for (int k = 1; k < mean_k_ + 1; ++k)  // k = 0 is the query point
+    dist_sum += sqrt (nn_dists[k]);
+  return (static_cast<float> (dist_sum / mean_k_));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::StatisticalOutlierRemoval<PointT>::computeMeanDistancesGrid (std::vector<float> &distances, unsigned int nr_threads)
+{
+  NeighborGrid<PointT> grid;
+  if (grid_leaf_size_ <= 0.0 || !grid.setInputCloud (*input_, static_cast<float> (grid_leaf_size_)))
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] Invalid grid leaf size %f, using the tree search instead.\n", getClassName ().c_str (), grid_leaf_size_);
+    return (false);
+  }
+
+  // Group the query points by cell, as all points of a cell get the same estimate
+  std::vector<std::pair<uint64_t, int> > queries;
+  queries.reserve (indices_->size ());
+  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+  {
+    distances[iii] = 0.0f;
+    if (isFinite (input_->points[(*indices_)[iii]]))
+      queries.push_back (std::make_pair (grid.getCellKey (input_->points[(*indices_)[iii]]), iii));
+  }
+  std::sort (queries.begin (), queries.end ());
+
+  std::vector<int> query_cells;
+  for (int q = 0; q < static_cast<int> (queries.size ()); ++q)
+    if (q == 0 || queries[q].first != queries[q - 1].first)
+      query_cells.push_back (q);
+  query_cells.push_back (static_cast<int> (queries.size ()));
+
+  // n points spread over the 27 cells around a point are on average cbrt (27 * leaf^3 / n) apart
+  const float block_size = 3.0f * static_cast<float> (grid_leaf_size_);
+
+#pragma omp parallel for schedule (dynamic, 64) num_threads (nr_threads)
+  for (int qc = 0; qc < static_cast<int> (query_cells.size ()) - 1; ++qc)
+  {
+    std::vector<typename NeighborGrid<PointT>::CellRange> ranges;
+    grid.getNeighborCells (queries[query_cells[qc]].first, ranges);
+
+    int occupancy = 0;
+    for (size_t r = 0; r < ranges.size (); ++r)
+      occupancy += ranges[r].second - ranges[r].first;
+    float distance = block_size / powf (static_cast<float> (occupancy), 1.0f / 3.0f);  // occupancy >= 1, the cell itself is occupied
+
+    for (int q = query_cells[qc]; q < query_cells[qc + 1]; ++q)
+      distances[queries[q].second] = distance;
+  }
+  return (true);
+}
+
 #define PCL_INSTANTIATE_StatisticalOutlierRemoval(T) template class PCL_EXPORTS pcl::StatisticalOutlierRemoval<T>;
 
 #endif  // PCL_FILTERS_IMPL_STATISTICAL_OUTLIER_REMOVAL_H_
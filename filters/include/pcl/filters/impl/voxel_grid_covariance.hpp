@@ -108,29 +108,39 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
     centroid_size += 3;
   }
 
-  // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
+  // Get the distance field index, if we don't want to process the entire cloud, but rather filter points far away
+  // from the viewpoint first
+  int distance_offset = -1;
   if (!filter_field_name_.empty ())
   {
-    // Get the distance field index
     std::vector<sensor_msgs::PointField> fields;
     int distance_idx = pcl::getFieldIndex (*input_, filter_field_name_, fields);
     if (distance_idx == -1)
       PCL_WARN ("[pcl::%s::applyFilter] Invalid filter field name. Index is %d.\n", getClassName ().c_str (), distance_idx);
+    else
+      distance_offset = fields[distance_idx].offset;
+  }
 
-    // First pass: go over all points and insert them into the right leaf
-    for (size_t cp = 0; cp < input_->points.size (); ++cp)
-    {
-      if (!input_->is_dense)
-        // Check if the point is invalid
-        if (!pcl_isfinite (input_->points[cp].x) ||
-            !pcl_isfinite (input_->points[cp].y) ||
-            !pcl_isfinite (input_->points[cp].z))
-          continue;
+  // First pass: compute the leaf index of every point in parallel, -1 for the points that are filtered out
+  const int nr_points = static_cast<int> (input_->points.size ());
+  std::vector<int> point_leaves (nr_points);
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for num_threads(threads_)
+#endif
+  for (int cp = 0; cp < nr_points; ++cp)
+  {
+    const PointT &point = input_->points[cp];
+    point_leaves[cp] = -1;
+    if (!input_->is_dense)
+      // Check if the point is invalid
+      if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+        continue;
 
+    if (distance_offset >= 0)
+    {
       // Get the distance value
-      const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&input_->points[cp]);
       float distance_value = 0;
-      memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
+      memcpy (&distance_value, reinterpret_cast<const uint8_t*> (&point) + distance_offset, sizeof (float));
 
       if (filter_limit_negative_)
       {
@@ -144,82 +154,87 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
         if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_))
           continue;
       }
+    }
 
-      int ijk0 = static_cast<int> (floor (input_->points[cp].x * inverse_leaf_size_[0]) - min_b_[0]);
-      int ijk1 = static_cast<int> (floor (input_->points[cp].y * inverse_leaf_size_[1]) - min_b_[1]);
-      int ijk2 = static_cast<int> (floor (input_->points[cp].z * inverse_leaf_size_[2]) - min_b_[2]);
-
-      // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-
-      Leaf& leaf = leaves_[idx];
-      if (leaf.nr_points == 0)
-      {
-        leaf.centroid.resize (centroid_size);
-        leaf.centroid.setZero ();
-      }
+    int ijk0 = static_cast<int> (floor (point.x * inverse_leaf_size_[0]) - min_b_[0]);
+    int ijk1 = static_cast<int> (floor (point.y * inverse_leaf_size_[1]) - min_b_[1]);
+    int ijk2 = static_cast<int> (floor (point.z * inverse_leaf_size_[2]) - min_b_[2]);
 
-      Eigen::Vector3d pt3d (input_->points[cp].x, input_->points[cp].y, input_->points[cp].z);
-      // Accumulate point sum for centroid calculation
-      leaf.mean_ += pt3d;
-      // Accumulate x*xT for single pass covariance calculation
-      leaf.cov_ += pt3d * pt3d.transpose ();
+    // Compute the centroid leaf index
+    point_leaves[cp] = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+  }
 
-      // Do we need to process all the fields?
-      if (!downsample_all_data_)
-      {
-        Eigen::Vector4f pt (input_->points[cp].x, input_->points[cp].y, input_->points[cp].z, 0);
-        leaf.centroid.template head<4> () += pt;
-      }
-      else
+  // Number the leaves in the order of their first point, and insert them in that order so that the leaves, and
+  // therefore the output, are in the same order as when the points are inserted one by one. Consecutive points
+  // usually fall in the same leaf, which saves most of the lookups.
+  std::vector<int> point_ids (nr_points, -1);
+  std::vector<size_t> leaf_indices;
+  std::vector<int> leaf_sizes;
+  {
+    boost::unordered_map<size_t, int> ids;
+    int last_leaf = -1, last_id = -1;
+    for (int cp = 0; cp < nr_points; ++cp)
+    {
+      if (point_leaves[cp] < 0)
+        continue;
+      if (point_leaves[cp] != last_leaf)
       {
-        // Copy all the fields
-        Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
-        // ---[ RGB special case
-        if (rgba_index >= 0)
+        last_leaf = point_leaves[cp];
+        std::pair<typename boost::unordered_map<size_t, int>::iterator, bool> inserted =
+          ids.insert (std::make_pair (static_cast<size_t> (last_leaf), static_cast<int> (leaf_indices.size ())));
+        if (inserted.second)
         {
-          // fill r/g/b data
-          int rgb;
-          memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[cp]) + rgba_index, sizeof (int));
-          centroid[centroid_size - 3] = static_cast<float> ((rgb >> 16) & 0x0000ff);
-          centroid[centroid_size - 2] = static_cast<float> ((rgb >> 8) & 0x0000ff);
-          centroid[centroid_size - 1] = static_cast<float> ((rgb) & 0x0000ff);
+          leaf_indices.push_back (last_leaf);
+          leaf_sizes.push_back (0);
         }
-        pcl::for_each_type<FieldList> (NdCopyPointEigenFunctor<PointT> (input_->points[cp], centroid));
-        leaf.centroid += centroid;
+        last_id = inserted.first->second;
       }
-      ++leaf.nr_points;
+      point_ids[cp] = last_id;
+      ++leaf_sizes[last_id];
     }
   }
-  // No distance filtering, process all data
-  else
+  const int nr_leaves = static_cast<int> (leaf_indices.size ());
+  std::vector<Leaf*> leaf_ptrs (nr_leaves);
+  for (int id = 0; id < nr_leaves; ++id)
   {
-    // First pass: go over all points and insert them into the right leaf
-    for (size_t cp = 0; cp < input_->points.size (); ++cp)
-    {
-      if (!input_->is_dense)
-        // Check if the point is invalid
-        if (!pcl_isfinite (input_->points[cp].x) ||
-            !pcl_isfinite (input_->points[cp].y) ||
-            !pcl_isfinite (input_->points[cp].z))
-          continue;
-
-      int ijk0 = static_cast<int> (floor (input_->points[cp].x * inverse_leaf_size_[0]) - min_b_[0]);
-      int ijk1 = static_cast<int> (floor (input_->points[cp].y * inverse_leaf_size_[1]) - min_b_[1]);
-      int ijk2 = static_cast<int> (floor (input_->points[cp].z * inverse_leaf_size_[2]) - min_b_[2]);
+    leaf_ptrs[id] = &leaves_[leaf_indices[id]];
+    leaf_ptrs[id]->centroid.resize (centroid_size);
+    leaf_ptrs[id]->centroid.setZero ();
+  }
 
-      // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+  // Split the leaves in ranges holding about the same number of points, one per thread
+  const int nr_ranges = std::max (1, std::min (static_cast<int> (threads_), nr_leaves));
+  std::vector<int> range_start (nr_ranges + 1, nr_leaves);
+  range_start[0] = 0;
+  {
+    int range = 1, nr_range_points = 0;
+    const double points_per_range = static_cast<double> (nr_points) / nr_ranges;
+    for (int id = 0; id < nr_leaves && range < nr_ranges; ++id)
+    {
+      nr_range_points += leaf_sizes[id];
+      if (nr_range_points >= range * points_per_range)
+        range_start[range++] = id + 1;
+    }
+  }
 
-      //int idx = (((input_->points[cp].getArray4fMap () * inverse_leaf_size_).template cast<int> ()).matrix () - min_b_).dot (divb_mul_);
-      Leaf& leaf = leaves_[idx];
-      if (leaf.nr_points == 0)
-      {
-        leaf.centroid.resize (centroid_size);
-        leaf.centroid.setZero ();
-      }
+  // Second pass: every thread goes over all points, and accumulates those of its range of leaves. The points of a leaf
+  // are summed in the order of the input whatever the number of threads, and are read sequentially.
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(threads_)
+#endif
+  for (int range = 0; range < nr_ranges; ++range)
+  {
+    const int first_id = range_start[range], last_id = range_start[range + 1];
+    Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
+    for (int cp = 0; cp < nr_points; ++cp)
+    {
+      const int id = point_ids[cp];
+      if (id < first_id || id >= last_id)
+        continue;
 
-      Eigen::Vector3d pt3d (input_->points[cp].x, input_->points[cp].y, input_->points[cp].z);
+      const PointT &point = input_->points[cp];
+      Leaf& leaf = *leaf_ptrs[id];
+      Eigen::Vector3d pt3d (point.x, point.y, point.z);
       // Accumulate point sum for centroid calculation
       leaf.mean_ += pt3d;
       // Accumulate x*xT for single pass covariance calculation
@@ -228,134 +243,141 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
       // Do we need to process all the fields?
       if (!downsample_all_data_)
       {
-        Eigen::Vector4f pt (input_->points[cp].x, input_->points[cp].y, input_->points[cp].z, 0);
+        Eigen::Vector4f pt (point.x, point.y, point.z, 0);
         leaf.centroid.template head<4> () += pt;
       }
       else
       {
         // Copy all the fields
-        Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
+        centroid.setZero ();
         // ---[ RGB special case
         if (rgba_index >= 0)
         {
           // Fill r/g/b data, assuming that the order is BGRA
           int rgb;
-          memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[cp]) + rgba_index, sizeof (int));
+          memcpy (&rgb, reinterpret_cast<const char*> (&point) + rgba_index, sizeof (int));
           centroid[centroid_size - 3] = static_cast<float> ((rgb >> 16) & 0x0000ff);
           centroid[centroid_size - 2] = static_cast<float> ((rgb >> 8) & 0x0000ff);
           centroid[centroid_size - 1] = static_cast<float> ((rgb) & 0x0000ff);
         }
-        pcl::for_each_type<FieldList> (NdCopyPointEigenFunctor<PointT> (input_->points[cp], centroid));
+        pcl::for_each_type<FieldList> (NdCopyPointEigenFunctor<PointT> (point, centroid));
         leaf.centroid += centroid;
       }
-      ++leaf.nr_points;
     }
   }
 
-  // Second pass: go over all leaves and compute centroids and covariance matrices
-  output.points.reserve (leaves_.size ());
-  if (searchable_)
-    voxel_centroids_leaf_indices_.reserve (leaves_.size ());
-  int cp = 0;
-  if (save_leaf_layout_)
-    leaf_layout_.resize (div_b_[0] * div_b_[1] * div_b_[2], -1);
-
-  // Eigen values and vectors calculated to prevent near singluar matrices
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
-  Eigen::Matrix3d eigen_val;
-  Eigen::Vector3d pt_sum;
-
-  // Eigen values less than a threshold of max eigen value are inflated to a set fraction of the max eigen value.
-  double min_covar_eigvalue;
-
-  for (typename boost::unordered_map<size_t, Leaf>::iterator it = leaves_.begin (); it != leaves_.end (); ++it)
+  // Compute the centroids and covariance matrices of the leaves
+  std::vector<char> degenerate (nr_leaves, 0);
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic, 64) num_threads(threads_)
+#endif
+  for (int id = 0; id < nr_leaves; ++id)
   {
-
-    // Normalize the centroid
-    Leaf& leaf = it->second;
+    Leaf& leaf = *leaf_ptrs[id];
+    leaf.nr_points = leaf_sizes[id];
 
     // Normalize the centroid
     leaf.centroid /= static_cast<float> (leaf.nr_points);
     // Point sum used for single pass covariance calculation
-    pt_sum = leaf.mean_;
+    const Eigen::Vector3d pt_sum = leaf.mean_;
     // Normalize mean
     leaf.mean_ /= leaf.nr_points;
 
-    // If the voxel contains sufficient points, its covariance is calculated and is added to the voxel centroids and output clouds.
+    // If the voxel contains sufficient points, its covariance is calculated.
     // Points with less than the minimum points will have a can not be accuratly approximated using a normal distribution.
     if (leaf.nr_points >= min_points_per_voxel_)
-    {
-      if (save_leaf_layout_)
-        leaf_layout_[it->first] = cp++;
-
-      output.push_back (PointT ());
+      degenerate[id] = !computeLeafCovariance (leaf, pt_sum);
+  }
 
-      // Do we need to process all the fields?
-      if (!downsample_all_data_)
-      {
-        output.points.back ().x = leaf.centroid[0];
-        output.points.back ().y = leaf.centroid[1];
-        output.points.back ().z = leaf.centroid[2];
-      }
-      else
-      {
-        pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor<PointT> (leaf.centroid, output.back ()));
-        // ---[ RGB special case
-        if (rgba_index >= 0)
-        {
-          // pack r/g/b into rgb
-          float r = leaf.centroid[centroid_size - 3], g = leaf.centroid[centroid_size - 2], b = leaf.centroid[centroid_size - 1];
-          int rgb = (static_cast<int> (r)) << 16 | (static_cast<int> (g)) << 8 | (static_cast<int> (b));
-          memcpy (reinterpret_cast<char*> (&output.points.back ()) + rgba_index, &rgb, sizeof (float));
-        }
-      }
+  // Third pass: go over all leaves, and add the centroids of those containing sufficient points to the output
+  output.points.reserve (leaves_.size ());
+  if (searchable_)
+    voxel_centroids_leaf_indices_.reserve (leaves_.size ());
+  int cp = 0;
+  if (save_leaf_layout_)
+    leaf_layout_.resize (div_b_[0] * div_b_[1] * div_b_[2], -1);
 
-      // Stores the voxel indice for fast access searching
-      if (searchable_)
-        voxel_centroids_leaf_indices_.push_back (static_cast<int> (it->first));
+  for (typename boost::unordered_map<size_t, Leaf>::iterator it = leaves_.begin (); it != leaves_.end (); ++it)
+  {
+    Leaf& leaf = it->second;
+    if (leaf.nr_points < min_points_per_voxel_)
+      continue;
 
-      // Single pass covariance calculation
-      leaf.cov_ = (leaf.cov_ - 2 * (pt_sum * leaf.mean_.transpose ())) / leaf.nr_points + leaf.mean_ * leaf.mean_.transpose ();
-      leaf.cov_ *= (leaf.nr_points - 1.0) / leaf.nr_points;
+    if (save_leaf_layout_)
+      leaf_layout_[it->first] = cp++;
 
-      //Normalize Eigen Val such that max no more than 100x min.
-      eigensolver.compute (leaf.cov_);
-      eigen_val = eigensolver.eigenvalues ().asDiagonal ();
-      leaf.evecs_ = eigensolver.eigenvectors ();
+    output.push_back (PointT ());
 
-      if (eigen_val (0, 0) < 0 || eigen_val (1, 1) < 0 || eigen_val (2, 2) <= 0)
+    // Do we need to process all the fields?
+    if (!downsample_all_data_)
+    {
+      output.points.back ().x = leaf.centroid[0];
+      output.points.back ().y = leaf.centroid[1];
+      output.points.back ().z = leaf.centroid[2];
+    }
+    else
+    {
+      pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor<PointT> (leaf.centroid, output.back ()));
+      // ---[ RGB special case
+      if (rgba_index >= 0)
       {
-        leaf.nr_points = -1;
-        continue;
+        // pack r/g/b into rgb
+        float r = leaf.centroid[centroid_size - 3], g = leaf.centroid[centroid_size - 2], b = leaf.centroid[centroid_size - 1];
+        int rgb = (static_cast<int> (r)) << 16 | (static_cast<int> (g)) << 8 | (static_cast<int> (b));
+        memcpy (reinterpret_cast<char*> (&output.points.back ()) + rgba_index, &rgb, sizeof (float));
       }
+    }
+
+    // Stores the voxel indice for fast access searching
+    if (searchable_)
+      voxel_centroids_leaf_indices_.push_back (static_cast<int> (it->first));
+  }
 
-      // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
+  // Leaves whose covariance could not be computed are marked as unusable
+  for (int id = 0; id < nr_leaves; ++id)
+    if (degenerate[id])
+      leaf_ptrs[id]->nr_points = -1;
 
-      min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val (2, 2);
-      if (eigen_val (0, 0) < min_covar_eigvalue)
-      {
-        eigen_val (0, 0) = min_covar_eigvalue;
+  output.width = static_cast<uint32_t> (output.points.size ());
+}
 
-        if (eigen_val (1, 1) < min_covar_eigvalue)
-        {
-          eigen_val (1, 1) = min_covar_eigvalue;
-        }
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::VoxelGridCovariance<PointT>::computeLeafCovariance (Leaf &leaf, const Eigen::Vector3d &pt_sum) const
+{
+  // Single pass covariance calculation
+  leaf.cov_ = (leaf.cov_ - 2 * (pt_sum * leaf.mean_.transpose ())) / leaf.nr_points + leaf.mean_ * leaf.mean_.transpose ();
+  leaf.cov_ *= (leaf.nr_points - 1.0) / leaf.nr_points;
 
-        leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse ();
-      }
-      leaf.evals_ = eigen_val.diagonal ();
+  //Normalize Eigen Val such that max no more than 100x min.
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver (leaf.cov_);
+  Eigen::Matrix3d eigen_val = eigensolver.eigenvalues ().asDiagonal ();
+  leaf.evecs_ = eigensolver.eigenvectors ();
 
-      leaf.icov_ = leaf.cov_.inverse ();
-      if (leaf.icov_.maxCoeff () == std::numeric_limits<float>::infinity ( )
-          || leaf.icov_.minCoeff () == -std::numeric_limits<float>::infinity ( ) )
-      {
-        leaf.nr_points = -1;
-      }
+  if (eigen_val (0, 0) < 0 || eigen_val (1, 1) < 0 || eigen_val (2, 2) <= 0)
+    return (false);
+
+  // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
+  // Eigen values less than a threshold of max eigen value are inflated to a set fraction of the max eigen value.
+  double min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val (2, 2);
+  if (eigen_val (0, 0) < min_covar_eigvalue)
+  {
+    eigen_val (0, 0) = min_covar_eigvalue;
 
+    if (eigen_val (1, 1) < min_covar_eigvalue)
+    {
+      eigen_val (1, 1) = min_covar_eigvalue;
     }
+
+    leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse ();
   }
+  leaf.evals_ = eigen_val.diagonal ();
 
-  output.width = static_cast<uint32_t> (output.points.size ());
+  leaf.icov_ = leaf.cov_.inverse ();
+  if (leaf.icov_.maxCoeff () == std::numeric_limits<float>::infinity ( )
+      || leaf.icov_.minCoeff () == -std::numeric_limits<float>::infinity ( ) )
+    return (false);
+  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -393,6 +415,91 @@ pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const PointT& referenc
   return (static_cast<int> (neighbors.size ()));
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::VoxelGridCovariance<PointT>::getFaceNeighborhoodAtPoint (const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const
+{
+  neighbors.clear ();
+
+  const int i = static_cast<int> (floor (reference_point.x * inverse_leaf_size_[0]) - min_b_[0]);
+  const int j = static_cast<int> (floor (reference_point.y * inverse_leaf_size_[1]) - min_b_[1]);
+  const int k = static_cast<int> (floor (reference_point.z * inverse_leaf_size_[2]) - min_b_[2]);
+
+  appendUsableLeaf (i, j, k, neighbors);
+  appendUsableLeaf (i - 1, j, k, neighbors);
+  appendUsableLeaf (i + 1, j, k, neighbors);
+  appendUsableLeaf (i, j - 1, k, neighbors);
+  appendUsableLeaf (i, j + 1, k, neighbors);
+  appendUsableLeaf (i, j, k - 1, neighbors);
+  appendUsableLeaf (i, j, k + 1, neighbors);
+
+  return (static_cast<int> (neighbors.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::VoxelGridCovariance<PointT>::getVoxelAtPoint (const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const
+{
+  neighbors.clear ();
+
+  appendUsableLeaf (static_cast<int> (floor (reference_point.x * inverse_leaf_size_[0]) - min_b_[0]),
+                    static_cast<int> (floor (reference_point.y * inverse_leaf_size_[1]) - min_b_[1]),
+                    static_cast<int> (floor (reference_point.z * inverse_leaf_size_[2]) - min_b_[2]), neighbors);
+
+  return (static_cast<int> (neighbors.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::VoxelGridCovariance<PointT>::radiusSearchInNeighborhood (const PointT &point, double radius,
+                                                              std::vector<LeafConstPtr> &k_leaves,
+                                                              std::vector<float> &k_sqr_distances,
+                                                              unsigned int max_nn) const
+{
+  k_leaves.clear ();
+  k_sqr_distances.clear ();
+
+  const int i = static_cast<int> (floor (point.x * inverse_leaf_size_[0]) - min_b_[0]);
+  const int j = static_cast<int> (floor (point.y * inverse_leaf_size_[1]) - min_b_[1]);
+  const int k = static_cast<int> (floor (point.z * inverse_leaf_size_[2]) - min_b_[2]);
+  const float sqr_radius = static_cast<float> (radius * radius);
+
+  for (int di = std::max (i - 1, 0); di <= std::min (i + 1, div_b_[0] - 1); ++di)
+    for (int dj = std::max (j - 1, 0); dj <= std::min (j + 1, div_b_[1] - 1); ++dj)
+      for (int dk = std::max (k - 1, 0); dk <= std::min (k + 1, div_b_[2] - 1); ++dk)
+      {
+        typename boost::unordered_map<size_t, Leaf>::const_iterator leaf_iter =
+          leaves_.find (di * divb_mul_[0] + dj * divb_mul_[1] + dk * divb_mul_[2]);
+        if (leaf_iter == leaves_.end () || leaf_iter->second.nr_points < min_points_per_voxel_)
+          continue;
+
+        const Eigen::VectorXf &centroid = leaf_iter->second.centroid;
+        const float dx = centroid[0] - point.x, dy = centroid[1] - point.y, dz = centroid[2] - point.z;
+        const float sqr_distance = dx * dx + dy * dy + dz * dz;
+        if (sqr_distance > sqr_radius)
+          continue;
+
+        // Insertion sort, there are at most 27 neighbors
+        size_t n = k_leaves.size ();
+        k_leaves.push_back (&leaf_iter->second);
+        k_sqr_distances.push_back (sqr_distance);
+        for (; n > 0 && k_sqr_distances[n - 1] > sqr_distance; --n)
+        {
+          k_leaves[n] = k_leaves[n - 1];
+          k_sqr_distances[n] = k_sqr_distances[n - 1];
+        }
+        k_leaves[n] = &leaf_iter->second;
+        k_sqr_distances[n] = sqr_distance;
+      }
+
+  if (max_nn > 0 && k_leaves.size () > max_nn)
+  {
+    k_leaves.resize (max_nn);
+    k_sqr_distances.resize (max_nn);
+  }
+  return (static_cast<int> (k_leaves.size ()));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
 pcl::VoxelGridCovariance<PointT>::getDisplayCloud (pcl::PointCloud<PointXYZ>& cell_cloud)
@@ -0,0 +1,192 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_NEIGHBOR_GRID_H_
+#define PCL_FILTERS_NEIGHBOR_GRID_H_
+
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/common/common.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief @b NeighborGrid sorts the finite points of a cloud into a uniform grid of cubic cells. All the
+    * points closer than one cell size to a point of the cloud lie in the 3x3x3 block of cells around it, so
+    * fixed radius neighborhoods can be collected without a spatial tree.
+    * Only the non-empty cells are stored: the points are sorted by cell key, and a cell is found by a binary
+    * search over the sorted keys of the occupied cells.
+    * It is used by the grid search modes of RadiusOutlierRemoval and StatisticalOutlierRemoval.
+    * \ingroup filters
+    */
+  template <typename PointT>
+  class NeighborGrid
+  {
+    public:
+      /** \brief A range [first, second) in getIndices (). */
+      typedef std::pair<int, int> CellRange;
+
+      /** \brief Empty constructor. */
+      NeighborGrid () :
+        leaf_size_ (0), inverse_leaf_size_ (0), min_b_ (Eigen::Array3f::Zero ()),
+        stride_y_ (0), stride_z_ (0), point_indices_ (), cell_keys_ (), cell_starts_ ()
+      {
+      }
+
+      /** \brief Sort the finite points of a cloud into cells of the given size.
+        * \param[in] cloud the input point cloud
+        * \param[in] leaf_size the cell size
+        * \return false if the leaf size is not positive, or if it is too small for the cells to be indexed
+        */
+      bool
+      setInputCloud (const PointCloud<PointT> &cloud, float leaf_size)
+      {
+        point_indices_.clear ();
+        cell_keys_.clear ();
+        cell_starts_.clear ();
+        if (!(leaf_size > 0))
+          return (false);
+
+        Eigen::Vector4f min_p, max_p;
+        getMinMax3D (cloud, min_p, max_p);
+
+        // Leave an empty layer of cells on every side, so the 27 cells around any point have a valid key
+        leaf_size_ = leaf_size;
+        inverse_leaf_size_ = 1.0f / leaf_size;
+        min_b_ = min_p.head<3> ().array () - leaf_size;
+        Eigen::Array3d dims = (((max_p.head<3> ().array () - min_p.head<3> ().array ()) * inverse_leaf_size_).floor () + 3.0f).cast<double> ();
+        if (!pcl_isfinite (dims.prod ()) || dims.prod () > static_cast<double> (uint64_t (1) << 62))
+          return (false);
+        stride_y_ = static_cast<uint64_t> (dims[0]);
+        stride_z_ = static_cast<uint64_t> (dims[0]) * static_cast<uint64_t> (dims[1]);
+
+        std::vector<std::pair<uint64_t, int> > keys;
+        keys.reserve (cloud.points.size ());
+        for (size_t i = 0; i < cloud.points.size (); ++i)
+        {
+          if (!pcl_isfinite (cloud.points[i].x) || !pcl_isfinite (cloud.points[i].y) || !pcl_isfinite (cloud.points[i].z))
+            continue;
+          keys.push_back (std::make_pair (getCellKey (cloud.points[i]), static_cast<int> (i)));
+        }
+        std::sort (keys.begin (), keys.end ());
+
+        point_indices_.resize (keys.size ());
+        for (size_t i = 0; i < keys.size (); ++i)
+        {
+          point_indices_[i] = keys[i].second;
+          if (i == 0 || keys[i].first != keys[i - 1].first)
+          {
+            cell_keys_.push_back (keys[i].first);
+            cell_starts_.push_back (static_cast<int> (i));
+          }
+        }
+        cell_starts_.push_back (static_cast<int> (keys.size ()));
+        return (true);
+      }
+
+      /** \brief Get the key of the cell holding a point. The point has to lie within the bounding box of the
+        * input cloud, extended by one cell size.
+        * \param[in] point the point
+        */
+      inline uint64_t
+      getCellKey (const PointT &point) const
+      {
+        Eigen::Array3f ijk = ((point.getArray3fMap () - min_b_) * inverse_leaf_size_).floor ();
+        return (static_cast<uint64_t> (ijk[0]) + static_cast<uint64_t> (ijk[1]) * stride_y_ + static_cast<uint64_t> (ijk[2]) * stride_z_);
+      }
+
+      /** \brief Get the ranges in getIndices () of the non-empty cells among the 3x3x3 block centered on a cell.
+        * \param[in] key the key of the center cell, as returned by getCellKey ()
+        * \param[out] ranges the ranges of the (at most 27) non-empty cells
+        */
+      void
+      getNeighborCells (uint64_t key, std::vector<CellRange> &ranges) const
+      {
+        ranges.clear ();
+        for (int dz = -1; dz <= 1; ++dz)
+          for (int dy = -1; dy <= 1; ++dy)
+          {
+            // The three cells of a row are consecutive keys, so a single binary search is enough
+            uint64_t row_key = key + dz * stride_z_ + dy * stride_y_;
+            std::vector<uint64_t>::const_iterator it = std::lower_bound (cell_keys_.begin (), cell_keys_.end (), row_key - 1);
+            for (; it != cell_keys_.end () && *it <= row_key + 1; ++it)
+            {
+              size_t cell = it - cell_keys_.begin ();
+              ranges.push_back (CellRange (cell_starts_[cell], cell_starts_[cell + 1]));
+            }
+          }
+      }
+
+      /** \brief Get the finite point indices of the input cloud, sorted by cell. */
+      inline const std::vector<int>&
+      getIndices () const { return (point_indices_); }
+
+      /** \brief Get the cell size. */
+      inline float
+      getLeafSize () const { return (leaf_size_); }
+
+    protected:
+      /** \brief The cell size and its inverse. */
+      float leaf_size_;
+      float inverse_leaf_size_;
+
+      /** \brief The lower corner of the grid, one cell below the minimum of the input cloud. */
+      Eigen::Array3f min_b_;
+
+      /** \brief The key increments between neighboring cells along y and z. */
+      uint64_t stride_y_;
+      uint64_t stride_z_;
+
+      /** \brief The finite point indices, sorted by cell key. */
+      std::vector<int> point_indices_;
+
+      /** \brief The sorted keys of the non-empty cells. */
+      std::vector<uint64_t> cell_keys_;
+
+      /** \brief The start of each non-empty cell in point_indices_, followed by the number of points. */
+      std::vector<int> cell_starts_;
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#endif  // PCL_FILTERS_NEIGHBOR_GRID_H_
@@ -42,11 +42,16 @@
 #include <time.h>
 #include <limits.h>
 
-#include <boost/dynamic_bitset.hpp>
+#include <algorithm>
 
 namespace pcl
 {
   /** \brief @b NormalSpaceSampling samples the input point cloud in the space of normal directions computed at every point.
+    *
+    * The normals are binned by their direction cosines, and the bins are visited in turn, each of them giving
+    * one of its points picked at random, until the requested number of points is drawn. The points are drawn
+    * from a \a boost::mt19937 seeded with \a seed_ and the number of the bin, so that the sample only depends on
+    * the seed, and not on the number of threads. Points with invalid normals are never sampled.
     * \ingroup filters
     */
   template<typename PointT, typename NormalT>
@@ -65,7 +70,8 @@ namespace pcl
     public:
       /** \brief Empty constructor. */
       NormalSpaceSampling () : 
-        sample_ (UINT_MAX), seed_ (static_cast<unsigned int> (time (NULL))), binsx_ (), binsy_ (), binsz_ (), input_normals_ ()
+        sample_ (UINT_MAX), seed_ (static_cast<unsigned int> (time (NULL))), binsx_ (), binsy_ (), binsz_ (), 
+        input_normals_ (), threads_ (1)
       {
         filter_name_ = "NormalSpaceSampling";
       }
@@ -138,6 +144,15 @@ namespace pcl
       inline NormalsPtr
       getNormals () const { return (input_normals_); }
 
+      /** \brief Set the number of threads used to bin and sample the points.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
     protected:
       /** \brief Number of indices that will be returned. */
       unsigned int sample_;
@@ -154,6 +169,9 @@ namespace pcl
       /** \brief The normals computed at each point in the input cloud */
       NormalsPtr input_normals_; 
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Sample of point indices into a separate PointCloud
         * \param[out] output the resultant point cloud
         */
@@ -167,21 +185,22 @@ namespace pcl
       applyFilter (std::vector<int> &indices);
 
     private:
-      /** \brief Finds the bin number of the input normal, returns the bin number
+      /** \brief Finds the bin number of the input normal, returns the number of bins if the normal is invalid
         * \param[in] normal the input normal 
-        * \param[in] nbins total number of bins
         */
       unsigned int 
-      findBin (float *normal, unsigned int nbins);
+      findBin (const float *normal) const;
 
-      /** \brief Checks of the entire bin is sampled, returns true or false
-        * \param[out] array flag which says whether a point is sampled or not
-        * \param[in] start_index the index to the first point of the bin in array.
-        * \param[in] length number of points in the bin
+      /** \brief Finds the bin number of a direction cosine along one axis
+        * \param[in] dcos the direction cosine
+        * \param[in] nbins number of bins along the axis
         */
-      bool
-      isEntireBinSampled (boost::dynamic_bitset<> &array, unsigned int start_index, unsigned int length);
-
+      static inline unsigned int
+      findAxisBin (float dcos, unsigned int nbins)
+      {
+        const int bin = static_cast<int> ((dcos + 1.0f) * 0.5f * static_cast<float> (nbins));
+        return (static_cast<unsigned int> (std::max (0, std::min (bin, static_cast<int> (nbins) - 1))));
+      }
   };
 }
 #endif  //#ifndef PCL_FILTERS_NORMAL_SPACE_SUBSAMPLE_H_
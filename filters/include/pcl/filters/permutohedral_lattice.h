@@ -0,0 +1,367 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_PERMUTOHEDRAL_LATTICE_H_
+#define PCL_FILTERS_PERMUTOHEDRAL_LATTICE_H_
+
+#include <pcl/pcl_config.h>
+#include <pcl/pcl_macros.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief @b PermutohedralLattice computes Gaussian weighted averages of values attached to points of a
+    * Dim dimensional feature space in linear time, following the splat, blur, slice scheme of:
+    * <b>A. Adams, J. Baek and M. A. Davis. Fast High-Dimensional Filtering Using the Permutohedral Lattice.
+    * Computer Graphics Forum (Eurographics), 2010.</b>
+    *
+    * The features are expected to be divided by the standard deviation of the Gaussian along each axis, so
+    * that the filter has a unit standard deviation. Each point is splatted onto the Dim + 1 vertices of the
+    * lattice simplex holding it, the vertices are blurred along the Dim + 1 lattice axes, and the result is
+    * interpolated back at the points. Only the vertices touched by a point are stored, in a hash table.
+    * The result differs from the exact Gaussian average by the lattice interpolation, which is bounded by
+    * the feature space distance to the simplex vertices (at most about one standard deviation).
+    * It is used by the approximate modes of BilateralFilter and Convolution3D.
+    * \ingroup filters
+    */
+  template <int Dim>
+  class PermutohedralLattice
+  {
+    public:
+      /** \brief Empty constructor. */
+      PermutohedralLattice () :
+        nr_values_ (0), keys_ (), values_ (), table_ (64, -1), point_vertices_ (), point_weights_ ()
+      {
+        for (int i = 0; i < Dim; ++i)
+          scale_factor_[i] = static_cast<float> ((Dim + 1) * std::sqrt (2.0 / 3.0) / std::sqrt ((i + 1.0) * (i + 2.0)));
+      }
+
+      /** \brief Clear the lattice and set the number of values attached to every point.
+        * \param[in] nr_values the number of values per point
+        * \param[in] nr_points the expected number of points, used to reserve memory
+        */
+      void
+      reset (int nr_values, int nr_points = 0)
+      {
+        nr_values_ = nr_values;
+        keys_.clear ();
+        values_.clear ();
+        point_vertices_.clear ();
+        point_weights_.clear ();
+        point_vertices_.reserve (nr_points * (Dim + 1));
+        point_weights_.reserve (nr_points * (Dim + 1));
+        table_.assign (64, -1);
+      }
+
+      /** \brief Add a point to the lattice. Points are numbered in the order they are splatted.
+        * \param[in] feature the Dim features of the point, divided by the standard deviations
+        * \param[in] value the nr_values values attached to the point
+        */
+      void
+      splat (const float *feature, const float *value)
+      {
+        float elevated[Dim + 1];
+        int greedy[Dim + 1];
+        int rank[Dim + 1];
+        float barycentric[Dim + 2];
+
+        // Elevate the point onto the hyperplane orthogonal to (1, ..., 1)
+        float sum = 0;
+        for (int i = Dim; i > 0; --i)
+        {
+          float cf = feature[i - 1] * scale_factor_[i - 1];
+          elevated[i] = sum - static_cast<float> (i) * cf;
+          sum += cf;
+        }
+        elevated[0] = sum;
+
+        // Find the closest remainder-0 lattice point
+        int coordinate_sum = 0;
+        for (int i = 0; i <= Dim; ++i)
+        {
+          float v = elevated[i] / static_cast<float> (Dim + 1);
+          float up = std::ceil (v) * static_cast<float> (Dim + 1);
+          float down = std::floor (v) * static_cast<float> (Dim + 1);
+          greedy[i] = static_cast<int> ((up - elevated[i] < elevated[i] - down) ? up : down);
+          coordinate_sum += greedy[i];
+        }
+        coordinate_sum /= Dim + 1;
+
+        // Rank the differential coordinates, then move the point back onto the hyperplane
+        for (int i = 0; i <= Dim; ++i)
+          rank[i] = 0;
+        for (int i = 0; i < Dim; ++i)
+          for (int j = i + 1; j <= Dim; ++j)
+          {
+            if (elevated[i] - static_cast<float> (greedy[i]) < elevated[j] - static_cast<float> (greedy[j]))
+              ++rank[i];
+            else
+              ++rank[j];
+          }
+        if (coordinate_sum > 0)
+        {
+          for (int i = 0; i <= Dim; ++i)
+          {
+            if (rank[i] >= Dim + 1 - coordinate_sum)
+            {
+              greedy[i] -= Dim + 1;
+              rank[i] += coordinate_sum - (Dim + 1);
+            }
+            else
+              rank[i] += coordinate_sum;
+          }
+        }
+        else if (coordinate_sum < 0)
+        {
+          for (int i = 0; i <= Dim; ++i)
+          {
+            if (rank[i] < -coordinate_sum)
+            {
+              greedy[i] += Dim + 1;
+              rank[i] += (Dim + 1) + coordinate_sum;
+            }
+            else
+              rank[i] += coordinate_sum;
+          }
+        }
+
+        // Barycentric coordinates of the point in its simplex
+        for (int i = 0; i < Dim + 2; ++i)
+          barycentric[i] = 0;
+        for (int i = 0; i <= Dim; ++i)
+        {
+          float delta = (elevated[i] - static_cast<float> (greedy[i])) / static_cast<float> (Dim + 1);
+          barycentric[Dim - rank[i]] += delta;
+          barycentric[Dim + 1 - rank[i]] -= delta;
+        }
+        barycentric[0] += 1.0f + barycentric[Dim + 1];
+
+        // Splat onto the vertices of the simplex, the last value is the homogeneous weight
+        int key[Dim];
+        for (int remainder = 0; remainder <= Dim; ++remainder)
+        {
+          for (int i = 0; i < Dim; ++i)
+            key[i] = greedy[i] + ((rank[i] <= Dim - remainder) ? remainder : remainder - (Dim + 1));
+          int vertex = insert (key);
+          float *vertex_values = &values_[vertex * (nr_values_ + 1)];
+          for (int v = 0; v < nr_values_; ++v)
+            vertex_values[v] += barycentric[remainder] * value[v];
+          vertex_values[nr_values_] += barycentric[remainder];
+          point_vertices_.push_back (vertex);
+          point_weights_.push_back (barycentric[remainder]);
+        }
+      }
+
+      /** \brief Blur the lattice vertices with a [1 2 1] kernel along each of the Dim + 1 lattice axes.
+        * \param[in] nr_threads the number of threads to use
+        */
+      void
+      blur (unsigned int nr_threads = 1)
+      {
+        const int nr_vertices = getNumberOfVertices ();
+        const int stride = nr_values_ + 1;
+        std::vector<float> blurred (values_.size ());
+        for (int axis = 0; axis <= Dim; ++axis)
+        {
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (blurred) num_threads (nr_threads)
+#endif
+          for (int vertex = 0; vertex < nr_vertices; ++vertex)
+          {
+            // The neighbors along an axis differ by (1, ..., 1) - (Dim + 1) e_axis
+            int previous[Dim], next[Dim];
+            const int *key = &keys_[vertex * Dim];
+            for (int i = 0; i < Dim; ++i)
+            {
+              previous[i] = key[i] + 1;
+              next[i] = key[i] - 1;
+            }
+            if (axis < Dim)
+            {
+              previous[axis] = key[axis] - Dim;
+              next[axis] = key[axis] + Dim;
+            }
+            const int p = find (previous), n = find (next);
+            const float *center = &values_[vertex * stride];
+            float *result = &blurred[vertex * stride];
+            for (int v = 0; v < stride; ++v)
+            {
+              float neighbors = ((p < 0) ? 0.0f : values_[p * stride + v]) + ((n < 0) ? 0.0f : values_[n * stride + v]);
+              result[v] = 0.5f * center[v] + 0.25f * neighbors;
+            }
+          }
+          values_.swap (blurred);
+        }
+      }
+
+      /** \brief Interpolate the blurred values at a splatted point.
+        * \param[in] point the number of the point, in splatting order
+        * \param[out] value the nr_values averaged values, or NaN if the point has no weight
+        * \return the homogeneous weight of the point
+        */
+      float
+      slice (int point, float *value) const
+      {
+        const int stride = nr_values_ + 1;
+        float weight = 0;
+        for (int v = 0; v < nr_values_; ++v)
+          value[v] = 0;
+        for (int r = 0; r <= Dim; ++r)
+        {
+          const float *vertex_values = &values_[point_vertices_[point * (Dim + 1) + r] * stride];
+          const float w = point_weights_[point * (Dim + 1) + r];
+          for (int v = 0; v < nr_values_; ++v)
+            value[v] += w * vertex_values[v];
+          weight += w * vertex_values[nr_values_];
+        }
+        const float inverse = (weight > 0) ? 1.0f / weight : std::numeric_limits<float>::quiet_NaN ();
+        for (int v = 0; v < nr_values_; ++v)
+          value[v] *= inverse;
+        return (weight);
+      }
+
+      /** \brief Get the number of splatted points. */
+      inline int
+      getNumberOfPoints () const { return (static_cast<int> (point_vertices_.size ()) / (Dim + 1)); }
+
+      /** \brief Get the number of lattice vertices touched by the splatted points. */
+      inline int
+      getNumberOfVertices () const { return (static_cast<int> (keys_.size ()) / Dim); }
+
+    protected:
+      /** \brief Hash a lattice key. */
+      inline size_t
+      hash (const int *key) const
+      {
+        size_t h = 0;
+        for (int i = 0; i < Dim; ++i)
+        {
+          h += static_cast<size_t> (key[i]);
+          h *= 2531011;
+        }
+        return (h);
+      }
+
+      /** \brief Get the vertex with the given key, or -1 if no point was splatted onto it. */
+      inline int
+      find (const int *key) const
+      {
+        const size_t mask = table_.size () - 1;
+        for (size_t h = hash (key) & mask; ; h = (h + 1) & mask)
+        {
+          const int vertex = table_[h];
+          if (vertex < 0)
+            return (-1);
+          if (equal (&keys_[vertex * Dim], key))
+            return (vertex);
+        }
+      }
+
+      /** \brief Get the vertex with the given key, adding it if needed. */
+      int
+      insert (const int *key)
+      {
+        // Keep the table at most half full
+        if (2 * (getNumberOfVertices () + 1) > static_cast<int> (table_.size ()))
+          rehash (2 * table_.size ());
+
+        const size_t mask = table_.size () - 1;
+        size_t h = hash (key) & mask;
+        for (; table_[h] >= 0; h = (h + 1) & mask)
+          if (equal (&keys_[table_[h] * Dim], key))
+            return (table_[h]);
+
+        const int vertex = getNumberOfVertices ();
+        table_[h] = vertex;
+        keys_.insert (keys_.end (), key, key + Dim);
+        values_.resize (values_.size () + nr_values_ + 1, 0.0f);
+        return (vertex);
+      }
+
+      /** \brief Resize the hash table and insert back all the vertices. */
+      void
+      rehash (size_t size)
+      {
+        table_.assign (size, -1);
+        const size_t mask = size - 1;
+        for (int vertex = 0; vertex < getNumberOfVertices (); ++vertex)
+        {
+          size_t h = hash (&keys_[vertex * Dim]) & mask;
+          while (table_[h] >= 0)
+            h = (h + 1) & mask;
+          table_[h] = vertex;
+        }
+      }
+
+      /** \brief Compare two lattice keys. */
+      static inline bool
+      equal (const int *a, const int *b)
+      {
+        for (int i = 0; i < Dim; ++i)
+          if (a[i] != b[i])
+            return (false);
+        return (true);
+      }
+
+      /** \brief The scaling of each feature axis applied before elevating a point onto the lattice. */
+      float scale_factor_[Dim];
+
+      /** \brief The number of values attached to every point. */
+      int nr_values_;
+
+      /** \brief The first Dim coordinates of every vertex (the last one follows from the zero sum). */
+      std::vector<int> keys_;
+
+      /** \brief The nr_values_ + 1 accumulated values of every vertex, the last being the homogeneous weight. */
+      std::vector<float> values_;
+
+      /** \brief Open addressing hash table of vertex indices, -1 for empty slots. Its size is a power of two. */
+      std::vector<int> table_;
+
+      /** \brief The Dim + 1 vertices of the simplex of every splatted point. */
+      std::vector<int> point_vertices_;
+
+      /** \brief The barycentric weights of every splatted point in its simplex. */
+      std::vector<float> point_weights_;
+  };
+}
+
+#endif // PCL_FILTERS_PERMUTOHEDRAL_LATTICE_H_
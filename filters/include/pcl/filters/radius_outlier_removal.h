@@ -78,6 +78,16 @@ namespace pcl
       typedef typename pcl::search::Search<PointT>::Ptr SearcherPtr;
 
     public:
+      /** \brief The ways the neighbors of the points can be counted. */
+      enum SearchMode
+      {
+        /** \brief Radius searches in a spatial tree (a k-d tree, or an organized search for organized clouds). */
+        SEARCH_MODE_TREE,
+        /** \brief A uniform grid with the search radius as cell size, where the neighbors of a point are in the
+          * 27 cells around it. Faster than the tree for dense clouds of fairly uniform density. */
+        SEARCH_MODE_GRID
+      };
+
       /** \brief Constructor.
         * \param[in] extract_removed_indices Set to true if you want to be able to extract the indices of points being removed (default = false).
         */
@@ -85,7 +95,8 @@ namespace pcl
         FilterIndices<PointT>::FilterIndices (extract_removed_indices),
         searcher_ (),
         search_radius_ (0.0),
-        min_pts_radius_ (1)
+        min_pts_radius_ (1),
+        search_mode_ (SEARCH_MODE_TREE)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -134,6 +145,24 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Set the way the neighbors are counted (default = SEARCH_MODE_TREE).
+        * \details Both modes give the same output. SEARCH_MODE_GRID falls back to the tree search if the
+        * radius is too small for the extent of the cloud to be gridded.
+        * \param[in] search_mode the search mode
+        */
+      inline void
+      setSearchMode (SearchMode search_mode)
+      {
+        search_mode_ = search_mode;
+      }
+
+      /** \brief Get the way the neighbors are counted. */
+      inline SearchMode
+      getSearchMode ()
+      {
+        return (search_mode_);
+      }
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -166,7 +195,25 @@ namespace pcl
       void
       applyFilterIndices (std::vector<int> &indices);
 
-    private:
+      /** \brief Count the neighbors of every point in indices_, within search_radius_. The counts are only
+        * exact up to min_pts_radius_ + 1, which is all the inlier test needs.
+        * \param[out] counts the number of neighbors of each indexed point (including the point itself)
+        */
+      virtual void
+      countNeighbors (std::vector<int> &counts);
+
+      /** \brief Count the neighbors of every point in indices_ using a NeighborGrid.
+        * \param[out] counts the number of neighbors of each indexed point (including the point itself)
+        * \param[in] nr_threads the number of threads to process the grid cells with
+        * \return false if the cloud could not be gridded, in which case the tree search has to be used
+        */
+      bool
+      countNeighborsGrid (std::vector<int> &counts, unsigned int nr_threads);
+
+      /** \brief Create the search object if none was given, and set its input cloud. */
+      void
+      initSearch ();
+
       /** \brief A pointer to the spatial search object. */
       SearcherPtr searcher_;
 
@@ -175,6 +222,9 @@ namespace pcl
 
       /** \brief The minimum number of neighbors that a point needs to have in the given search radius to be considered an inlier. */
       int min_pts_radius_;
+
+      /** \brief The way the neighbors are counted. */
+      SearchMode search_mode_;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,96 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_RADIUS_OUTLIER_REMOVAL_OMP_H_
+#define PCL_FILTERS_RADIUS_OUTLIER_REMOVAL_OMP_H_
+
+#include <pcl/filters/radius_outlier_removal.h>
+
+namespace pcl
+{
+  /** \brief @b RadiusOutlierRemovalOMP is the OpenMP version of RadiusOutlierRemoval: the neighbors of the
+    * query points are counted in parallel. The output is the same as the one of RadiusOutlierRemoval.
+    * \ingroup filters
+    */
+  template<typename PointT>
+  class RadiusOutlierRemovalOMP : public RadiusOutlierRemoval<PointT>
+  {
+    public:
+      /** \brief Constructor. The filter runs on a single thread until setNumberOfThreads () is called.
+        * \param[in] extract_removed_indices Set to true if you want to be able to extract the indices of points being removed (default = false).
+        */
+      explicit
+      RadiusOutlierRemovalOMP (bool extract_removed_indices = false) :
+        RadiusOutlierRemoval<PointT> (extract_removed_indices),
+        threads_ (1)
+      {
+        filter_name_ = "RadiusOutlierRemovalOMP";
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+    protected:
+      using RadiusOutlierRemoval<PointT>::indices_;
+      using RadiusOutlierRemoval<PointT>::filter_name_;
+      using RadiusOutlierRemoval<PointT>::searcher_;
+      using RadiusOutlierRemoval<PointT>::search_radius_;
+      using RadiusOutlierRemoval<PointT>::min_pts_radius_;
+      using RadiusOutlierRemoval<PointT>::search_mode_;
+
+      /** \brief Count the neighbors of every point in indices_ in parallel.
+        * \param[out] counts the number of neighbors of each indexed point (including the point itself)
+        */
+      void
+      countNeighbors (std::vector<int> &counts);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+  };
+}
+
+#endif  // PCL_FILTERS_RADIUS_OUTLIER_REMOVAL_OMP_H_
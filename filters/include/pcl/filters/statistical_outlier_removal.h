@@ -87,6 +87,17 @@ namespace pcl
       typedef typename pcl::search::Search<PointT>::Ptr SearcherPtr;
 
     public:
+      /** \brief The ways the mean neighbor distances can be estimated. */
+      enum SearchMode
+      {
+        /** \brief The exact mean distance to the mean_k_ nearest neighbors, found in a spatial tree. */
+        SEARCH_MODE_TREE,
+        /** \brief An approximation from the number of points in the 27 cells of a uniform grid around each
+          * point (see setGridLeafSize ()). Much faster, but only a density estimate: mean_k_ is ignored and
+          * all points of a cell get the same value. */
+        SEARCH_MODE_GRID
+      };
+
       /** \brief Constructor.
         * \param[in] extract_removed_indices Set to true if you want to be able to extract the indices of points being removed (default = false).
         */
@@ -94,7 +105,9 @@ namespace pcl
         FilterIndices<PointT>::FilterIndices (extract_removed_indices),
         searcher_ (),
         mean_k_ (1),
-        std_mul_ (0.0)
+        std_mul_ (0.0),
+        search_mode_ (SEARCH_MODE_TREE),
+        grid_leaf_size_ (0.0)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
@@ -139,6 +152,40 @@ namespace pcl
         return (std_mul_);
       }
 
+      /** \brief Set the way the mean neighbor distances are estimated (default = SEARCH_MODE_TREE).
+        * \details SEARCH_MODE_GRID needs a grid leaf size, and falls back to the tree search without one.
+        * \param[in] search_mode the search mode
+        */
+      inline void
+      setSearchMode (SearchMode search_mode)
+      {
+        search_mode_ = search_mode;
+      }
+
+      /** \brief Get the way the mean neighbor distances are estimated. */
+      inline SearchMode
+      getSearchMode ()
+      {
+        return (search_mode_);
+      }
+
+      /** \brief Set the cell size of the grid used in SEARCH_MODE_GRID.
+        * \details A good value has a few points per cell, e.g. about twice the mean point spacing.
+        * \param[in] leaf_size the grid cell size
+        */
+      inline void
+      setGridLeafSize (double leaf_size)
+      {
+        grid_leaf_size_ = leaf_size;
+      }
+
+      /** \brief Get the cell size of the grid used in SEARCH_MODE_GRID. */
+      inline double
+      getGridLeafSize ()
+      {
+        return (grid_leaf_size_);
+      }
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -171,7 +218,33 @@ namespace pcl
       void
       applyFilterIndices (std::vector<int> &indices);
 
-    private:
+      /** \brief Compute the mean distance of every point in indices_ to its mean_k_ nearest neighbors.
+        * \param[out] distances the mean distance of each indexed point (0 for invalid points)
+        */
+      virtual void
+      computeMeanDistances (std::vector<float> &distances);
+
+      /** \brief Compute the mean distance of one point in indices_ to its mean_k_ nearest neighbors.
+        * \param[in] iii the position of the point in indices_
+        * \param[out] nn_indices buffer for the indices of the neighbors
+        * \param[out] nn_dists buffer for the squared distances to the neighbors
+        * \return the mean distance (0 for invalid points)
+        */
+      float
+      computeMeanDistance (int iii, std::vector<int> &nn_indices, std::vector<float> &nn_dists);
+
+      /** \brief Estimate the mean neighbor distance of every point in indices_ from the occupancy of a NeighborGrid.
+        * \param[out] distances the estimated mean distance of each indexed point (0 for invalid points)
+        * \param[in] nr_threads the number of threads to process the grid cells with
+        * \return false if the cloud could not be gridded, in which case the tree search has to be used
+        */
+      bool
+      computeMeanDistancesGrid (std::vector<float> &distances, unsigned int nr_threads);
+
+      /** \brief Create the search object if none was given, and set its input cloud. */
+      void
+      initSearch ();
+
       /** \brief A pointer to the spatial search object. */
       SearcherPtr searcher_;
 
@@ -181,6 +254,12 @@ namespace pcl
       /** \brief Standard deviations threshold (i.e., points outside of 
         * \f$ \mu \pm \sigma \cdot std\_mul \f$ will be marked as outliers). */
       double std_mul_;
+
+      /** \brief The way the mean neighbor distances are estimated. */
+      SearchMode search_mode_;
+
+      /** \brief The cell size of the grid used in SEARCH_MODE_GRID. */
+      double grid_leaf_size_;
   };
 
   /** \brief @b StatisticalOutlierRemoval uses point neighborhood statistics to filter outlier data. For more
@@ -0,0 +1,98 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_FILTERS_STATISTICAL_OUTLIER_REMOVAL_OMP_H_
+#define PCL_FILTERS_STATISTICAL_OUTLIER_REMOVAL_OMP_H_
+
+#include <pcl/filters/statistical_outlier_removal.h>
+
+namespace pcl
+{
+  /** \brief @b StatisticalOutlierRemovalOMP is the OpenMP version of StatisticalOutlierRemoval: the mean
+    * distances of the query points to their neighbors are computed in parallel. The output is the same as the
+    * one of StatisticalOutlierRemoval.
+    * \ingroup filters
+    */
+  template<typename PointT>
+  class StatisticalOutlierRemovalOMP : public StatisticalOutlierRemoval<PointT>
+  {
+    public:
+      /** \brief Constructor. The filter runs on a single thread until setNumberOfThreads () is called.
+        * \param[in] extract_removed_indices Set to true if you want to be able to extract the indices of points being removed (default = false).
+        */
+      explicit
+      StatisticalOutlierRemovalOMP (bool extract_removed_indices = false) :
+        StatisticalOutlierRemoval<PointT> (extract_removed_indices),
+        threads_ (1)
+      {
+        filter_name_ = "StatisticalOutlierRemovalOMP";
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+    protected:
+      using StatisticalOutlierRemoval<PointT>::input_;
+      using StatisticalOutlierRemoval<PointT>::indices_;
+      using StatisticalOutlierRemoval<PointT>::filter_name_;
+      using StatisticalOutlierRemoval<PointT>::getClassName;
+      using StatisticalOutlierRemoval<PointT>::searcher_;
+      using StatisticalOutlierRemoval<PointT>::mean_k_;
+      using StatisticalOutlierRemoval<PointT>::search_mode_;
+
+      /** \brief Compute the mean distance of every point in indices_ to its mean_k_ nearest neighbors, in parallel.
+        * \param[out] distances the mean distance of each indexed point (0 for invalid points)
+        */
+      void
+      computeMeanDistances (std::vector<float> &distances);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+  };
+}
+
+#endif  // PCL_FILTERS_STATISTICAL_OUTLIER_REMOVAL_OMP_H_
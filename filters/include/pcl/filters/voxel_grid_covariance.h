@@ -202,7 +202,8 @@ namespace pcl
         leaves_ (),
         voxel_centroids_ (),
         voxel_centroids_leaf_indices_ (),
-        kdtree_ ()
+        kdtree_ (),
+        threads_ (1)
       {
         downsample_all_data_ = false;
         save_leaf_layout_ = false;
@@ -256,6 +257,15 @@ namespace pcl
         return min_covar_eigvalue_mult_;
       }
 
+      /** \brief Set the number of threads used to build the voxel structure.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
       /** \brief Filter cloud and initializes voxel structure.
        * \param[out] output cloud containing centroids of voxels containing a sufficient number of points
        * \param[in] searchable flag if voxel structure is searchable, if true then kdtree is built
@@ -373,6 +383,23 @@ namespace pcl
       int
       getNeighborhoodAtPoint (const PointT& reference_point, std::vector<LeafConstPtr> &neighbors);
 
+      /** \brief Get the voxel containing point p and the 6 voxels sharing a face with it, looked up directly in 
+       * the voxel structure. Only voxels containing a sufficient number of points are used.
+       * \param[in] reference_point the point to get the leaf structures at
+       * \param[out] neighbors the usable voxels, the one containing the point first if it is usable
+       * \return number of neighbors found
+       */
+      int
+      getFaceNeighborhoodAtPoint (const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const;
+
+      /** \brief Get the voxel containing point p if it contains a sufficient number of points.
+       * \param[in] reference_point the point to get the leaf structure at
+       * \param[out] neighbors the voxel containing the point, empty if it is not usable
+       * \return number of neighbors found (0 or 1)
+       */
+      int
+      getVoxelAtPoint (const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const;
+
       /** \brief Get the leaf structure map
        * \return a map contataining all leaves
        */
@@ -453,6 +480,9 @@ namespace pcl
 
       /** \brief Search for all the nearest occupied voxels of the query point in a given radius.
        * \note Only voxels containing a sufficient number of points are used.
+       * \note When the radius is not larger than the voxels, the neighbors can only be in the 27 voxels around the
+       * query point: they are then looked up directly in the voxel structure, which does not need to be searchable,
+       * and the voxels whose covariance could not be computed are left out.
        * \param[in] point the given query point
        * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
        * \param[out] k_leaves the resultant leaves of the neighboring points
@@ -465,6 +495,9 @@ namespace pcl
       {
         k_leaves.clear ();
 
+        if (radius <= leaf_size_.template head<3> ().minCoeff ())
+          return (radiusSearchInNeighborhood (point, radius, k_leaves, k_sqr_distances, max_nn));
+
         // Check if kdtree has been built
         if (!searchable_)
         {
@@ -511,6 +544,41 @@ namespace pcl
        */
       void applyFilter (PointCloud &output);
 
+      /** \brief Compute the covariance matrix of a leaf from the sums of its points, and its inverse.
+       * \param[in,out] leaf the leaf, holding its mean and the sum of the outer products of its points
+       * \param[in] pt_sum the sum of the points of the leaf
+       * \return false if the covariance matrix is degenerate
+       */
+      bool
+      computeLeafCovariance (Leaf &leaf, const Eigen::Vector3d &pt_sum) const;
+
+      /** \brief Append the voxel at grid coordinates (i, j, k), relative to the minimum of the bounding box, if it
+       * lies in the grid and contains a sufficient number of points.
+       */
+      inline void
+      appendUsableLeaf (int i, int j, int k, std::vector<LeafConstPtr> &neighbors) const
+      {
+        if (i < 0 || j < 0 || k < 0 || i >= div_b_[0] || j >= div_b_[1] || k >= div_b_[2])
+          return;
+        typename boost::unordered_map<size_t, Leaf>::const_iterator leaf_iter =
+          leaves_.find (i * divb_mul_[0] + j * divb_mul_[1] + k * divb_mul_[2]);
+        if (leaf_iter != leaves_.end () && leaf_iter->second.nr_points >= min_points_per_voxel_)
+          neighbors.push_back (&leaf_iter->second);
+      }
+
+      /** \brief Search for the usable voxels whose centroid is within radius of the query point among the 27 voxels
+       * around it, sorted by distance. The radius must not be larger than the voxels.
+       * \param[in] point the given query point
+       * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+       * \param[out] k_leaves the resultant leaves of the neighboring points
+       * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+       * \param[in] max_nn if greater than 0, the maximum number of neighbors returned
+       * \return number of neighbors found
+       */
+      int
+      radiusSearchInNeighborhood (const PointT &point, double radius, std::vector<LeafConstPtr> &k_leaves,
+                                  std::vector<float> &k_sqr_distances, unsigned int max_nn) const;
+
       /** \brief Flag to determine if voxel structure is searchable. */
       bool searchable_;
 
@@ -531,6 +599,9 @@ namespace pcl
 
       /** \brief KdTree generated using \ref voxel_centroids_ (used for searching). */
       KdTreeFLANN<PointT> kdtree_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
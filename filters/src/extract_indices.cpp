@@ -79,18 +79,9 @@ pcl::ExtractIndices<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &output)
 
   if (negative_)
   {
-    // Prepare a vector holding all indices
-    std::vector<int> all_indices (input_->width * input_->height);
-    for (int i = 0; i < static_cast<int>(all_indices.size ()); ++i)
-      all_indices[i] = i;
-
-    std::vector<int> indices = *indices_;
-    std::sort (indices.begin (), indices.end ());
-
-    // Get the diference
+    // Get the difference
     std::vector<int> remaining_indices;
-    set_difference (all_indices.begin (), all_indices.end (), indices.begin (), indices.end (),
-                    inserter (remaining_indices, remaining_indices.begin ()));
+    applyFilter (remaining_indices);
 
     // Prepare the output and copy the data
     output.width = static_cast<uint32_t> (remaining_indices.size ());
@@ -123,26 +114,18 @@ pcl::ExtractIndices<sensor_msgs::PointCloud2>::applyFilter (std::vector<int> &in
       return;
     }
 
-    // Set up the full indices set
-    std::vector<int> indices_fullset (input_->width * input_->height);
-    for (int p_it = 0; p_it < static_cast<int> (indices_fullset.size ()); ++p_it)
-      indices_fullset[p_it] = p_it;
-
-    // If the subset is the empty set
-    if (indices_->empty () || (input_->width * input_->height == 0))
-    {
-      // Full set copy
-      indices = indices_fullset;
-      return;
-    }
-
-    // If the subset is a proper subset
-    // Set up the subset input indices
-    std::vector<int> indices_subset = *indices_;
-    std::sort (indices_subset.begin (), indices_subset.end ());
+    // Mark the subset in a bitmask and keep the unmarked points, in ascending order
+    const int nr_points = static_cast<int> (input_->width * input_->height);
+    std::vector<bool> selected (nr_points, false);
+    for (size_t i = 0; i < indices_->size (); ++i)
+      if ((*indices_)[i] >= 0 && (*indices_)[i] < nr_points)
+        selected[(*indices_)[i]] = true;
 
-    // Get the difference
-    set_difference (indices_fullset.begin (), indices_fullset.end (), indices_subset.begin (), indices_subset.end (), inserter (indices, indices.begin ()));
+    indices.clear ();
+    indices.reserve (nr_points);
+    for (int i = 0; i < nr_points; ++i)
+      if (!selected[i])
+        indices.push_back (i);
   }
   else
     indices = *indices_;
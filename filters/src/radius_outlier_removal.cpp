@@ -76,9 +76,8 @@ pcl::RadiusOutlierRemoval<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &o
   }
   tree_->setInputCloud (cloud);
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
+  // Only the neighbor count matters, and only up to min_pts_radius_
+  unsigned int max_count = min_pts_radius_ > 0 ? static_cast<unsigned int> (min_pts_radius_) : 0;
 
   // Copy the common fields
   output.is_bigendian = input_->is_bigendian;
@@ -93,7 +92,7 @@ pcl::RadiusOutlierRemoval<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &o
   // Go over all the points and check which doesn't have enough neighbors
   for (int cp = 0; cp < static_cast<int> (indices_->size ()); ++cp)
   {
-    int k = tree_->radiusSearch ((*indices_)[cp], search_radius_, nn_indices, nn_dists);
+    int k = tree_->radiusSearchCount ((*indices_)[cp], search_radius_, max_count);
     // Check if the number of neighbors is larger than the user imposed limit
     if (k < min_pts_radius_)
     {
@@ -55,6 +55,13 @@ namespace pcl
     /** \brief @b CorrespondenceEstimation represents the base class for
       * determining correspondences between target and query point
       * sets/features.
+      *
+      * The nearest neighbor queries are spread over \ref setNumberOfThreads threads, and the correspondences are
+      * always returned in the order of the source indices. The k-D tree over the source that is needed for reciprocal
+      * correspondences is kept between calls and only rebuilt when the source cloud or the contents of its indices
+      * change. The query index of a correspondence is the index of the source point in the source cloud. When the
+      * source moves between calls (e.g., inside an ICP loop), pass its pose through \ref setSourceTransformation
+      * instead of transforming the cloud, so that the source tree stays valid.
       * \author Radu Bogdan Rusu, Michael Dixon, Dirk Holz
       * \ingroup registration
       */
@@ -70,6 +77,9 @@ namespace pcl
         typedef typename pcl::KdTree<PointTarget> KdTree;
         typedef typename pcl::KdTree<PointTarget>::Ptr KdTreePtr;
 
+        typedef typename pcl::KdTree<PointSource> KdTreeReciprocal;
+        typedef typename KdTreeReciprocal::Ptr KdTreeReciprocalPtr;
+
         typedef pcl::PointCloud<PointSource> PointCloudSource;
         typedef typename PointCloudSource::Ptr PointCloudSourcePtr;
         typedef typename PointCloudSource::ConstPtr PointCloudSourceConstPtr;
@@ -85,10 +95,26 @@ namespace pcl
           corr_name_ (),
           tree_ (new pcl::KdTreeFLANN<PointTarget>),
           target_ (),
+          tree_reciprocal_ (new pcl::KdTreeFLANN<PointSource>),
+          tree_reciprocal_indices_ (),
+          source_cloud_updated_ (true),
+          source_transformation_ (Eigen::Matrix4f::Identity ()),
+          use_source_transformation_ (false),
+          threads_ (1),
           point_representation_ ()
         {
         }
 
+        /** \brief Provide a pointer to the input source (e.g., the point cloud that we want to align to the target).
+          * \param[in] cloud the input point cloud source
+          */
+        virtual inline void 
+        setInputCloud (const PointCloudSourceConstPtr &cloud)
+        {
+          source_cloud_updated_ = true;
+          PCLBase<PointSource>::setInputCloud (cloud);
+        }
+
         /** \brief Provide a pointer to the input target (e.g., the point cloud that we want to align the 
           * input source to)
           * \param[in] cloud the input point cloud target
@@ -109,8 +135,36 @@ namespace pcl
           point_representation_ = point_representation;
         }
 
+        /** \brief Set the rigid transformation that is applied to the source points before they are matched.
+          * \details The source cloud and the k-D tree built over it for reciprocal correspondences are left untouched:
+          * the source points are transformed on the fly, and the target points are moved into the source frame by the
+          * inverse transformation for the reciprocal check. Only applies to point types with x, y, z coordinates.
+          * \param[in] transformation the transformation from the source frame into the target frame
+          */
+        inline void
+        setSourceTransformation (const Eigen::Matrix4f &transformation)
+        {
+          source_transformation_ = transformation;
+          use_source_transformation_ = !transformation.isIdentity ();
+        }
+
+        /** \brief Get the rigid transformation that is applied to the source points before they are matched. */
+        inline Eigen::Matrix4f
+        getSourceTransformation () const { return (source_transformation_); }
+
+        /** \brief Set the number of threads to use for the nearest neighbor queries.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          threads_ = nr_threads == 0 ? 1 : nr_threads;
+        }
+
         /** \brief Determine the correspondences between input and target cloud.
-          * \param[out] correspondences the found correspondences (index of query point, index of target point, distance)
+          * \details Source points without a target point within \a max_distance get no correspondence.
+          * \param[out] correspondences the found correspondences (index of query point in the source cloud, index of
+          * target point, distance)
           * \param[in] max_distance maximum distance between correspondences
           */
         virtual void 
@@ -133,6 +187,25 @@ namespace pcl
         /** \brief The input point cloud dataset target. */
         PointCloudTargetConstPtr target_;
 
+        /** \brief A pointer to the spatial search object over the source, used for reciprocal correspondences. */
+        KdTreeReciprocalPtr tree_reciprocal_;
+
+        /** \brief A copy of the source indices \a tree_reciprocal_ was built with, so that indices edited in place
+          * are detected. */
+        std::vector<int> tree_reciprocal_indices_;
+
+        /** \brief Set when the source cloud changed and \a tree_reciprocal_ needs to be rebuilt. */
+        bool source_cloud_updated_;
+
+        /** \brief The rigid transformation applied to the source points before matching. */
+        Eigen::Matrix4f source_transformation_;
+
+        /** \brief Whether \a source_transformation_ differs from the identity. */
+        bool use_source_transformation_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
         /** \brief Abstract class get name method. */
         inline const std::string& 
         getClassName () const { return (corr_name_); }
@@ -140,6 +213,9 @@ namespace pcl
       private:
         /** \brief The point representation used (internal). */
         PointRepresentationConstPtr point_representation_;
+
+      public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
      };
   }
 }
@@ -100,6 +100,34 @@ namespace pcl
         getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
                                      pcl::Correspondences& remaining_correspondences) = 0;
 
+        /** \brief Remove the rejected correspondences from the given set, in place.
+          * The default implementation goes through \a getRemainingCorrespondences
+          * and thus copies the set once. Rejectors that can filter without a copy
+          * override it.
+          * \param[in,out] correspondences the correspondences to filter
+          */
+        virtual void
+        removeRejectedCorrespondences (pcl::Correspondences &correspondences)
+        {
+          pcl::Correspondences remaining_correspondences;
+          getRemainingCorrespondences (correspondences, remaining_correspondences);
+          correspondences.swap (remaining_correspondences);
+        }
+
+        /** \brief Whether the rejector decides on every correspondence on its own,
+          * without looking at the rest of the set. If so, \a isCorrespondenceValid
+          * implements the test and may be called concurrently from several threads.
+          */
+        virtual bool
+        hasPointwiseTest () const { return (false); }
+
+        /** \brief Test a single correspondence. Only meaningful if \a hasPointwiseTest returns true.
+          * \param[in] correspondence the correspondence to test
+          * \return true if the correspondence is kept
+          */
+        virtual bool
+        isCorrespondenceValid (const pcl::Correspondence &) { return (true); }
+
         /** \brief Determine the indices of query points of
           * correspondences that have been rejected, i.e., the difference
           * between the input correspondences (set via \a setInputCorrespondences)
@@ -138,6 +166,8 @@ namespace pcl
         applyRejection (Correspondences &correspondences) = 0;
     };
 
+    typedef boost::shared_ptr<CorrespondenceRejector> CorrespondenceRejectorPtr;
+
     /** @b DataContainerInterface provides a generic interface for computing correspondence scores between correspondent
       * points in the input and target clouds
       * \ingroup registration
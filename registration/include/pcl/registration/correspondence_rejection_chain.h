@@ -0,0 +1,133 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_REGISTRATION_CORRESPONDENCE_REJECTION_CHAIN_H_
+#define PCL_REGISTRATION_CORRESPONDENCE_REJECTION_CHAIN_H_
+
+#include <pcl/registration/correspondence_rejection.h>
+
+namespace pcl
+{
+  namespace registration
+  {
+    /**
+      * @b CorrespondenceRejectorChain applies a sequence of correspondence
+      * rejectors to a set of correspondences, with the same result as running
+      * them one after the other.
+      *
+      * The correspondences are filtered in place: the input set is copied once
+      * and no further copies are made between the rejectors. Consecutive
+      * rejectors that test every correspondence on its own (see
+      * CorrespondenceRejector::hasPointwiseTest, e.g.
+      * CorrespondenceRejectorDistance and CorrespondenceRejectorSurfaceNormal)
+      * are fused into a single pass, which runs in parallel. The other
+      * rejectors (e.g. CorrespondenceRejectorMedianDistance,
+      * CorrespondenceRejectorOneToOne or CorrespondenceRejectorTrimmed) work
+      * on the set left by their predecessors.
+      *
+      * \ingroup registration
+      */
+    class PCL_EXPORTS CorrespondenceRejectorChain: public CorrespondenceRejector
+    {
+      using CorrespondenceRejector::input_correspondences_;
+      using CorrespondenceRejector::rejection_name_;
+      using CorrespondenceRejector::getClassName;
+
+      public:
+
+        /** \brief Empty constructor. */
+        CorrespondenceRejectorChain () : rejectors_ (), threads_ (1)
+        {
+          rejection_name_ = "CorrespondenceRejectorChain";
+        }
+
+        /** \brief Append a rejector to the end of the chain.
+          * \param[in] rejector the rejector to add. Its own input correspondences are not used.
+          */
+        inline void
+        addRejector (const CorrespondenceRejectorPtr &rejector) { rejectors_.push_back (rejector); }
+
+        /** \brief Remove all rejectors from the chain. */
+        inline void
+        clearRejectors () { rejectors_.clear (); }
+
+        /** \brief Get the number of rejectors in the chain. */
+        inline size_t
+        getNumberOfRejectors () const { return (rejectors_.size ()); }
+
+        /** \brief Set the number of threads used to test the correspondences.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+        /** \brief Get a list of valid correspondences after rejection from the original set of correspondences.
+          * \param[in] original_correspondences the set of initial correspondences given
+          * \param[out] remaining_correspondences the resultant filtered set of remaining correspondences
+          */
+        void
+        getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
+                                     pcl::Correspondences& remaining_correspondences);
+
+        /** \brief Run all rejectors of the chain on the given correspondences, in place.
+          * \param[in,out] correspondences the correspondences to filter
+          */
+        void
+        removeRejectedCorrespondences (pcl::Correspondences &correspondences);
+
+      protected:
+
+        /** \brief Apply the rejection algorithm.
+          * \param[out] correspondences the set of resultant correspondences.
+          */
+        inline void 
+        applyRejection (pcl::Correspondences &correspondences)
+        {
+          getRemainingCorrespondences (*input_correspondences_, correspondences);
+        }
+
+        /** \brief The rejectors, in the order they are applied. */
+        std::vector<CorrespondenceRejectorPtr> rejectors_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+    };
+  }
+}
+
+#endif /* PCL_REGISTRATION_CORRESPONDENCE_REJECTION_CHAIN_H_ */
@@ -79,6 +79,27 @@ namespace pcl
         getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
                                      pcl::Correspondences& remaining_correspondences);
 
+        /** \brief Remove the correspondences whose distance exceeds the threshold, in place.
+          * \param[in,out] correspondences the correspondences to filter
+          */
+        inline void
+        removeRejectedCorrespondences (pcl::Correspondences &correspondences);
+
+        /** \brief The distance test is done for every correspondence on its own. */
+        inline bool
+        hasPointwiseTest () const { return (true); }
+
+        /** \brief Test whether a correspondence is closer than the maximum distance.
+          * \param[in] correspondence the correspondence to test
+          */
+        inline bool
+        isCorrespondenceValid (const pcl::Correspondence &correspondence)
+        {
+          if (data_container_)
+            return (data_container_->getCorrespondenceScore (correspondence) < max_distance_);
+          return (correspondence.distance < max_distance_);
+        }
+
         /** \brief Set the maximum distance used for thresholding in correspondence rejection.
           * \param[in] distance Distance to be used as maximum distance between correspondences. 
           * Correspondences with larger distances are rejected.
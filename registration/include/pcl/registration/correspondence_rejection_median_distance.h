@@ -81,6 +81,12 @@ namespace pcl
         getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
                                      pcl::Correspondences& remaining_correspondences);
 
+        /** \brief Remove the correspondences further apart than the scaled median distance, in place.
+          * \param[in,out] correspondences the correspondences to filter
+          */
+        inline void
+        removeRejectedCorrespondences (pcl::Correspondences &correspondences);
+
         /** \brief Get the median distance used for thresholding in correspondence rejection. */
         inline double
         getMedianDistance () const { return median_distance_; };
@@ -75,6 +75,13 @@ namespace pcl
         getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
                                      pcl::Correspondences& remaining_correspondences);
 
+        /** \brief Keep only the closest correspondence for every target point, in place.
+          * The correspondences are left sorted by match index.
+          * \param[in,out] correspondences the correspondences to filter
+          */
+        inline void
+        removeRejectedCorrespondences (pcl::Correspondences &correspondences);
+
       protected:
         /** \brief Apply the rejection algorithm.
           * \param[out] correspondences the set of resultant correspondences.
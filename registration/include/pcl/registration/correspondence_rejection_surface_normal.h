@@ -79,6 +79,27 @@ namespace pcl
         getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
                                      pcl::Correspondences& remaining_correspondences);
 
+        /** \brief Remove the correspondences whose normals disagree, in place.
+          * \param[in,out] correspondences the correspondences to filter
+          */
+        inline void
+        removeRejectedCorrespondences (pcl::Correspondences &correspondences);
+
+        /** \brief The normal test is done for every correspondence on its own. */
+        inline bool
+        hasPointwiseTest () const { return (true); }
+
+        /** \brief Test whether the normals of a correspondence are similar enough.
+          * \param[in] correspondence the correspondence to test
+          */
+        inline bool
+        isCorrespondenceValid (const pcl::Correspondence &correspondence)
+        {
+          assert (data_container_ && "DataContainer object is not initialized");
+          return (boost::static_pointer_cast<DataContainer<pcl::PointXYZ, pcl::PointNormal> > 
+                  (data_container_)->getCorrespondenceScoreFromNormals (correspondence) > threshold_);
+        }
+
         /** \brief Set the thresholding angle between the normals for correspondence rejection. 
           * \param[in] threshold cosine of the thresholding angle between the normals for rejection
           */
@@ -111,6 +111,13 @@ namespace pcl
         getRemainingCorrespondences (const pcl::Correspondences& original_correspondences,
                                      pcl::Correspondences& remaining_correspondences);
 
+        /** \brief Keep the closest overlap_ratio_ part of the correspondences, in place.
+          * If correspondences are removed, the remaining ones are sorted by distance.
+          * \param[in,out] correspondences the correspondences to filter
+          */
+        inline void
+        removeRejectedCorrespondences (pcl::Correspondences &correspondences);
+
 
       protected:
 
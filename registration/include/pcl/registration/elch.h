@@ -45,6 +45,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include <Eigen/Geometry>
+#include <Eigen/StdVector>
 
 #include <pcl/pcl_base.h>
 #include <pcl/point_types.h>
@@ -98,7 +99,12 @@ namespace pcl
           reg_ (new pcl::IterativeClosestPoint<PointT, PointT>), 
           loop_transform_ (),
           compute_loop_ (true),
-          vd_ ()
+          vd_ (),
+          defer_transformation_ (false),
+          pending_transforms_ (),
+          nr_updated_vertices_ (0),
+          nr_optimized_vertices_ (0),
+          threads_ (1)
         {};
 
         /** \brief Add a new point cloud to the internal graph.
@@ -128,6 +134,7 @@ namespace pcl
         setLoopGraph (LoopGraphPtr loop_graph)
         {
           loop_graph_ = loop_graph;
+          pending_transforms_.clear ();
         }
 
         /** \brief Getter for the first scan of a loop. */
@@ -195,13 +202,79 @@ namespace pcl
           compute_loop_ = false;
         }
 
+        /** \brief Set whether compute () should only accumulate the per scan
+         * corrections instead of transforming the point clouds right away.
+         * The accumulated corrections are taken into account when the next loop
+         * is registered and can be applied to the clouds at any time with
+         * applyPendingTransformations ().
+         * \param[in] defer true to defer the point cloud transformation
+         */
+        inline void
+        setDeferTransformation (bool defer)
+        {
+          defer_transformation_ = defer;
+        }
+
+        /** \brief Get whether the point cloud transformation is deferred. */
+        inline bool
+        getDeferTransformation () const
+        {
+          return (defer_transformation_);
+        }
+
+        /** \brief Get the correction accumulated for a scan that has not been
+         * applied to its point cloud yet.
+         * \param[in] vd the scan in the loop graph
+         */
+        inline Eigen::Affine3f
+        getPendingTransformation (const typename boost::graph_traits<LoopGraph>::vertex_descriptor &vd) const
+        {
+          if (vd < pending_transforms_.size ())
+            return (pending_transforms_[vd]);
+          return (Eigen::Affine3f::Identity ());
+        }
+
+        /** \brief Get the number of scans whose pose was changed by the last call to compute (). */
+        inline size_t
+        getNumberOfUpdatedVertices () const
+        {
+          return (nr_updated_vertices_);
+        }
+
+        /** \brief Get the number of scans the loop optimizer balanced in the last call to compute (),
+         * i.e. the scans on a cycle through the closed loop.
+         */
+        inline size_t
+        getNumberOfOptimizedVertices () const
+        {
+          return (nr_optimized_vertices_);
+        }
+
+        /** \brief Set the number of threads used to transform the point clouds.
+         * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+         */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          threads_ = nr_threads == 0 ? 1 : nr_threads;
+        }
+
         /** \brief Computes now poses for all point clouds by closing the loop
-         * between start and end point cloud. This will transform all given point
-         * clouds for now!
+         * between start and end point cloud. The loop optimizer only runs on the
+         * scans that lie on a cycle through the new loop closure; the scans
+         * hanging off them follow the scan they are attached to, and only the
+         * scans whose pose changes are touched. Unless setDeferTransformation (true) was called, this will
+         * transform all affected point clouds right away.
          */
         void
         compute ();
 
+        /** \brief Transform every point cloud in the graph by its pending
+         * correction and reset the corrections to identity.
+         */
+        void
+        applyPendingTransformations ();
+
       protected:
         using PCLBase<PointT>::deinitCompute;
 
@@ -209,6 +282,14 @@ namespace pcl
         virtual bool
         initCompute ();
 
+        /** \brief Copy the point cloud of a scan, including its pending correction.
+         * \param[in] vd the scan in the loop graph
+         * \param[out] cloud the resultant point cloud
+         */
+        void
+        getTransformedCloud (const typename boost::graph_traits<LoopGraph>::vertex_descriptor &vd,
+                             PointCloud &cloud) const;
+
       private:
         /** \brief graph structure for the internal optimization graph */
         typedef boost::adjacency_list<
@@ -225,7 +306,9 @@ namespace pcl
          * @param[out] weights array for the weights
          */
         void
-        loopOptimizerAlgorithm (LOAGraph &g, double *weights);
+        loopOptimizerAlgorithm (LOAGraph &g, int f, int l, double *weights);
+
+        typedef std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > TransformVector;
 
         /** \brief The internal loop graph. */
         LoopGraphPtr loop_graph_;
@@ -246,6 +329,21 @@ namespace pcl
         /** \brief previously added node in the loop_graph_. */
         typename boost::graph_traits<LoopGraph>::vertex_descriptor vd_;
 
+        /** \brief Whether compute () only accumulates the corrections in pending_transforms_. */
+        bool defer_transformation_;
+
+        /** \brief Corrections not yet applied to the point clouds, indexed by vertex. */
+        TransformVector pending_transforms_;
+
+        /** \brief Number of scans moved by the last call to compute (). */
+        size_t nr_updated_vertices_;
+
+        /** \brief Number of scans balanced by the loop optimizer in the last call to compute (). */
+        size_t nr_optimized_vertices_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
       public:
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     };
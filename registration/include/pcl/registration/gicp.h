@@ -73,6 +73,7 @@ namespace pcl
     using IterativeClosestPoint<PointSource, PointTarget>::inlier_threshold_;
     using IterativeClosestPoint<PointSource, PointTarget>::min_number_correspondences_;
     using IterativeClosestPoint<PointSource, PointTarget>::update_visualizer_;
+    using IterativeClosestPoint<PointSource, PointTarget>::threads_;
 
     typedef pcl::PointCloud<PointSource> PointCloudSource;
     typedef typename PointCloudSource::Ptr PointCloudSourcePtr;
@@ -100,6 +101,8 @@ namespace pcl
         , target_covariances_(0)
         , mahalanobis_(0)
         , max_inner_iterations_(20)
+        , input_covariances_valid_ (false)
+        , target_covariances_valid_ (false)
       {
         min_number_correspondences_ = 4;
         reg_name_ = "GeneralizedIterativeClosestPoint";
@@ -131,6 +134,7 @@ namespace pcl
         input_ = input.makeShared ();
         input_tree_->setInputCloud (input_);
         input_covariances_.reserve (input_->size ());
+        input_covariances_valid_ = false;
       }
 
       /** \brief Provide a pointer to the input target (e.g., the point cloud that we want to align the input source to)
@@ -141,8 +145,53 @@ namespace pcl
       {
         pcl::Registration<PointSource, PointTarget>::setInputTarget(target);
         target_covariances_.reserve (target_->size ());
+        target_covariances_valid_ = false;
       }
 
+      /** \brief Compute the covariance matrices of the target points now instead of 
+        * during the first call to align (). The matrices are kept until a new target or 
+        * a different number of neighbors is set, so repeated alignments against the 
+        * same target only compute the source covariances.
+        */
+      void
+      computeTargetCovariances ();
+
+      /** \brief Provide precomputed covariance matrices for the target points (e.g., 
+        * obtained through getTargetCovariances () on a previous run). Must be called 
+        * after setInputTarget ().
+        * \param[in] covariances one regularized covariance matrix per target point
+        * \return false if the number of matrices does not match the target size
+        */
+      bool
+      setTargetCovariances (const std::vector<Eigen::Matrix3d> &covariances);
+
+      /** \brief Get the covariance matrices of the target points, computing them first 
+        * if needed. 
+        */
+      inline const std::vector<Eigen::Matrix3d>&
+      getTargetCovariances ()
+      {
+        computeTargetCovariances ();
+        return (target_covariances_);
+      }
+
+      /** \brief Save the target covariance matrices to a binary file, computing them 
+        * first if needed.
+        * \param[in] file_name the name of the file to write to
+        * \return true on success
+        */
+      bool
+      saveTargetCovariances (const std::string &file_name);
+
+      /** \brief Load target covariance matrices previously written by 
+        * saveTargetCovariances (). Must be called after setInputTarget (); the file is 
+        * rejected if it was written for a target of a different size.
+        * \param[in] file_name the name of the file to read from
+        * \return true on success
+        */
+      bool
+      loadTargetCovariances (const std::string &file_name);
+
       /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using an iterative
         * non-linear Levenberg-Marquardt approach.
         * \param[in] cloud_src the source point cloud dataset
@@ -196,7 +245,12 @@ namespace pcl
         * \param k the number of neighbors to use when computing covariances
         */
       void
-      setCorrespondenceRandomness (int k) { k_correspondences_ = k; }
+      setCorrespondenceRandomness (int k) 
+      { 
+        if (k != k_correspondences_)
+          input_covariances_valid_ = target_covariances_valid_ = false;
+        k_correspondences_ = k; 
+      }
 
       /** \brief Get the number of neighbors used when computing covariances as set by 
         * the user 
@@ -263,14 +317,21 @@ namespace pcl
       /** \brief maximum number of optimizations */
       int max_inner_iterations_;
 
+      /** \brief True if input_covariances_ hold the covariances of the current input. */
+      bool input_covariances_valid_;
+
+      /** \brief True if target_covariances_ hold the covariances of the current target. */
+      bool target_covariances_valid_;
+
       /** \brief compute points covariances matrices according to the K nearest 
         * neighbors. K is set via setCorrespondenceRandomness() methode.
         * \param cloud pointer to point cloud
         * \param tree KD tree performer for nearest neighbors search
         * \return cloud_covariance covariances matrices for each point in the cloud
+        * \return false if the cloud has fewer points than the number of neighbors
         */
       template<typename PointT>
-      void computeCovariances(typename pcl::PointCloud<PointT>::ConstPtr cloud, 
+      bool computeCovariances(typename pcl::PointCloud<PointT>::ConstPtr cloud, 
                               const typename pcl::KdTree<PointT>::Ptr tree,
                               std::vector<Eigen::Matrix3d>& cloud_covariances);
 
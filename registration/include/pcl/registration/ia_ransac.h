@@ -40,11 +40,19 @@
 
 #include <pcl/registration/registration.h>
 #include <pcl/registration/transformation_estimation_svd.h>
+#include <boost/random/mersenne_twister.hpp>
 
 namespace pcl
 {
   /** \brief @b SampleConsensusInitialAlignment is an implementation of the initial alignment algorithm described in
     *  section IV of "Fast Point Feature Histograms (FPFH) for 3D Registration," Rusu et al.
+    *
+    * The hypotheses can be generated and scored in parallel (see setNumberOfThreads). Each hypothesis draws its
+    * samples from its own random number generator, seeded from rand () and the hypothesis index, and relaxes the
+    * minimum sample distance on its own, starting from \ref setMinSampleDistance, so the result does not depend on
+    * the number of threads. Scoring stops as soon as a hypothesis is worse than the best one found so far, starting
+    * with a subsample of the source cloud so that bad hypotheses are rejected cheaply.
+    *
     * \author Michael Dixon, Radu B. Rusu
     * \ingroup registration
     */
@@ -128,7 +136,10 @@ namespace pcl
         input_features_ (), target_features_ (), 
         nr_samples_(3), min_sample_distance_ (0.0f), k_correspondences_ (10), 
         feature_tree_ (new pcl::KdTreeFLANN<FeatureT>),
-        error_functor_ ()
+        error_functor_ (),
+        threads_ (1),
+        max_computation_time_ (0),
+        nr_hypotheses_ (0)
       {
         reg_name_ = "SampleConsensusInitialAlignment";
         max_iterations_ = 1000;
@@ -199,12 +210,44 @@ namespace pcl
       boost::shared_ptr<ErrorFunctor>
       getErrorFunction () { return (error_functor_); }
 
+      /** \brief Set the number of threads generating and scoring hypotheses.
+        * \note The transformation estimation is never called concurrently, the feature and target trees are.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      /** \brief Set a time budget after which no new hypotheses are drawn, even if the maximum number of 
+        * iterations has not been reached. At least one hypothesis is always scored.
+        * \param[in] seconds the time budget in seconds (0 disables it)
+        */
+      inline void
+      setMaximumComputationTime (double seconds) { max_computation_time_ = seconds; }
+
+      /** \brief Get the time budget in seconds (0 if disabled). */
+      inline double
+      getMaximumComputationTime () const { return (max_computation_time_); }
+
+      /** \brief Get the number of hypotheses scored during the last alignment. */
+      inline int
+      getNumberOfHypotheses () const { return (nr_hypotheses_); }
+
     protected:
       /** \brief Choose a random index between 0 and n-1
         * \param n the number of possible indices to choose from
         */
       inline int 
       getRandomIndex (int n) { return (static_cast<int> (n * (rand () / (RAND_MAX + 1.0)))); };
+
+      /** \brief Choose a random index between 0 and n-1 with the given generator
+        * \param rng the random number generator
+        * \param n the number of possible indices to choose from
+        */
+      inline int 
+      getRandomIndex (boost::mt19937 &rng, int n) const
+      { 
+        return (static_cast<int> (n * (static_cast<double> (rng ()) / (static_cast<double> ((boost::mt19937::max) ()) + 1.0)))); 
+      }
       
       /** \brief Select \a nr_samples sample points from cloud while making sure that their pairwise distances are 
         * greater than a user-defined minimum distance, \a min_sample_distance.
@@ -217,6 +260,18 @@ namespace pcl
       selectSamples (const PointCloudSource &cloud, int nr_samples, float min_sample_distance, 
                      std::vector<int> &sample_indices);
 
+      /** \brief Select \a nr_samples sample points from cloud with the given generator, relaxing 
+        * \a min_sample_distance if no valid sample can be found.
+        * \param cloud the input point cloud
+        * \param nr_samples the number of samples to select
+        * \param min_sample_distance the minimum distance between any two samples, halved on every relaxation
+        * \param sample_indices the resulting sample indices
+        * \param rng the random number generator
+        */
+      void 
+      selectSamples (const PointCloudSource &cloud, int nr_samples, float &min_sample_distance, 
+                     std::vector<int> &sample_indices, boost::mt19937 &rng) const;
+
       /** \brief For each of the sample points, find a list of points in the target cloud whose features are similar to 
         * the sample points' features. From these, select one randomly which will be considered that sample point's 
         * correspondence. 
@@ -228,6 +283,16 @@ namespace pcl
       findSimilarFeatures (const FeatureCloud &input_features, const std::vector<int> &sample_indices, 
                            std::vector<int> &corresponding_indices);
 
+      /** \brief Find a random correspondence for each of the sample points with the given generator.
+        * \param input_features a cloud of feature descriptors
+        * \param sample_indices the indices of each sample point
+        * \param corresponding_indices the resulting indices of each sample's corresponding point in the target cloud
+        * \param rng the random number generator
+        */
+      void 
+      findSimilarFeatures (const FeatureCloud &input_features, const std::vector<int> &sample_indices, 
+                           std::vector<int> &corresponding_indices, boost::mt19937 &rng) const;
+
       /** \brief An error metric for that computes the quality of the alignment between the given cloud and the target.
         * \param cloud the input cloud
         * \param threshold distances greater than this value are capped
@@ -235,6 +300,17 @@ namespace pcl
       float 
       computeErrorMetric (const PointCloudSource &cloud, float threshold);
 
+      /** \brief Compute the error metric of the input cloud transformed by the given transformation, without 
+        * transforming the whole cloud. The points are visited in strides, so that the first ones form a 
+        * subsample of the cloud, and the computation stops as soon as the error exceeds \a max_error.
+        * \note This assumes that the error function is not negative.
+        * \param transformation the transformation to score
+        * \param max_error the error above which the computation can stop
+        * \return the error, or a partial error greater than max_error
+        */
+      float 
+      computeErrorMetric (const Eigen::Matrix4f &transformation, float max_error) const;
+
       /** \brief Rigid transformation computation method.
         * \param output the transformed input point cloud dataset using the rigid transformation found
         */
@@ -261,6 +337,15 @@ namespace pcl
 
       /** */
       boost::shared_ptr<ErrorFunctor> error_functor_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief The time budget in seconds, 0 if disabled. */
+      double max_computation_time_;
+
+      /** \brief The number of hypotheses scored during the last alignment. */
+      int nr_hypotheses_;
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -98,14 +98,27 @@ namespace pcl
 
     public:
       /** \brief Empty constructor. */
-      IterativeClosestPoint () 
+      IterativeClosestPoint () : threads_ (1)
       {
         reg_name_ = "IterativeClosestPoint";
         ransac_iterations_ = 1000;
         transformation_estimation_.reset (new pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>);
       };
 
+      /** \brief Set the number of threads to use for the correspondence search in each iteration.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
     protected:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+
       /** \brief Rigid transformation computation method  with initial guess.
         * \param output the transformed input point cloud dataset using the rigid transformation found
         * \param guess the initial guess of the transformation to compute
@@ -38,6 +38,8 @@
 #ifndef PCL_REGISTRATION_IMPL_CORRESPONDENCE_ESTIMATION_H_
 #define PCL_REGISTRATION_IMPL_CORRESPONDENCE_ESTIMATION_H_
 
+#include <boost/mpl/contains.hpp>
+#include <pcl/point_types.h>
 #include <pcl/common/concatenate.h>
 //#include <pcl/registration/correspondence_estimation.h>
 
@@ -55,6 +57,36 @@ pcl::registration::CorrespondenceEstimation<PointSource, PointTarget>::setInputT
   tree_->setInputCloud (target_);
 }
 
+namespace pcl
+{
+  namespace registration
+  {
+    namespace detail
+    {
+      /** \brief Apply a rigid transformation to the x, y, z coordinates of a point, if it has them. */
+      template <typename PointT> inline void
+      transformCoordinates (const Eigen::Matrix4f &transformation, PointT &pt, boost::mpl::true_)
+      {
+        const Eigen::Vector3f p (pt.x, pt.y, pt.z);
+        const Eigen::Vector3f tp = transformation.topLeftCorner<3, 3> () * p + transformation.block<3, 1> (0, 3);
+        pt.x = tp[0]; pt.y = tp[1]; pt.z = tp[2];
+      }
+
+      template <typename PointT> inline void
+      transformCoordinates (const Eigen::Matrix4f &, PointT &, boost::mpl::false_)
+      {
+      }
+
+      template <typename PointT> inline void
+      transformCoordinates (const Eigen::Matrix4f &transformation, PointT &pt)
+      {
+        typedef typename pcl::traits::fieldList<PointT>::type FieldList;
+        transformCoordinates (transformation, pt, typename boost::mpl::contains<FieldList, pcl::fields::x>::type ());
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget> void
 pcl::registration::CorrespondenceEstimation<PointSource, PointTarget>::determineCorrespondences (
@@ -73,32 +105,52 @@ pcl::registration::CorrespondenceEstimation<PointSource, PointTarget>::determine
 
   float max_dist_sqr = max_distance * max_distance;
 
-  correspondences.resize (indices_->size ());
-  std::vector<int> index (1);
-  std::vector<float> distance (1);
-  pcl::Correspondence corr;
-  for (size_t i = 0; i < indices_->size (); ++i)
+  // Every source point writes its own slot, so the result does not depend on the number of threads
+  const int nr_points = static_cast<int> (indices_->size ());
+  std::vector<int> matches (nr_points, -1);
+  std::vector<float> distances (nr_points);
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel shared (matches, distances) num_threads (threads_)
+#endif
   {
-    // Copy the source data to a target PointTarget format so we can search in the tree
-    PointTarget pt;
-    pcl::for_each_type <FieldListTarget> (pcl::NdConcatenateFunctor <PointSource, PointTarget> (
-          input_->points[(*indices_)[i]], 
-          pt));
-
-    //if (tree_->nearestKSearch (input_->points[(*indices_)[i]], 1, index, distance))
-    if (tree_->nearestKSearch (pt, 1, index, distance))
+    std::vector<int> index (1);
+    std::vector<float> distance (1);
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (static)
+#endif
+    for (int i = 0; i < nr_points; ++i)
     {
-      if (distance[0] <= max_dist_sqr)
+      // Copy the source data to a target PointTarget format so we can search in the tree
+      PointTarget pt;
+      pcl::for_each_type <FieldListTarget> (pcl::NdConcatenateFunctor <PointSource, PointTarget> (
+            input_->points[(*indices_)[i]], 
+            pt));
+      if (use_source_transformation_)
+        detail::transformCoordinates (source_transformation_, pt);
+
+      if (tree_->nearestKSearch (pt, 1, index, distance) > 0 && distance[0] <= max_dist_sqr)
       {
-        corr.index_query = static_cast<int> (i);
-        corr.index_match = index[0];
-        corr.distance = distance[0];
-        correspondences[i] = corr;
-        continue;
+        matches[i] = index[0];
+        distances[i] = distance[0];
       }
     }
-//    correspondences[i] = pcl::Correspondence(i, -1, std::numeric_limits<float>::max());
   }
+
+  // Keep the valid correspondences in source order
+  correspondences.resize (nr_points);
+  unsigned int nr_valid_correspondences = 0;
+  for (int i = 0; i < nr_points; ++i)
+  {
+    if (matches[i] < 0)
+      continue;
+    correspondences[nr_valid_correspondences].index_query = (*indices_)[i];
+    correspondences[nr_valid_correspondences].index_match = matches[i];
+    correspondences[nr_valid_correspondences].distance = distances[i];
+    ++nr_valid_correspondences;
+  }
+  correspondences.resize (nr_valid_correspondences);
+
   deinitCompute ();
 }
 
@@ -120,46 +172,79 @@ pcl::registration::CorrespondenceEstimation<PointSource, PointTarget>::determine
     return;
   }
 
-  // setup tree for reciprocal search
-  pcl::KdTreeFLANN<PointSource> tree_reciprocal;
-  tree_reciprocal.setInputCloud (input_, indices_);
+  // Setup the tree for reciprocal search, unless the one of the previous call still indexes the same source points
+  if (source_cloud_updated_ || tree_reciprocal_indices_ != *indices_)
+  {
+    tree_reciprocal_->setInputCloud (input_, indices_);
+    tree_reciprocal_indices_ = *indices_;
+    source_cloud_updated_ = false;
+  }
+
+  // Target points are moved into the frame the source tree was built in
+  Eigen::Matrix4f target_to_source = Eigen::Matrix4f::Identity ();
+  if (use_source_transformation_)
+  {
+    target_to_source.topLeftCorner<3, 3> () = source_transformation_.topLeftCorner<3, 3> ().transpose ();
+    target_to_source.block<3, 1> (0, 3) = -target_to_source.topLeftCorner<3, 3> () * source_transformation_.block<3, 1> (0, 3);
+  }
 
-  correspondences.resize (indices_->size());
-  std::vector<int> index (1);
-  std::vector<float> distance (1);
-  std::vector<int> index_reciprocal (1);
-  std::vector<float> distance_reciprocal (1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
+  const int nr_points = static_cast<int> (indices_->size ());
+  std::vector<int> matches (nr_points, -1);
+  std::vector<float> distances (nr_points);
 
-  for (size_t i = 0; i < indices_->size (); ++i)
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel shared (matches, distances, target_to_source) num_threads (threads_)
+#endif
   {
-    // Copy the source data to a target PointTarget format so we can search in the tree
-    PointTarget pt_src;
-    pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointSource, PointTarget> (
-          input_->points[(*indices_)[i]], 
-          pt_src));
-
-    //tree_->nearestKSearch (input_->points[(*indices_)[i]], 1, index, distance);
-    tree_->nearestKSearch (pt_src, 1, index, distance);
-
-    // Copy the target data to a target PointSource format so we can search in the tree_reciprocal
-    PointSource pt_tgt;
-    pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointTarget, PointSource> (
-          target_->points[index[0]],
-          pt_tgt));
-    //tree_reciprocal.nearestKSearch (target_->points[index[0]], 1, index_reciprocal, distance_reciprocal);
-    tree_reciprocal.nearestKSearch (pt_tgt, 1, index_reciprocal, distance_reciprocal);
-
-    if ((*indices_)[i] == index_reciprocal[0])
+    std::vector<int> index (1);
+    std::vector<float> distance (1);
+    std::vector<int> index_reciprocal (1);
+    std::vector<float> distance_reciprocal (1);
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (static)
+#endif
+    for (int i = 0; i < nr_points; ++i)
     {
-      corr.index_query = (*indices_)[i];
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences] = corr;
-      ++nr_valid_correspondences;
+      // Copy the source data to a target PointTarget format so we can search in the tree
+      PointTarget pt_src;
+      pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointSource, PointTarget> (
+            input_->points[(*indices_)[i]], 
+            pt_src));
+      if (use_source_transformation_)
+        detail::transformCoordinates (source_transformation_, pt_src);
+
+      if (tree_->nearestKSearch (pt_src, 1, index, distance) == 0)
+        continue;
+
+      // Copy the target data to a target PointSource format so we can search in the tree_reciprocal
+      PointSource pt_tgt;
+      pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointTarget, PointSource> (
+            target_->points[index[0]],
+            pt_tgt));
+      if (use_source_transformation_)
+        detail::transformCoordinates (target_to_source, pt_tgt);
+
+      if (tree_reciprocal_->nearestKSearch (pt_tgt, 1, index_reciprocal, distance_reciprocal) > 0 &&
+          (*indices_)[i] == index_reciprocal[0])
+      {
+        matches[i] = index[0];
+        distances[i] = distance[0];
+      }
     }
   }
+
+  // Keep the reciprocal correspondences in source order
+  correspondences.resize (nr_points);
+  unsigned int nr_valid_correspondences = 0;
+  for (int i = 0; i < nr_points; ++i)
+  {
+    if (matches[i] < 0)
+      continue;
+    correspondences[nr_valid_correspondences].index_query = (*indices_)[i];
+    correspondences[nr_valid_correspondences].index_match = matches[i];
+    correspondences[nr_valid_correspondences].distance = distances[i];
+    ++nr_valid_correspondences;
+  }
   correspondences.resize (nr_valid_correspondences);
 
   deinitCompute ();
@@ -48,24 +48,27 @@ pcl::registration::CorrespondenceRejectorDistance::getRemainingCorrespondences (
   remaining_correspondences.resize (original_correspondences.size ());
   for (size_t i = 0; i < original_correspondences.size (); ++i)
   {
-    if (data_container_)
+    if (isCorrespondenceValid (original_correspondences[i]))
     {
-      if (data_container_->getCorrespondenceScore (original_correspondences[i]) < max_distance_)
-      {
-        remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
-        ++number_valid_correspondences;
-      }
-    }
-    else
-    {
-      if (original_correspondences[i].distance < max_distance_)
-      {
-        remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
-        ++number_valid_correspondences;
-      }
+      remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
+      ++number_valid_correspondences;
     }
   }
   remaining_correspondences.resize (number_valid_correspondences);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorDistance::removeRejectedCorrespondences (
+    pcl::Correspondences &correspondences)
+{
+  size_t number_valid_correspondences = 0;
+  for (size_t i = 0; i < correspondences.size (); ++i)
+  {
+    if (isCorrespondenceValid (correspondences[i]))
+      correspondences[number_valid_correspondences++] = correspondences[i];
+  }
+  correspondences.resize (number_valid_correspondences);
+}
+
 #endif /* PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_DISTANCE_HPP_ */
@@ -46,35 +46,45 @@ pcl::registration::CorrespondenceRejectorMedianDistance::getRemainingCorresponde
     const pcl::Correspondences& original_correspondences, 
     pcl::Correspondences& remaining_correspondences)
 {
+  remaining_correspondences = original_correspondences;
+  removeRejectedCorrespondences (remaining_correspondences);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorMedianDistance::removeRejectedCorrespondences (
+    pcl::Correspondences &correspondences)
+{
+  if (correspondences.empty ())
+    return;
+
   std::vector <double> dists;
-  dists.resize (original_correspondences.size ());
+  dists.resize (correspondences.size ());
 
-  for (size_t i = 0; i < original_correspondences.size (); ++i)
+  for (size_t i = 0; i < correspondences.size (); ++i)
   {
     if (data_container_)
     {
-      dists[i] = data_container_->getCorrespondenceScore (original_correspondences[i]);
+      dists[i] = data_container_->getCorrespondenceScore (correspondences[i]);
     }
     else
     {
-      dists[i] = original_correspondences[i].distance;
+      dists[i] = correspondences[i].distance;
     }
   }
-  nth_element (dists.begin (), dists.begin () + (dists.size () / 2), dists.end ());
-  median_distance_ = dists [dists.size () / 2];
 
-  unsigned int number_valid_correspondences = 0;
-  remaining_correspondences.resize (original_correspondences.size ());
+  // nth_element reorders its input, so the median is selected on a copy
+  std::vector <double> sorted_dists (dists);
+  nth_element (sorted_dists.begin (), sorted_dists.begin () + (sorted_dists.size () / 2), sorted_dists.end ());
+  median_distance_ = sorted_dists [sorted_dists.size () / 2];
 
-  for (size_t i = 0; i < original_correspondences.size (); ++i)
+  size_t number_valid_correspondences = 0;
+  for (size_t i = 0; i < correspondences.size (); ++i)
   {
-    if ( dists[i] < median_distance_ * factor_)
-    {
-      remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
-      ++number_valid_correspondences;
-    }
+    if (dists[i] < median_distance_ * factor_)
+      correspondences[number_valid_correspondences++] = correspondences[i];
   }
-  remaining_correspondences.resize (number_valid_correspondences);
+  correspondences.resize (number_valid_correspondences);
 }
 
 #endif /* PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_MEDIAN_DISTANCE_HPP_ */
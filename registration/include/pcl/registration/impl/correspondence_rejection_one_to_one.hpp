@@ -44,26 +44,30 @@ pcl::registration::CorrespondenceRejectorOneToOne::getRemainingCorrespondences (
     const pcl::Correspondences& original_correspondences, 
     pcl::Correspondences& remaining_correspondences)
 {
-  /* not really an efficient implementation */
-  pcl::Correspondences input = original_correspondences;
+  remaining_correspondences = original_correspondences;
+  removeRejectedCorrespondences (remaining_correspondences);
+}
 
-  std::sort (input.begin (), input.end (), pcl::registration::sortCorrespondencesByMatchIndexAndDistance ());
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorOneToOne::removeRejectedCorrespondences (
+    pcl::Correspondences &correspondences)
+{
+  std::sort (correspondences.begin (), correspondences.end (), pcl::registration::sortCorrespondencesByMatchIndexAndDistance ());
 
-  remaining_correspondences.resize (input.size ());
   int index_last = -1;
-  unsigned int number_valid_correspondences = 0;
-  for (size_t i = 0; i < input.size (); ++i)
+  size_t number_valid_correspondences = 0;
+  for (size_t i = 0; i < correspondences.size (); ++i)
   {
-    if (input[i].index_match < 0)
+    if (correspondences[i].index_match < 0)
       continue;
-    else if (input[i].index_match != index_last)
+    else if (correspondences[i].index_match != index_last)
     {
-      remaining_correspondences[number_valid_correspondences] = input[i];
-      index_last = input[i].index_match;
-      ++number_valid_correspondences;
+      index_last = correspondences[i].index_match;
+      correspondences[number_valid_correspondences++] = correspondences[i];
     }
   }
-  remaining_correspondences.resize (number_valid_correspondences);
+  correspondences.resize (number_valid_correspondences);
 }
 
 #endif /* PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_ONE_TO_ONE_HPP_ */
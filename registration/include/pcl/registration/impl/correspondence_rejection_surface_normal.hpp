@@ -50,13 +50,29 @@ pcl::registration::CorrespondenceRejectorSurfaceNormal::getRemainingCorresponden
   remaining_correspondences.resize (original_correspondences.size ());
   for (size_t i = 0; i < original_correspondences.size (); ++i)
   {
-    if (boost::static_pointer_cast<DataContainer<pcl::PointXYZ, pcl::PointNormal> > 
-        (data_container_)->getCorrespondenceScoreFromNormals (original_correspondences[i]) > threshold_)
+    if (isCorrespondenceValid (original_correspondences[i]))
     {
       remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
       ++number_valid_correspondences;
     }
   }
+  remaining_correspondences.resize (number_valid_correspondences);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorSurfaceNormal::removeRejectedCorrespondences (
+    pcl::Correspondences &correspondences)
+{
+  assert (data_container_ && "DataContainer object is not initialized");
+
+  size_t number_valid_correspondences = 0;
+  for (size_t i = 0; i < correspondences.size (); ++i)
+  {
+    if (isCorrespondenceValid (correspondences[i]))
+      correspondences[number_valid_correspondences++] = correspondences[i];
+  }
+  correspondences.resize (number_valid_correspondences);
 }
 
 #endif /* PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_SURFACE_NORMAL_HPP_ */
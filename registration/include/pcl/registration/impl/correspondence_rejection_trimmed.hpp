@@ -44,16 +44,26 @@ pcl::registration::CorrespondenceRejectorTrimmed::getRemainingCorrespondences (
     const pcl::Correspondences& original_correspondences, 
     pcl::Correspondences& remaining_correspondences)
 {
-  /* not really an efficient implementation */
   remaining_correspondences = original_correspondences;
-  unsigned int number_valid_correspondences = (int (std::floor (overlap_ratio_ * static_cast<float> (remaining_correspondences.size ()))));
+  removeRejectedCorrespondences (remaining_correspondences);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorTrimmed::removeRejectedCorrespondences (
+    pcl::Correspondences &correspondences)
+{
+  unsigned int number_valid_correspondences = (int (std::floor (overlap_ratio_ * static_cast<float> (correspondences.size ()))));
   number_valid_correspondences = std::max (number_valid_correspondences, nr_min_correspondences_);
 
-  if (number_valid_correspondences < remaining_correspondences.size ())
+  if (number_valid_correspondences < correspondences.size ())
   {
-    std::sort (remaining_correspondences.begin (), remaining_correspondences.end (), 
+    // select the kept part first, so that only it has to be sorted
+    std::nth_element (correspondences.begin (), correspondences.begin () + number_valid_correspondences, correspondences.end (), 
+                      pcl::registration::sortCorrespondencesByDistance ());
+    correspondences.resize (number_valid_correspondences);
+    std::sort (correspondences.begin (), correspondences.end (), 
                pcl::registration::sortCorrespondencesByDistance ());
-    remaining_correspondences.resize (number_valid_correspondences);
   }
 }
 
@@ -41,11 +41,13 @@
 #define PCL_REGISTRATION_IMPL_ELCH_H_
 
 #include <list>
+#include <vector>
 #include <algorithm>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <boost/tuple/tuple.hpp>
 
 #include <Eigen/Geometry>
 
@@ -54,13 +56,13 @@
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::registration::ELCH<PointT>::loopOptimizerAlgorithm (LOAGraph &g, double *weights)
+pcl::registration::ELCH<PointT>::loopOptimizerAlgorithm (LOAGraph &g, int f, int l, double *weights)
 {
   std::list<int> crossings, branches;
-  crossings.push_back (static_cast<int> (loop_start_));
-  crossings.push_back (static_cast<int> (loop_end_));
-  weights[loop_start_] = 0;
-  weights[loop_end_] = 1;
+  crossings.push_back (f);
+  crossings.push_back (l);
+  weights[f] = 0;
+  weights[l] = 1;
 
   int *p = new int[num_vertices (g)];
   int *p_min = new int[num_vertices (g)];
@@ -153,6 +155,17 @@ pcl::registration::ELCH<PointT>::loopOptimizerAlgorithm (LOAGraph &g, double *we
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::registration::ELCH<PointT>::getTransformedCloud (
+    const typename boost::graph_traits<LoopGraph>::vertex_descriptor &vd, PointCloud &cloud) const
+{
+  if (vd < pending_transforms_.size () && !pending_transforms_[vd].matrix ().isIdentity (0))
+    pcl::transformPointCloud (*(*loop_graph_)[vd].cloud, cloud, pending_transforms_[vd]);
+  else
+    cloud = *(*loop_graph_)[vd].cloud;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::registration::ELCH<PointT>::initCompute ()
@@ -173,17 +186,25 @@ pcl::registration::ELCH<PointT>::initCompute ()
   //compute transformation if it's not given
   if (compute_loop_)
   {
+    // register the scans where they would be if all pending corrections were applied
     PointCloudPtr meta_start (new PointCloud);
     PointCloudPtr meta_end (new PointCloud);
-    *meta_start = *(*loop_graph_)[loop_start_].cloud;
-    *meta_end = *(*loop_graph_)[loop_end_].cloud;
+    PointCloud neighbor;
+    getTransformedCloud (loop_start_, *meta_start);
+    getTransformedCloud (loop_end_, *meta_end);
 
     typename boost::graph_traits<LoopGraph>::adjacency_iterator si, si_end;
     for (boost::tuples::tie (si, si_end) = adjacent_vertices (loop_start_, *loop_graph_); si != si_end; si++)
-      *meta_start += *(*loop_graph_)[*si].cloud;
+    {
+      getTransformedCloud (*si, neighbor);
+      *meta_start += neighbor;
+    }
 
     for (boost::tuples::tie (si, si_end) = adjacent_vertices (loop_end_, *loop_graph_); si != si_end; si++)
-      *meta_end += *(*loop_graph_)[*si].cloud;
+    {
+      getTransformedCloud (*si, neighbor);
+      *meta_end += neighbor;
+    }
 
     //TODO use real pose instead of centroid
     //Eigen::Vector4f pose_start;
@@ -222,22 +243,126 @@ pcl::registration::ELCH<PointT>::compute ()
     return;
   }
 
-  LOAGraph grb[4];
+  // All four components (x, y, z, rotation) are balanced over the same edge
+  // weights, so a single run of the loop optimizer yields the weights for all of them.
+  const int nr_vertices = static_cast<int> (num_vertices (*loop_graph_));
+  const int start = static_cast<int> (loop_start_), end = static_cast<int> (loop_end_);
 
+  // Flat adjacency of the loop graph, with the new loop closure as an extra edge
+  std::vector<std::vector<std::pair<int, int> > > adjacency (nr_vertices);
+  std::vector<std::pair<int, int> > edge_list;
   typename boost::graph_traits<LoopGraph>::edge_iterator edge_it, edge_it_end;
   for (boost::tuples::tie (edge_it, edge_it_end) = edges (*loop_graph_); edge_it != edge_it_end; edge_it++)
   {
-    for (int j = 0; j < 4; j++)
-      add_edge (source (*edge_it, *loop_graph_), target (*edge_it, *loop_graph_), 1, grb[j]);  //TODO add variance
+    const int u = static_cast<int> (source (*edge_it, *loop_graph_)), v = static_cast<int> (target (*edge_it, *loop_graph_));
+    adjacency[u].push_back (std::make_pair (v, static_cast<int> (edge_list.size ())));
+    adjacency[v].push_back (std::make_pair (u, static_cast<int> (edge_list.size ())));
+    edge_list.push_back (std::make_pair (u, v));
+  }
+  const int closure = static_cast<int> (edge_list.size ());
+  adjacency[start].push_back (std::make_pair (end, closure));
+  adjacency[end].push_back (std::make_pair (start, closure));
+
+  // Only the scans on a cycle through the new loop closure are balanced. Everything else hangs
+  // off one of them through bridges and just follows it, so the optimizer runs on the
+  // 2-edge-connected component of the loop instead of on the whole graph.
+  std::vector<bool> bridge (closure + 1, false);
+  {
+    std::vector<int> order (nr_vertices, -1), low (nr_vertices, 0);
+    // (vertex, edge it was reached through, next adjacency entry to visit)
+    std::vector<boost::tuple<int, int, size_t> > stack;
+    int counter = 0;
+    order[start] = low[start] = counter++;
+    stack.push_back (boost::make_tuple (start, -1, size_t (0)));
+    while (!stack.empty ())
+    {
+      const int u = stack.back ().get<0> (), parent_edge = stack.back ().get<1> ();
+      size_t &next = stack.back ().get<2> ();
+      if (next < adjacency[u].size ())
+      {
+        const int v = adjacency[u][next].first, e = adjacency[u][next].second;
+        ++next;
+        if (e == parent_edge)
+          continue;
+        if (order[v] < 0)
+        {
+          order[v] = low[v] = counter++;
+          stack.push_back (boost::make_tuple (v, e, size_t (0)));
+        }
+        else
+          low[u] = std::min (low[u], order[v]);
+        continue;
+      }
+      stack.pop_back ();
+      if (!stack.empty ())
+      {
+        const int parent = stack.back ().get<0> ();
+        low[parent] = std::min (low[parent], low[u]);
+        if (low[u] > order[parent])
+          bridge[parent_edge] = true;
+      }
+    }
   }
 
-  double *weights[4];
-  for (int i = 0; i < 4; i++)
+  std::vector<bool> in_loop (nr_vertices, false);
+  std::vector<int> queue (1, start);
+  in_loop[start] = true;
+  for (size_t q = 0; q < queue.size (); ++q)
+    for (size_t k = 0; k < adjacency[queue[q]].size (); ++k)
+    {
+      const int v = adjacency[queue[q]][k].first;
+      if (!bridge[adjacency[queue[q]][k].second] && !in_loop[v])
+      {
+        in_loop[v] = true;
+        queue.push_back (v);
+      }
+    }
+  // Start and end are not connected: balance the whole graph, as the optimizer did before
+  if (!in_loop[end])
+    in_loop.assign (nr_vertices, true);
+
+  // Number the loop vertices and add their edges in graph order, so that the optimizer
+  // visits them in the same order as on the whole graph
+  std::vector<int> loop_index (nr_vertices, -1);
+  int nr_loop_vertices = 0;
+  for (int i = 0; i < nr_vertices; i++)
+    if (in_loop[i])
+      loop_index[i] = nr_loop_vertices++;
+  LOAGraph grb (nr_loop_vertices);
+  for (int e = 0; e < closure; e++)
+    if (in_loop[edge_list[e].first] && in_loop[edge_list[e].second])
+      add_edge (loop_index[edge_list[e].first], loop_index[edge_list[e].second], 1, grb);  //TODO add variance
+  nr_optimized_vertices_ = nr_loop_vertices;
+
+  std::vector<double> loop_weights (nr_loop_vertices, 0.0);
+  loopOptimizerAlgorithm (grb, loop_index[start], loop_index[end], &loop_weights[0]);
+
+  // scans that are not reached from the loop keep their pose, the others follow the loop scan they hang off
+  std::vector<double> weights (nr_vertices, 0.0);
+  for (int i = 0; i < nr_vertices; i++)
+    if (in_loop[i])
+      weights[i] = loop_weights[loop_index[i]];
+  std::vector<bool> visited (in_loop);
+  for (int i = 0; i < nr_vertices; i++)
   {
-    weights[i] = new double[num_vertices (*loop_graph_)];
-    loopOptimizerAlgorithm (grb[i], weights[i]);
+    if (!in_loop[i] || weights[i] == 0)
+      continue;
+    queue.assign (1, i);
+    for (size_t q = 0; q < queue.size (); ++q)
+      for (size_t k = 0; k < adjacency[queue[q]].size (); ++k)
+      {
+        const int v = adjacency[queue[q]][k].first;
+        if (!visited[v])
+        {
+          visited[v] = true;
+          weights[v] = weights[i];
+          queue.push_back (v);
+        }
+      }
   }
 
+  pending_transforms_.resize (nr_vertices, Eigen::Affine3f::Identity ());
+
   //TODO use pose
   //Eigen::Vector4f cend;
   //pcl::compute3DCentroid (*((*loop_graph_)[loop_end_].cloud), cend);
@@ -245,32 +370,57 @@ pcl::registration::ELCH<PointT>::compute ()
   //Eigen::Affine3f aend (tend);
   //Eigen::Affine3f aendI = aend.inverse ();
 
-  //TODO iterate ovr loop_graph_
-  //typename boost::graph_traits<LoopGraph>::vertex_iterator vertex_it, vertex_it_end;
-  //for (boost::tuples::tie (vertex_it, vertex_it_end) = vertices (*loop_graph_); vertex_it != vertex_it_end; vertex_it++)
-  for (size_t i = 0; i < num_vertices (*loop_graph_); i++)
+  const Eigen::Affine3f bl (loop_transform_);
+  const Eigen::Quaternionf q (bl.rotation ());
+
+  int nr_updated = 0;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:nr_updated) num_threads(threads_)
+#endif
+  for (int i = 0; i < nr_vertices; i++)
   {
-    Eigen::Vector3f t2;
-    t2[0] = loop_transform_ (0, 3) * static_cast<float> (weights[0][i]);
-    t2[1] = loop_transform_ (1, 3) * static_cast<float> (weights[1][i]);
-    t2[2] = loop_transform_ (2, 3) * static_cast<float> (weights[2][i]);
+    // a zero weight yields the identity, so the scan does not move
+    if (weights[i] == 0)
+      continue;
 
-    Eigen::Affine3f bl (loop_transform_);
-    Eigen::Quaternionf q (bl.rotation ());
+    Eigen::Vector3f t2 (loop_transform_.block<3, 1> (0, 3) * static_cast<float> (weights[i]));
     Eigen::Quaternionf q2;
-    q2 = Eigen::Quaternionf::Identity ().slerp (static_cast<float> (weights[3][i]), q);
+    q2 = Eigen::Quaternionf::Identity ().slerp (static_cast<float> (weights[i]), q);
 
     //TODO use rotation from branch start
     Eigen::Translation3f t3 (t2);
     Eigen::Affine3f a (t3 * q2);
     //a = aend * a * aendI;
 
-    pcl::transformPointCloud (*(*loop_graph_)[i].cloud, *(*loop_graph_)[i].cloud, a);
+    if (defer_transformation_)
+      pending_transforms_[i] = a * pending_transforms_[i];
+    else
+      pcl::transformPointCloud (*(*loop_graph_)[i].cloud, *(*loop_graph_)[i].cloud, a);
+    nr_updated++;
   }
+  nr_updated_vertices_ = nr_updated;
 
   add_edge (loop_start_, loop_end_, *loop_graph_);
 
   deinitCompute ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::registration::ELCH<PointT>::applyPendingTransformations ()
+{
+  const int nr_transforms = static_cast<int> (std::min (pending_transforms_.size (), num_vertices (*loop_graph_)));
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads_)
+#endif
+  for (int i = 0; i < nr_transforms; i++)
+  {
+    if (pending_transforms_[i].matrix ().isIdentity (0))
+      continue;
+    pcl::transformPointCloud (*(*loop_graph_)[i].cloud, *(*loop_graph_)[i].cloud, pending_transforms_[i]);
+    pending_transforms_[i].setIdentity ();
+  }
+}
+
 #endif // PCL_REGISTRATION_IMPL_ELCH_H_
@@ -36,85 +36,208 @@
  */
 
 #include <boost/unordered_map.hpp>
+#include <fstream>
+#include <pcl/common/eigen.h>
 #include <pcl/registration/exceptions.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget> 
-template<typename PointT> void
+template<typename PointT> bool
 pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(typename pcl::PointCloud<PointT>::ConstPtr cloud, 
                                                                                     const typename pcl::KdTree<PointT>::Ptr kdtree,
                                                                                     std::vector<Eigen::Matrix3d>& cloud_covariances)
 {
   if (k_correspondences_ > int (cloud->size ()))
   {
-    PCL_ERROR ("[pcl::GeneralizedIterativeClosestPoint::computeCovariances] Number or points in cloud (%zu) is less than k_correspondences_ (%zu)!\n", cloud->size (), k_correspondences_);
-    return;
+    PCL_ERROR ("[pcl::GeneralizedIterativeClosestPoint::computeCovariances] Number or points in cloud (%zu) is less than k_correspondences_ (%d)!\n", cloud->size (), k_correspondences_);
+    return (false);
   }
 
-  Eigen::Vector3d mean;
-  std::vector<int> nn_indecies; nn_indecies.reserve (k_correspondences_);
-  std::vector<float> nn_dist_sq; nn_dist_sq.reserve (k_correspondences_);
-
   // We should never get there but who knows
   if(cloud_covariances.size () < cloud->size ())
     cloud_covariances.resize (cloud->size ());
 
-  typename pcl::PointCloud<PointT>::const_iterator points_iterator = cloud->begin ();
-  std::vector<Eigen::Matrix3d>::iterator matrices_iterator = cloud_covariances.begin ();
-  for(;
-      points_iterator != cloud->end ();
-      ++points_iterator, ++matrices_iterator)
+  const int nr_points = static_cast<int> (cloud->size ());
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel num_threads (threads_)
+#endif
   {
-    const PointT &query_point = *points_iterator;
-    Eigen::Matrix3d &cov = *matrices_iterator;
-    // Zero out the cov and mean
-    cov.setZero ();
-    mean.setZero ();
-
-    // Search for the K nearest neighbours
-    kdtree->nearestKSearch(query_point, k_correspondences_, nn_indecies, nn_dist_sq);
-    
-    // Find the covariance matrix
-    for(int j = 0; j < k_correspondences_; j++) {
-      const PointT &pt = (*cloud)[nn_indecies[j]];
-      
-      mean[0] += pt.x;
-      mean[1] += pt.y;
-      mean[2] += pt.z;
-      
-      cov(0,0) += pt.x*pt.x;
-      
-      cov(1,0) += pt.y*pt.x;
-      cov(1,1) += pt.y*pt.y;
-      
-      cov(2,0) += pt.z*pt.x;
-      cov(2,1) += pt.z*pt.y;
-      cov(2,2) += pt.z*pt.z;    
-    }
-  
-    mean /= static_cast<double> (k_correspondences_);
-    // Get the actual covariance
-    for (int k = 0; k < 3; k++)
-      for (int l = 0; l <= k; l++) 
-      {
-        cov(k,l) /= static_cast<double> (k_correspondences_);
-        cov(k,l) -= mean[k]*mean[l];
-        cov(l,k) = cov(k,l);
+    Eigen::Vector3d mean;
+    std::vector<int> nn_indecies; nn_indecies.reserve (k_correspondences_);
+    std::vector<float> nn_dist_sq; nn_dist_sq.reserve (k_correspondences_);
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (dynamic, 256)
+#endif
+    for (int i = 0; i < nr_points; ++i)
+    {
+      const PointT &query_point = (*cloud)[i];
+      Eigen::Matrix3d &cov = cloud_covariances[i];
+      // Zero out the cov and mean
+      cov.setZero ();
+      mean.setZero ();
+
+      // Search for the K nearest neighbours
+      kdtree->nearestKSearch(query_point, k_correspondences_, nn_indecies, nn_dist_sq);
+
+      // Find the covariance matrix
+      for(int j = 0; j < k_correspondences_; j++) {
+        const PointT &pt = (*cloud)[nn_indecies[j]];
+
+        mean[0] += pt.x;
+        mean[1] += pt.y;
+        mean[2] += pt.z;
+
+        cov(0,0) += pt.x*pt.x;
+
+        cov(1,0) += pt.y*pt.x;
+        cov(1,1) += pt.y*pt.y;
+
+        cov(2,0) += pt.z*pt.x;
+        cov(2,1) += pt.z*pt.y;
+        cov(2,2) += pt.z*pt.z;
       }
-    
-    // Compute the SVD (covariance matrix is symmetric so U = V')
-    Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU);
-    cov.setZero ();
-    Eigen::Matrix3d U = svd.matrixU ();
-    // Reconstitute the covariance matrix with modified singular values using the column     // vectors in V.
-    for(int k = 0; k < 3; k++) {
-      Eigen::Vector3d col = U.col(k);
-      double v = 1.; // biggest 2 singular values replaced by 1
-      if(k == 2)   // smallest singular value replaced by gicp_epsilon
-        v = gicp_epsilon_;
-      cov+= v * col * col.transpose(); 
+
+      mean /= static_cast<double> (k_correspondences_);
+      // Get the actual covariance
+      for (int k = 0; k < 3; k++)
+        for (int l = 0; l <= k; l++) 
+        {
+          cov(k,l) /= static_cast<double> (k_correspondences_);
+          cov(k,l) -= mean[k]*mean[l];
+          cov(l,k) = cov(k,l);
+        }
+
+      // The covariance is reconstituted with its two biggest eigenvalues replaced by 1 
+      // and the smallest one by gicp_epsilon. As the eigenvectors form an orthonormal 
+      // basis this is I - (1 - gicp_epsilon) n n', so only the eigenvector n of the 
+      // smallest eigenvalue is needed, which eigen33 computes in closed form.
+      double min_eigenvalue;
+      Eigen::Vector3d normal;
+      pcl::eigen33 (cov, min_eigenvalue, normal);
+      // Degenerate neighborhood (all neighbors on the same spot)
+      if (!pcl_isfinite (normal[0]) || !pcl_isfinite (normal[1]) || !pcl_isfinite (normal[2]))
+        normal = Eigen::Vector3d::UnitZ ();
+      cov = Eigen::Matrix3d::Identity () - (1. - gicp_epsilon_) * normal * normal.transpose ();
     }
   }
+  return (true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTargetCovariances ()
+{
+  if (target_covariances_valid_)
+    return;
+  if (!target_)
+  {
+    PCL_ERROR ("[pcl::%s::computeTargetCovariances] No input target dataset was given!\n", getClassName ().c_str ());
+    return;
+  }
+  target_covariances_valid_ = computeCovariances<PointTarget> (target_, tree_, target_covariances_);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> bool
+pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::setTargetCovariances (const std::vector<Eigen::Matrix3d> &covariances)
+{
+  if (!target_ || covariances.size () != target_->size ())
+  {
+    PCL_ERROR ("[pcl::%s::setTargetCovariances] Expected one covariance matrix per target point (%zu), got %zu!\n", 
+               getClassName ().c_str (), target_ ? target_->size () : 0, covariances.size ());
+    return (false);
+  }
+  target_covariances_ = covariances;
+  target_covariances_valid_ = true;
+  return (true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> bool
+pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::saveTargetCovariances (const std::string &file_name)
+{
+  computeTargetCovariances ();
+  if (!target_covariances_valid_)
+    return (false);
+
+  std::ofstream fs (file_name.c_str (), std::ios::out | std::ios::binary);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::%s::saveTargetCovariances] Could not open %s for writing!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+  // Header: number of matrices followed by the parameters they were computed with
+  uint64_t nr_covariances = target_->size ();
+  fs.write (reinterpret_cast<const char*> (&nr_covariances), sizeof (nr_covariances));
+  fs.write (reinterpret_cast<const char*> (&k_correspondences_), sizeof (k_correspondences_));
+  fs.write (reinterpret_cast<const char*> (&gicp_epsilon_), sizeof (gicp_epsilon_));
+  // Only the upper triangle of each symmetric matrix is stored
+  for (size_t i = 0; i < target_->size (); ++i)
+  {
+    const Eigen::Matrix3d &cov = target_covariances_[i];
+    double upper[6] = { cov (0, 0), cov (0, 1), cov (0, 2), cov (1, 1), cov (1, 2), cov (2, 2) };
+    fs.write (reinterpret_cast<const char*> (upper), sizeof (upper));
+  }
+  fs.close ();
+  if (fs.fail ())
+  {
+    PCL_ERROR ("[pcl::%s::saveTargetCovariances] Error writing to %s!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+  return (true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> bool
+pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::loadTargetCovariances (const std::string &file_name)
+{
+  if (!target_)
+  {
+    PCL_ERROR ("[pcl::%s::loadTargetCovariances] No input target dataset was given!\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::%s::loadTargetCovariances] Could not open %s for reading!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+  uint64_t nr_covariances = 0;
+  int k = 0;
+  double epsilon = 0;
+  fs.read (reinterpret_cast<char*> (&nr_covariances), sizeof (nr_covariances));
+  fs.read (reinterpret_cast<char*> (&k), sizeof (k));
+  fs.read (reinterpret_cast<char*> (&epsilon), sizeof (epsilon));
+  if (!fs || nr_covariances != target_->size ())
+  {
+    PCL_ERROR ("[pcl::%s::loadTargetCovariances] %s does not hold covariances for a target of %zu points!\n", 
+               getClassName ().c_str (), file_name.c_str (), target_->size ());
+    return (false);
+  }
+  if (k != k_correspondences_ || epsilon != gicp_epsilon_)
+    PCL_WARN ("[pcl::%s::loadTargetCovariances] %s was computed with k = %d and epsilon = %g instead of k = %d and epsilon = %g.\n",
+              getClassName ().c_str (), file_name.c_str (), k, epsilon, k_correspondences_, gicp_epsilon_);
+
+  std::vector<Eigen::Matrix3d> covariances (target_->size ());
+  for (size_t i = 0; i < covariances.size (); ++i)
+  {
+    double upper[6];
+    fs.read (reinterpret_cast<char*> (upper), sizeof (upper));
+    Eigen::Matrix3d &cov = covariances[i];
+    cov (0, 0) = upper[0]; cov (0, 1) = cov (1, 0) = upper[1]; cov (0, 2) = cov (2, 0) = upper[2];
+    cov (1, 1) = upper[3]; cov (1, 2) = cov (2, 1) = upper[4]; 
+    cov (2, 2) = upper[5];
+  }
+  if (!fs)
+  {
+    PCL_ERROR ("[pcl::%s::loadTargetCovariances] Unexpected end of file in %s!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+  target_covariances_.swap (covariances);
+  target_covariances_valid_ = true;
+  return (true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -345,17 +468,21 @@ pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransfor
   const size_t N = indices_->size ();
   // Set the mahalanobis matrices to identity
   mahalanobis_.resize (N, Eigen::Matrix3d::Identity ());
-  // Compute target cloud covariance matrices
-  computeCovariances<PointTarget> (target_, tree_, target_covariances_);
+  // Compute target cloud covariance matrices, unless they are still valid from a 
+  // previous alignment or were provided by the user
+  computeTargetCovariances ();
   // Compute input cloud covariance matrices
-  computeCovariances<PointSource> (input_, input_tree_, input_covariances_);
+  if (!input_covariances_valid_)
+    input_covariances_valid_ = computeCovariances<PointSource> (input_, input_tree_, input_covariances_);
+  if (!target_covariances_valid_ || !input_covariances_valid_)
+    return;
 
   base_transformation_ = guess;
   nr_iterations_ = 0;
   converged_ = false;
   double dist_threshold = corr_dist_threshold_ * corr_dist_threshold_;
-  std::vector<int> nn_indices (1);
-  std::vector<float> nn_dists (1);
+  // Per source point nearest target index, -1 if rejected
+  std::vector<int> nn_targets (N);
 
   while(!converged_)
   {
@@ -370,38 +497,63 @@ pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransfor
         for(size_t k = 0; k < 4; k++)
           transform_R(i,j)+= double(transformation_(i,k)) * double(guess(k,j));
 
-    Eigen::Matrix3d R = transform_R.topLeftCorner<3,3> ();
+    const Eigen::Matrix3d R = transform_R.topLeftCorner<3,3> ();
+    const Eigen::Matrix4f current = transformation_ * guess;
 
-    for (size_t i = 0; i < N; i++)
+    int failed_idx = -1;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel num_threads (threads_)
+#endif
     {
-      PointSource query = output[i];
-      query.getVector4fMap () = guess * query.getVector4fMap ();
-      query.getVector4fMap () = transformation_ * query.getVector4fMap ();
+      std::vector<int> nn_indices (1);
+      std::vector<float> nn_dists (1);
 
-      if (!searchForNeighbors (query, nn_indices, nn_dists))
-      {
-        PCL_ERROR ("[pcl::%s::computeTransformation] Unable to find a nearest neighbor in the target dataset for point %d in the source!\n", getClassName ().c_str (), (*indices_)[i]);
-        return;
-      }
-      
-      // Check if the distance to the nearest neighbor is smaller than the user imposed threshold
-      if (nn_dists[0] < dist_threshold)
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (dynamic, 256)
+#endif
+      for (int i = 0; i < static_cast<int> (N); i++)
       {
-        Eigen::Matrix3d &C1 = input_covariances_[i];
-        Eigen::Matrix3d &C2 = target_covariances_[nn_indices[0]];
-        Eigen::Matrix3d &M = mahalanobis_[i];
-        // M = R*C1
-        M = R * C1;
-        // temp = M*R' + C2 = R*C1*R' + C2
-        Eigen::Matrix3d temp = M * R.transpose();        
-        temp+= C2;
-        // M = temp^-1
-        M = temp.inverse ();
-        source_indices[cnt] = static_cast<int> (i);
-        target_indices[cnt] = nn_indices[0];
-        cnt++;
+        nn_targets[i] = -1;
+        PointSource query = output[i];
+        query.getVector4fMap () = current * query.getVector4fMap ();
+
+        if (!searchForNeighbors (query, nn_indices, nn_dists))
+        {
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical
+#endif
+          failed_idx = (*indices_)[i];
+          continue;
+        }
+
+        // Check if the distance to the nearest neighbor is smaller than the user imposed threshold
+        if (nn_dists[0] < dist_threshold)
+        {
+          const Eigen::Matrix3d &C1 = input_covariances_[i];
+          const Eigen::Matrix3d &C2 = target_covariances_[nn_indices[0]];
+          // temp = R*C1*R' + C2
+          Eigen::Matrix3d temp = R * C1 * R.transpose ();
+          temp += C2;
+          // M = temp^-1
+          mahalanobis_[i] = temp.inverse ();
+          nn_targets[i] = nn_indices[0];
+        }
       }
     }
+    if (failed_idx != -1)
+    {
+      PCL_ERROR ("[pcl::%s::computeTransformation] Unable to find a nearest neighbor in the target dataset for point %d in the source!\n", getClassName ().c_str (), failed_idx);
+      return;
+    }
+    // Collect the valid correspondences in source order
+    for (size_t i = 0; i < N; i++)
+    {
+      if (nn_targets[i] < 0)
+        continue;
+      source_indices[cnt] = static_cast<int> (i);
+      target_indices[cnt] = nn_targets[i];
+      cnt++;
+    }
     // Resize to the actual number of valid correspondences
     source_indices.resize(cnt); target_indices.resize(cnt);
     /* optimize transformation using the current assignment and Mahalanobis metrics*/
@@ -41,6 +41,9 @@
 #define IA_RANSAC_HPP_
 
 #include <pcl/common/distances.h>
+#include <pcl/common/time.h>
+#include <pcl/common/utils.h>
+#include <limits>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget, typename FeatureT> void 
@@ -129,6 +132,66 @@ pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::select
 
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename FeatureT> void 
+pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSamples (
+    const PointCloudSource &cloud, int nr_samples, float &min_sample_distance, 
+    std::vector<int> &sample_indices, boost::mt19937 &rng) const
+{
+  if (nr_samples > static_cast<int> (cloud.points.size ()))
+  {
+    PCL_ERROR ("[pcl::%s::selectSamples] ", getClassName ().c_str ());
+    PCL_ERROR ("The number of samples (%d) must not be greater than the number of points (%zu)!\n",
+               nr_samples, cloud.points.size ());
+    return;
+  }
+
+  // Iteratively draw random samples until nr_samples is reached
+  int iterations_without_a_sample = 0;
+  int max_iterations_without_a_sample = static_cast<int> (3 * cloud.points.size ());
+  sample_indices.clear ();
+  while (static_cast<int> (sample_indices.size ()) < nr_samples)
+  {
+    // Choose a sample at random
+    int sample_index = getRandomIndex (rng, static_cast<int> (cloud.points.size ()));
+
+    // Check to see if the sample is 1) unique and 2) far away from the other samples
+    bool valid_sample = true;
+    for (size_t i = 0; i < sample_indices.size (); ++i)
+    {
+      float distance_between_samples = euclideanDistance (cloud.points[sample_index], cloud.points[sample_indices[i]]);
+
+      if (sample_index == sample_indices[i] || distance_between_samples < min_sample_distance)
+      {
+        valid_sample = false;
+        break;
+      }
+    }
+
+    // If the sample is valid, add it to the output
+    if (valid_sample)
+    {
+      sample_indices.push_back (sample_index);
+      iterations_without_a_sample = 0;
+    }
+    else
+    {
+      ++iterations_without_a_sample;
+    }
+
+    // If no valid samples can be found, relax the inter-sample distance requirements
+    if (iterations_without_a_sample >= max_iterations_without_a_sample)
+    {
+      PCL_WARN ("[pcl::%s::selectSamples] ", getClassName ().c_str ());
+      PCL_WARN ("No valid sample found after %d iterations. Relaxing min_sample_distance_ to %f\n",
+                iterations_without_a_sample, 0.5*min_sample_distance);
+
+      min_sample_distance *= 0.5f;
+      iterations_without_a_sample = 0;
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget, typename FeatureT> void 
 pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::findSimilarFeatures (
@@ -150,6 +213,27 @@ pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::findSi
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename FeatureT> void 
+pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::findSimilarFeatures (
+    const FeatureCloud &input_features, const std::vector<int> &sample_indices, 
+    std::vector<int> &corresponding_indices, boost::mt19937 &rng) const
+{
+  std::vector<int> nn_indices (k_correspondences_);
+  std::vector<float> nn_distances (k_correspondences_);
+
+  corresponding_indices.resize (sample_indices.size ());
+  for (size_t i = 0; i < sample_indices.size (); ++i)
+  {
+    // Find the k features nearest to input_features.points[sample_indices[i]]
+    feature_tree_->nearestKSearch (input_features, sample_indices[i], k_correspondences_, nn_indices, nn_distances);
+
+    // Select one at random and add it to corresponding_indices
+    int random_correspondence = getRandomIndex (rng, k_correspondences_);
+    corresponding_indices[i] = nn_indices[random_correspondence];
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget, typename FeatureT> float 
 pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeErrorMetric (
@@ -172,6 +256,40 @@ pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::comput
   return (error);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename FeatureT> float 
+pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeErrorMetric (
+    const Eigen::Matrix4f &transformation, float max_error) const
+{
+  std::vector<int> nn_index (1);
+  std::vector<float> nn_distance (1);
+
+  const ErrorFunctor & compute_error = *error_functor_;
+  const Eigen::Matrix3f rotation = transformation.topLeftCorner<3, 3> ();
+  const Eigen::Vector3f translation = transformation.block<3, 1> (0, 3);
+  const int nr_points = static_cast<int> (input_->points.size ());
+  float error = 0;
+
+  // Visit every stride-th point first, so that a bad hypothesis is rejected after a subsample of the cloud
+  const int stride = 16;
+  for (int offset = 0; offset < stride; ++offset)
+  {
+    for (int i = offset; i < nr_points; i += stride)
+    {
+      // Find the distance between the transformed point and its nearest neighbor in the target point cloud
+      PointSource point = input_->points[i];
+      point.getVector3fMap () = rotation * input_->points[i].getVector3fMap () + translation;
+      tree_->nearestKSearch (point, 1, nn_index, nn_distance);
+
+      // Compute the error, the sum can only grow from here
+      error += compute_error (nn_distance[0]);
+      if (error > max_error)
+        return (error);
+    }
+  }
+  return (error);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget, typename FeatureT> void 
 pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeTransformation (PointCloudSource &output, const Eigen::Matrix4f& guess)
@@ -194,42 +312,89 @@ pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::comput
     error_functor_.reset (new TruncatedError (static_cast<float> (corr_dist_threshold_)));
   }
 
-  std::vector<int> sample_indices (nr_samples_);
-  std::vector<int> corresponding_indices (nr_samples_);
-  PointCloudSource input_transformed;
-  float error, lowest_error (0);
-
   final_transformation_ = guess;
+  float lowest_error = std::numeric_limits<float>::max ();
+  int lowest_error_iteration = -1;
   int i_iter = 0;
   if (!guess.isApprox(Eigen::Matrix4f::Identity (), 0.01f)) 
   { //If guess is not the Identity matrix we check it.
-	  transformPointCloud (*input_, input_transformed, final_transformation_);
-	  lowest_error = computeErrorMetric (input_transformed, static_cast<float> (corr_dist_threshold_));
-	  i_iter = 1;
+    lowest_error = computeErrorMetric (final_transformation_, std::numeric_limits<float>::max ());
+    lowest_error_iteration = 0;
+    i_iter = 1;
   }
 
-  for (; i_iter < max_iterations_; ++i_iter)
+  // Every hypothesis draws its samples from its own generator, seeded from the hypothesis index, and relaxes its
+  // own copy of the minimum sample distance, so that hypotheses do not depend on the order they are drawn in
+  const unsigned int seed = static_cast<unsigned int> (rand ());
+  const int max_iterations = max_iterations_;
+  bool out_of_time = false;
+  nr_hypotheses_ = 0;
+  pcl::StopWatch watch;
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel num_threads (threads_)
+#endif
   {
-    // Draw nr_samples_ random samples
-    selectSamples (*input_, nr_samples_, min_sample_distance_, sample_indices);
+    std::vector<int> sample_indices (nr_samples_);
+    std::vector<int> corresponding_indices (nr_samples_);
+    Eigen::Matrix4f transformation;
+    boost::mt19937 rng;
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (dynamic, 1)
+#endif
+    for (int iteration = i_iter; iteration < max_iterations; ++iteration)
+    {
+      float max_error, sample_distance = min_sample_distance_;
+      bool skip;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical (sac_ia_best)
+#endif
+      {
+        // Stop drawing hypotheses once the time budget is spent and something has been scored
+        if (max_computation_time_ > 0 && lowest_error_iteration >= 0 && watch.getTimeSeconds () > max_computation_time_)
+          out_of_time = true;
+        skip = out_of_time;
+        max_error = lowest_error;
+      }
+      if (skip)
+        continue;
 
-    // Find corresponding features in the target cloud
-    findSimilarFeatures (*input_features_, sample_indices, corresponding_indices);
+      // Draw nr_samples_ random samples
+      rng.seed (pcl::utils::mixSeed (seed, static_cast<unsigned int> (iteration)));
+      selectSamples (*input_, nr_samples_, sample_distance, sample_indices, rng);
 
-    // Estimate the transform from the samples to their corresponding points
-    transformation_estimation_->estimateRigidTransformation (*input_, sample_indices, *target_, corresponding_indices, transformation_);
+      // Find corresponding features in the target cloud
+      findSimilarFeatures (*input_features_, sample_indices, corresponding_indices, rng);
 
-    // Tranform the data and compute the error
-    transformPointCloud (*input_, input_transformed, transformation_);
-    error = computeErrorMetric (input_transformed, static_cast<float> (corr_dist_threshold_));
+      // Estimate the transform from the samples to their corresponding points
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical (sac_ia_estimation)
+#endif
+      transformation_estimation_->estimateRigidTransformation (*input_, sample_indices, *target_, corresponding_indices, transformation);
 
-    // If the new error is lower, update the final transformation
-    if (i_iter == 0 || error < lowest_error)
-    {
-      lowest_error = error;
-      final_transformation_ = transformation_;
+      // Score the transformation, stopping as soon as it is worse than the best one
+      float error = computeErrorMetric (transformation, max_error);
+
+      // If the new error is lower, update the final transformation. Ties go to the first hypothesis, as in a serial run
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical (sac_ia_best)
+#endif
+      {
+        ++nr_hypotheses_;
+        if (error < lowest_error || (error == lowest_error && iteration < lowest_error_iteration))
+        {
+          lowest_error = error;
+          lowest_error_iteration = iteration;
+          final_transformation_ = transformation;
+        }
+      }
     }
   }
+  transformation_ = final_transformation_;
+  if (out_of_time)
+    PCL_DEBUG ("[pcl::%s::computeTransformation] Time budget of %g s spent after %d hypotheses.\n", 
+               getClassName ().c_str (), max_computation_time_, nr_hypotheses_);
 
   // Apply the final transformation
   transformPointCloud (*input_, output, final_transformation_);
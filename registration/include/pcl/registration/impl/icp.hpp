@@ -80,25 +80,46 @@ pcl::IterativeClosestPoint<PointSource, PointTarget>::computeTransformation (Poi
     std::vector<int> source_indices (indices_->size ());
     std::vector<int> target_indices (indices_->size ());
 
-    // Iterating over the entire index vector and  find all correspondences
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    // Find the nearest neighbors of all points in parallel, then collect the correspondences in source order
+    const int nr_points = static_cast<int> (indices_->size ());
+    std::vector<int> nn_index (nr_points, -1);
+    std::vector<float> nn_dist (nr_points);
+    int failed_idx = nr_points;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (output, nn_index, nn_dist) firstprivate (nn_indices, nn_dists) num_threads (threads_)
+#endif
+    for (int idx = 0; idx < nr_points; ++idx)
     {
       if (!this->searchForNeighbors (output, (*indices_)[idx], nn_indices, nn_dists))
       {
-        PCL_ERROR ("[pcl::%s::computeTransformation] Unable to find a nearest neighbor in the target dataset for point %d in the source!\n", getClassName ().c_str (), (*indices_)[idx]);
-        return;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical
+#endif
+        failed_idx = std::min (failed_idx, idx);
+        continue;
       }
+      nn_index[idx] = nn_indices[0];
+      nn_dist[idx] = nn_dists[0];
+    }
+    if (failed_idx < nr_points)
+    {
+      PCL_ERROR ("[pcl::%s::computeTransformation] Unable to find a nearest neighbor in the target dataset for point %d in the source!\n", getClassName ().c_str (), (*indices_)[failed_idx]);
+      return;
+    }
 
+    // Iterating over the entire index vector and  find all correspondences
+    for (int idx = 0; idx < nr_points; ++idx)
+    {
       // Check if the distance to the nearest neighbor is smaller than the user imposed threshold
-      if (nn_dists[0] < dist_threshold)
+      if (nn_dist[idx] < dist_threshold)
       {
         source_indices[cnt] = (*indices_)[idx];
-        target_indices[cnt] = nn_indices[0];
+        target_indices[cnt] = nn_index[idx];
         cnt++;
       }
 
       // Save the nn_dists[0] to a global vector of distances
-      correspondence_distances_[(*indices_)[idx]] = std::min (nn_dists[0], static_cast<float> (dist_threshold));
+      correspondence_distances_[(*indices_)[idx]] = std::min (nn_dist[idx], static_cast<float> (dist_threshold));
     }
     if (cnt < min_number_correspondences_)
     {
@@ -41,6 +41,25 @@
 #define PCL_REGISTRATION_IMPL_LUM_HPP_
 
 #include <pcl/registration/lum.h>
+#include <Eigen/SparseCholesky>
+
+namespace pcl
+{
+  namespace registration
+  {
+    namespace detail
+    {
+      /** \brief Append the 36 entries of a 6x6 block at block position (row, col) to a sparse matrix triplet list. */
+      inline void
+      appendBlock (std::vector<Eigen::Triplet<float> > &triplets, int row, int col, const Eigen::Matrix6f &block)
+      {
+        for (int c = 0; c < 6; ++c)
+          for (int r = 0; r < 6; ++r)
+            triplets.push_back (Eigen::Triplet<float> (6 * row + r, 6 * col + c, block (r, c)));
+      }
+    }
+  }
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> inline void
@@ -215,50 +234,103 @@ pcl::registration::LUM<PointT>::compute ()
     PCL_ERROR("[pcl::registration::LUM::compute] The slam graph needs at least 2 vertices.\n");
     return;
   }
+  // The edges are linearized independently of each other, so they are collected once to be spread over the threads
+  std::vector<Edge> edge_list;
+  typename SLAMGraph::edge_iterator e, e_end;
+  for (tie (e, e_end) = edges (*slam_graph_); e != e_end; ++e)
+    edge_list.push_back (*e);
+  const int nr_edges = static_cast<int> (edge_list.size ());
+
   for (int i = 0; i < max_iterations_; ++i)
   {
     // Linearized computation of C^-1 and C^-1*D and convergence checking for all edges in the graph (results stored in slam_graph_)
-    typename SLAMGraph::edge_iterator e, e_end;
-    for (tie (e, e_end) = edges (*slam_graph_); e != e_end; ++e)
-      computeEdge (*e);
-
-    // Declare matrices G and B
-    Eigen::MatrixXf G = Eigen::MatrixXf::Zero (6 * (n - 1), 6 * (n - 1));
-    Eigen::VectorXf B = Eigen::VectorXf::Zero (6 * (n - 1));
-
-    // Start at 1 because 0 is the reference pose
-    for (int vi = 1; vi != n; ++vi)
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for shared (edge_list) schedule (dynamic) num_threads (threads_)
+#endif
+    for (int ei = 0; ei < nr_edges; ++ei)
+      computeEdge (edge_list[ei]);
+
+    // Only the vertices connected to the reference pose through usable edges are solved for, the other ones would
+    // make the system singular and keep their pose
+    std::vector<std::vector<int> > neighbors (n);
+    for (int ei = 0; ei < nr_edges; ++ei)
     {
-      for (int vj = 0; vj != n; ++vj)
-      {
-        // Attempt to use the forward edge, otherwise use backward edge, otherwise there was no edge
-        Edge e;
-        bool present1, present2;
-        tie (e, present1) = edge (vi, vj, *slam_graph_);
-        if (!present1)
+      if ((*slam_graph_)[edge_list[ei]].cinv_.isZero ())
+        continue;
+      const int vs = static_cast<int> (source (edge_list[ei], *slam_graph_));
+      const int vt = static_cast<int> (target (edge_list[ei], *slam_graph_));
+      neighbors[vs].push_back (vt);
+      neighbors[vt].push_back (vs);
+    }
+    std::vector<int> system_index (n, -1);
+    std::vector<bool> connected (n, false);
+    std::vector<int> queue (1, 0);
+    connected[0] = true;
+    for (size_t qi = 0; qi < queue.size (); ++qi)
+      for (size_t ni = 0; ni < neighbors[queue[qi]].size (); ++ni)
+        if (!connected[neighbors[queue[qi]][ni]])
         {
-          tie (e, present2) = edge (vj, vi, *slam_graph_);
-          if (!present2)
-            continue;
+          connected[neighbors[queue[qi]][ni]] = true;
+          queue.push_back (neighbors[queue[qi]][ni]);
         }
+    // Start at 1 because 0 is the reference pose
+    int m = 0;
+    for (int vi = 1; vi != n; ++vi)
+      if (connected[vi])
+        system_index[vi] = m++;
+    if (m == 0)
+    {
+      PCL_WARN("[pcl::registration::LUM::compute] None of the vertices is connected to the reference pose.\n");
+      return;
+    }
 
-        // Fill in elements of G and B
-        if (vj > 0)
-          G.block (6 * (vi - 1), 6 * (vj - 1), 6, 6) = -(*slam_graph_)[e].cinv_;
-        G.block (6 * (vi - 1), 6 * (vi - 1), 6, 6) += (*slam_graph_)[e].cinv_;
-        B.segment (6 * (vi - 1), 6) += (present1 ? 1 : -1) * (*slam_graph_)[e].cinvd_;
+    // Assemble the sparse block system GX = B: every edge adds its C^-1 to the diagonal blocks of both of its
+    // vertices and subtracts it from the two blocks coupling them
+    std::vector<Eigen::Triplet<float> > triplets;
+    triplets.reserve (36 * (m + 2 * nr_edges));
+    Eigen::VectorXf B = Eigen::VectorXf::Zero (6 * m);
+    for (int ei = 0; ei < nr_edges; ++ei)
+    {
+      const Eigen::Matrix6f &cinv = (*slam_graph_)[edge_list[ei]].cinv_;
+      const Eigen::Vector6f &cinvd = (*slam_graph_)[edge_list[ei]].cinvd_;
+      if (cinv.isZero ())
+        continue;
+      const int si = system_index[source (edge_list[ei], *slam_graph_)];
+      const int ti = system_index[target (edge_list[ei], *slam_graph_)];
+      if (si >= 0)
+      {
+        detail::appendBlock (triplets, si, si, cinv);
+        B.segment (6 * si, 6) += cinvd;
+        if (ti >= 0)
+          detail::appendBlock (triplets, si, ti, -cinv);
+      }
+      if (ti >= 0)
+      {
+        detail::appendBlock (triplets, ti, ti, cinv);
+        B.segment (6 * ti, 6) -= cinvd;
+        if (si >= 0)
+          detail::appendBlock (triplets, ti, si, -cinv);
       }
     }
+    Eigen::SparseMatrix<float> G (6 * m, 6 * m);
+    G.setFromTriplets (triplets.begin (), triplets.end ());
 
     // Computation of the linear equation system: GX = B
-    // TODO investigate accuracy vs. speed tradeoff and find the best solving method for our type of linear equation (sparse)
-    Eigen::VectorXf X = G.colPivHouseholderQr ().solve (B);
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<float> > solver (G);
+    if (solver.info () != Eigen::Success)
+    {
+      PCL_ERROR("[pcl::registration::LUM::compute] The linear system could not be factorized.\n");
+      return;
+    }
+    Eigen::VectorXf X = solver.solve (B);
 
     // Update the poses
     float sum = 0.0;
     for (int vi = 1; vi != n; ++vi)
     {
-      Eigen::Vector6f difference_pose = -incidenceCorrection (getPose (vi)).inverse () * X.segment (6 * (vi - 1), 6);
+      if (system_index[vi] < 0)
+        continue;
+      Eigen::Vector6f difference_pose = -incidenceCorrection (getPose (vi)).inverse () * X.segment (6 * system_index[vi], 6);
       sum += difference_pose.norm ();
       setPose (vi, getPose (vi) + difference_pose);
     }
@@ -307,12 +379,14 @@ pcl::registration::LUM<PointT>::computeEdge (Edge e)
   // Build the average and difference vectors for all correspondences
   std::vector < Eigen::Vector3f > corrs_aver (corrs->size ());
   std::vector < Eigen::Vector3f > corrs_diff (corrs->size ());
+  const Eigen::Affine3f source_transformation = pcl::getTransformation (source_pose (0), source_pose (1), source_pose (2), source_pose (3), source_pose (4), source_pose (5));
+  const Eigen::Affine3f target_transformation = pcl::getTransformation (target_pose (0), target_pose (1), target_pose (2), target_pose (3), target_pose (4), target_pose (5));
   int oci = 0;  // oci = output correspondence iterator
   for (int ici = 0; ici != static_cast<int> (corrs->size ()); ++ici)  // ici = input correspondence iterator
   {
     // Compound the point pair onto the current pose
-    Eigen::Vector3f source_compounded = pcl::getTransformation (source_pose (0), source_pose (1), source_pose (2), source_pose (3), source_pose (4), source_pose (5)) * source_cloud->points[(*corrs)[ici].index_query].getVector3fMap ();
-    Eigen::Vector3f target_compounded = pcl::getTransformation (target_pose (0), target_pose (1), target_pose (2), target_pose (3), target_pose (4), target_pose (5)) * target_cloud->points[(*corrs)[ici].index_match].getVector3fMap ();
+    Eigen::Vector3f source_compounded = source_transformation * source_cloud->points[(*corrs)[ici].index_query].getVector3fMap ();
+    Eigen::Vector3f target_compounded = target_transformation * target_cloud->points[(*corrs)[ici].index_match].getVector3fMap ();
 
     // NaN points can not be passed to the remaining computational pipeline
     if (!pcl_isfinite (source_compounded (0)) || !pcl_isfinite (source_compounded (1)) || !pcl_isfinite (source_compounded (2)) || !pcl_isfinite (target_compounded (0)) || !pcl_isfinite (target_compounded (1)) || !pcl_isfinite (target_compounded (2)))
@@ -0,0 +1,151 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_REGISTRATION_IMPL_MULTI_RESOLUTION_REGISTRATION_HPP_
+#define PCL_REGISTRATION_IMPL_MULTI_RESOLUTION_REGISTRATION_HPP_
+
+#include <pcl/common/io.h>
+#include <pcl/common/time.h>
+#include <pcl/common/transforms.h>
+#include <pcl/filters/voxel_grid.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::MultiResolutionRegistration<PointSource, PointTarget>::prepareTargets (std::vector<double> &target_times)
+{
+  level_targets_.resize (levels_.size ());
+  target_times.assign (levels_.size (), 0);
+  for (size_t l = 0; l < levels_.size (); ++l)
+  {
+    StopWatch watch;
+    if (levels_[l].leaf_size > 0)
+    {
+      PointCloudTargetPtr downsampled (new PointCloudTarget);
+      VoxelGrid<PointTarget> grid;
+      grid.setLeafSize (levels_[l].leaf_size, levels_[l].leaf_size, levels_[l].leaf_size);
+      grid.setInputCloud (target_);
+      grid.filter (*downsampled);
+      level_targets_[l] = downsampled;
+    }
+    else
+      level_targets_[l] = target_;
+    levels_[l].registration->setInputTarget (level_targets_[l]);
+    target_times[l] = watch.getTime ();
+  }
+  targets_valid_ = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::MultiResolutionRegistration<PointSource, PointTarget>::computeTransformation (PointCloudSource &output, const Eigen::Matrix4f &guess)
+{
+  statistics_.clear ();
+  if (levels_.empty ())
+  {
+    PCL_ERROR ("[pcl::%s::computeTransformation] No levels were added!\n", getClassName ().c_str ());
+    return;
+  }
+
+  // A registration object that is used by several levels holds the target of the last 
+  // of them, so it has to be given its target again before each level runs
+  std::vector<bool> shared (levels_.size (), false);
+  for (size_t l = 0; l < levels_.size (); ++l)
+    for (size_t m = 0; m < levels_.size (); ++m)
+      if (l != m && levels_[l].registration == levels_[m].registration)
+        shared[l] = true;
+
+  std::vector<double> target_times (levels_.size (), 0);
+  if (!targets_valid_)
+    prepareTargets (target_times);
+
+  // The source points selected through the indices, if any
+  PointCloudSourceConstPtr source = input_;
+  if (!fake_indices_)
+  {
+    PointCloudSourcePtr selected (new PointCloudSource);
+    copyPointCloud (*input_, *indices_, *selected);
+    source = selected;
+  }
+
+  Eigen::Matrix4f current = guess;
+  PointCloudSource level_output;
+  statistics_.resize (levels_.size ());
+  for (size_t l = 0; l < levels_.size (); ++l)
+  {
+    StopWatch watch;
+    const Level &level = levels_[l];
+    PointCloudSourceConstPtr level_source = source;
+    if (level.leaf_size > 0)
+    {
+      PointCloudSourcePtr downsampled (new PointCloudSource);
+      VoxelGrid<PointSource> grid;
+      grid.setLeafSize (level.leaf_size, level.leaf_size, level.leaf_size);
+      grid.setInputCloud (source);
+      grid.filter (*downsampled);
+      level_source = downsampled;
+    }
+
+    if (shared[l])
+      level.registration->setInputTarget (level_targets_[l]);
+    level.registration->setInputCloud (level_source);
+    // Indices left over from a previous level or call would not match the new source
+    IndicesPtr level_indices (new std::vector<int> (level_source->points.size ()));
+    for (size_t i = 0; i < level_indices->size (); ++i)
+      (*level_indices)[i] = static_cast<int> (i);
+    level.registration->setIndices (level_indices);
+    level.registration->align (level_output, current);
+    current = level.registration->getFinalTransformation ();
+
+    LevelStatistics &stats = statistics_[l];
+    stats.leaf_size = level.leaf_size;
+    stats.nr_source_points = level_source->points.size ();
+    stats.nr_target_points = level_targets_[l]->points.size ();
+    stats.target_time = target_times[l];
+    stats.time = watch.getTime ();
+    stats.converged = level.registration->hasConverged ();
+    PCL_DEBUG ("[pcl::%s::computeTransformation] Level %zu (leaf size %f): %zu source and %zu target points, %g ms, %s.\n",
+               getClassName ().c_str (), l, level.leaf_size, stats.nr_source_points, stats.nr_target_points, 
+               stats.target_time + stats.time, stats.converged ? "converged" : "not converged");
+  }
+
+  final_transformation_ = transformation_ = current;
+  converged_ = statistics_.back ().converged;
+  transformPointCloud (output, output, final_transformation_);
+}
+
+#endif  //#ifndef PCL_REGISTRATION_IMPL_MULTI_RESOLUTION_REGISTRATION_HPP_
@@ -55,6 +55,9 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::NormalDistributions
   , h_ang_d3_ (), h_ang_e1_ (), h_ang_e2_ (), h_ang_e3_ (), h_ang_f1_ (), h_ang_f2_ (), h_ang_f3_ ()
   , point_gradient_ ()
   , point_hessian_ ()
+  , threads_ (1)
+  , search_method_ (RADIUS)
+  , neighborhoods_ ()
 {
   reg_name_ = "NormalDistributionsTransform";
 
@@ -178,15 +181,6 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeDerivatives
                                                                                  Eigen::Matrix<double, 6, 1> &p,
                                                                                  bool compute_hessian)
 {
-  // Original Point and Transformed Point
-  PointSource x_pt, x_trans_pt;
-  // Original Point and Transformed Point (for math)
-  Eigen::Vector3d x, x_trans;
-  // Occupied Voxel
-  TargetGridLeafConstPtr cell;
-  // Inverse Covariance of Occupied Voxel
-  Eigen::Matrix3d c_inv;
-
   score_gradient.setZero ();
   hessian.setZero ();
   double score = 0;
@@ -194,34 +188,63 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeDerivatives
   // Precompute Angular Derivatives (eq. 6.19 and 6.21)[Magnusson 2009]
   computeAngleDerivatives (p);
 
-  // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
-  for (size_t idx = 0; idx < input_->points.size (); idx++)
-  {
-    x_trans_pt = trans_cloud.points[idx];
+  const int nr_points = static_cast<int> (input_->points.size ());
+  neighborhoods_.resize (nr_points);
 
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor checking.
-    std::vector<TargetGridLeafConstPtr> neighborhood;
+  // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson 2009].
+  // Every thread accumulates its points into its own score, gradient and hessian, which are summed up at the end.
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel num_threads (threads_)
+#endif
+  {
+    Eigen::Matrix<double, 6, 1> thread_gradient = Eigen::Matrix<double, 6, 1>::Zero ();
+    Eigen::Matrix<double, 6, 6> thread_hessian = Eigen::Matrix<double, 6, 6>::Zero ();
+    double thread_score = 0;
+
+    // Constant parts of the point gradient and hessian
+    Eigen::Matrix<double, 3, 6> point_gradient = Eigen::Matrix<double, 3, 6>::Zero ();
+    point_gradient.block<3, 3>(0, 0).setIdentity ();
+    Eigen::Matrix<double, 18, 6> point_hessian = Eigen::Matrix<double, 18, 6>::Zero ();
     std::vector<float> distances;
-    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
 
-    for (typename std::vector<TargetGridLeafConstPtr>::iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); neighborhood_it++)
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (dynamic, 256)
+#endif
+    for (int idx = 0; idx < nr_points; idx++)
     {
-      cell = *neighborhood_it;
-      x_pt = input_->points[idx];
-      x = Eigen::Vector3d (x_pt.x, x_pt.y, x_pt.z);
-
-      x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
-
-      // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-      x_trans -= cell->getMean ();
-      // Uses precomputed covariance for speed.
-      c_inv = cell->getInverseCov ();
-
-      // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
-      computePointDerivatives (x);
-      // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
-      score += updateDerivatives (score_gradient, hessian, x_trans, c_inv, compute_hessian);
+      const PointSource &x_trans_pt = trans_cloud.points[idx];
+
+      // Find nieghbors, kept for the hessian computation at the end of the line search
+      std::vector<TargetGridLeafConstPtr> &neighborhood = neighborhoods_[idx];
+      searchNeighborhood (x_trans_pt, neighborhood, distances);
+      if (neighborhood.empty ())
+        continue;
+
+      // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009].
+      // They only depend on the source point, not on the voxel.
+      const PointSource &x_pt = input_->points[idx];
+      const Eigen::Vector3d x (x_pt.x, x_pt.y, x_pt.z);
+      computePointDerivatives (x, point_gradient, point_hessian, compute_hessian);
+      const Eigen::Vector3d x_trans_d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
+
+      for (typename std::vector<TargetGridLeafConstPtr>::const_iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); neighborhood_it++)
+      {
+        const TargetGridLeafConstPtr cell = *neighborhood_it;
+        // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
+        const Eigen::Vector3d x_trans = x_trans_d - cell->getMean ();
+        // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
+        thread_score += updateDerivatives (thread_gradient, thread_hessian, x_trans, cell->getInverseCov (), 
+                                           point_gradient, point_hessian, compute_hessian);
+      }
+    }
 
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical
+#endif
+    {
+      score_gradient += thread_gradient;
+      hessian += thread_hessian;
+      score += thread_score;
     }
   }
   return (score);
@@ -306,18 +329,21 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeAngleDerivat
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointSource, typename PointTarget> void
-pcl::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian)
+pcl::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives (const Eigen::Vector3d &x,
+                                                                                      Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                                      Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                                      bool compute_hessian) const
 {
   // Calculate first derivative of Transformation Equation 6.17 w.r.t. transform vector p.
   // Derivative w.r.t. ith element of transform vector corresponds to column i, Equation 6.18 and 6.19 [Magnusson 2009]
-  point_gradient_ (1, 3) = x.dot (j_ang_a_);
-  point_gradient_ (2, 3) = x.dot (j_ang_b_);
-  point_gradient_ (0, 4) = x.dot (j_ang_c_);
-  point_gradient_ (1, 4) = x.dot (j_ang_d_);
-  point_gradient_ (2, 4) = x.dot (j_ang_e_);
-  point_gradient_ (0, 5) = x.dot (j_ang_f_);
-  point_gradient_ (1, 5) = x.dot (j_ang_g_);
-  point_gradient_ (2, 5) = x.dot (j_ang_h_);
+  point_gradient (1, 3) = x.dot (j_ang_a_);
+  point_gradient (2, 3) = x.dot (j_ang_b_);
+  point_gradient (0, 4) = x.dot (j_ang_c_);
+  point_gradient (1, 4) = x.dot (j_ang_d_);
+  point_gradient (2, 4) = x.dot (j_ang_e_);
+  point_gradient (0, 5) = x.dot (j_ang_f_);
+  point_gradient (1, 5) = x.dot (j_ang_g_);
+  point_gradient (2, 5) = x.dot (j_ang_h_);
 
   if (compute_hessian)
   {
@@ -333,15 +359,15 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivat
 
     // Calculate second derivative of Transformation Equation 6.17 w.r.t. transform vector p.
     // Derivative w.r.t. ith and jth elements of transform vector corresponds to the 3x1 block matrix starting at (3i,j), Equation 6.20 and 6.21 [Magnusson 2009]
-    point_hessian_.block<3, 1>(9, 3) = a;
-    point_hessian_.block<3, 1>(12, 3) = b;
-    point_hessian_.block<3, 1>(15, 3) = c;
-    point_hessian_.block<3, 1>(9, 4) = b;
-    point_hessian_.block<3, 1>(12, 4) = d;
-    point_hessian_.block<3, 1>(15, 4) = e;
-    point_hessian_.block<3, 1>(9, 5) = c;
-    point_hessian_.block<3, 1>(12, 5) = e;
-    point_hessian_.block<3, 1>(15, 5) = f;
+    point_hessian.block<3, 1>(9, 3) = a;
+    point_hessian.block<3, 1>(12, 3) = b;
+    point_hessian.block<3, 1>(15, 3) = c;
+    point_hessian.block<3, 1>(9, 4) = b;
+    point_hessian.block<3, 1>(12, 4) = d;
+    point_hessian.block<3, 1>(15, 4) = e;
+    point_hessian.block<3, 1>(9, 5) = c;
+    point_hessian.block<3, 1>(12, 5) = e;
+    point_hessian.block<3, 1>(15, 5) = f;
   }
 }
 
@@ -349,12 +375,15 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivat
 template<typename PointSource, typename PointTarget> double
 pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
                                                                                 Eigen::Matrix<double, 6, 6> &hessian,
-                                                                                Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv,
-                                                                                bool compute_hessian)
+                                                                                const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv,
+                                                                                const Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                                const Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                                bool compute_hessian) const
 {
-  Eigen::Vector3d cov_dxd_pi;
+  // Sigma_k^-1 (x_k - mu_k), the covariance being symmetric x_trans' Sigma_k^-1 v = c_inv_x_trans' v
+  const Eigen::Vector3d c_inv_x_trans = c_inv * x_trans;
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
-  double e_x_cov_x = exp (-gauss_d2_ * x_trans.dot (c_inv * x_trans) / 2);
+  double e_x_cov_x = exp (-gauss_d2_ * x_trans.dot (c_inv_x_trans) / 2);
   // Calculate probability of transtormed points existance, Equation 6.9 [Magnusson 2009]
   double score_inc = -gauss_d1_ * e_x_cov_x;
 
@@ -367,23 +396,24 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (
   // Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
   e_x_cov_x *= gauss_d1_;
 
+  // x_trans' Sigma_k^-1 d(T(x,p))/dpi for all i, reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
+  const Eigen::Matrix<double, 1, 6> x_cov_dxd = c_inv_x_trans.transpose () * point_gradient;
 
-  for (int i = 0; i < 6; i++)
-  {
-    // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-    cov_dxd_pi = c_inv * point_gradient_.col (i);
-
-    // Update gradient, Equation 6.12 [Magnusson 2009]
-    score_gradient (i) += x_trans.dot (cov_dxd_pi) * e_x_cov_x;
+  // Update gradient, Equation 6.12 [Magnusson 2009]
+  score_gradient += e_x_cov_x * x_cov_dxd.transpose ();
 
-    if (compute_hessian)
+  if (compute_hessian)
+  {
+    // Sigma_k^-1 d(T(x,p))/dpi for all i
+    const Eigen::Matrix<double, 3, 6> cov_dxd = c_inv * point_gradient;
+    for (int i = 0; i < 6; i++)
     {
       for (int j = 0; j < hessian.cols (); j++)
       {
         // Update hessian, Equation 6.13 [Magnusson 2009]
-        hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient_.col (j)) +
-                                    x_trans.dot (c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                                    point_gradient_.col (j).dot (cov_dxd_pi) );
+        hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_cov_dxd (i) * x_cov_dxd (j) +
+                                    c_inv_x_trans.dot (point_hessian.block<3, 1>(3 * i, j)) +
+                                    point_gradient.col (j).dot (cov_dxd.col (i)) );
       }
     }
   }
@@ -396,82 +426,61 @@ template<typename PointSource, typename PointTarget> void
 pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeHessian (Eigen::Matrix<double, 6, 6> &hessian,
                                                                              PointCloudSource &trans_cloud, Eigen::Matrix<double, 6, 1> &)
 {
-  // Original Point and Transformed Point
-  PointSource x_pt, x_trans_pt;
-  // Original Point and Transformed Point (for math)
-  Eigen::Vector3d x, x_trans;
-  // Occupied Voxel
-  TargetGridLeafConstPtr cell;
-  // Inverse Covariance of Occupied Voxel
-  Eigen::Matrix3d c_inv;
-
   hessian.setZero ();
 
   // Precompute Angular Derivatives unessisary because only used after regular derivative calculation
 
+  const int nr_points = static_cast<int> (input_->points.size ());
+  // The neighborhoods found for trans_cloud by the last computeDerivatives () call are reused
+  const bool search = neighborhoods_.size () != input_->points.size ();
+  if (search)
+    neighborhoods_.resize (nr_points);
+
   // Update hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
-  for (size_t idx = 0; idx < input_->points.size (); idx++)
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel num_threads (threads_)
+#endif
   {
-    x_trans_pt = trans_cloud.points[idx];
-
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor checking.
-    std::vector<TargetGridLeafConstPtr> neighborhood;
+    Eigen::Matrix<double, 6, 1> thread_gradient = Eigen::Matrix<double, 6, 1>::Zero ();
+    Eigen::Matrix<double, 6, 6> thread_hessian = Eigen::Matrix<double, 6, 6>::Zero ();
+    Eigen::Matrix<double, 3, 6> point_gradient = Eigen::Matrix<double, 3, 6>::Zero ();
+    point_gradient.block<3, 3>(0, 0).setIdentity ();
+    Eigen::Matrix<double, 18, 6> point_hessian = Eigen::Matrix<double, 18, 6>::Zero ();
     std::vector<float> distances;
-    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
 
-    for (typename std::vector<TargetGridLeafConstPtr>::iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); neighborhood_it++)
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (dynamic, 256)
+#endif
+    for (int idx = 0; idx < nr_points; idx++)
     {
-      cell = *neighborhood_it;
-
-      {
-        x_pt = input_->points[idx];
-        x = Eigen::Vector3d (x_pt.x, x_pt.y, x_pt.z);
+      const PointSource &x_trans_pt = trans_cloud.points[idx];
+      std::vector<TargetGridLeafConstPtr> &neighborhood = neighborhoods_[idx];
+      if (search)
+        searchNeighborhood (x_trans_pt, neighborhood, distances);
+      if (neighborhood.empty ())
+        continue;
 
-        x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
+      // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
+      const PointSource &x_pt = input_->points[idx];
+      const Eigen::Vector3d x (x_pt.x, x_pt.y, x_pt.z);
+      computePointDerivatives (x, point_gradient, point_hessian);
+      const Eigen::Vector3d x_trans_d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
 
+      for (typename std::vector<TargetGridLeafConstPtr>::const_iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); neighborhood_it++)
+      {
+        const TargetGridLeafConstPtr cell = *neighborhood_it;
         // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-        x_trans -= cell->getMean ();
-        // Uses precomputed covariance for speed.
-        c_inv = cell->getInverseCov ();
-
-        // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
-        computePointDerivatives (x);
+        const Eigen::Vector3d x_trans = x_trans_d - cell->getMean ();
         // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
-        updateHessian (hessian, x_trans, c_inv);
+        updateDerivatives (thread_gradient, thread_hessian, x_trans, cell->getInverseCov (), point_gradient, point_hessian, true);
       }
     }
-  }
-}
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointSource, typename PointTarget> void
-pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Matrix<double, 6, 6> &hessian, Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv)
-{
-  Eigen::Vector3d cov_dxd_pi;
-  // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
-  double e_x_cov_x = gauss_d2_ * exp (-gauss_d2_ * x_trans.dot (c_inv * x_trans) / 2);
-
-  // Error checking for invalid values.
-  if (e_x_cov_x > 1 || e_x_cov_x < 0 || e_x_cov_x != e_x_cov_x)
-    return;
-
-  // Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-  e_x_cov_x *= gauss_d1_;
-
-  for (int i = 0; i < 6; i++)
-  {
-    // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-    cov_dxd_pi = c_inv * point_gradient_.col (i);
-
-    for (int j = 0; j < hessian.cols (); j++)
-    {
-      // Update hessian, Equation 6.13 [Magnusson 2009]
-      hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient_.col (j)) +
-                                  x_trans.dot (c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                                  point_gradient_.col (j).dot (cov_dxd_pi) );
-    }
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical
+#endif
+    hessian += thread_hessian;
   }
-
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,284 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_IRLS_HPP_
+#define PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_IRLS_HPP_
+
+#include <pcl/point_traits.h>
+#include <boost/mpl/contains.hpp>
+#include <Eigen/Geometry>
+#include <Eigen/Cholesky>
+
+namespace pcl
+{
+  namespace registration
+  {
+    namespace detail
+    {
+      /** \brief Get the normal of a point, or NaN if the point type has no normal. */
+      template <typename PointT> inline Eigen::Vector3d
+      getNormalVector3d (const PointT &pt, boost::mpl::true_)
+      {
+        return (Eigen::Vector3d (pt.normal_x, pt.normal_y, pt.normal_z));
+      }
+
+      template <typename PointT> inline Eigen::Vector3d
+      getNormalVector3d (const PointT &, boost::mpl::false_)
+      {
+        return (Eigen::Vector3d::Constant (std::numeric_limits<double>::quiet_NaN ()));
+      }
+
+      template <typename PointT> inline Eigen::Vector3d
+      getNormalVector3d (const PointT &pt)
+      {
+        typedef typename pcl::traits::fieldList<PointT>::type FieldList;
+        return (getNormalVector3d (pt, typename boost::mpl::contains<FieldList, pcl::fields::normal_x>::type ()));
+      }
+
+      /** \brief Rotation matrix of a rotation vector (axis times angle). */
+      inline Eigen::Matrix3d
+      rotationVectorToMatrix (const Eigen::Vector3d &rotation)
+      {
+        const double angle = rotation.norm ();
+        if (angle == 0)
+          return (Eigen::Matrix3d::Identity ());
+        return (Eigen::AngleAxisd (angle, rotation / angle).toRotationMatrix ());
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> inline void
+pcl::registration::TransformationEstimationPointToPlaneIRLS<PointSource, PointTarget>::
+estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src,
+                             const pcl::PointCloud<PointTarget> &cloud_tgt,
+                             Eigen::Matrix4f &transformation_matrix)
+{
+  size_t nr_points = cloud_src.points.size ();
+  if (cloud_tgt.points.size () != nr_points)
+  {
+    PCL_ERROR ("[pcl::TransformationEstimationPointToPlaneIRLS::estimateRigidTransformation] Number or points in source (%zu) differs than target (%zu)!\n", nr_points, cloud_tgt.points.size ());
+    return;
+  }
+  estimate (cloud_src, NULL, cloud_tgt, NULL, nr_points, transformation_matrix);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> inline void
+pcl::registration::TransformationEstimationPointToPlaneIRLS<PointSource, PointTarget>::
+estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src,
+                             const std::vector<int> &indices_src,
+                             const pcl::PointCloud<PointTarget> &cloud_tgt,
+                             Eigen::Matrix4f &transformation_matrix)
+{
+  size_t nr_points = indices_src.size ();
+  if (cloud_tgt.points.size () != nr_points)
+  {
+    PCL_ERROR ("[pcl::TransformationEstimationPointToPlaneIRLS::estimateRigidTransformation] Number or points in source (%zu) differs than target (%zu)!\n", nr_points, cloud_tgt.points.size ());
+    return;
+  }
+  estimate (cloud_src, &indices_src, cloud_tgt, NULL, nr_points, transformation_matrix);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> inline void
+pcl::registration::TransformationEstimationPointToPlaneIRLS<PointSource, PointTarget>::
+estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src,
+                             const std::vector<int> &indices_src,
+                             const pcl::PointCloud<PointTarget> &cloud_tgt,
+                             const std::vector<int> &indices_tgt,
+                             Eigen::Matrix4f &transformation_matrix)
+{
+  size_t nr_points = indices_src.size ();
+  if (indices_tgt.size () != nr_points)
+  {
+    PCL_ERROR ("[pcl::TransformationEstimationPointToPlaneIRLS::estimateRigidTransformation] Number or points in source (%zu) differs than target (%zu)!\n", nr_points, indices_tgt.size ());
+    return;
+  }
+  estimate (cloud_src, &indices_src, cloud_tgt, &indices_tgt, nr_points, transformation_matrix);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> inline void
+pcl::registration::TransformationEstimationPointToPlaneIRLS<PointSource, PointTarget>::
+estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src,
+                             const pcl::PointCloud<PointTarget> &cloud_tgt,
+                             const pcl::Correspondences &correspondences,
+                             Eigen::Matrix4f &transformation_matrix)
+{
+  const size_t nr_points = correspondences.size ();
+  std::vector<int> indices_src (nr_points), indices_tgt (nr_points);
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+    indices_src[i] = correspondences[i].index_query;
+    indices_tgt[i] = correspondences[i].index_match;
+  }
+  estimate (cloud_src, &indices_src, cloud_tgt, &indices_tgt, nr_points, transformation_matrix);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::registration::TransformationEstimationPointToPlaneIRLS<PointSource, PointTarget>::
+estimate (const pcl::PointCloud<PointSource> &cloud_src, const std::vector<int> *indices_src,
+          const pcl::PointCloud<PointTarget> &cloud_tgt, const std::vector<int> *indices_tgt,
+          size_t nr_points, Eigen::Matrix4f &transformation_matrix) const
+{
+  Eigen::Matrix4d transformation = Eigen::Matrix4d::Identity ();
+  Matrix6d JtJ;
+  Vector6d Jtr;
+
+  typedef typename pcl::traits::fieldList<PointSource>::type FieldListSource;
+  bool symmetric = symmetric_;
+  if (symmetric && !boost::mpl::contains<FieldListSource, pcl::fields::normal_x>::type::value)
+  {
+    PCL_WARN ("[pcl::TransformationEstimationPointToPlaneIRLS::estimateRigidTransformation] The symmetric objective needs source normals, using the point-to-plane objective instead.\n");
+    symmetric = false;
+  }
+
+  for (int iteration = 0; iteration < max_iterations_; ++iteration)
+  {
+    accumulate (cloud_src, indices_src, cloud_tgt, indices_tgt, nr_points, transformation, symmetric, JtJ, Jtr);
+
+    // Solve J' W J x = -J' W r
+    Eigen::LDLT<Matrix6d> ldlt (JtJ);
+    if (ldlt.info () != Eigen::Success)
+    {
+      PCL_WARN ("[pcl::TransformationEstimationPointToPlaneIRLS::estimateRigidTransformation] The normal equations are degenerate, stopping after %d iterations.\n", iteration);
+      break;
+    }
+    const Vector6d x = ldlt.solve (-Jtr);
+    if (!pcl_isfinite (x.sum ()))
+    {
+      PCL_WARN ("[pcl::TransformationEstimationPointToPlaneIRLS::estimateRigidTransformation] The normal equations are degenerate, stopping after %d iterations.\n", iteration);
+      break;
+    }
+
+    // Compose the update with the current estimate
+    Eigen::Matrix4d update = Eigen::Matrix4d::Identity ();
+    if (symmetric)
+    {
+      // The rotation is split half way between both clouds: T = R_h * Trans (t) * R_h
+      const Eigen::Matrix3d half_rotation = detail::rotationVectorToMatrix (x.head<3> ());
+      update.topLeftCorner<3, 3> () = half_rotation * half_rotation;
+      update.block<3, 1> (0, 3) = half_rotation * x.tail<3> ();
+    }
+    else
+    {
+      update.topLeftCorner<3, 3> () = detail::rotationVectorToMatrix (x.head<3> ());
+      update.block<3, 1> (0, 3) = x.tail<3> ();
+    }
+    transformation = update * transformation;
+
+    if (x.norm () < epsilon_)
+      break;
+  }
+
+  transformation_matrix = transformation.cast<float> ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> double
+pcl::registration::TransformationEstimationPointToPlaneIRLS<PointSource, PointTarget>::
+accumulate (const pcl::PointCloud<PointSource> &cloud_src, const std::vector<int> *indices_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt, const std::vector<int> *indices_tgt,
+            size_t nr_points, const Eigen::Matrix4d &transformation, bool symmetric,
+            Matrix6d &JtJ, Vector6d &Jtr) const
+{
+  JtJ.setZero ();
+  Jtr.setZero ();
+  double error = 0;
+
+  const Eigen::Matrix3d rotation = transformation.topLeftCorner<3, 3> ();
+  const Eigen::Vector3d translation = transformation.block<3, 1> (0, 3);
+  const int nr_correspondences = static_cast<int> (nr_points);
+
+  // Every thread accumulates its correspondences into its own normal equations, which are summed up at the end.
+  // The Jacobian row of a correspondence is never stored, only its outer product.
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel num_threads (threads_)
+#endif
+  {
+    Matrix6d thread_JtJ = Matrix6d::Zero ();
+    Vector6d thread_Jtr = Vector6d::Zero ();
+    Vector6d J;
+    double thread_error = 0;
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (static)
+#endif
+    for (int i = 0; i < nr_correspondences; ++i)
+    {
+      const PointSource &src = cloud_src.points[indices_src ? (*indices_src)[i] : i];
+      const PointTarget &tgt = cloud_tgt.points[indices_tgt ? (*indices_tgt)[i] : i];
+
+      const Eigen::Vector3d p = rotation * Eigen::Vector3d (src.x, src.y, src.z) + translation;
+      const Eigen::Vector3d q (tgt.x, tgt.y, tgt.z);
+      Eigen::Vector3d n (tgt.normal_x, tgt.normal_y, tgt.normal_z);
+      if (symmetric)
+        n += rotation * detail::getNormalVector3d (src);
+      if (!pcl_isfinite (n.sum ()) || !pcl_isfinite (p.sum ()) || !pcl_isfinite (q.sum ()))
+        continue;
+
+      // Residual along the normal and its derivative w.r.t. (rotation vector, translation)
+      const double r = n.dot (p - q);
+      if (symmetric)
+        J.head<3> () = (p + q).cross (n);
+      else
+        J.head<3> () = p.cross (n);
+      J.tail<3> () = n;
+
+      const double w = weight (r);
+      thread_JtJ.noalias () += (w * J) * J.transpose ();
+      thread_Jtr.noalias () += (w * r) * J;
+      thread_error += w * r * r;
+    }
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical
+#endif
+    {
+      JtJ += thread_JtJ;
+      Jtr += thread_Jtr;
+      error += thread_error;
+    }
+  }
+  return (error);
+}
+
+#endif /* PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_IRLS_HPP_ */
@@ -134,7 +134,7 @@ namespace pcl
         /** \brief Empty constructor.
           */
         LUM () :
-            slam_graph_ (new SLAMGraph), max_iterations_ (5), convergence_threshold_ (0.0)
+            slam_graph_ (new SLAMGraph), max_iterations_ (5), convergence_threshold_ (0.0), threads_ (1)
         {
         }
 
@@ -192,6 +192,15 @@ namespace pcl
         inline float
         getConvergenceThreshold ();
 
+        /** \brief Set the number of threads to use for the linearization of the edges in the compute() method.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          threads_ = nr_threads == 0 ? 1 : nr_threads;
+        }
+
         /** \brief Add a new point cloud to the SLAM graph.
           * \details This method will add a new vertex to the SLAM graph and attach a point cloud to that vertex.
           * Optionally you can specify a pose estimate for this point cloud.
@@ -290,6 +299,10 @@ namespace pcl
           * </ul>
           * Computation will change the pose estimates for the vertices of the SLAM graph, not the point clouds attached to them.
           * The results can be retrieved with getPose(), getTransformation(), getTransformedCloud() or getConcatenatedCloud().
+          * <br>
+          * The linear system of each iteration only couples vertices that share an edge, so it is assembled as a sparse
+          * block matrix and solved with a sparse Cholesky factorization. Memory and time thus grow with the number of
+          * edges rather than with the square and cube of the number of vertices.
           */
         void
         compute ();
@@ -326,6 +339,9 @@ namespace pcl
 
         /** \brief The convergence threshold for the summed vector lengths of all poses. */
         float convergence_threshold_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
     };
   }
 }
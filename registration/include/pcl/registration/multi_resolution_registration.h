@@ -0,0 +1,216 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_REGISTRATION_MULTI_RESOLUTION_REGISTRATION_H_
+#define PCL_REGISTRATION_MULTI_RESOLUTION_REGISTRATION_H_
+
+#include <pcl/registration/registration.h>
+
+namespace pcl
+{
+  /** \brief MultiResolutionRegistration aligns a source to a target coarse to fine. 
+    * Each level downsamples both clouds with a VoxelGrid of its own leaf size and runs 
+    * its own registration object, starting from the transformation found at the previous 
+    * (coarser) level. A bad initial guess is thereby corrected on few points, and only 
+    * the last iterations run at full resolution.
+    *
+    * Each level holds its own Registration object, so the algorithm and the convergence 
+    * criteria (maximum iterations, transformation epsilon, maximum correspondence 
+    * distance) can be chosen per level. For NormalDistributionsTransform the grid 
+    * resolution of each level is set on its object via setResolution (). The 
+    * downsampled targets and the search structures built by the level objects are kept 
+    * until a new target is set, so repeated alignments against the same target only 
+    * downsample the source.
+    *
+    * Usage example:
+    * \code
+    * pcl::MultiResolutionRegistration<pcl::PointXYZ, pcl::PointXYZ> pyramid;
+    * for (int level = 0; level < 3; ++level)
+    * {
+    *   typedef pcl::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> NDT;
+    *   boost::shared_ptr<NDT> ndt (new NDT);
+    *   ndt->setResolution (4.0f / (1 << level));
+    *   ndt->setMaximumIterations (10);
+    *   pyramid.addLevel (ndt, level < 2 ? 1.0f / (1 << level) : 0.0f);
+    * }
+    * pyramid.setInputTarget (map);
+    * pyramid.setInputCloud (scan);
+    * pyramid.align (aligned, guess);
+    * \endcode
+    * \ingroup registration
+    */
+  template <typename PointSource, typename PointTarget>
+  class MultiResolutionRegistration : public Registration<PointSource, PointTarget>
+  {
+    public:
+      using Registration<PointSource, PointTarget>::reg_name_;
+      using Registration<PointSource, PointTarget>::getClassName;
+      using Registration<PointSource, PointTarget>::input_;
+      using Registration<PointSource, PointTarget>::indices_;
+      using Registration<PointSource, PointTarget>::fake_indices_;
+      using Registration<PointSource, PointTarget>::target_;
+      using Registration<PointSource, PointTarget>::final_transformation_;
+      using Registration<PointSource, PointTarget>::transformation_;
+      using Registration<PointSource, PointTarget>::converged_;
+
+      typedef typename Registration<PointSource, PointTarget>::PointCloudSource PointCloudSource;
+      typedef typename PointCloudSource::Ptr PointCloudSourcePtr;
+      typedef typename PointCloudSource::ConstPtr PointCloudSourceConstPtr;
+
+      typedef typename Registration<PointSource, PointTarget>::PointCloudTarget PointCloudTarget;
+      typedef typename PointCloudTarget::Ptr PointCloudTargetPtr;
+      typedef typename PointCloudTarget::ConstPtr PointCloudTargetConstPtr;
+
+      typedef typename Registration<PointSource, PointTarget>::Ptr RegistrationPtr;
+
+      /** \brief Timing and size information about one level of the last alignment. */
+      struct LevelStatistics
+      {
+        LevelStatistics () : leaf_size (0), nr_source_points (0), nr_target_points (0), 
+                             target_time (0), time (0), converged (false) {}
+
+        /** \brief The VoxelGrid leaf size of the level, 0 for full resolution. */
+        float leaf_size;
+        /** \brief The number of source points the level was run on. */
+        size_t nr_source_points;
+        /** \brief The number of target points the level was run on. */
+        size_t nr_target_points;
+        /** \brief Time spent preparing the level target in this call, in milliseconds 
+          * (0 when the target of a previous call was reused). 
+          */
+        double target_time;
+        /** \brief Time spent downsampling the source and aligning it, in milliseconds. */
+        double time;
+        /** \brief Whether the level registration reported convergence. */
+        bool converged;
+      };
+
+      /** \brief Empty constructor. */
+      MultiResolutionRegistration () : levels_ (), level_targets_ (), targets_valid_ (false), statistics_ ()
+      {
+        reg_name_ = "MultiResolutionRegistration";
+      }
+
+      /** \brief Provide a pointer to the input target. The per level targets are built 
+        * during the next call to align ().
+        * \param[in] cloud the input point cloud target
+        */
+      inline void
+      setInputTarget (const PointCloudTargetConstPtr &cloud)
+      {
+        Registration<PointSource, PointTarget>::setInputTarget (cloud);
+        targets_valid_ = false;
+      }
+
+      /** \brief Append a level, finer than all levels added before.
+        * \param[in] registration the registration method to run at this level, configured 
+        * with its own convergence criteria
+        * \param[in] leaf_size the VoxelGrid leaf size the source and target are downsampled 
+        * with at this level, 0 to use the full resolution clouds
+        */
+      inline void
+      addLevel (const RegistrationPtr &registration, float leaf_size)
+      {
+        Level level;
+        level.registration = registration;
+        level.leaf_size = leaf_size;
+        levels_.push_back (level);
+        targets_valid_ = false;
+      }
+
+      /** \brief Remove all levels. */
+      inline void
+      clearLevels ()
+      {
+        levels_.clear ();
+        level_targets_.clear ();
+        targets_valid_ = false;
+      }
+
+      /** \brief Get the number of levels. */
+      inline size_t
+      getNumberOfLevels () const { return (levels_.size ()); }
+
+      /** \brief Get the registration object of a level.
+        * \param[in] level the level index, 0 being the coarsest level
+        */
+      inline RegistrationPtr
+      getLevelRegistration (size_t level) const { return (levels_[level].registration); }
+
+      /** \brief Get the timing and size information of every level of the last alignment. */
+      inline const std::vector<LevelStatistics>&
+      getLevelStatistics () const { return (statistics_); }
+
+    protected:
+      /** \brief Run all levels from the coarsest to the finest one.
+        * \param[out] output the transformed input point cloud dataset
+        * \param[in] guess the initial guess of the transformation
+        */
+      virtual void
+      computeTransformation (PointCloudSource &output, const Eigen::Matrix4f &guess);
+
+      /** \brief Downsample the target of each level and give it to the level registration. 
+        * \param[out] target_times the time spent on each level, in milliseconds
+        */
+      void
+      prepareTargets (std::vector<double> &target_times);
+
+      /** \brief One level of the pyramid. */
+      struct Level
+      {
+        RegistrationPtr registration;
+        float leaf_size;
+      };
+
+      /** \brief The levels, from the coarsest to the finest. */
+      std::vector<Level> levels_;
+
+      /** \brief The downsampled target of each level. */
+      std::vector<PointCloudTargetConstPtr> level_targets_;
+
+      /** \brief True if the level registrations hold the targets of the current target. */
+      bool targets_valid_;
+
+      /** \brief Information about each level of the last alignment. */
+      std::vector<LevelStatistics> statistics_;
+  };
+}
+
+#include <pcl/registration/impl/multi_resolution_registration.hpp>
+
+#endif  //#ifndef PCL_REGISTRATION_MULTI_RESOLUTION_REGISTRATION_H_
@@ -158,6 +158,43 @@ namespace pcl
         outlier_ratio_ = outlier_ratio;
       }
 
+      /** \brief Set the number of threads used to build the voxel grid of the target and to accumulate the 
+        * score, gradient and hessian over the source points.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief The voxels a transformed source point is scored against. */
+      enum NeighborSearchMethod
+      {
+        /** \brief The voxels among the 27 around the point whose mean is within resolution of the point (default). */
+        RADIUS,
+        /** \brief The voxel containing the point and the 6 voxels sharing a face with it. */
+        DIRECT7,
+        /** \brief Only the voxel containing the point, the fastest but with the smallest basin of convergence. */
+        DIRECT1
+      };
+
+      /** \brief Set how the voxels each transformed source point is scored against are found.
+        * \param[in] method the neighbor search method
+        */
+      inline void
+      setNeighborSearchMethod (NeighborSearchMethod method)
+      {
+        search_method_ = method;
+      }
+
+      /** \brief Get the neighbor search method. */
+      inline NeighborSearchMethod
+      getNeighborSearchMethod () const
+      {
+        return (search_method_);
+      }
+
       /** \brief Get the registration alignment probability.
         * \return transformation probability
         */
@@ -242,8 +279,9 @@ namespace pcl
       {
         target_cells_.setLeafSize (resolution_, resolution_, resolution_);
         target_cells_.setInputCloud ( target_ );
-        // Initiate voxel structure.
-        target_cells_.filter (true);
+        target_cells_.setNumberOfThreads (threads_);
+        // Initiate voxel structure. The neighborhoods are looked up in the voxel structure itself, no need for a kdtree.
+        target_cells_.filter ();
       }
 
       /** \brief Compute derivatives of probability function w.r.t. the transformation vector.
@@ -273,7 +311,28 @@ namespace pcl
       updateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
                          Eigen::Matrix<double, 6, 6> &hessian,
                          Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv,
-                         bool compute_hessian = true);
+                         bool compute_hessian = true)
+      {
+        return (updateDerivatives (score_gradient, hessian, x_trans, c_inv, point_gradient_, point_hessian_, compute_hessian));
+      }
+
+      /** \brief Compute individual point contirbutions to derivatives of probability function w.r.t. the transformation 
+        * vector, from the given point derivatives.
+        * \param[in,out] score_gradient the gradient vector of the probability function w.r.t. the transformation vector
+        * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
+        * \param[in] x_trans transformed point minus mean of occupied covariance voxel
+        * \param[in] c_inv covariance of occupied covariance voxel
+        * \param[in] point_gradient the point gradient computed by computePointDerivatives ()
+        * \param[in] point_hessian the point hessian computed by computePointDerivatives ()
+        * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
+        */
+      double
+      updateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
+                         Eigen::Matrix<double, 6, 6> &hessian,
+                         const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv,
+                         const Eigen::Matrix<double, 3, 6> &point_gradient,
+                         const Eigen::Matrix<double, 18, 6> &point_hessian,
+                         bool compute_hessian = true) const;
 
       /** \brief Precompute anglular components of derivatives.
         * \note Equation 6.19 and 6.21 [Magnusson 2009].
@@ -289,7 +348,23 @@ namespace pcl
         * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
         */
       void
-      computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian = true);
+      computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian = true)
+      {
+        computePointDerivatives (x, point_gradient_, point_hessian_, compute_hessian);
+      }
+
+      /** \brief Compute point derivatives into the given matrices, so that several points can be handled in parallel.
+        * \note Equation 6.18-21 [Magnusson 2009].
+        * \param[in] x point from the input cloud
+        * \param[in,out] point_gradient the point gradient, whose constant part has to be initialized by the caller
+        * \param[in,out] point_hessian the point hessian, whose constant part has to be initialized by the caller
+        * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
+        */
+      void
+      computePointDerivatives (const Eigen::Vector3d &x, 
+                               Eigen::Matrix<double, 3, 6> &point_gradient,
+                               Eigen::Matrix<double, 18, 6> &point_hessian,
+                               bool compute_hessian = true) const;
 
       /** \brief Compute hessian of probability function w.r.t. the transformation vector.
         * \note Equation 6.13 [Magnusson 2009].
@@ -310,7 +385,32 @@ namespace pcl
         */
       void
       updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
-                     Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv);
+                     Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv)
+      {
+        Eigen::Matrix<double, 6, 1> score_gradient = Eigen::Matrix<double, 6, 1>::Zero ();
+        updateDerivatives (score_gradient, hessian, x_trans, c_inv, point_gradient_, point_hessian_, true);
+      }
+
+      /** \brief Find the voxels a transformed source point is scored against, according to the neighbor search method.
+        * \param[in] point the transformed source point
+        * \param[out] neighborhood the voxels found
+        * \param[out] distances buffer for the squared distances of the radius search
+        */
+      inline void
+      searchNeighborhood (const PointSource &point, std::vector<TargetGridLeafConstPtr> &neighborhood, std::vector<float> &distances)
+      {
+        switch (search_method_)
+        {
+          case DIRECT1:
+            target_cells_.getVoxelAtPoint (point, neighborhood);
+            break;
+          case DIRECT7:
+            target_cells_.getFaceNeighborhoodAtPoint (point, neighborhood);
+            break;
+          default:
+            target_cells_.radiusSearch (point, resolution_, neighborhood, distances);
+        }
+      }
 
       /** \brief Compute line search step length and update transform and probability derivatives using More-Thuente method.
         * \note Search Algorithm [More, Thuente 1994]
@@ -446,6 +546,17 @@ namespace pcl
       /** \brief The second order derivative of the transformation of a point w.r.t. the transform vector, \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]. */
       Eigen::Matrix<double, 18, 6> point_hessian_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief How the voxels each source point is scored against are found. */
+      NeighborSearchMethod search_method_;
+
+      /** \brief The voxels found for each source point by the last call to computeDerivatives (), reused by 
+        * computeHessian () at the end of the line search. 
+        */
+      std::vector<std::vector<TargetGridLeafConstPtr> > neighborhoods_;
+
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -41,17 +41,23 @@
 
 #include <pcl/registration/registration.h>
 #include <pcl/features/ppf.h>
-#include <boost/unordered_map.hpp>
 
 namespace pcl
 {
+  /** \brief Search structure for the discretized point pair features of a model.
+    *
+    * The feature pairs are stored in a flat table sorted by their discretized feature, in compressed sparse
+    * row layout: all the pairs of a bin are contiguous in memory, next to their alpha_m angle, and a bin is
+    * found with a binary search over the sorted keys. Building the table is multi-threaded, and a trained
+    * table can be saved to and loaded from disk instead of being rebuilt from the feature cloud.
+    */
   class PCL_EXPORTS PPFHashMapSearch
   {
     public:
       /** \brief Data structure to hold the information for the key in the feature hash map of the
         * PPFHashMapSearch class
-        * \note It uses multiple pair levels in order to enable the usage of the boost::hash function
-        * which has the std::pair implementation (i.e., does not require a custom hash function)
+        * \note It uses multiple pair levels in order to reuse the lexicographic ordering of std::pair
+        * (i.e., does not require a custom comparison function)
         */
       struct HashKeyStruct : public std::pair <int, std::pair <int, std::pair <int, int> > >
       {
@@ -63,8 +69,16 @@ namespace pcl
           this->second.second.second = d;
         }
       };
-      typedef boost::unordered_multimap<HashKeyStruct, std::pair<size_t, size_t> > FeatureHashMapType;
-      typedef boost::shared_ptr<FeatureHashMapType> FeatureHashMapTypePtr;
+
+      /** \brief A model feature pair stored in the table: the indices of its reference point and second
+        * point, and its alpha_m angle */
+      struct PairEntry
+      {
+        unsigned int reference_index;
+        unsigned int point_index;
+        float alpha_m;
+      };
+
       typedef boost::shared_ptr<PPFHashMapSearch> Ptr;
 
 
@@ -75,11 +89,14 @@ namespace pcl
       PPFHashMapSearch (float angle_discretization_step = 12.0f / 180.0f * static_cast<float> (M_PI),
                         float distance_discretization_step = 0.01f)
         : alpha_m_ ()
-        , feature_hash_map_ (new FeatureHashMapType)
+        , bucket_keys_ ()
+        , bucket_offsets_ ()
+        , entries_ ()
         , internals_initialized_ (false)
         , angle_discretization_step_ (angle_discretization_step)
         , distance_discretization_step_ (distance_discretization_step)
         , max_dist_ (-1.0f)
+        , threads_ (1)
       {
       }
 
@@ -101,6 +118,39 @@ namespace pcl
       nearestNeighborSearch (float &f1, float &f2, float &f3, float &f4,
                              std::vector<std::pair<size_t, size_t> > &indices);
 
+      /** \brief Find the bin of the given feature, without copying its pairs.
+       * \param[in] f1 The 1st value describing the query PPFSignature feature
+       * \param[in] f2 The 2nd value describing the query PPFSignature feature
+       * \param[in] f3 The 3rd value describing the query PPFSignature feature
+       * \param[in] f4 The 4th value describing the query PPFSignature feature
+       * \param[out] begin pointer to the first pair of the bin
+       * \param[out] end pointer past the last pair of the bin
+       * \return false if the table has not been built, true otherwise (the bin may be empty)
+       */
+      bool
+      findBin (float f1, float f2, float f3, float f4,
+               const PairEntry* &begin, const PairEntry* &end) const;
+
+      /** \brief Save the table (including the discretization steps) to a binary file.
+       * \param[in] file_name the name of the file
+       * \return true on success
+       */
+      bool
+      saveHashMap (const std::string &file_name) const;
+
+      /** \brief Load a table saved with saveHashMap, replacing the current one and the discretization steps.
+       * \param[in] file_name the name of the file
+       * \return true on success
+       */
+      bool
+      loadHashMap (const std::string &file_name);
+
+      /** \brief Set the number of threads used to build the table.
+       * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+       */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
       /** \brief Convenience method for returning a copy of the class instance as a boost::shared_ptr */
       Ptr
       makeShared() { return Ptr (new PPFHashMapSearch (*this)); }
@@ -117,13 +167,46 @@ namespace pcl
       inline float
       getModelDiameter () { return max_dist_; }
 
+      /** \brief Returns the number of model points the table was built from */
+      inline size_t
+      getNumberOfModelPoints () const { return alpha_m_.size (); }
+
+      /** \brief Returns the number of non-empty bins in the table */
+      inline size_t
+      getNumberOfBins () const { return bucket_keys_.size (); }
+
+      /** \brief Returns the number of feature pairs stored in the table */
+      inline size_t
+      getNumberOfPairs () const { return entries_.size (); }
+
       std::vector <std::vector <float> > alpha_m_;
     private:
-      FeatureHashMapTypePtr feature_hash_map_;
+      /** \brief Discretize a feature into the key of its bin. */
+      inline HashKeyStruct
+      discretize (float f1, float f2, float f3, float f4) const
+      {
+        return (HashKeyStruct (static_cast<int> (floor (f1 / angle_discretization_step_)),
+                               static_cast<int> (floor (f2 / angle_discretization_step_)),
+                               static_cast<int> (floor (f3 / angle_discretization_step_)),
+                               static_cast<int> (floor (f4 / distance_discretization_step_))));
+      }
+
+      /** \brief The sorted keys of the non-empty bins */
+      std::vector<HashKeyStruct> bucket_keys_;
+
+      /** \brief The pairs of bin i are entries_[bucket_offsets_[i] .. bucket_offsets_[i+1]) */
+      std::vector<size_t> bucket_offsets_;
+
+      /** \brief The feature pairs, grouped by bin */
+      std::vector<PairEntry> entries_;
+
       bool internals_initialized_;
 
       float angle_discretization_step_, distance_discretization_step_;
       float max_dist_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 
   /** \brief Class that registers two point clouds based on their sets of PPFSignatures.
@@ -180,7 +263,8 @@ namespace pcl
          search_method_ (),
          scene_reference_point_sampling_rate_ (5),
          clustering_position_diff_threshold_ (0.01f),
-         clustering_rotation_diff_threshold_ (20.0f / 180.0f * static_cast<float> (M_PI))
+         clustering_rotation_diff_threshold_ (20.0f / 180.0f * static_cast<float> (M_PI)),
+         threads_ (1)
       {}
 
       /** \brief Method for setting the position difference clustering parameter
@@ -231,6 +315,12 @@ namespace pcl
       inline PPFHashMapSearch::Ptr
       getSearchMethod () { return search_method_; }
 
+      /** \brief Set the number of threads voting for the scene reference points in parallel.
+       * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+       */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
       /** \brief Provide a pointer to the input target (e.g., the point cloud that we want to align the input source to)
        * \param cloud the input point cloud target
        */
@@ -254,6 +344,9 @@ namespace pcl
         * poses are considered to be in the same cluster (for the clustering phase of the algorithm) */
       float clustering_position_diff_threshold_, clustering_rotation_diff_threshold_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief use a kd-tree with range searches of range max_dist to skip an O(N) pass through the point cloud */
       typename pcl::KdTreeFLANN<PointTarget>::Ptr scene_search_tree_;
 
@@ -0,0 +1,277 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_IRLS_H_
+#define PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_IRLS_H_
+
+#include <pcl/registration/transformation_estimation.h>
+
+namespace pcl
+{
+  namespace registration
+  {
+    /** \brief @b TransformationEstimationPointToPlaneIRLS minimizes the point-to-plane distance between two clouds 
+      * of corresponding points with Gauss-Newton iterations and optional robust weights.
+      *
+      * Every iteration linearizes the rotation around the current estimate, as 
+      * TransformationEstimationPointToPlaneLLS does once, and accumulates the 6x6 normal equations 
+      * \f$ J^T W J \f$ and \f$ J^T W r \f$ in a single (multi-threaded) pass over the correspondences, without 
+      * forming the Jacobian. The weights W are recomputed from the residuals of the current estimate with 
+      * a Huber or Cauchy kernel (iteratively reweighted least squares), which bounds the influence of 
+      * wrong correspondences.
+      *
+      * With setSymmetric (true), the symmetric point-to-plane objective is used instead: the residual is 
+      * measured along the sum of the source and target normals and the rotation is split half way between
+      * both clouds, which enlarges the basin of convergence. This requires normals in the source too.
+      *
+      * For additional details, see 
+      *   "Linear Least-Squares Optimization for Point-to-Plane ICP Surface Registration", Kok-Lim Low, 2004 and
+      *   "A Symmetric Objective Function for ICP", Szymon Rusinkiewicz, SIGGRAPH 2019
+      *
+      * \ingroup registration
+      */
+    template <typename PointSource, typename PointTarget>
+    class TransformationEstimationPointToPlaneIRLS : public TransformationEstimation<PointSource, PointTarget>
+    {
+      public:
+        typedef boost::shared_ptr<TransformationEstimationPointToPlaneIRLS<PointSource, PointTarget> > Ptr;
+        typedef boost::shared_ptr<const TransformationEstimationPointToPlaneIRLS<PointSource, PointTarget> > ConstPtr;
+
+        /** \brief The robust kernels turning residuals into IRLS weights. */
+        enum RobustKernel
+        {
+          /** \brief All correspondences weigh 1 (plain least squares). */
+          NONE,
+          /** \brief Weight 1 up to the kernel scale, then scale / |r|. */
+          HUBER,
+          /** \brief Weight 1 / (1 + (r / scale)^2). */
+          CAUCHY
+        };
+
+        TransformationEstimationPointToPlaneIRLS () 
+          : kernel_ (NONE)
+          , kernel_scale_ (0.01)
+          , symmetric_ (false)
+          , max_iterations_ (10)
+          , epsilon_ (1e-6)
+          , threads_ (1)
+        {};
+        virtual ~TransformationEstimationPointToPlaneIRLS () {};
+
+        /** \brief Estimate a rigid rotation transformation between a source and a target point cloud.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        inline void
+        estimateRigidTransformation (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            Eigen::Matrix4f &transformation_matrix);
+
+        /** \brief Estimate a rigid rotation transformation between a source and a target point cloud.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] indices_src the vector of indices describing the points of interest in \a cloud_src
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        inline void
+        estimateRigidTransformation (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const std::vector<int> &indices_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            Eigen::Matrix4f &transformation_matrix);
+
+        /** \brief Estimate a rigid rotation transformation between a source and a target point cloud.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] indices_src the vector of indices describing the points of interest in \a cloud_src
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[in] indices_tgt the vector of indices describing the correspondences of the interst points from \a indices_src
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        inline void
+        estimateRigidTransformation (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const std::vector<int> &indices_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            const std::vector<int> &indices_tgt,
+            Eigen::Matrix4f &transformation_matrix);
+
+        /** \brief Estimate a rigid rotation transformation between a source and a target point cloud.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[in] correspondences the vector of correspondences between source and target point cloud
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        inline void
+        estimateRigidTransformation (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            const pcl::Correspondences &correspondences,
+            Eigen::Matrix4f &transformation_matrix);
+
+        /** \brief Set the robust kernel used to weigh the correspondences.
+          * \param[in] kernel the robust kernel
+          * \param[in] scale the residual (in the units of the clouds) above which correspondences are down-weighted
+          */
+        inline void
+        setRobustKernel (RobustKernel kernel, double scale)
+        {
+          kernel_ = kernel;
+          kernel_scale_ = scale;
+        }
+
+        /** \brief Get the robust kernel. */
+        inline RobustKernel
+        getRobustKernel () const { return (kernel_); }
+
+        /** \brief Get the robust kernel scale. */
+        inline double
+        getRobustKernelScale () const { return (kernel_scale_); }
+
+        /** \brief Use the symmetric point-to-plane objective, which needs source normals.
+          * \param[in] symmetric true to use the symmetric objective
+          */
+        inline void
+        setSymmetric (bool symmetric) { symmetric_ = symmetric; }
+
+        /** \brief Get whether the symmetric point-to-plane objective is used. */
+        inline bool
+        getSymmetric () const { return (symmetric_); }
+
+        /** \brief Set the maximum number of Gauss-Newton iterations (1 gives the linear least squares solution of 
+          * TransformationEstimationPointToPlaneLLS).
+          * \param[in] nr_iterations the maximum number of iterations
+          */
+        inline void
+        setMaximumIterations (int nr_iterations) { max_iterations_ = nr_iterations < 1 ? 1 : nr_iterations; }
+
+        /** \brief Get the maximum number of Gauss-Newton iterations. */
+        inline int
+        getMaximumIterations () const { return (max_iterations_); }
+
+        /** \brief Set the norm of the update (in radians and cloud units) below which the iterations stop.
+          * \param[in] epsilon the convergence threshold
+          */
+        inline void
+        setConvergenceThreshold (double epsilon) { epsilon_ = epsilon; }
+
+        /** \brief Get the convergence threshold. */
+        inline double
+        getConvergenceThreshold () const { return (epsilon_); }
+
+        /** \brief Set the number of threads used to accumulate the normal equations.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      protected:
+        typedef Eigen::Matrix<double, 6, 1> Vector6d;
+        typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+
+        /** \brief Run the Gauss-Newton iterations on nr_points correspondences.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] indices_src the source index of each correspondence, NULL for 0..nr_points-1
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[in] indices_tgt the target index of each correspondence, NULL for 0..nr_points-1
+          * \param[in] nr_points the number of correspondences
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        void
+        estimate (const pcl::PointCloud<PointSource> &cloud_src, const std::vector<int> *indices_src,
+                  const pcl::PointCloud<PointTarget> &cloud_tgt, const std::vector<int> *indices_tgt,
+                  size_t nr_points, Eigen::Matrix4f &transformation_matrix) const;
+
+        /** \brief Accumulate the weighted normal equations of all correspondences at the given transformation.
+          * \param[in] symmetric whether the symmetric objective is used
+          * \param[out] JtJ J' W J
+          * \param[out] Jtr J' W r
+          * \return the weighted sum of squared residuals
+          */
+        double
+        accumulate (const pcl::PointCloud<PointSource> &cloud_src, const std::vector<int> *indices_src,
+                    const pcl::PointCloud<PointTarget> &cloud_tgt, const std::vector<int> *indices_tgt,
+                    size_t nr_points, const Eigen::Matrix4d &transformation, bool symmetric,
+                    Matrix6d &JtJ, Vector6d &Jtr) const;
+
+        /** \brief Compute the IRLS weight of a residual. */
+        inline double
+        weight (double residual) const
+        {
+          switch (kernel_)
+          {
+            case HUBER:
+            {
+              const double abs_residual = std::abs (residual);
+              return (abs_residual <= kernel_scale_ ? 1.0 : kernel_scale_ / abs_residual);
+            }
+            case CAUCHY:
+            {
+              const double ratio = residual / kernel_scale_;
+              return (1.0 / (1.0 + ratio * ratio));
+            }
+            default:
+              return (1.0);
+          }
+        }
+
+        /** \brief The robust kernel. */
+        RobustKernel kernel_;
+
+        /** \brief The robust kernel scale. */
+        double kernel_scale_;
+
+        /** \brief Whether the symmetric objective is used. */
+        bool symmetric_;
+
+        /** \brief The maximum number of Gauss-Newton iterations. */
+        int max_iterations_;
+
+        /** \brief The convergence threshold on the update norm. */
+        double epsilon_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+    };
+  }
+}
+
+#include <pcl/registration/impl/transformation_estimation_point_to_plane_irls.hpp>
+
+#endif /* PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_IRLS_H_ */
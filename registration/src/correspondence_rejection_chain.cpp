@@ -0,0 +1,98 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <pcl/registration/correspondence_rejection_chain.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorChain::getRemainingCorrespondences (
+    const pcl::Correspondences& original_correspondences, 
+    pcl::Correspondences& remaining_correspondences)
+{
+  remaining_correspondences = original_correspondences;
+  removeRejectedCorrespondences (remaining_correspondences);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorChain::removeRejectedCorrespondences (
+    pcl::Correspondences &correspondences)
+{
+  // char instead of bool, so that the threads can write neighboring flags concurrently
+  std::vector<char> valid;
+
+  size_t first = 0;
+  while (first < rejectors_.size () && !correspondences.empty ())
+  {
+    if (!rejectors_[first]->hasPointwiseTest ())
+    {
+      rejectors_[first]->removeRejectedCorrespondences (correspondences);
+      ++first;
+      continue;
+    }
+
+    // A run of pointwise rejectors keeps exactly the correspondences accepted by all of them,
+    // so the whole run is tested in one pass over the set
+    size_t last = first + 1;
+    while (last < rejectors_.size () && rejectors_[last]->hasPointwiseTest ())
+      ++last;
+
+    const int nr_correspondences = static_cast<int> (correspondences.size ());
+    valid.resize (nr_correspondences);
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for schedule(static) num_threads(threads_)
+#endif
+    for (int i = 0; i < nr_correspondences; ++i)
+    {
+      bool is_valid = true;
+      for (size_t r = first; r < last && is_valid; ++r)
+        is_valid = rejectors_[r]->isCorrespondenceValid (correspondences[i]);
+      valid[i] = is_valid;
+    }
+
+    size_t number_valid_correspondences = 0;
+    for (size_t i = 0; i < correspondences.size (); ++i)
+    {
+      if (valid[i])
+        correspondences[number_valid_correspondences++] = correspondences[i];
+    }
+    correspondences.resize (number_valid_correspondences);
+
+    first = last;
+  }
+}
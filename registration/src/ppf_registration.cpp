@@ -35,6 +35,304 @@
  * $Id$
  */
 
+#include <pcl/registration/ppf_registration.h>
+#include <fstream>
+#include <algorithm>
+
+namespace
+{
+  /** \brief A model feature pair together with the key of its bin, used while building the table. */
+  struct KeyedPair
+  {
+    int key[4];
+    pcl::PPFHashMapSearch::PairEntry entry;
+  };
+
+  /** \brief Order pairs by bin, then by model point indices, so that the table does not depend on the
+    * number of threads used to build it. */
+  inline bool
+  compareKeyedPairs (const KeyedPair &a, const KeyedPair &b)
+  {
+    for (int k = 0; k < 4; ++k)
+      if (a.key[k] != b.key[k])
+        return (a.key[k] < b.key[k]);
+    if (a.entry.reference_index != b.entry.reference_index)
+      return (a.entry.reference_index < b.entry.reference_index);
+    return (a.entry.point_index < b.entry.point_index);
+  }
+
+  /** \brief Magic number and version at the start of the files written by PPFHashMapSearch::saveHashMap */
+  const char ppf_hash_map_magic[8] = { 'P', 'P', 'F', 'H', 'A', 'S', 'H', '1' };
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PPFHashMapSearch::setInputFeatureCloud (PointCloud<PPFSignature>::ConstPtr feature_cloud)
+{
+  // Discretize the feature cloud, in parallel over the model reference points
+  const size_t n = static_cast<size_t> (sqrt (static_cast<float> (feature_cloud->points.size ())));
+  std::vector<KeyedPair> pairs (n * n);
+  std::vector<char> valid (n * n, 0);
+  max_dist_ = -1.0;
+  alpha_m_.resize (n);
+  for (size_t i = 0; i < n; ++i)
+    alpha_m_[i].resize (n);
+
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel num_threads (threads_)
+#endif
+  {
+    float thread_max_dist = -1.0f;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp for schedule (static)
+#endif
+    for (int i = 0; i < static_cast<int> (n); ++i)
+    {
+      for (size_t j = 0; j < n; ++j)
+      {
+        const PPFSignature &feature = feature_cloud->points[i*n + j];
+        alpha_m_[i][j] = feature.alpha_m;
+        if (thread_max_dist < feature.f4)
+          thread_max_dist = feature.f4;
+
+        // Identity pairs and pairs whose feature could not be computed are never matched, so that they
+        // can not vote for invalid angles
+        if (!pcl_isfinite (feature.f1) || !pcl_isfinite (feature.f2) || !pcl_isfinite (feature.f3) || 
+            !pcl_isfinite (feature.f4) || !pcl_isfinite (feature.alpha_m))
+          continue;
+
+        KeyedPair &pair = pairs[i*n + j];
+        const HashKeyStruct key = discretize (feature.f1, feature.f2, feature.f3, feature.f4);
+        pair.key[0] = key.first;
+        pair.key[1] = key.second.first;
+        pair.key[2] = key.second.second.first;
+        pair.key[3] = key.second.second.second;
+        pair.entry.reference_index = static_cast<unsigned int> (i);
+        pair.entry.point_index = static_cast<unsigned int> (j);
+        pair.entry.alpha_m = feature.alpha_m;
+        valid[i*n + j] = 1;
+      }
+    }
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp critical
+#endif
+    if (max_dist_ < thread_max_dist)
+      max_dist_ = thread_max_dist;
+  }
+
+  size_t nr_pairs = 0;
+  for (size_t k = 0; k < pairs.size (); ++k)
+    if (valid[k])
+      pairs[nr_pairs++] = pairs[k];
+  pairs.resize (nr_pairs);
+  std::vector<char> ().swap (valid);
+
+  // Sort the pairs by bin: every thread sorts a chunk, then the chunks are merged two by two
+  const int nr_chunks = static_cast<int> (threads_);
+  std::vector<size_t> chunk_bounds (nr_chunks + 1);
+  for (int c = 0; c <= nr_chunks; ++c)
+    chunk_bounds[c] = nr_pairs * c / nr_chunks;
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for num_threads (threads_) schedule (static, 1)
+#endif
+  for (int c = 0; c < nr_chunks; ++c)
+    std::sort (pairs.begin () + chunk_bounds[c], pairs.begin () + chunk_bounds[c+1], compareKeyedPairs);
+  for (int width = 1; width < nr_chunks; width *= 2)
+  {
+#if !defined __APPLE__ && defined HAVE_OPENMP
+#pragma omp parallel for num_threads (threads_) schedule (static, 1)
+#endif
+    for (int c = 0; c < nr_chunks - width; c += 2 * width)
+      std::inplace_merge (pairs.begin () + chunk_bounds[c], 
+                          pairs.begin () + chunk_bounds[c + width], 
+                          pairs.begin () + chunk_bounds[std::min (c + 2 * width, nr_chunks)], 
+                          compareKeyedPairs);
+  }
+
+  // Compress the sorted pairs into one row per bin
+  bucket_keys_.clear ();
+  bucket_offsets_.clear ();
+  entries_.resize (nr_pairs);
+  for (size_t k = 0; k < nr_pairs; ++k)
+  {
+    const int *key = pairs[k].key;
+    if (k == 0 || !std::equal (key, key + 4, pairs[k-1].key))
+    {
+      bucket_keys_.push_back (HashKeyStruct (key[0], key[1], key[2], key[3]));
+      bucket_offsets_.push_back (k);
+    }
+    entries_[k] = pairs[k].entry;
+  }
+  bucket_offsets_.push_back (nr_pairs);
+
+  internals_initialized_ = true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PPFHashMapSearch::findBin (float f1, float f2, float f3, float f4,
+                                const PairEntry* &begin, const PairEntry* &end) const
+{
+  begin = end = NULL;
+  if (!internals_initialized_)
+    return (false);
+
+  const HashKeyStruct key = discretize (f1, f2, f3, f4);
+  std::vector<HashKeyStruct>::const_iterator bin = std::lower_bound (bucket_keys_.begin (), bucket_keys_.end (), key);
+  if (bin != bucket_keys_.end () && *bin == key)
+  {
+    const size_t bin_index = bin - bucket_keys_.begin ();
+    begin = &entries_[0] + bucket_offsets_[bin_index];
+    end = &entries_[0] + bucket_offsets_[bin_index + 1];
+  }
+  return (true);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PPFHashMapSearch::nearestNeighborSearch (float &f1, float &f2, float &f3, float &f4,
+                                              std::vector<std::pair<size_t, size_t> > &indices)
+{
+  if (!internals_initialized_)
+  {
+    PCL_ERROR("[pcl::PPFRegistration::nearestNeighborSearch]: input feature cloud has not been set - skipping search!\n");
+    return;
+  }
+
+  indices.clear ();
+  const PairEntry *begin, *end;
+  findBin (f1, f2, f3, f4, begin, end);
+  for (; begin != end; ++begin)
+    indices.push_back (std::pair<size_t, size_t> (begin->reference_index, begin->point_index));
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PPFHashMapSearch::saveHashMap (const std::string &file_name) const
+{
+  if (!internals_initialized_)
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::saveHashMap] Input feature cloud has not been set - nothing to save!\n");
+    return (false);
+  }
+
+  std::ofstream fs (file_name.c_str (), std::ios::out | std::ios::binary);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::saveHashMap] Could not open %s for writing!\n", file_name.c_str ());
+    return (false);
+  }
+  // Header: discretization parameters followed by the table sizes
+  const uint64_t nr_model_points = alpha_m_.size (), nr_bins = bucket_keys_.size (), nr_pairs = entries_.size ();
+  fs.write (ppf_hash_map_magic, sizeof (ppf_hash_map_magic));
+  fs.write (reinterpret_cast<const char*> (&angle_discretization_step_), sizeof (angle_discretization_step_));
+  fs.write (reinterpret_cast<const char*> (&distance_discretization_step_), sizeof (distance_discretization_step_));
+  fs.write (reinterpret_cast<const char*> (&max_dist_), sizeof (max_dist_));
+  fs.write (reinterpret_cast<const char*> (&nr_model_points), sizeof (nr_model_points));
+  fs.write (reinterpret_cast<const char*> (&nr_bins), sizeof (nr_bins));
+  fs.write (reinterpret_cast<const char*> (&nr_pairs), sizeof (nr_pairs));
+  for (size_t b = 0; b < nr_bins; ++b)
+  {
+    const HashKeyStruct &key = bucket_keys_[b];
+    const int32_t k[4] = { key.first, key.second.first, key.second.second.first, key.second.second.second };
+    const uint64_t offset = bucket_offsets_[b];
+    fs.write (reinterpret_cast<const char*> (k), sizeof (k));
+    fs.write (reinterpret_cast<const char*> (&offset), sizeof (offset));
+  }
+  for (size_t k = 0; k < nr_pairs; ++k)
+  {
+    const uint32_t indices[2] = { entries_[k].reference_index, entries_[k].point_index };
+    fs.write (reinterpret_cast<const char*> (indices), sizeof (indices));
+    fs.write (reinterpret_cast<const char*> (&entries_[k].alpha_m), sizeof (entries_[k].alpha_m));
+  }
+  fs.close ();
+  if (fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::saveHashMap] Error writing to %s!\n", file_name.c_str ());
+    return (false);
+  }
+  return (true);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PPFHashMapSearch::loadHashMap (const std::string &file_name)
+{
+  std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::loadHashMap] Could not open %s for reading!\n", file_name.c_str ());
+    return (false);
+  }
+  char magic[sizeof (ppf_hash_map_magic)];
+  float angle_step = 0, distance_step = 0, max_dist = 0;
+  uint64_t nr_model_points = 0, nr_bins = 0, nr_pairs = 0;
+  fs.read (magic, sizeof (magic));
+  fs.read (reinterpret_cast<char*> (&angle_step), sizeof (angle_step));
+  fs.read (reinterpret_cast<char*> (&distance_step), sizeof (distance_step));
+  fs.read (reinterpret_cast<char*> (&max_dist), sizeof (max_dist));
+  fs.read (reinterpret_cast<char*> (&nr_model_points), sizeof (nr_model_points));
+  fs.read (reinterpret_cast<char*> (&nr_bins), sizeof (nr_bins));
+  fs.read (reinterpret_cast<char*> (&nr_pairs), sizeof (nr_pairs));
+  if (!fs || !std::equal (magic, magic + sizeof (magic), ppf_hash_map_magic) || 
+      nr_bins > nr_pairs || nr_pairs > nr_model_points * nr_model_points)
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::loadHashMap] %s is not a PPF hash map file!\n", file_name.c_str ());
+    return (false);
+  }
+
+  std::vector<HashKeyStruct> bucket_keys;
+  bucket_keys.reserve (nr_bins);
+  std::vector<size_t> bucket_offsets (nr_bins + 1);
+  for (size_t b = 0; b < nr_bins; ++b)
+  {
+    int32_t k[4];
+    uint64_t offset;
+    fs.read (reinterpret_cast<char*> (k), sizeof (k));
+    fs.read (reinterpret_cast<char*> (&offset), sizeof (offset));
+    bucket_keys.push_back (HashKeyStruct (k[0], k[1], k[2], k[3]));
+    bucket_offsets[b] = offset;
+    if (offset > nr_pairs || (b > 0 && offset < bucket_offsets[b-1]))
+      fs.setstate (std::ios::failbit);
+  }
+  bucket_offsets[nr_bins] = nr_pairs;
+
+  std::vector<PairEntry> entries (nr_pairs);
+  for (size_t k = 0; k < nr_pairs; ++k)
+  {
+    uint32_t indices[2];
+    fs.read (reinterpret_cast<char*> (indices), sizeof (indices));
+    fs.read (reinterpret_cast<char*> (&entries[k].alpha_m), sizeof (entries[k].alpha_m));
+    entries[k].reference_index = indices[0];
+    entries[k].point_index = indices[1];
+    if (indices[0] >= nr_model_points || indices[1] >= nr_model_points)
+      fs.setstate (std::ios::failbit);
+  }
+  if (!fs)
+  {
+    PCL_ERROR ("[pcl::PPFHashMapSearch::loadHashMap] Unexpected end of file or corrupted data in %s!\n", file_name.c_str ());
+    return (false);
+  }
+
+  // The alpha_m angles of the pairs that are not in the table were not valid
+  alpha_m_.assign (nr_model_points, std::vector<float> (nr_model_points, std::numeric_limits<float>::quiet_NaN ()));
+  for (size_t k = 0; k < nr_pairs; ++k)
+    alpha_m_[entries[k].reference_index][entries[k].point_index] = entries[k].alpha_m;
+
+  bucket_keys_.swap (bucket_keys);
+  bucket_offsets_.swap (bucket_offsets);
+  entries_.swap (entries);
+  angle_discretization_step_ = angle_step;
+  distance_discretization_step_ = distance_step;
+  max_dist_ = max_dist;
+  internals_initialized_ = true;
+  return (true);
+}
+
 /** Re-enable these once all of registration is separated into H/HPP correctly. */
 //#include <pcl/point_types.h>
 //#include <pcl/impl/instantiate.hpp>
@@ -85,6 +85,8 @@ namespace pcl
       // replace by some metric functor
       float getDistSqr (const PointT& point1, const PointT& point2) const;
       public:
+        using pcl::search::Search<PointT>::radiusSearchCount;
+
         BruteForce (bool sorted_results = false)
         : Search<PointT> ("BruteForce", sorted_results)
         {
@@ -122,6 +124,15 @@ namespace pcl
                       std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
                       unsigned int max_nn = 0) const;
 
+        /** \brief Count the neighbors of the query point in a given radius, stopping at \a max_count.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if given, the counting stops once this many neighbors were found
+          * \return number of neighbors found in radius, at most \a max_count if given
+          */
+        int
+        radiusSearchCount (const PointT &point, double radius, unsigned int max_count = 0) const;
+
       private:
         int
         denseKSearch (const PointT &point, int k, std::vector<int> &k_indices, std::vector<float> &k_distances) const;
@@ -349,6 +349,32 @@ pcl::search::BruteForce<PointT>::radiusSearch (
     return sparseRadiusSearch (point, radius, k_indices, k_sqr_distances, max_nn);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::BruteForce<PointT>::radiusSearchCount (
+    const PointT& point, double radius, unsigned int max_count) const
+{
+  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearchCount!");
+
+  if (radius <= 0)
+    return 0;
+  radius *= radius;
+
+  // Same traversal as denseRadiusSearch () / sparseRadiusSearch (), without storing the neighbors
+  const bool dense = input_->is_dense;
+  const size_t nr_points = indices_ != NULL ? indices_->size () : input_->size ();
+  unsigned int count = 0;
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+    const PointT &candidate = input_->points[indices_ != NULL ? (*indices_)[i] : static_cast<int> (i)];
+    if (!dense && !pcl_isfinite (candidate.x))
+      continue;
+    if (getDistSqr (candidate, point) <= radius && ++count == max_count) // never true if max_count = 0
+      break;
+  }
+  return (static_cast<int> (count));
+}
+
 #define PCL_INSTANTIATE_BruteForce(T) template class PCL_EXPORTS pcl::search::BruteForce<T>;
 
 #endif //PCL_SEARCH_IMPL_BRUTE_FORCE_SEARCH_H_
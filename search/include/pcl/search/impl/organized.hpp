@@ -108,6 +108,42 @@ pcl::search::OrganizedNeighbor<PointT>::radiusSearch (const               PointT
   return (static_cast<int> (k_indices.size ()));
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::search::OrganizedNeighbor<PointT>::radiusSearchCount (const PointT &query,
+                                                           const double radius,
+                                                           unsigned int max_count) const
+{
+  // NAN test
+  assert (isFinite (query) && "Invalid (NaN, Inf) point coordinates given to radiusSearchCount!");
+
+  // search window
+  unsigned left, right, top, bottom;
+  double squared_radius = radius * radius;
+  this->getProjectedRadiusSearchBox (query, static_cast<float> (squared_radius), left, right, top, bottom);
+
+  // iterate over search box, the same way radiusSearch () does
+  unsigned count = 0;
+  unsigned yEnd  = (bottom + 1) * input_->width + right + 1;
+  unsigned idx  = top * input_->width + left;
+  unsigned skip = input_->width - right + left - 1;
+  unsigned xEnd = idx - left + right + 1;
+
+  for (; xEnd != yEnd; idx += skip, xEnd += input_->width)
+  {
+    for (; idx < xEnd; ++idx)
+    {
+      if (!mask_[idx] || !isFinite (input_->points[idx]))
+        continue;
+
+      float squared_distance = (input_->points[idx].getVector3fMap () - query.getVector3fMap ()).squaredNorm ();
+      if (squared_distance <= squared_radius && ++count == max_count) // never true if max_count = 0
+        return (static_cast<int> (count));
+    }
+  }
+  return (static_cast<int> (count));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> int
 pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
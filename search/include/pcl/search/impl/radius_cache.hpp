@@ -0,0 +1,142 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_IMPL_RADIUS_CACHE_H_
+#define PCL_SEARCH_IMPL_RADIUS_CACHE_H_
+
+#include <pcl/search/radius_cache.h>
+#include <algorithm>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::RadiusCache<PointT>::setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr &indices)
+{
+  input_ = cloud;
+  indices_ = indices;
+  search_->setInputCloud (cloud, indices);
+  fillCache (*cloud, indices, input_cache_);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::RadiusCache<PointT>::setQueryCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr &indices)
+{
+  query_cloud_ = cloud;
+  fillCache (*cloud, indices, query_cache_);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::RadiusCache<PointT>::fillCache (const PointCloud &cloud, const IndicesConstPtr &indices,
+                                             std::vector<Neighborhood> &cache) const
+{
+  cache.clear ();
+  cache.resize (cloud.points.size ());
+
+  size_t nr_queries = indices ? indices->size () : cloud.points.size ();
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  std::vector<std::pair<float, int> > sorted;
+  for (size_t i = 0; i < nr_queries; ++i)
+  {
+    int index = indices ? (*indices)[i] : static_cast<int> (i);
+    Neighborhood &neighborhood = cache[index];
+    if (neighborhood.cached)
+      continue;
+
+    search_->radiusSearch (cloud, index, max_radius_, nn_indices, nn_dists, 0);
+
+    // Sort by distance; the index breaks ties so the order does not depend on the wrapped search
+    sorted.resize (nn_indices.size ());
+    for (size_t j = 0; j < nn_indices.size (); ++j)
+      sorted[j] = std::make_pair (nn_dists[j], nn_indices[j]);
+    std::sort (sorted.begin (), sorted.end ());
+
+    neighborhood.indices.resize (sorted.size ());
+    neighborhood.sqr_distances.resize (sorted.size ());
+    for (size_t j = 0; j < sorted.size (); ++j)
+    {
+      neighborhood.sqr_distances[j] = sorted[j].first;
+      neighborhood.indices[j] = sorted[j].second;
+    }
+    neighborhood.cached = true;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::RadiusCache<PointT>::truncate (const Neighborhood &neighborhood, double radius,
+                                            std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                                            unsigned int max_nn) const
+{
+  const float sqr_radius = static_cast<float> (radius * radius);
+  size_t count = std::upper_bound (neighborhood.sqr_distances.begin (), neighborhood.sqr_distances.end (), sqr_radius) -
+                 neighborhood.sqr_distances.begin ();
+  if (max_nn > 0 && count > max_nn)
+    count = max_nn;
+
+  k_indices.assign (neighborhood.indices.begin (), neighborhood.indices.begin () + count);
+  k_sqr_distances.assign (neighborhood.sqr_distances.begin (), neighborhood.sqr_distances.begin () + count);
+  return (static_cast<int> (count));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::RadiusCache<PointT>::radiusSearch (const PointCloud &cloud, int index, double radius,
+                                                std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                                                unsigned int max_nn) const
+{
+  if (radius <= max_radius_)
+  {
+    const std::vector<Neighborhood> *cache = NULL;
+    if (&cloud == input_.get ())
+      cache = &input_cache_;
+    else if (&cloud == query_cloud_.get ())
+      cache = &query_cache_;
+
+    if (cache && index >= 0 && index < static_cast<int> (cache->size ()) && (*cache)[index].cached)
+      return (truncate ((*cache)[index], radius, k_indices, k_sqr_distances, max_nn));
+  }
+
+  return (search_->radiusSearch (cloud, index, radius, k_indices, k_sqr_distances, max_nn));
+}
+
+#define PCL_INSTANTIATE_RadiusCache(T) template class PCL_EXPORTS pcl::search::RadiusCache<T>;
+
+#endif  // PCL_SEARCH_IMPL_RADIUS_CACHE_H_
@@ -0,0 +1,222 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_RADIUS_CACHE_H_
+#define PCL_SEARCH_RADIUS_CACHE_H_
+
+#include <pcl/search/search.h>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief Search wrapper that runs a single radius search per point at a maximum radius and answers
+      * every later radius search with a smaller (or equal) radius by truncating the cached neighborhood.
+      *
+      * The neighborhoods are stored sorted by increasing squared distance, so a radius search for \a r is
+      * a binary search followed by a prefix copy. This is meant for multi-scale estimation, where the same
+      * points are queried over and over with a growing radius (see MultiscaleFeaturePersistence).
+      *
+      * Only queries given as (cloud, index) pairs can be answered from the cache: the cloud has to be
+      * either the input cloud of the search, or the query cloud given through \ref setQueryCloud. All the
+      * other queries, as well as radius searches above the maximum radius and all k-nearest neighbor
+      * searches, are forwarded to the wrapped search object.
+      * \ingroup search
+      */
+    template<typename PointT>
+    class RadiusCache : public Search<PointT>
+    {
+      public:
+        typedef typename Search<PointT>::PointCloud PointCloud;
+        typedef typename Search<PointT>::PointCloudConstPtr PointCloudConstPtr;
+        typedef typename Search<PointT>::IndicesConstPtr IndicesConstPtr;
+
+        typedef boost::shared_ptr<RadiusCache<PointT> > Ptr;
+        typedef boost::shared_ptr<const RadiusCache<PointT> > ConstPtr;
+
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::indices_;
+
+        /** \brief Constructor.
+          * \param[in] search the search object used to fill the cache and to answer the queries that miss it
+          * \param[in] max_radius the radius used to fill the cache
+          */
+        RadiusCache (const typename Search<PointT>::Ptr &search, double max_radius)
+          : Search<PointT> ("RadiusCache", true)
+          , search_ (search)
+          , max_radius_ (max_radius)
+          , input_cache_ ()
+          , query_cloud_ ()
+          , query_cache_ ()
+        {
+        }
+
+        /** \brief Destructor. */
+        virtual
+        ~RadiusCache ()
+        {
+        }
+
+        /** \brief Set the maximum radius. Call this before \ref setInputCloud and \ref setQueryCloud. */
+        inline void
+        setMaximumRadius (double max_radius) { max_radius_ = max_radius; }
+
+        /** \brief Get the radius used to fill the cache. */
+        inline double
+        getMaximumRadius () const { return (max_radius_); }
+
+        /** \brief Provide a pointer to the input dataset. The wrapped search is built on it, and the
+          * neighborhoods of all the points in \a cloud (or only of those in \a indices) are cached.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr &indices = IndicesConstPtr ());
+
+        /** \brief Cache the neighborhoods (searched in the input cloud) of the points of another cloud, for
+          * when the queries do not come from the input cloud itself (e.g. keypoints described on a larger surface).
+          * \param[in] cloud the cloud holding the query points
+          * \param[in] indices the query point indices in \a cloud; all points are cached if not given
+          */
+        void
+        setQueryCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr &indices = IndicesConstPtr ());
+
+        /** \brief Search for the k-nearest neighbors of the given query point (forwarded to the wrapped search).
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const
+        {
+          return (search_->nearestKSearch (point, k, k_indices, k_sqr_distances));
+        }
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius (forwarded to the
+          * wrapped search, as the query point cannot be matched to a cached neighborhood).
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of point's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+        {
+          return (search_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
+        }
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius. The result is
+          * read from the cache if \a cloud is the input or the query cloud, and \a radius is not larger than
+          * the maximum radius. The neighbors are returned sorted by increasing distance.
+          * \param[in] cloud the point cloud data
+          * \param[in] index a \a valid index in \a cloud representing a \a valid (i.e., finite) query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointCloud &cloud, int index, double radius,
+                      std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius, the query
+          * point being given by its index in the input cloud (or in the input indices, if set).
+          * \param[in] index the index of the query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (int index, double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+        {
+          if (indices_)
+            index = (*indices_)[index];
+          return (radiusSearch (*input_, index, radius, k_indices, k_sqr_distances, max_nn));
+        }
+
+      protected:
+        /** \brief A cached neighborhood, sorted by increasing squared distance. */
+        struct Neighborhood
+        {
+          Neighborhood () : cached (false), indices (), sqr_distances () {}
+
+          bool cached;
+          std::vector<int> indices;
+          std::vector<float> sqr_distances;
+        };
+
+        /** \brief Fill \a cache with the neighborhoods of the points of \a cloud given by \a indices. */
+        void
+        fillCache (const PointCloud &cloud, const IndicesConstPtr &indices, std::vector<Neighborhood> &cache) const;
+
+        /** \brief Copy the part of a cached neighborhood that lies within \a radius. */
+        int
+        truncate (const Neighborhood &neighborhood, double radius,
+                  std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                  unsigned int max_nn) const;
+
+        /** \brief The wrapped search object. */
+        typename Search<PointT>::Ptr search_;
+
+        /** \brief The radius used to fill the cache. */
+        double max_radius_;
+
+        /** \brief The neighborhoods of the input cloud points. */
+        std::vector<Neighborhood> input_cache_;
+
+        /** \brief The cloud the query cache refers to. */
+        PointCloudConstPtr query_cloud_;
+
+        /** \brief The neighborhoods of the query cloud points. */
+        std::vector<Neighborhood> query_cache_;
+    };
+  }
+}
+
+#endif    // PCL_SEARCH_RADIUS_CACHE_H_
@@ -399,6 +399,61 @@ namespace pcl
           }
         }
 
+        /** \brief Count the neighbors of the query point in a given radius, without returning them.
+          *
+          * The default implementation runs a bounded radiusSearch (); search methods that can stop the
+          * traversal as soon as \a max_count neighbors were found override it.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if given, the counting stops once this many neighbors were found. If \a max_count
+          * is set to 0, all neighbors in \a radius will be counted.
+          * \return number of neighbors found in radius, at most \a max_count if given
+          */
+        virtual int
+        radiusSearchCount (const PointT &point, double radius, unsigned int max_count = 0) const
+        {
+          std::vector<int> k_indices;
+          std::vector<float> k_sqr_distances;
+          return (radiusSearch (point, radius, k_indices, k_sqr_distances, max_count));
+        }
+
+        /** \brief Count the neighbors of the query point in a given radius, without returning them.
+          * \param[in] cloud the point cloud data
+          * \param[in] index a \a valid index in \a cloud representing a \a valid (i.e., finite) query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if given, the counting stops once this many neighbors were found
+          * \return number of neighbors found in radius, at most \a max_count if given
+          */
+        virtual int
+        radiusSearchCount (const PointCloud &cloud, int index, double radius, unsigned int max_count = 0) const
+        {
+          assert (index >= 0 && index < static_cast<int> (cloud.points.size ()) && "Out-of-bounds error in radiusSearchCount!");
+          return (radiusSearchCount (cloud.points[index], radius, max_count));
+        }
+
+        /** \brief Count the neighbors of the query point in a given radius, without returning them.
+          * \param[in] index a \a valid index representing a \a valid query point in the dataset given
+          * by \a setInputCloud. If indices were given in setInputCloud, index will be the position in
+          * the indices vector.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if given, the counting stops once this many neighbors were found
+          * \return number of neighbors found in radius, at most \a max_count if given
+          */
+        virtual int
+        radiusSearchCount (int index, double radius, unsigned int max_count = 0) const
+        {
+          if (indices_ == NULL)
+          {
+            assert (index >= 0 && index < static_cast<int> (input_->points.size ()) && "Out-of-bounds error in radiusSearchCount!");
+            return (radiusSearchCount (input_->points[index], radius, max_count));
+          }
+          else
+          {
+            assert (index >= 0 && index < static_cast<int> (indices_->size ()) && "Out-of-bounds error in radiusSearchCount!");
+            return (radiusSearchCount (input_->points[(*indices_)[index]], radius, max_count));
+          }
+        }
+
         /** \brief Search for all the nearest neighbors of the query point in a given radius.
           * \param[in] cloud the point cloud data
           * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
@@ -46,6 +46,8 @@
 #include <pcl/point_cloud.h>
 
 #include <pcl/common/centroid.h>
+#include <pcl/common/utils.h>
+#include <set>
 
 using namespace pcl;
 
@@ -962,6 +964,19 @@ TEST (PCL, SetIfFieldExists)
 //  pcl::for_each_type<pcl::traits::fieldList<pcl::PFHSignature125>::type> (pcl::SetIfFieldExists<pcl::PFHSignature125, float*> (p2, "intensity", 3.0));
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, mixSeed)
+{
+  // Consecutive seeds must not share streams, as they would with seed + stream
+  std::set<unsigned int> seeds;
+  for (unsigned int seed = 0; seed < 100; ++seed)
+    for (unsigned int stream = 0; stream < 20; ++stream)
+      seeds.insert (pcl::utils::mixSeed (seed, stream));
+  EXPECT_EQ (seeds.size (), 2000u);
+
+  EXPECT_EQ (pcl::utils::mixSeed (42, 3), pcl::utils::mixSeed (42, 3));
+}
+
 //* ---[ */
 int
 main (int argc, char** argv)
@@ -44,7 +44,11 @@
 #include <pcl/features/fpfh.h>
 #include <pcl/features/fpfh_omp.h>
 #include <pcl/features/vfh.h>
+#include <pcl/features/cvfh.h>
 #include <pcl/features/gfpfh.h>
+#include <pcl/features/esf.h>
+#include <pcl/features/batch_global_feature.h>
+#include <pcl/features/multiscale_feature_persistence.h>
 #include <pcl/io/pcd_io.h>
 
 using namespace pcl;
@@ -578,6 +582,298 @@ TEST (PCL, GFPFH)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ESFEstimation)
+{
+  ESFEstimation<PointXYZ, ESFSignature640> esf;
+  esf.setInputCloud (cloud.makeShared ());
+  esf.setSeed (42);
+  EXPECT_EQ (esf.getSeed (), 42);
+
+  PointCloud<ESFSignature640> esf_serial;
+  esf.compute (esf_serial);
+  EXPECT_EQ (esf_serial.points.size (), 1);
+
+  float sum = 0;
+  for (int i = 0; i < 640; ++i)
+    sum += esf_serial.points[0].histogram[i];
+  EXPECT_NEAR (sum, 1.0f, 1e-4);
+
+  // The same seed must produce the same descriptor regardless of the number of threads
+  PointCloud<ESFSignature640> esf_parallel;
+  esf.setNumberOfThreads (4);
+  esf.compute (esf_parallel);
+  EXPECT_EQ (esf_parallel.points.size (), 1);
+  for (int i = 0; i < 640; ++i)
+    EXPECT_EQ (esf_serial.points[0].histogram[i], esf_parallel.points[0].histogram[i]);
+
+  // A neighboring seed must be as different as an unrelated one: with overlapping block streams,
+  // seeds 42 and 43 would share most of their triplets
+  PointCloud<ESFSignature640> esf_next_seed, esf_other_seed;
+  esf.setSeed (43);
+  esf.compute (esf_next_seed);
+  esf.setSeed (1042);
+  esf.compute (esf_other_seed);
+  float next_seed_distance = 0, other_seed_distance = 0;
+  for (int i = 0; i < 640; ++i)
+  {
+    next_seed_distance += fabsf (esf_next_seed.points[0].histogram[i] - esf_serial.points[0].histogram[i]);
+    other_seed_distance += fabsf (esf_other_seed.points[0].histogram[i] - esf_serial.points[0].histogram[i]);
+  }
+  EXPECT_GT (next_seed_distance, 0.5f * other_seed_distance);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, BatchGlobalFeatureEstimation)
+{
+  PointCloud<PointXYZ>::Ptr cloud_ptr = cloud.makeShared ();
+
+  // Split the cloud into a few clusters
+  const int nr_clusters = 3;
+  vector<PointIndices> clusters (nr_clusters);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+    clusters[(i * nr_clusters) / cloud.points.size ()].indices.push_back (static_cast<int> (i));
+
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud_ptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  // VFH works on the full cloud through the cluster indices
+  typedef VFHEstimation<PointXYZ, Normal, VFHSignature308> VFH;
+  VFH::Ptr vfh (new VFH);
+  vfh->setInputNormals (normals);
+
+  BatchGlobalFeatureEstimation<PointXYZ, VFHSignature308, VFH> batch_vfh;
+  batch_vfh.setEstimator (vfh);
+  batch_vfh.setInputCloud (cloud_ptr);
+  batch_vfh.setClusters (clusters);
+  batch_vfh.setNumberOfThreads (2);
+  EXPECT_EQ (batch_vfh.getNumberOfClusters (), nr_clusters);
+
+  Eigen::MatrixXf vfh_matrix;
+  vector<int> vfh_clusters;
+  batch_vfh.compute (vfh_matrix, vfh_clusters);
+  ASSERT_EQ (vfh_matrix.rows (), nr_clusters);
+  ASSERT_EQ (vfh_matrix.cols (), 308);
+  ASSERT_EQ (vfh_clusters.size (), nr_clusters);
+
+  for (int c = 0; c < nr_clusters; ++c)
+  {
+    EXPECT_EQ (vfh_clusters[c], c);
+
+    VFH single;
+    PointCloud<VFHSignature308> output;
+    single.setInputCloud (cloud_ptr);
+    single.setInputNormals (normals);
+    single.setIndices (boost::shared_ptr<vector<int> > (new vector<int> (clusters[c].indices)));
+    single.setSearchMethod (tree);
+    single.compute (output);
+    ASSERT_EQ (output.points.size (), 1);
+    for (int d = 0; d < 308; ++d)
+      EXPECT_EQ (vfh_matrix (c, d), output.points[0].histogram[d]);
+  }
+
+  // ESF works on an extracted copy of every cluster
+  typedef ESFEstimation<PointXYZ, ESFSignature640> ESF;
+  boost::shared_ptr<ESF> esf (new ESF);
+  esf->setSeed (42);
+
+  BatchGlobalFeatureEstimation<PointXYZ, ESFSignature640, ESF> batch_esf;
+  batch_esf.setEstimator (esf);
+  batch_esf.setInputCloud (cloud_ptr);
+  batch_esf.setClusters (clusters);
+  batch_esf.setNumberOfThreads (2);
+
+  PointCloud<ESFSignature640> esf_descriptors;
+  vector<int> esf_clusters;
+  batch_esf.compute (esf_descriptors, esf_clusters);
+  ASSERT_EQ (esf_descriptors.points.size (), nr_clusters);
+
+  for (int c = 0; c < nr_clusters; ++c)
+  {
+    PointCloud<PointXYZ>::Ptr cluster (new PointCloud<PointXYZ>);
+    copyPointCloud (cloud, clusters[c], *cluster);
+
+    ESF single;
+    PointCloud<ESFSignature640> output;
+    single.setSeed (42);
+    single.setInputCloud (cluster);
+    single.compute (output);
+    ASSERT_EQ (output.points.size (), 1);
+    for (int d = 0; d < 640; ++d)
+      EXPECT_EQ (esf_descriptors.points[c].histogram[d], output.points[0].histogram[d]);
+  }
+
+  // CVFH may return several descriptors per cluster, one per smooth region. With more clusters than threads, a
+  // thread computes several clusters, which must not see the smooth regions of the previous one
+  typedef CVFHEstimation<PointXYZ, Normal, VFHSignature308> CVFH;
+  boost::shared_ptr<CVFH> cvfh (new CVFH);
+  cvfh->setInputNormals (normals);
+  cvfh->setClusterTolerance (0.01f);
+  cvfh->setRadiusNormals (0.01f);
+  cvfh->setMinPoints (5);
+
+  BatchGlobalFeatureEstimation<PointXYZ, VFHSignature308, CVFH> batch_cvfh;
+  batch_cvfh.setEstimator (cvfh);
+  batch_cvfh.setInputCloud (cloud_ptr);
+  batch_cvfh.setClusters (clusters);
+  batch_cvfh.setNumberOfThreads (2);
+
+  Eigen::MatrixXf cvfh_matrix;
+  vector<int> cvfh_clusters;
+  batch_cvfh.compute (cvfh_matrix, cvfh_clusters);
+  ASSERT_EQ (cvfh_matrix.cols (), 308);
+  ASSERT_EQ (cvfh_matrix.rows (), static_cast<int> (cvfh_clusters.size ()));
+
+  int row = 0, nr_multiple = 0;
+  for (int c = 0; c < nr_clusters; ++c)
+  {
+    CVFH single;
+    PointCloud<VFHSignature308> output;
+    single.setInputCloud (cloud_ptr);
+    single.setInputNormals (normals);
+    single.setIndices (boost::shared_ptr<vector<int> > (new vector<int> (clusters[c].indices)));
+    single.setSearchMethod (tree);
+    single.setClusterTolerance (0.01f);
+    single.setRadiusNormals (0.01f);
+    single.setMinPoints (5);
+    single.compute (output);
+    EXPECT_GE (output.points.size (), 1);
+    if (output.points.size () > 1)
+      ++nr_multiple;
+
+    for (size_t i = 0; i < output.points.size (); ++i, ++row)
+    {
+      ASSERT_LT (row, cvfh_matrix.rows ());
+      EXPECT_EQ (cvfh_clusters[row], c);
+      for (int d = 0; d < 308; ++d)
+        EXPECT_EQ (cvfh_matrix (row, d), output.points[i].histogram[d]);
+    }
+  }
+  EXPECT_EQ (row, cvfh_matrix.rows ());
+  EXPECT_GT (nr_multiple, 1);
+
+  // GFPFH works on an extracted copy of every cluster and of its labels
+  PointCloud<PointXYZL>::Ptr labeled (new PointCloud<PointXYZL> ());
+  for (int z = -10; z < 10; ++z)
+    for (int y = -10; y < 10; ++y)
+      for (int x = -10; x < 10; ++x)
+      {
+        if (x >= -9 && x < 9 && y >= -9 && y < 9 && z >= -9 && z < 9)
+          continue;
+        PointXYZL p;
+        p.label = 1 + (std::abs (x+y+z) % 3);
+        p.x = static_cast<float> (x);
+        p.y = static_cast<float> (y);
+        p.z = static_cast<float> (z);
+        labeled->points.push_back (p);
+      }
+  labeled->width = static_cast<uint32_t> (labeled->points.size ());
+  labeled->height = 1;
+
+  // Keep the labels in a cloud of their own, so that they can only reach the clusters through
+  // the prototype
+  PointCloud<PointXYZL>::Ptr labels (new PointCloud<PointXYZL> (*labeled));
+
+  vector<PointIndices> halves (2);
+  for (size_t i = 0; i < labeled->points.size (); ++i)
+    halves[labeled->points[i].z < 0 ? 0 : 1].indices.push_back (static_cast<int> (i));
+
+  typedef GFPFHEstimation<PointXYZL, PointXYZL, GFPFHSignature16> GFPFH;
+  boost::shared_ptr<GFPFH> gfpfh (new GFPFH);
+  gfpfh->setNumberOfClasses (3);
+  gfpfh->setOctreeLeafSize (2);
+  gfpfh->setInputLabels (labels);
+
+  BatchGlobalFeatureEstimation<PointXYZL, GFPFHSignature16, GFPFH> batch_gfpfh;
+  batch_gfpfh.setEstimator (gfpfh);
+  batch_gfpfh.setInputCloud (labeled);
+  batch_gfpfh.setClusters (halves);
+  batch_gfpfh.setNumberOfThreads (2);
+
+  PointCloud<GFPFHSignature16> gfpfh_descriptors;
+  vector<int> gfpfh_clusters;
+  batch_gfpfh.compute (gfpfh_descriptors, gfpfh_clusters);
+  ASSERT_EQ (gfpfh_descriptors.points.size (), 2);
+
+  for (int c = 0; c < 2; ++c)
+  {
+    EXPECT_EQ (gfpfh_clusters[c], c);
+
+    PointCloud<PointXYZL>::Ptr cluster (new PointCloud<PointXYZL>);
+    PointCloud<PointXYZL>::Ptr cluster_labels (new PointCloud<PointXYZL>);
+    copyPointCloud (*labeled, halves[c], *cluster);
+    copyPointCloud (*labels, halves[c], *cluster_labels);
+
+    GFPFH single;
+    PointCloud<GFPFHSignature16> output;
+    single.setNumberOfClasses (3);
+    single.setOctreeLeafSize (2);
+    single.setInputCloud (cluster);
+    single.setInputLabels (cluster_labels);
+    single.compute (output);
+    ASSERT_EQ (output.points.size (), 1);
+    for (int d = 0; d < 16; ++d)
+      EXPECT_EQ (gfpfh_descriptors.points[c].histogram[d], output.points[0].histogram[d]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MultiscaleFeaturePersistenceSinglePass)
+{
+  PointCloud<PointXYZ>::Ptr cloud_ptr = cloud.makeShared ();
+
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud_ptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  vector<float> scales;
+  scales.push_back (0.005f);
+  scales.push_back (0.0075f);
+  scales.push_back (0.01f);
+
+  typedef FPFHEstimation<PointXYZ, Normal, FPFHSignature33> FPFH;
+  PointCloud<FPFHSignature33> features[2];
+  boost::shared_ptr<vector<int> > persistent_indices[2];
+  for (int single_pass = 0; single_pass < 2; ++single_pass)
+  {
+    FPFH::Ptr fpfh (new FPFH);
+    fpfh->setInputCloud (cloud_ptr);
+    fpfh->setInputNormals (normals);
+    fpfh->setSearchMethod (tree);
+
+    MultiscaleFeaturePersistence<PointXYZ, FPFHSignature33> persistence;
+    persistence.setScalesVector (scales);
+    persistence.setAlpha (1.2f);
+    persistence.setFeatureEstimator (fpfh);
+    persistence.setSingleNeighborhoodPass (single_pass == 1);
+    EXPECT_EQ (persistence.getSingleNeighborhoodPass (), single_pass == 1);
+
+    persistent_indices[single_pass].reset (new vector<int>);
+    persistence.determinePersistentFeatures (features[single_pass], persistent_indices[single_pass]);
+
+    // The user's search method is given back to the estimator
+    EXPECT_EQ (fpfh->getSearchMethod (), tree);
+  }
+
+  // Only the order of the neighbors differs between the two modes
+  EXPECT_GT (persistent_indices[0]->size (), 0);
+  ASSERT_EQ (persistent_indices[0]->size (), persistent_indices[1]->size ());
+  ASSERT_EQ (features[0].points.size (), features[1].points.size ());
+  for (size_t i = 0; i < persistent_indices[0]->size (); ++i)
+  {
+    EXPECT_EQ ((*persistent_indices[0])[i], (*persistent_indices[1])[i]);
+    for (int d = 0; d < 33; ++d)
+      EXPECT_NEAR (features[0].points[i].histogram[d], features[1].points[i].histogram[d], 1e-3);
+  }
+}
+
 #ifndef PCL_ONLY_CORE_POINT_TYPES
   ///////////////////////////////////////////////////////////////////////////////////
   template <typename FeatureEstimation, typename PointT, typename NormalT> void
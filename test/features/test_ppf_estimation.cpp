@@ -97,6 +97,27 @@ TEST (PCL, PPFEstimation)
   EXPECT_NEAR (feature_cloud->points[45381].f3, 0.868716, 1e-4);
   EXPECT_NEAR (feature_cloud->points[45381].f4, 0.140129, 1e-4);
   EXPECT_NEAR (feature_cloud->points[45381].alpha_m, -1.97276, 1e-4);
+
+  // Spreading the reference points over several threads gives the same pairs
+  PointCloud<PPFSignature> parallel_feature_cloud;
+  ppf_estimation.setNumberOfThreads (4);
+  ppf_estimation.compute (parallel_feature_cloud);
+  ASSERT_EQ (parallel_feature_cloud.points.size (), feature_cloud->points.size ());
+  EXPECT_EQ (parallel_feature_cloud.is_dense, feature_cloud->is_dense);
+  for (size_t i = 0; i < feature_cloud->points.size (); ++i)
+  {
+    const PPFSignature &serial = feature_cloud->points[i], &parallel = parallel_feature_cloud.points[i];
+    if (pcl_isnan (serial.f1))
+    {
+      EXPECT_TRUE (pcl_isnan (parallel.f1));
+      continue;
+    }
+    EXPECT_EQ (serial.f1, parallel.f1);
+    EXPECT_EQ (serial.f2, parallel.f2);
+    EXPECT_EQ (serial.f3, parallel.f3);
+    EXPECT_EQ (serial.f4, parallel.f4);
+    EXPECT_EQ (serial.alpha_m, parallel.alpha_m);
+  }
 }
 
 /* ---[ */
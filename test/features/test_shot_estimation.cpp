@@ -41,11 +41,14 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d_omp.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/common/common.h>
 #include <pcl/features/shot.h>
 #include <pcl/features/shot_omp.h>
 #include "pcl/features/shot_lrf.h"
 #include <pcl/features/3dsc.h>
+#include <pcl/features/3dsc_omp.h>
 #include <pcl/features/usc.h>
+#include <pcl/features/usc_omp.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -503,6 +506,28 @@ TEST (PCL, SHOTShapeEstimation)
   EXPECT_NEAR (shots352->points[103].descriptor[54], 0.013584172, 1e-4);
   EXPECT_NEAR (shots352->points[103].descriptor[55], 0.0050609680, 1e-4);
 
+  // SHOT352 binned in single precision
+  SHOTEstimation<PointXYZ, Normal, SHOT352> shot352f;
+  shot352f.setInputNormals (normals);
+  shot352f.setRadiusSearch (20 * mr);
+  shot352f.setUseFloatPrecision (true);
+  EXPECT_TRUE (shot352f.getUseFloatPrecision ());
+
+  PointCloud<SHOT352>::Ptr shots352f (new PointCloud<SHOT352> ());
+  shot352f.setInputCloud (cloud.makeShared ());
+  shot352f.setIndices (indicesptr);
+  shot352f.setSearchMethod (tree);
+  shot352f.compute (*shots352f);
+  EXPECT_EQ (shots352f->points.size (), shots352->points.size ());
+
+  for (size_t i = 0; i < shots352->points.size (); ++i)
+  {
+    if (!pcl_isfinite (shots352->points[i].descriptor[0]))
+      continue;
+    for (size_t j = 0; j < 352; ++j)
+      EXPECT_NEAR (shots352f->points[i].descriptor[j], shots352->points[i].descriptor[j], 1e-5);
+  }
+
 
   // Test results when setIndices and/or setSearchSurface are used
 
@@ -990,6 +1015,91 @@ TEST (PCL,3DSCEstimation)
     test_indices->push_back (static_cast<int> (i));
 
   testSHOTIndicesAndSearchSurface<ShapeContext3DEstimation<PointXYZ, Normal, SHOT>, PointXYZ, Normal, SHOT> (cloudptr, normals, test_indices);
+
+  // The OpenMP version draws the same random axes, whatever the number of threads
+  ShapeContext3DEstimationOMP<PointXYZ, Normal, SHOT> sc3d_omp (false, 4);
+  sc3d_omp.setInputCloud (cloudptr);
+  sc3d_omp.setInputNormals (normals);
+  sc3d_omp.setSearchMethod (tree);
+  sc3d_omp.setRadiusSearch (radius);
+  sc3d_omp.setAzimuthBins (nBinsL);
+  sc3d_omp.setElevationBins (nBinsK);
+  sc3d_omp.setRadiusBins (nBinsJ);
+  sc3d_omp.setMinimalRadius (rmin);
+  sc3d_omp.setPointDensityRadius (ptDensityRad);
+  PointCloud<SHOT>::Ptr sc3ds_omp (new PointCloud<SHOT> ());
+  sc3d_omp.compute (*sc3ds_omp);
+  ASSERT_EQ (sc3ds_omp->size (), sc3ds->size ());
+  for (size_t i = 0; i < sc3ds->size (); ++i)
+  {
+    ASSERT_EQ ((*sc3ds_omp)[i].descriptor.size (), (*sc3ds)[i].descriptor.size ());
+    for (size_t j = 0; j < (*sc3ds)[i].descriptor.size (); ++j)
+      EXPECT_EQ ((*sc3ds_omp)[i].descriptor[j], (*sc3ds)[i].descriptor[j]);
+  }
+
+  // Points without neighbors must not use up random values: with a search surface that covers
+  // only half of the cloud, the descriptors of the other points are the same as when the points
+  // without neighbors are left out
+  PointCloud<PointXYZ>::Ptr half_surface (new PointCloud<PointXYZ> ());
+  PointCloud<Normal>::Ptr half_normals (new PointCloud<Normal> ());
+  PointXYZ min_pt, max_pt;
+  getMinMax3D (cloud, min_pt, max_pt);
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    if (cloud[i].x < 0.5f * (min_pt.x + max_pt.x))
+      continue;
+    half_surface->push_back (cloud[i]);
+    half_normals->push_back ((*normals)[i]);
+  }
+
+  // The random generator is seeded on construction, so every run needs a new estimator
+  ShapeContext3DEstimation<PointXYZ, Normal, SHOT> sc3d_half, sc3d_valid;
+  ShapeContext3DEstimationOMP<PointXYZ, Normal, SHOT> sc3d_omp_half (false, 4);
+  ShapeContext3DEstimation<PointXYZ, Normal, SHOT>* estimators[] = {&sc3d_half, &sc3d_valid, &sc3d_omp_half};
+  for (int e = 0; e < 3; ++e)
+  {
+    estimators[e]->setInputCloud (cloudptr);
+    estimators[e]->setSearchSurface (half_surface);
+    estimators[e]->setInputNormals (half_normals);
+    estimators[e]->setSearchMethod (KdTreePtr (new search::KdTree<PointXYZ> (false)));
+    estimators[e]->setRadiusSearch (radius);
+    estimators[e]->setAzimuthBins (nBinsL);
+    estimators[e]->setElevationBins (nBinsK);
+    estimators[e]->setRadiusBins (nBinsJ);
+    estimators[e]->setMinimalRadius (rmin);
+    estimators[e]->setPointDensityRadius (ptDensityRad);
+  }
+
+  PointCloud<SHOT> sc3ds_half;
+  sc3d_half.compute (sc3ds_half);
+  ASSERT_EQ (sc3ds_half.size (), cloud.size ());
+
+  boost::shared_ptr<vector<int> > valid_indices (new vector<int> ());
+  for (size_t i = 0; i < sc3ds_half.size (); ++i)
+    if (pcl_isfinite (sc3ds_half[i].descriptor[0]))
+      valid_indices->push_back (static_cast<int> (i));
+  EXPECT_GT (valid_indices->size (), 0);
+  EXPECT_LT (valid_indices->size (), cloud.size ());
+
+  sc3d_valid.setIndices (valid_indices);
+  PointCloud<SHOT> sc3ds_valid;
+  sc3d_valid.compute (sc3ds_valid);
+  ASSERT_EQ (sc3ds_valid.size (), valid_indices->size ());
+  for (size_t i = 0; i < valid_indices->size (); ++i)
+    for (size_t j = 0; j < sc3ds_valid[i].descriptor.size (); ++j)
+      EXPECT_EQ (sc3ds_valid[i].descriptor[j], sc3ds_half[(*valid_indices)[i]].descriptor[j]);
+
+  // And the OpenMP version skips the same points when drawing
+  sc3d_omp_half.compute (*sc3ds_omp);
+  ASSERT_EQ (sc3ds_omp->size (), sc3ds_half.size ());
+  for (size_t i = 0; i < sc3ds_half.size (); ++i)
+    for (size_t j = 0; j < sc3ds_half[i].descriptor.size (); ++j)
+    {
+      if (pcl_isfinite (sc3ds_half[i].descriptor[j]))
+        EXPECT_EQ ((*sc3ds_omp)[i].descriptor[j], sc3ds_half[i].descriptor[j]);
+      else
+        EXPECT_FALSE (pcl_isfinite ((*sc3ds_omp)[i].descriptor[j]));
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1055,6 +1165,29 @@ TEST (PCL, USCEstimation)
   PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
   testSHOTIndicesAndSearchSurface<UniqueShapeContext<PointXYZ, SHOT>, PointXYZ, Normal, SHOT> (cloud.makeShared (), normals, test_indices);
   testSHOTLocalReferenceFrame<UniqueShapeContext<PointXYZ, SHOT>, PointXYZ, Normal, SHOT> (cloud.makeShared (), normals, test_indices);
+
+  // The OpenMP version must give the same results
+  UniqueShapeContextOMP<PointXYZ, SHOT> uscd_omp (4);
+  uscd_omp.setInputCloud (cloud.makeShared ());
+  uscd_omp.setSearchMethod (tree);
+  uscd_omp.setRadiusSearch (radius);
+  uscd_omp.setAzimuthBins (nBinsL);
+  uscd_omp.setElevationBins (nBinsK);
+  uscd_omp.setRadiusBins (nBinsJ);
+  uscd_omp.setMinimalRadius (rmin);
+  uscd_omp.setPointDensityRadius (ptDensityRad);
+  uscd_omp.setLocalRadius (radius);
+  PointCloud<SHOT>::Ptr uscds_omp (new PointCloud<SHOT>);
+  uscd_omp.compute (*uscds_omp);
+  ASSERT_EQ (uscds_omp->size (), uscds->size ());
+  for (size_t i = 0; i < uscds->size (); ++i)
+  {
+    for (int d = 0; d < 9; ++d)
+      EXPECT_EQ ((*uscds_omp)[i].rf[d], (*uscds)[i].rf[d]);
+    ASSERT_EQ ((*uscds_omp)[i].descriptor.size (), (*uscds)[i].descriptor.size ());
+    for (size_t j = 0; j < (*uscds)[i].descriptor.size (); ++j)
+      EXPECT_EQ ((*uscds_omp)[i].descriptor[j], (*uscds)[i].descriptor[j]);
+  }
 }
 
 #ifndef PCL_ONLY_CORE_POINT_TYPES
@@ -42,6 +42,7 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/features/spin_image.h>
+#include <pcl/features/spin_image_omp.h>
 #include <pcl/features/intensity_spin.h>
 
 using namespace pcl;
@@ -230,6 +231,22 @@ TEST (PCL, SpinImageEstimation)
   EXPECT_NEAR (spin_images->points[300].histogram[120], 0, 1e-4);
   EXPECT_NEAR (spin_images->points[300].histogram[132], 0, 1e-4);
   EXPECT_NEAR (spin_images->points[300].histogram[144], 0.272542, 1e-4);
+
+  // The OpenMP version must give the same results
+  SpinImageEstimationOMP<PointXYZ, Normal, SpinImage> spin_est_omp (8, 0.5, 16, 4);
+  spin_est_omp.setInputCloud (cloud.makeShared ());
+  spin_est_omp.setInputNormals (normals);
+  spin_est_omp.setIndices (indicesptr);
+  spin_est_omp.setSearchMethod (tree);
+  spin_est_omp.setRadiusSearch (40*mr);
+  spin_est_omp.setAngularDomain ();
+
+  PointCloud<SpinImage>::Ptr spin_images_omp (new PointCloud<SpinImage> ());
+  spin_est_omp.compute (*spin_images_omp);
+  ASSERT_EQ (spin_images_omp->points.size (), spin_images->points.size ());
+  for (size_t i = 0; i < spin_images->points.size (); ++i)
+    for (int j = 0; j < 153; ++j)
+      EXPECT_EQ (spin_images_omp->points[i].histogram[j], spin_images->points[i].histogram[j]);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
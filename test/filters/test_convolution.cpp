@@ -89,6 +89,209 @@ TEST (Convolution, convolveRows)
 
 }
 
+TEST (Convolution, convolveSeparable)
+{
+  using namespace pcl::filters;
+  Eigen::ArrayXf v_kernel (3);
+  v_kernel << 0.25, 0.5, 0.25;
+
+  // reference: rows then columns through an intermediate cloud
+  PointCloud<PointXYZI>::Ptr rows (new PointCloud<PointXYZI> ());
+  PointCloud<PointXYZI> reference;
+  Convolution<PointXYZI, PointXYZI> convolve;
+  convolve.setBordersPolicy (Convolution<PointXYZI, PointXYZI>::BORDERS_POLICY_DUPLICATE);
+  convolve.setInputCloud (input);
+  convolve.setKernel (filter);
+  convolve.convolveRows (*rows);
+  convolve.setInputCloud (rows);
+  convolve.setKernel (v_kernel);
+  convolve.convolveCols (reference);
+
+  PointCloud<PointXYZI> output;
+  convolve.setInputCloud (input);
+  convolve.setNumberOfThreads (2);
+  convolve.convolve (filter, v_kernel, output);
+  ASSERT_EQ (output.width, input->width);
+  ASSERT_EQ (output.height, input->height);
+  for (size_t i = 0; i < output.size (); ++i)
+    EXPECT_EQ (output.points[i].intensity, reference.points[i].intensity);
+
+  // duplicated borders take the closest convolved value
+  EXPECT_EQ (output (0,0).intensity, output (3,1).intensity);
+  EXPECT_EQ (output (63,47).intensity, output (60,46).intensity);
+
+  // the input cloud is left untouched, a second call gives the same result
+  PointCloud<PointXYZI> again;
+  convolve.convolve (filter, v_kernel, again);
+  for (size_t i = 0; i < again.size (); ++i)
+    EXPECT_EQ (again.points[i].intensity, output.points[i].intensity);
+}
+
+/** \brief Exposes the point by point convolution, the path taken by point types
+  * without a plane layout, as a reference for the plane based one.
+  */
+template <typename PointT>
+class PointByPointConvolution : public pcl::filters::Convolution<PointT, PointT>
+{
+  public:
+    typedef pcl::filters::Convolution<PointT, PointT> Base;
+
+    void
+    setInput (const typename PointCloud<PointT>::ConstPtr& cloud)
+    {
+      input = cloud;
+      this->setInputCloud (cloud);
+    }
+
+    void
+    convolveRowsPointByPoint (PointCloud<PointT>& output)
+    {
+      this->initCompute (output);
+      switch (this->getBordersPolicy ())
+      {
+        case Base::BORDERS_POLICY_MIRROR : this->convolve_rows_mirror (output); break;
+        case Base::BORDERS_POLICY_DUPLICATE : this->convolve_rows_duplicate (output); break;
+        case Base::BORDERS_POLICY_IGNORE : this->convolve_rows (output); break;
+      }
+    }
+
+    void
+    convolveColsPointByPoint (PointCloud<PointT>& output)
+    {
+      this->initCompute (output);
+      switch (this->getBordersPolicy ())
+      {
+        case Base::BORDERS_POLICY_MIRROR : this->convolve_cols_mirror (output); break;
+        case Base::BORDERS_POLICY_DUPLICATE : this->convolve_cols_duplicate (output); break;
+        case Base::BORDERS_POLICY_IGNORE : this->convolve_cols (output); break;
+      }
+    }
+
+    /// rows then columns through an intermediate cloud, as convolve () did before the planes
+    void
+    convolvePointByPoint (const Eigen::ArrayXf& h_kernel, const Eigen::ArrayXf& v_kernel, PointCloud<PointT>& output)
+    {
+      typename PointCloud<PointT>::ConstPtr original = input;
+      typename PointCloud<PointT>::Ptr tmp (new PointCloud<PointT> ());
+      this->setKernel (h_kernel);
+      convolveRowsPointByPoint (*tmp);
+      this->setInputCloud (tmp);
+      this->setKernel (v_kernel);
+      convolveColsPointByPoint (output);
+      this->setInputCloud (original);
+    }
+
+    typename PointCloud<PointT>::ConstPtr input;
+};
+
+/// an organized cloud with the intensities of \a input, a slanted surface and a few NaN points
+template <typename PointT> typename PointCloud<PointT>::Ptr
+makeCloud (bool dense)
+{
+  typename PointCloud<PointT>::Ptr cloud (new PointCloud<PointT> ());
+  cloud->width = input->width;
+  cloud->height = input->height;
+  cloud->resize (input->size ());
+  for (uint32_t j = 0; j < cloud->height; ++j)
+    for (uint32_t i = 0; i < cloud->width; ++i)
+    {
+      PointT& p = (*cloud) (i,j);
+      p.x = static_cast<float> (i) * 0.01f;
+      p.y = static_cast<float> (j) * 0.01f;
+      // a step in depth, so that the distance threshold rejects some neighbors
+      p.z = 1.f + ((i / 16 + j / 12) % 2) * 0.1f + (*input) (i,j).intensity * 1e-4f;
+      if (!dense && (i * 7 + j * 3) % 23 == 0)
+        p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  cloud->is_dense = dense;
+  return (cloud);
+}
+
+/// compare the plane based separable convolution with the point by point one
+template <typename PointT, typename Compare> void
+compareWithPointByPoint (const typename PointCloud<PointT>::ConstPtr& cloud, int policy, Compare compare)
+{
+  Eigen::ArrayXf v_kernel (3);
+  v_kernel << 0.25, 0.5, 0.25;
+
+  PointByPointConvolution<PointT> convolve;
+  convolve.setBordersPolicy (policy);
+  convolve.setDistanceThreshold (0.05f);
+  convolve.setInput (cloud);
+
+  PointCloud<PointT> reference, output, rows_reference, rows_output;
+  convolve.convolvePointByPoint (filter, v_kernel, reference);
+  convolve.setNumberOfThreads (2);
+  convolve.convolve (filter, v_kernel, output);
+  ASSERT_EQ (output.size (), reference.size ());
+  for (size_t i = 0; i < output.size (); ++i)
+    compare (output.points[i], reference.points[i]);
+
+  // a single pass goes through convolveUsingPlanes ()
+  convolve.setKernel (filter);
+  convolve.convolveRowsPointByPoint (rows_reference);
+  convolve.convolveRows (rows_output);
+  for (size_t i = 0; i < rows_output.size (); ++i)
+    compare (rows_output.points[i], rows_reference.points[i]);
+}
+
+template <typename PointT> void
+compareXYZ (const PointT& p, const PointT& q)
+{
+  for (int d = 0; d < 3; ++d)
+  {
+    if (pcl_isfinite (q.data[d]))
+      EXPECT_EQ (p.data[d], q.data[d]);
+    else
+      EXPECT_FALSE (pcl_isfinite (p.data[d]));
+  }
+}
+
+void
+compareXYZI (const PointXYZI& p, const PointXYZI& q)
+{
+  compareXYZ (p, q);
+  EXPECT_EQ (p.intensity, q.intensity);
+}
+
+void
+compareXYZRGB (const PointXYZRGB& p, const PointXYZRGB& q)
+{
+  compareXYZ (p, q);
+  EXPECT_EQ (p.r, q.r);
+  EXPECT_EQ (p.g, q.g);
+  EXPECT_EQ (p.b, q.b);
+}
+
+TEST (Convolution, convolveSeparablePointByPoint)
+{
+  typedef pcl::filters::Convolution<PointXYZI, PointXYZI> ConvolutionXYZI;
+  const int policies[] = { ConvolutionXYZI::BORDERS_POLICY_IGNORE,
+                           ConvolutionXYZI::BORDERS_POLICY_MIRROR,
+                           ConvolutionXYZI::BORDERS_POLICY_DUPLICATE };
+
+  for (int dense = 0; dense < 2; ++dense)
+  {
+    PointCloud<PointXYZI>::Ptr xyzi = makeCloud<PointXYZI> (dense != 0);
+    PointCloud<PointXYZRGB>::Ptr xyzrgb = makeCloud<PointXYZRGB> (dense != 0);
+    for (size_t i = 0; i < input->size (); ++i)
+    {
+      xyzi->points[i].intensity = input->points[i].intensity;
+      // large enough for the convolved colors to have fractional parts to truncate
+      xyzrgb->points[i].r = static_cast<pcl::uint8_t> (input->points[i].intensity);
+      xyzrgb->points[i].g = static_cast<pcl::uint8_t> (255 - input->points[i].intensity);
+      xyzrgb->points[i].b = static_cast<pcl::uint8_t> ((i * 37) % 256);
+    }
+
+    for (int p = 0; p < 3; ++p)
+    {
+      SCOPED_TRACE (testing::Message () << "dense " << dense << " policy " << policies[p]);
+      compareWithPointByPoint<PointXYZI> (xyzi, policies[p], compareXYZI);
+      compareWithPointByPoint<PointXYZRGB> (xyzrgb, policies[p], compareXYZRGB);
+    }
+  }
+}
+
 int
 main (int argc, char** argv)
 {
@@ -41,16 +41,24 @@
 #include <pcl/point_types.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/filters/filter.h>
+#include <pcl/filters/filter_pipeline.h>
 #include <pcl/filters/passthrough.h>
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/filters/voxel_grid_covariance.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/project_inliers.h>
 #include <pcl/filters/radius_outlier_removal.h>
+#include <pcl/filters/radius_outlier_removal_omp.h>
 #include <pcl/filters/statistical_outlier_removal.h>
+#include <pcl/filters/statistical_outlier_removal_omp.h>
 #include <pcl/filters/conditional_removal.h>
 #include <pcl/filters/random_sample.h>
+#include <pcl/filters/normal_space.h>
+#include <pcl/filters/covariance_sampling.h>
 #include <pcl/filters/crop_box.h>
+#include <pcl/filters/crop_hull.h>
+#include <pcl/filters/bilateral.h>
+#include <pcl/filters/convolution_3d.h>
 
 #include <pcl/common/transforms.h>
 #include <pcl/common/eigen.h>
@@ -233,6 +241,58 @@ TEST (ExtractIndices, Filters)
   */
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ExtractIndicesInPlace, Filters)
+{
+  // Unsorted indices with a duplicate
+  boost::shared_ptr<vector<int> > indices (new vector<int>);
+  for (int i = static_cast<int> (cloud->points.size ()) - 1; i >= 0; i -= 3)
+    indices->push_back (i);
+  indices->push_back ((*indices)[0]);
+
+  // Removed indices and negative mode both yield the ascending complement
+  ExtractIndices<PointXYZ> ei (true);
+  ei.setNumberOfThreads (4);
+  ei.setInputCloud (cloud);
+  ei.setIndices (indices);
+  PointCloud<PointXYZ> output;
+  ei.filter (output);
+  ASSERT_EQ (output.points.size (), indices->size ());
+  for (size_t i = 0; i < indices->size (); ++i)
+    EXPECT_EQ (cloud->points[(*indices)[i]].getVector3fMap (), output.points[i].getVector3fMap ());
+
+  vector<int> removed = *ei.getRemovedIndices ();
+  vector<int> complement;
+  ei.setNegative (true);
+  ei.filter (complement);
+  EXPECT_EQ (complement.size (), cloud->points.size () - (indices->size () - 1));
+  EXPECT_TRUE (removed == complement);
+  for (size_t i = 1; i < complement.size (); ++i)
+    EXPECT_LT (complement[i - 1], complement[i]);
+
+  // Negative in place compaction matches the copy
+  ei.filter (output);
+  PointCloud<PointXYZ>::Ptr compacted (new PointCloud<PointXYZ> (*cloud));
+  ei.filterInPlace (compacted);
+  ASSERT_EQ (compacted->points.size (), output.points.size ());
+  EXPECT_EQ (compacted->width, output.width);
+  EXPECT_EQ (int (compacted->height), 1);
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (output.points[i].getVector3fMap (), compacted->points[i].getVector3fMap ());
+
+  // Positive mode with unsorted indices falls back to a gather
+  ei.setNegative (false);
+  ei.setIndices (indices);
+  compacted.reset (new PointCloud<PointXYZ> (*cloud));
+  ei.filterInPlace (compacted);
+  ASSERT_EQ (compacted->points.size (), indices->size ());
+  for (size_t i = 0; i < indices->size (); ++i)
+    EXPECT_EQ (cloud->points[(*indices)[i]].getVector3fMap (), compacted->points[i].getVector3fMap ());
+
+  // The removed indices of the negative run must not have replaced the user indices
+  EXPECT_EQ ((*indices)[0], static_cast<int> (cloud->points.size ()) - 1);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PassThrough, Filters)
 {
@@ -853,6 +913,39 @@ TEST (VoxelGridCovariance, Filters)
   EXPECT_NEAR (leaves[2]->getMean ()[0], -0.00936106, 1e-4);
   EXPECT_NEAR (leaves[2]->getMean ()[1], 0.0516725, 1e-4);
   EXPECT_NEAR (leaves[2]->getMean ()[2], 0.0508024, 1e-4);
+
+  // radius searches within a voxel look the neighbors up in the grid, they should agree with the kdtree
+  VoxelGridCovariance<PointXYZ> grid2;
+  grid2.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid2.setMinPointPerVoxel (3);
+  grid2.setInputCloud (cloud);
+  grid2.setNumberOfThreads (2);
+  grid2.filter (output, true);
+  ASSERT_GT (output.points.size (), 0);
+  KdTreeFLANN<PointXYZ> tree;
+  tree.setInputCloud (output.makeShared ());
+  for (size_t i = 0; i < cloud->points.size (); i += 10)
+  {
+    grid2.radiusSearch (cloud->points[i], 0.01, leaves, distances);
+    vector<int> k_indices;
+    vector<float> k_distances;
+    tree.radiusSearch (cloud->points[i], 0.01, k_indices, k_distances);
+    vector<VoxelGridCovariance<PointXYZ>::LeafConstPtr> usable_leaves;
+    for (size_t j = 0; j < k_indices.size (); ++j)
+    {
+      VoxelGridCovariance<PointXYZ>::LeafConstPtr leaf = grid2.getLeaf (output.points[k_indices[j]]);
+      ASSERT_TRUE (leaf != NULL);
+      if (leaf->getPointCount () >= 3)
+        usable_leaves.push_back (leaf);
+    }
+    ASSERT_EQ (leaves.size (), usable_leaves.size ());
+    for (size_t j = 0; j < leaves.size (); ++j)
+    {
+      EXPECT_EQ (leaves[j], usable_leaves[j]);
+      if (j > 0)
+        EXPECT_LE (distances[j - 1], distances[j]);
+    }
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -961,6 +1054,86 @@ TEST (RadiusOutlierRemoval, Filters)
   EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].z, -0.021299, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RadiusOutlierRemovalOMP, Filters)
+{
+  PointCloud<PointXYZ> cloud_out, cloud_out_omp;
+  RadiusOutlierRemoval<PointXYZ> outrem (true);
+  outrem.setInputCloud (cloud);
+  outrem.setRadiusSearch (0.02);
+  outrem.setMinNeighborsInRadius (14);
+  outrem.filter (cloud_out);
+
+  RadiusOutlierRemovalOMP<PointXYZ> outrem_omp (true);
+
+  outrem_omp.setNumberOfThreads (4);
+  outrem_omp.setInputCloud (cloud);
+  outrem_omp.setRadiusSearch (0.02);
+  outrem_omp.setMinNeighborsInRadius (14);
+  outrem_omp.filter (cloud_out_omp);
+
+  EXPECT_EQ (int (cloud_out_omp.points.size ()), 307);
+  ASSERT_EQ (cloud_out_omp.points.size (), cloud_out.points.size ());
+  for (size_t i = 0; i < cloud_out.points.size (); ++i)
+  {
+    EXPECT_EQ (cloud_out_omp.points[i].x, cloud_out.points[i].x);
+    EXPECT_EQ (cloud_out_omp.points[i].y, cloud_out.points[i].y);
+    EXPECT_EQ (cloud_out_omp.points[i].z, cloud_out.points[i].z);
+  }
+  EXPECT_EQ (*outrem_omp.getRemovedIndices (), *outrem.getRemovedIndices ());
+
+  outrem.setNegative (true);
+  outrem.filter (cloud_out);
+  outrem_omp.setNegative (true);
+  outrem_omp.filter (cloud_out_omp);
+  EXPECT_EQ (int (cloud_out_omp.points.size ()), int (cloud->points.size ()) - 307);
+  EXPECT_EQ (*outrem_omp.getRemovedIndices (), *outrem.getRemovedIndices ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RadiusOutlierRemovalGrid, Filters)
+{
+  PointCloud<PointXYZ> cloud_out, cloud_out_grid;
+  RadiusOutlierRemoval<PointXYZ> outrem (true);
+  outrem.setInputCloud (cloud);
+  outrem.setRadiusSearch (0.02);
+  outrem.setMinNeighborsInRadius (14);
+  outrem.filter (cloud_out);
+
+  // The grid search counts the same neighbors as the tree search
+  RadiusOutlierRemoval<PointXYZ> outrem_grid (true);
+  outrem_grid.setInputCloud (cloud);
+  outrem_grid.setRadiusSearch (0.02);
+  outrem_grid.setMinNeighborsInRadius (14);
+  outrem_grid.setSearchMode (RadiusOutlierRemoval<PointXYZ>::SEARCH_MODE_GRID);
+  EXPECT_EQ (outrem_grid.getSearchMode (), RadiusOutlierRemoval<PointXYZ>::SEARCH_MODE_GRID);
+  outrem_grid.filter (cloud_out_grid);
+
+  EXPECT_EQ (int (cloud_out_grid.points.size ()), 307);
+  ASSERT_EQ (cloud_out_grid.points.size (), cloud_out.points.size ());
+  for (size_t i = 0; i < cloud_out.points.size (); ++i)
+  {
+    EXPECT_EQ (cloud_out_grid.points[i].x, cloud_out.points[i].x);
+    EXPECT_EQ (cloud_out_grid.points[i].y, cloud_out.points[i].y);
+    EXPECT_EQ (cloud_out_grid.points[i].z, cloud_out.points[i].z);
+  }
+  EXPECT_EQ (*outrem_grid.getRemovedIndices (), *outrem.getRemovedIndices ());
+
+  RadiusOutlierRemovalOMP<PointXYZ> outrem_omp (true);
+
+  outrem_omp.setNumberOfThreads (4);
+  outrem_omp.setInputCloud (cloud);
+  outrem_omp.setRadiusSearch (0.02);
+  outrem_omp.setMinNeighborsInRadius (14);
+  outrem_omp.setSearchMode (RadiusOutlierRemoval<PointXYZ>::SEARCH_MODE_GRID);
+  outrem_omp.setNegative (true);
+  outrem_omp.filter (cloud_out_grid);
+  EXPECT_EQ (int (cloud_out_grid.points.size ()), int (cloud->points.size ()) - 307);
+  outrem.setNegative (true);
+  outrem.filter (cloud_out);
+  EXPECT_EQ (*outrem_omp.getRemovedIndices (), *outrem.getRemovedIndices ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RandomSample, Filters)
 {
@@ -1026,6 +1199,127 @@ TEST (RandomSample, Filters)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* A floor of 900 points, and two walls of 30 points along the x and y axes */
+void
+createFloorAndWalls (PointCloud<PointXYZ> &points, PointCloud<Normal> &normals)
+{
+  points.clear ();
+  normals.clear ();
+  for (int i = 0; i < 30; ++i)
+    for (int j = 0; j < 30; ++j)
+    {
+      points.push_back (PointXYZ (0.1f * float (i), 0.1f * float (j), 0.0f));
+      normals.push_back (Normal (0.0f, 0.0f, 1.0f));
+    }
+  for (int i = 0; i < 30; ++i)
+  {
+    points.push_back (PointXYZ (0.0f, 0.1f * float (i), 0.1f * float (i % 3 + 1)));
+    normals.push_back (Normal (1.0f, 0.0f, 0.0f));
+    points.push_back (PointXYZ (0.1f * float (i), 0.0f, 0.1f * float (i % 3 + 1)));
+    normals.push_back (Normal (0.0f, 1.0f, 0.0f));
+  }
+}
+
+TEST (NormalSpaceSampling, Filters)
+{
+  PointCloud<PointXYZ>::Ptr points (new PointCloud<PointXYZ>);
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  createFloorAndWalls (*points, *normals);
+  normals->points[0].normal_x = std::numeric_limits<float>::quiet_NaN ();
+
+  NormalSpaceSampling<PointXYZ, Normal> sample;
+  sample.setInputCloud (points);
+  sample.setNormals (normals);
+  sample.setBins (4, 4, 4);
+  sample.setSample (90);
+  sample.setSeed (42);
+  vector<int> indices;
+  sample.filter (indices);
+
+  // Every direction gives the same number of points
+  ASSERT_EQ (int (indices.size ()), 90);
+  int nr_floor = 0, nr_x = 0, nr_y = 0;
+  vector<bool> sampled (points->size (), false);
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    EXPECT_NE (indices[i], 0);
+    EXPECT_FALSE (sampled[indices[i]]);
+    sampled[indices[i]] = true;
+    if (normals->points[indices[i]].normal_z == 1.0f)
+      ++nr_floor;
+    else if (normals->points[indices[i]].normal_x == 1.0f)
+      ++nr_x;
+    else
+      ++nr_y;
+  }
+  EXPECT_EQ (nr_floor, 30);
+  EXPECT_EQ (nr_x, 30);
+  EXPECT_EQ (nr_y, 30);
+
+  // The sample only depends on the seed
+  vector<int> indices2;
+  sample.setNumberOfThreads (4);
+  sample.filter (indices2);
+  EXPECT_EQ (indices, indices2);
+  sample.setSeed (43);
+  sample.filter (indices2);
+  EXPECT_NE (indices, indices2);
+
+  PointCloud<PointXYZ> cloud_out;
+  sample.filter (cloud_out);
+  ASSERT_EQ (cloud_out.size (), indices2.size ());
+  for (size_t i = 0; i < indices2.size (); ++i)
+    EXPECT_EQ (cloud_out.points[i].z, points->points[indices2[i]].z);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CovarianceSampling, Filters)
+{
+  PointCloud<PointXYZ>::Ptr points (new PointCloud<PointXYZ>);
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  createFloorAndWalls (*points, *normals);
+
+  CovarianceSampling<PointXYZ, Normal> sample;
+  sample.setInputCloud (points);
+  sample.setNormals (normals);
+  const double condition_number = sample.computeConditionNumber ();
+  EXPECT_GT (condition_number, 1.0);
+
+  // The floor alone leaves the alignment unconstrained along x, y and around z
+  IndicesPtr floor (new vector<int>);
+  for (int i = 0; i < 900; ++i)
+    floor->push_back (i);
+  sample.setIndices (floor);
+  EXPECT_GT (sample.computeConditionNumber (), 1e6);
+
+  // A small sample keeps the walls, and stays as well conditioned as the whole cloud
+  sample.setIndices (IndicesPtr ());
+  sample.setNumberOfSamples (60);
+  sample.setNumberOfThreads (2);
+  IndicesPtr indices (new vector<int>);
+  sample.filter (*indices);
+  ASSERT_EQ (int (indices->size ()), 60);
+  int nr_walls = 0;
+  vector<bool> sampled (points->size (), false);
+  for (size_t i = 0; i < indices->size (); ++i)
+  {
+    EXPECT_FALSE (sampled[(*indices)[i]]);
+    sampled[(*indices)[i]] = true;
+    if ((*indices)[i] >= 900)
+      ++nr_walls;
+  }
+  EXPECT_GE (nr_walls, 20);
+
+  vector<int> indices2;
+  sample.setNumberOfThreads (1);
+  sample.filter (indices2);
+  EXPECT_EQ (*indices, indices2);
+
+  sample.setIndices (indices);
+  EXPECT_LT (sample.computeConditionNumber (), condition_number);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (CropBox, Filters)
 {
@@ -1186,6 +1480,290 @@ TEST (CropBox, Filters)
   EXPECT_EQ (int (cloud_out2.width * cloud_out2.height), 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CropHull, Filters)
+{
+  // A unit cube triangulated into 12 faces, and a 11x11x11 grid of points around it
+  PointCloud<PointXYZ>::Ptr hull_cloud (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 8; ++i)
+    hull_cloud->push_back (PointXYZ (float (i & 1), float ((i >> 1) & 1), float ((i >> 2) & 1)));
+  const uint32_t faces[12][3] = {{0, 1, 3}, {0, 3, 2}, {4, 5, 7}, {4, 7, 6}, {0, 1, 5}, {0, 5, 4},
+                                 {2, 3, 7}, {2, 7, 6}, {0, 2, 6}, {0, 6, 4}, {1, 3, 7}, {1, 7, 5}};
+  std::vector<Vertices> polygons (12);
+  for (int f = 0; f < 12; ++f)
+    polygons[f].vertices.assign (faces[f], faces[f] + 3);
+
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 11; ++i)
+    for (int j = 0; j < 11; ++j)
+      for (int k = 0; k < 11; ++k)
+        input->push_back (PointXYZ (-0.45f + 0.2f * i, -0.45f + 0.2f * j, -0.45f + 0.2f * k));
+
+  // Points with all coordinates in (0, 1): 0.15 ... 0.95, 5 per axis
+  CropHull<PointXYZ> crop;
+  crop.setInputCloud (input);
+  crop.setHullCloud (hull_cloud);
+  crop.setHullIndices (polygons);
+  crop.setDim (3);
+  vector<int> indices;
+  crop.filter (indices);
+  EXPECT_EQ (int (indices.size ()), 125);
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    Eigen::Vector3f p = input->points[indices[i]].getVector3fMap ();
+    EXPECT_TRUE (p.minCoeff () > 0.0f && p.maxCoeff () < 1.0f);
+  }
+
+  // Filtering again gives the same result, and so do several threads
+  crop.setNumberOfThreads (4);
+  PointCloud<PointXYZ> cloud_out;
+  crop.filter (cloud_out);
+  EXPECT_EQ (int (cloud_out.points.size ()), 125);
+
+  crop.setCropOutside (false);
+  crop.filter (indices);
+  EXPECT_EQ (int (indices.size ()), 11 * 11 * 11 - 125);
+
+  // The bottom face of the cube as a 2D polygon, and the points in its plane
+  std::vector<Vertices> square (1);
+  const uint32_t corners[4] = {0, 1, 3, 2};
+  square[0].vertices.assign (corners, corners + 4);
+  PointCloud<PointXYZ>::Ptr plane (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 11; ++i)
+    for (int j = 0; j < 11; ++j)
+      plane->push_back (PointXYZ (-0.45f + 0.2f * i, -0.45f + 0.2f * j, 0.0f));
+  crop.setInputCloud (plane);
+  crop.setHullIndices (square);
+  crop.setDim (2);
+  crop.setCropOutside (true);
+  crop.filter (indices);
+  EXPECT_EQ (int (indices.size ()), 25);
+  crop.setCropOutside (false);
+  crop.filter (indices);
+  EXPECT_EQ (int (indices.size ()), 11 * 11 - 25);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (BilateralFilter, Filters)
+{
+  // A noisy plane with an intensity step in the middle
+  PointCloud<PointXYZI>::Ptr input (new PointCloud<PointXYZI>);
+  srand (0);
+  for (int i = 0; i < 40; ++i)
+    for (int j = 0; j < 40; ++j)
+    {
+      PointXYZI p;
+      p.x = 0.01f * float (i);
+      p.y = 0.01f * float (j);
+      p.z = 0.002f * float (rand () % 10);
+      p.intensity = (i < 20 ? 1.0f : 3.0f) + 0.002f * float (rand () % 100);
+      input->push_back (p);
+    }
+
+  BilateralFilter<PointXYZI> bilateral;
+  bilateral.setInputCloud (input);
+  bilateral.setHalfSize (0.02);
+  bilateral.setStdDev (0.3);
+  PointCloud<PointXYZI> exact, approximate;
+  bilateral.filter (exact);
+  bilateral.setApproximate (true);
+  bilateral.setNumberOfThreads (2);
+  bilateral.filter (approximate);
+
+  // The step is preserved by both, and the lattice stays close to the exact filter
+  ASSERT_EQ (exact.points.size (), input->points.size ());
+  ASSERT_EQ (approximate.points.size (), input->points.size ());
+  double error = 0;
+  for (size_t i = 0; i < input->points.size (); ++i)
+  {
+    EXPECT_NEAR (approximate.points[i].intensity, input->points[i].intensity, 0.2);
+    EXPECT_NEAR (approximate.points[i].intensity, exact.points[i].intensity, 0.05);
+    EXPECT_EQ (approximate.points[i].x, input->points[i].x);
+    error += fabs (approximate.points[i].intensity - exact.points[i].intensity);
+  }
+  EXPECT_LT (error / double (input->points.size ()), 0.01);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (Convolution3DApproximate, Filters)
+{
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  srand (0);
+  for (int i = 0; i < 30; ++i)
+    for (int j = 0; j < 30; ++j)
+      input->push_back (PointXYZ (0.01f * float (i), 0.01f * float (j), 0.005f * float (rand () % 10)));
+  PointXYZ invalid;
+  invalid.x = invalid.y = invalid.z = std::numeric_limits<float>::quiet_NaN ();
+  input->push_back (invalid);
+  input->is_dense = false;
+
+  typedef filters::GaussianKernel<PointXYZ, PointXYZ> Kernel;
+  Kernel kernel;
+  kernel.setSigma (0.01f);
+  kernel.setThresholdRelativeToSigma (4);
+  filters::Convolution3D<PointXYZ, PointXYZ, Kernel> convolution;
+  convolution.setInputCloud (input);
+  convolution.setKernel (kernel);
+  convolution.setRadiusSearch (0.04);
+  PointCloud<PointXYZ> exact, approximate;
+  convolution.convolve (exact);
+  convolution.setApproximate (true);
+  convolution.convolve (approximate);
+
+  ASSERT_EQ (approximate.points.size (), input->points.size ());
+  EXPECT_FALSE (approximate.is_dense);
+  EXPECT_FALSE (pcl_isfinite (approximate.points.back ().x));
+  double error = 0;
+  for (size_t i = 0; i + 1 < input->points.size (); ++i)
+  {
+    EXPECT_NEAR (approximate.points[i].z, exact.points[i].z, 0.01);
+    error += fabs (approximate.points[i].z - exact.points[i].z);
+  }
+  EXPECT_LT (error / double (input->points.size () - 1), 0.002);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+isAboveFloor (const PointXYZ &point)
+{
+  return (point.y > 0.05f);
+}
+
+void
+shiftUp (PointXYZ &point)
+{
+  point.z += 1.0f;
+}
+
+TEST (FilterPipeline, Filters)
+{
+  boost::shared_ptr<PassThrough<PointXYZ> > pass_through (new PassThrough<PointXYZ>);
+  pass_through->setFilterFieldName ("z");
+  pass_through->setFilterLimits (0.0f, 0.05f);
+  boost::shared_ptr<CropBox<PointXYZ> > crop_box (new CropBox<PointXYZ>);
+  crop_box->setMin (Eigen::Vector4f (-0.1f, 0.04f, -1.0f, 1.0f));
+  crop_box->setMax (Eigen::Vector4f (0.0f, 0.2f, 1.0f, 1.0f));
+  boost::shared_ptr<VoxelGrid<PointXYZ> > voxel_grid (new VoxelGrid<PointXYZ>);
+  voxel_grid->setLeafSize (0.01f, 0.01f, 0.01f);
+
+  // Same filters, run one after the other
+  PointCloud<PointXYZ>::Ptr passed (new PointCloud<PointXYZ>), cropped (new PointCloud<PointXYZ>);
+  PointCloud<PointXYZ> expected;
+  pass_through->setInputCloud (cloud);
+  pass_through->filter (*passed);
+  crop_box->setInputCloud (passed);
+  crop_box->filter (*cropped);
+  voxel_grid->setInputCloud (cropped);
+  voxel_grid->filter (expected);
+
+  FilterPipeline<PointXYZ> pipeline;
+  pipeline.addFilter (pass_through);
+  pipeline.addFilter (crop_box);
+  pipeline.addFilter (voxel_grid);
+  EXPECT_EQ (pipeline.getNumberOfStages (), 3);
+  pipeline.setInputCloud (cloud);
+  PointCloud<PointXYZ> output;
+  pipeline.filter (output);
+  EXPECT_EQ (output.header.frame_id, cloud->header.frame_id);
+  ASSERT_EQ (output.points.size (), expected.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output.points[i].x, expected.points[i].x);
+    EXPECT_EQ (output.points[i].y, expected.points[i].y);
+    EXPECT_EQ (output.points[i].z, expected.points[i].z);
+  }
+
+  // Point stages, fused with the index based filters
+  pipeline.clear ();
+  pipeline.addFilter (pass_through);
+  pipeline.addPointTest (&isAboveFloor);
+  pipeline.addFilter (crop_box);
+  pipeline.filter (output);
+  ASSERT_GT (output.points.size (), 0);
+  EXPECT_EQ (output.width, output.points.size ());
+  EXPECT_EQ (output.height, 1);
+  size_t nr_expected = 0;
+  for (size_t i = 0; i < cropped->points.size (); ++i)
+    if (isAboveFloor (cropped->points[i]))
+    {
+      ASSERT_LT (nr_expected, output.points.size ());
+      EXPECT_EQ (output.points[nr_expected].x, cropped->points[i].x);
+      EXPECT_EQ (output.points[nr_expected].y, cropped->points[i].y);
+      EXPECT_EQ (output.points[nr_expected].z, cropped->points[i].z);
+      ++nr_expected;
+    }
+  EXPECT_EQ (output.points.size (), nr_expected);
+
+  // A transform is seen by the following stages
+  pipeline.clear ();
+  pipeline.addPointTransform (&shiftUp);
+  pipeline.addFilter (pass_through);
+  pipeline.filter (output);
+  EXPECT_EQ (output.points.size (), 0);
+  pass_through->setFilterLimits (1.0f, 1.05f);
+  pipeline.filter (output);
+  PointCloud<PointXYZ>::Ptr shifted (new PointCloud<PointXYZ> (*cloud));
+  for (size_t i = 0; i < shifted->points.size (); ++i)
+    shiftUp (shifted->points[i]);
+  pass_through->setInputCloud (shifted);
+  pass_through->filter (expected);
+  ASSERT_GT (output.points.size (), 0);
+  ASSERT_EQ (output.points.size (), expected.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (output.points[i].z, expected.points[i].z);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (FilterPipelineNeighborhoodFilters, Filters)
+{
+  boost::shared_ptr<PassThrough<PointXYZ> > pass_through (new PassThrough<PointXYZ>);
+  pass_through->setFilterFieldName ("z");
+  pass_through->setFilterLimits (0.0f, 0.05f);
+  boost::shared_ptr<StatisticalOutlierRemoval<PointXYZ> > sor (new StatisticalOutlierRemoval<PointXYZ>);
+  sor->setMeanK (10);
+  sor->setStddevMulThresh (0.5);
+  boost::shared_ptr<RadiusOutlierRemovalOMP<PointXYZ> > ror (new RadiusOutlierRemovalOMP<PointXYZ>);
+  ror->setNumberOfThreads (2);
+  ror->setRadiusSearch (0.015);
+  ror->setMinNeighborsInRadius (8);
+
+  // The outlier filters must only see the points that passed, as when run one after the other
+  PointCloud<PointXYZ>::Ptr passed (new PointCloud<PointXYZ>), sor_filtered (new PointCloud<PointXYZ>);
+  PointCloud<PointXYZ> expected;
+  pass_through->setInputCloud (cloud);
+  pass_through->filter (*passed);
+  sor->setInputCloud (passed);
+  sor->filter (*sor_filtered);
+  ror->setInputCloud (sor_filtered);
+  ror->filter (expected);
+  ASSERT_GT (expected.points.size (), 0);
+  ASSERT_LT (expected.points.size (), sor_filtered->points.size ());
+
+  // Searching over the whole cloud instead keeps a different set of points
+  PointCloud<PointXYZ> unfiltered_neighbors;
+  IndicesPtr passed_indices (new std::vector<int>);
+  pass_through->filter (*passed_indices);
+  sor->setInputCloud (cloud);
+  sor->setIndices (passed_indices);
+  sor->filter (unfiltered_neighbors);
+  EXPECT_NE (unfiltered_neighbors.points.size (), sor_filtered->points.size ());
+
+  FilterPipeline<PointXYZ> pipeline;
+  pipeline.addFilter (pass_through);
+  pipeline.addFilter (sor);
+  pipeline.addFilter (ror);
+  pipeline.setInputCloud (cloud);
+  PointCloud<PointXYZ> output;
+  pipeline.filter (output);
+  ASSERT_EQ (output.points.size (), expected.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output.points[i].x, expected.points[i].x);
+    EXPECT_EQ (output.points[i].y, expected.points[i].y);
+    EXPECT_EQ (output.points[i].z, expected.points[i].z);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (StatisticalOutlierRemoval, Filters)
 {
@@ -1301,6 +1879,77 @@ TEST (StatisticalOutlierRemoval, Filters)
   EXPECT_NEAR (output.points[output.points.size () - 1].z, -0.0444, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (StatisticalOutlierRemovalOMP, Filters)
+{
+  PointCloud<PointXYZ> output, output_omp;
+  StatisticalOutlierRemoval<PointXYZ> outrem (true);
+  outrem.setInputCloud (cloud);
+  outrem.setMeanK (50);
+  outrem.setStddevMulThresh (1.0);
+  outrem.filter (output);
+
+  StatisticalOutlierRemovalOMP<PointXYZ> outrem_omp (true);
+
+  outrem_omp.setNumberOfThreads (4);
+  outrem_omp.setInputCloud (cloud);
+  outrem_omp.setMeanK (50);
+  outrem_omp.setStddevMulThresh (1.0);
+  outrem_omp.filter (output_omp);
+
+  EXPECT_EQ (int (output_omp.points.size ()), 352);
+  ASSERT_EQ (output_omp.points.size (), output.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output_omp.points[i].x, output.points[i].x);
+    EXPECT_EQ (output_omp.points[i].y, output.points[i].y);
+    EXPECT_EQ (output_omp.points[i].z, output.points[i].z);
+  }
+  EXPECT_EQ (*outrem_omp.getRemovedIndices (), *outrem.getRemovedIndices ());
+
+  outrem.setNegative (true);
+  outrem.filter (output);
+  outrem_omp.setNegative (true);
+  outrem_omp.filter (output_omp);
+  EXPECT_EQ (int (output_omp.points.size ()), int (cloud->points.size ()) - 352);
+  EXPECT_EQ (*outrem_omp.getRemovedIndices (), *outrem.getRemovedIndices ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (StatisticalOutlierRemovalGrid, Filters)
+{
+  PointCloud<PointXYZ> output, output_omp;
+  StatisticalOutlierRemoval<PointXYZ> outrem (true);
+  outrem.setInputCloud (cloud);
+  outrem.setStddevMulThresh (1.0);
+  outrem.setSearchMode (StatisticalOutlierRemoval<PointXYZ>::SEARCH_MODE_GRID);
+  outrem.setGridLeafSize (0.01);
+  EXPECT_EQ (outrem.getGridLeafSize (), 0.01);
+  outrem.filter (output);
+
+  // The grid search only estimates the point density, so just check that it removes the sparse points
+  EXPECT_GT (output.points.size (), cloud->points.size () / 2);
+  EXPECT_LT (output.points.size (), cloud->points.size ());
+  EXPECT_EQ (output.points.size () + outrem.getRemovedIndices ()->size (), cloud->points.size ());
+
+  StatisticalOutlierRemovalOMP<PointXYZ> outrem_omp (true);
+
+  outrem_omp.setNumberOfThreads (4);
+  outrem_omp.setInputCloud (cloud);
+  outrem_omp.setStddevMulThresh (1.0);
+  outrem_omp.setSearchMode (StatisticalOutlierRemoval<PointXYZ>::SEARCH_MODE_GRID);
+  outrem_omp.setGridLeafSize (0.01);
+  outrem_omp.filter (output_omp);
+  ASSERT_EQ (output_omp.points.size (), output.points.size ());
+  EXPECT_EQ (*outrem_omp.getRemovedIndices (), *outrem.getRemovedIndices ());
+
+  // Without a leaf size, the tree search is used
+  outrem.setGridLeafSize (0.0);
+  outrem.setMeanK (50);
+  outrem.filter (output);
+  EXPECT_EQ (int (output.points.size ()), 352);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemoval, Filters)
 {
@@ -1387,6 +2036,70 @@ TEST (ConditionalRemoval, Filters)
   EXPECT_EQ (int (num_not_nan), cloud->points.size()-condrem_.getRemovedIndices()->size());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ConditionalRemovalBlockEvaluation, Filters)
+{
+  // A copy of the cloud with a few invalid points, and a subset of its indices
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ> (*cloud));
+  for (size_t i = 0; i < input->points.size (); i += 37)
+    input->points[i].y = std::numeric_limits<float>::quiet_NaN ();
+  input->is_dense = false;
+  IndicesPtr indices (new std::vector<int>);
+  for (int i = 0; i < static_cast<int> (input->points.size ()); i += 2)
+    indices->push_back (i);
+
+  // (z > 0.0 AND y <= 0.15 AND (x < -0.05 OR x >= 0.0 OR (y == 0.1 AND z == 0.1))) AND (an empty OR)
+  ConditionOr<PointXYZ>::Ptr x_cond (new ConditionOr<PointXYZ> ());
+  x_cond->addComparison (FieldComparison<PointXYZ>::ConstPtr (new FieldComparison<PointXYZ> ("x", ComparisonOps::LT, -0.05)));
+  x_cond->addComparison (FieldComparison<PointXYZ>::ConstPtr (new FieldComparison<PointXYZ> ("x", ComparisonOps::GE, 0.0)));
+  ConditionAnd<PointXYZ>::Ptr eq_cond (new ConditionAnd<PointXYZ> ());
+  eq_cond->addComparison (FieldComparison<PointXYZ>::ConstPtr (new FieldComparison<PointXYZ> ("y", ComparisonOps::EQ, 0.1)));
+  eq_cond->addComparison (FieldComparison<PointXYZ>::ConstPtr (new FieldComparison<PointXYZ> ("z", ComparisonOps::EQ, 0.1)));
+  x_cond->addCondition (eq_cond);
+  ConditionAnd<PointXYZ>::Ptr range_cond (new ConditionAnd<PointXYZ> ());
+  range_cond->addComparison (FieldComparison<PointXYZ>::ConstPtr (new FieldComparison<PointXYZ> ("z", ComparisonOps::GT, 0.0)));
+  range_cond->addComparison (FieldComparison<PointXYZ>::ConstPtr (new FieldComparison<PointXYZ> ("y", ComparisonOps::LE, 0.15)));
+  range_cond->addCondition (x_cond);
+  range_cond->addCondition (ConditionOr<PointXYZ>::Ptr (new ConditionOr<PointXYZ> ()));
+
+  ConditionalRemoval<PointXYZ> condrem (range_cond, true);
+  ConditionalRemoval<PointXYZ> condrem_block (range_cond, true);
+  condrem_block.setBlockEvaluation (true);
+  EXPECT_TRUE (condrem_block.getBlockEvaluation ());
+  EXPECT_EQ (range_cond->getNestingDepth (), 3);
+
+  for (int keep_organized = 0; keep_organized < 2; ++keep_organized)
+  {
+    for (int use_indices = 0; use_indices < 2; ++use_indices)
+    {
+      PointCloud<PointXYZ> output, output_block;
+      condrem.setInputCloud (input);
+      condrem_block.setInputCloud (input);
+      if (use_indices)
+      {
+        condrem.setIndices (indices);
+        condrem_block.setIndices (indices);
+      }
+      condrem.setKeepOrganized (keep_organized != 0);
+      condrem_block.setKeepOrganized (keep_organized != 0);
+      condrem.filter (output);
+      condrem_block.filter (output_block);
+
+      EXPECT_GT (output.points.size (), 0);
+      ASSERT_EQ (output_block.points.size (), output.points.size ());
+      for (size_t i = 0; i < output.points.size (); ++i)
+        for (int d = 0; d < 3; ++d)
+        {
+          if (pcl_isfinite (output.points[i].data[d]))
+            EXPECT_EQ (output_block.points[i].data[d], output.points[i].data[d]);
+          else
+            EXPECT_FALSE (pcl_isfinite (output_block.points[i].data[d]));
+        }
+      EXPECT_EQ (*condrem_block.getRemovedIndices (), *condrem.getRemovedIndices ());
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemovalSetIndices, Filters)
 {
@@ -46,14 +46,20 @@
 #include <pcl/registration/registration.h>
 #include <pcl/registration/icp.h>
 #include <pcl/registration/icp_nl.h>
+#include <pcl/registration/gicp.h>
 #include <pcl/registration/transformation_estimation_point_to_plane.h>
 #include <pcl/registration/transformation_validation_euclidean.h>
 #include <pcl/registration/transformation_estimation_point_to_plane_lls.h>
+#include <pcl/registration/transformation_estimation_point_to_plane_irls.h>
 #include <pcl/registration/ia_ransac.h>
 #include <pcl/registration/pyramid_feature_matching.h>
 #include <pcl/features/ppf.h>
 #include <pcl/registration/ppf_registration.h>
 #include <pcl/registration/ndt.h>
+#include <pcl/registration/multi_resolution_registration.h>
+#include <pcl/registration/lum.h>
+#include <pcl/registration/impl/lum.hpp>
+#include <pcl/registration/elch.h>
 // We need Histogram<2> to function, so we'll explicitely add kdtree_flann.hpp here
 #include <pcl/kdtree/impl/kdtree_flann.hpp>
 //(pcl::Histogram<2>)
@@ -185,6 +191,14 @@ TEST (PCL, IterativeClosestPoint)
   EXPECT_EQ (transformation (3, 1), 0);
   EXPECT_EQ (transformation (3, 2), 0);
   EXPECT_EQ (transformation (3, 3), 1);
+
+  // The parallel correspondence search converges to the same alignment
+  reg.setNumberOfThreads (4);
+  reg.align (cloud_reg);
+  Eigen::Matrix4f transformation_parallel = reg.getFinalTransformation ();
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (transformation (i, j), transformation_parallel (i, j), 1e-3);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -294,6 +308,58 @@ TEST (PCL, IterativeClosestPoint_PointToPlane)
   EXPECT_LT (reg.getFitnessScore (), 0.001);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GeneralizedIterativeClosestPoint)
+{
+  typedef PointXYZ PointT;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT> (cloud_source));
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT> (cloud_target));
+  PointCloud<PointT> output;
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg;
+  reg.setInputCloud (src);
+  reg.setInputTarget (tgt);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.setNumberOfThreads (2);
+
+  // Register
+  reg.align (output);
+  EXPECT_EQ (int (output.points.size ()), int (cloud_source.points.size ()));
+  EXPECT_LT (reg.getFitnessScore (), 0.0001);
+  Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+
+  // The regularized covariances have eigenvalues (epsilon, 1, 1)
+  const std::vector<Eigen::Matrix3d> &covariances = reg.getTargetCovariances ();
+  ASSERT_EQ (covariances.size (), tgt->size ());
+  for (size_t i = 0; i < covariances.size (); i += 100)
+  {
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (covariances[i]);
+    EXPECT_NEAR (solver.eigenvalues () (0), 0.001, 1e-6);
+    EXPECT_NEAR (solver.eigenvalues () (1), 1.0, 1e-6);
+    EXPECT_NEAR (solver.eigenvalues () (2), 1.0, 1e-6);
+  }
+
+  // Target covariances loaded from disk give the same alignment
+  EXPECT_TRUE (reg.saveTargetCovariances ("test_gicp_covariances.bin"));
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg_loaded;
+  reg_loaded.setInputCloud (src);
+  reg_loaded.setInputTarget (tgt);
+  reg_loaded.setMaximumIterations (50);
+  reg_loaded.setTransformationEpsilon (1e-8);
+  EXPECT_TRUE (reg_loaded.loadTargetCovariances ("test_gicp_covariances.bin"));
+  reg_loaded.align (output);
+  Eigen::Matrix4f transformation_loaded = reg_loaded.getFinalTransformation ();
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (transformation (i, j), transformation_loaded (i, j), 1e-4);
+
+  // A file written for another target is rejected
+  reg_loaded.setInputTarget (src);
+  EXPECT_FALSE (reg_loaded.loadTargetCovariances ("test_gicp_covariances.bin"));
+  remove ("test_gicp_covariances.bin");
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, NormalDistributionsTransform)
 {
@@ -317,8 +383,214 @@ TEST (PCL, NormalDistributionsTransform)
   EXPECT_EQ (int (output.points.size ()), int (cloud_source.points.size ()));
 
   EXPECT_LT (reg.getFitnessScore (), 0.001);
+  Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+
+  // The per thread accumulation gives the same alignment
+  reg.setNumberOfThreads (4);
+  reg.align (output);
+  Eigen::Matrix4f transformation_parallel = reg.getFinalTransformation ();
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (transformation (i, j), transformation_parallel (i, j), 1e-4);
+
+  // Scoring against the voxel of each point and its face neighbors only
+  reg.setNeighborSearchMethod (NormalDistributionsTransform<PointT, PointT>::DIRECT7);
+  reg.align (output);
+  EXPECT_LT (reg.getFitnessScore (), 0.001);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MultiResolutionRegistration)
+{
+  typedef PointXYZ PointT;
+  typedef IterativeClosestPoint<PointT, PointT> ICP;
+  typedef NormalDistributionsTransform<PointT, PointT> NDT;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT> (cloud_source));
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT> (cloud_target));
+  PointCloud<PointT> output;
+
+  // ICP from 1cm voxels down to the full resolution
+  MultiResolutionRegistration<PointT, PointT> reg;
+  const float leaf_sizes[] = { 0.01f, 0.005f, 0.0f };
+  for (int l = 0; l < 3; ++l)
+  {
+    boost::shared_ptr<ICP> icp (new ICP);
+    icp->setMaximumIterations (l < 2 ? 20 : 10);
+    icp->setTransformationEpsilon (1e-8);
+    icp->setMaxCorrespondenceDistance (0.05 / (l + 1));
+    reg.addLevel (icp, leaf_sizes[l]);
+  }
+  EXPECT_EQ (reg.getNumberOfLevels (), 3u);
+  reg.setInputCloud (src);
+  reg.setInputTarget (tgt);
+
+  reg.align (output);
+  EXPECT_EQ (int (output.points.size ()), int (cloud_source.points.size ()));
+  EXPECT_LT (reg.getFitnessScore (), 0.0001);
+  Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+
+  // The coarse levels bring the alignment further than the same number of full 
+  // resolution iterations alone
+  ICP icp;
+  icp.setMaximumIterations (10);
+  icp.setTransformationEpsilon (1e-8);
+  icp.setMaxCorrespondenceDistance (0.05 / 3);
+  icp.setInputCloud (src);
+  icp.setInputTarget (tgt);
+  PointCloud<PointT> output_icp;
+  icp.align (output_icp);
+  EXPECT_LT (reg.getFitnessScore (), icp.getFitnessScore ());
+
+  const std::vector<MultiResolutionRegistration<PointT, PointT>::LevelStatistics> &stats = reg.getLevelStatistics ();
+  ASSERT_EQ (stats.size (), 3u);
+  EXPECT_LT (stats[0].nr_source_points, stats[1].nr_source_points);
+  EXPECT_LT (stats[1].nr_source_points, stats[2].nr_source_points);
+  EXPECT_EQ (stats[2].nr_source_points, cloud_source.points.size ());
+  EXPECT_EQ (stats[2].nr_target_points, cloud_target.points.size ());
+
+  // A second alignment against the same target reuses the level targets
+  reg.align (output, transformation);
+  EXPECT_LT (reg.getFitnessScore (), 0.0001);
+
+  // NDT with a finer grid at every level
+  MultiResolutionRegistration<PointT, PointT> reg_ndt;
+  for (int l = 0; l < 2; ++l)
+  {
+    boost::shared_ptr<NDT> ndt (new NDT);
+    ndt->setStepSize (0.05);
+    ndt->setResolution (l == 0 ? 0.05f : 0.025f);
+    ndt->setMaximumIterations (25);
+    ndt->setTransformationEpsilon (1e-8);
+    reg_ndt.addLevel (ndt, l == 0 ? 0.01f : 0.0f);
+  }
+  reg_ndt.setInputCloud (src);
+  reg_ndt.setInputTarget (tgt);
+  reg_ndt.align (output);
+  EXPECT_EQ (int (output.points.size ()), int (cloud_source.points.size ()));
+  EXPECT_LT (reg_ndt.getFitnessScore (), 0.001);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LUM)
+{
+  // A loop of scans of the same points, with exact correspondences between consecutive scans
+  const int nr_scans = 12;
+  PointCloud<PointXYZ> world;
+  for (int i = 0; i < 60; ++i)
+    world.push_back (PointXYZ (float ((i * 37) % 17) * 0.1f, float ((i * 53) % 23) * 0.07f, float ((i * 11) % 13) * 0.09f));
+
+  registration::LUM<PointXYZ> lum;
+  for (int k = 0; k < nr_scans; ++k)
+  {
+    const float angle = 2.0f * static_cast<float> (M_PI) * static_cast<float> (k) / static_cast<float> (nr_scans);
+    Eigen::Vector6f pose;
+    pose << 3.0f * cosf (angle) - 3.0f, 3.0f * sinf (angle), 0.1f * sinf (3.0f * angle), 0.0f, 0.0f, angle;
+    PointCloud<PointXYZ>::Ptr scan (new PointCloud<PointXYZ>);
+    transformPointCloud (world, *scan, getTransformation (pose (0), pose (1), pose (2), pose (3), pose (4), pose (5)).inverse ());
+
+    // Disturb the pose estimates
+    if (k > 0)
+    {
+      pose (0) += 0.02f * static_cast<float> (k) / static_cast<float> (nr_scans);
+      pose (5) += 0.01f * static_cast<float> (k % 3 - 1);
+    }
+    lum.addPointCloud (scan, pose);
+  }
+  for (int k = 0; k < nr_scans; ++k)
+  {
+    CorrespondencesPtr corrs (new Correspondences);
+    for (int i = 0; i < static_cast<int> (world.points.size ()); ++i)
+      corrs->push_back (Correspondence (i, i, 0.0f));
+    lum.setCorrespondences (k, (k + 1) % nr_scans, corrs);
+  }
+  // A scan without usable correspondences keeps its pose
+  PointCloud<PointXYZ>::Ptr lonely (new PointCloud<PointXYZ> (world));
+  Eigen::Vector6f lonely_pose = Eigen::Vector6f::Constant (0.5f);
+  lum.addPointCloud (lonely, lonely_pose);
+
+  lum.setMaxIterations (10);
+  lum.setNumberOfThreads (4);
+  lum.compute ();
+
+  for (int k = 0; k < nr_scans; ++k)
+  {
+    PointCloud<PointXYZ>::Ptr aligned = lum.getTransformedCloud (k);
+    for (size_t i = 0; i < world.points.size (); ++i)
+    {
+      EXPECT_NEAR (aligned->points[i].x, world.points[i].x, 1e-2);
+      EXPECT_NEAR (aligned->points[i].y, world.points[i].y, 1e-2);
+      EXPECT_NEAR (aligned->points[i].z, world.points[i].z, 1e-2);
+    }
+  }
+  EXPECT_EQ (lum.getPose (nr_scans), lonely_pose);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ELCH)
+{
+  typedef registration::ELCH<PointXYZ> ELCH;
+  ELCH elch, elch_deferred;
+  elch_deferred.setDeferTransformation (true);
+  elch_deferred.setNumberOfThreads (4);
+
+  const int nr_scans = 10;
+  for (int k = 0; k < nr_scans; ++k)
+  {
+    PointCloud<PointXYZ>::Ptr scan (new PointCloud<PointXYZ>);
+    for (int i = 0; i < 50; ++i)
+      scan->push_back (PointXYZ (float (k) + float ((i * 37) % 17) * 0.05f, float ((i * 53) % 23) * 0.04f, float ((i * 11) % 13) * 0.03f));
+    elch.addPointCloud (scan);
+    elch_deferred.addPointCloud (PointCloud<PointXYZ>::Ptr (new PointCloud<PointXYZ> (*scan)));
+  }
+  ELCH::LoopGraphPtr graph = elch.getLoopGraph ();
+  ELCH::LoopGraphPtr graph_deferred = elch_deferred.getLoopGraph ();
+  const PointCloud<PointXYZ> first_scan = *(*graph)[0].cloud;
+  const PointCloud<PointXYZ> last_scan = *(*graph)[nr_scans - 1].cloud;
+
+  // Two loops, given explicitly so that no registration is involved
+  Eigen::Affine3f loops[2];
+  loops[0] = Eigen::Translation3f (0.3f, -0.2f, 0.1f) * Eigen::AngleAxisf (0.2f, Eigen::Vector3f::UnitZ ());
+  loops[1] = Eigen::Translation3f (-0.1f, 0.25f, 0.0f) * Eigen::AngleAxisf (0.1f, Eigen::Vector3f::UnitX ());
+  const int starts[2] = {2, 0}, ends[2] = {8, nr_scans - 1};
+  for (int l = 0; l < 2; ++l)
+  {
+    elch.setLoopStart (starts[l]);
+    elch.setLoopEnd (ends[l]);
+    elch.setLoopTransform (loops[l].matrix ());
+    elch.compute ();
+    elch_deferred.setLoopStart (starts[l]);
+    elch_deferred.setLoopEnd (ends[l]);
+    elch_deferred.setLoopTransform (loops[l].matrix ());
+    elch_deferred.compute ();
+
+    // Only the scans behind the start of the loop move, and only the scans on the loop are balanced
+    EXPECT_EQ (elch.getNumberOfUpdatedVertices (), size_t (nr_scans - 1 - starts[l]));
+    EXPECT_EQ (elch.getNumberOfOptimizedVertices (), size_t (ends[l] - starts[l] + 1));
+    EXPECT_EQ (elch_deferred.getNumberOfUpdatedVertices (), elch.getNumberOfUpdatedVertices ());
+    if (l == 0)
+    {
+      for (size_t i = 0; i < first_scan.points.size (); ++i)
+        EXPECT_EQ ((*graph)[0].cloud->points[i].getVector3fMap (), first_scan.points[i].getVector3fMap ());
+      // The end of the loop receives the full correction
+      for (size_t i = 0; i < last_scan.points.size (); ++i)
+        EXPECT_LT (((*graph)[nr_scans - 1].cloud->points[i].getVector3fMap () - loops[0] * last_scan.points[i].getVector3fMap ()).norm (), 1e-4);
+    }
+  }
+
+  // The deferred clouds are untouched until the corrections are applied
+  for (size_t i = 0; i < last_scan.points.size (); ++i)
+    EXPECT_EQ ((*graph_deferred)[nr_scans - 1].cloud->points[i].getVector3fMap (), last_scan.points[i].getVector3fMap ());
+  EXPECT_FALSE (elch_deferred.getPendingTransformation (nr_scans - 1).matrix ().isIdentity ());
+
+  elch_deferred.applyPendingTransformations ();
+  for (int k = 0; k < nr_scans; ++k)
+  {
+    EXPECT_TRUE (elch_deferred.getPendingTransformation (k).matrix ().isIdentity ());
+    for (size_t i = 0; i < (*graph)[k].cloud->points.size (); ++i)
+      EXPECT_LT (((*graph_deferred)[k].cloud->points[i].getVector3fMap () - (*graph)[k].cloud->points[i].getVector3fMap ()).norm (), 1e-4);
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, TransformationEstimationPointToPlaneLLS)
@@ -373,6 +645,79 @@ TEST (PCL, TransformationEstimationPointToPlaneLLS)
       EXPECT_NEAR (estimated_tform (i, j), ground_truth_tform (i, j), 1e-2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TransformationEstimationPointToPlaneIRLS)
+{
+  // Create a test cloud
+  PointCloud<PointNormal>::Ptr src (new PointCloud<PointNormal>);
+  src->height = 1;
+  src->is_dense = true;
+  for (float x = -5.0f; x <= 5.0f; x += 0.5f)
+  {
+    for (float y = -5.0f; y <= 5.0f; y += 0.5f)
+    {
+      PointNormal p;
+      p.x = x;
+      p.y = y;
+      p.z = 0.1f * powf (x, 2.0f) + 0.2f * p.x * p.y - 0.3f * y + 1.0f;
+      Eigen::Vector3f n (-0.2f * p.x - 0.2f * p.y, 0.3f - 0.2f * p.x, 1.0f);
+      n.normalize ();
+      p.normal_x = n[0]; p.normal_y = n[1]; p.normal_z = n[2];
+      src->points.push_back (p);
+    }
+  }
+  src->width = static_cast<uint32_t> (src->points.size ());
+
+  // Create a rigid test matrix, with a rotation too large for a single linearization
+  Eigen::Matrix4f ground_truth_tform = Eigen::Matrix4f::Identity ();
+  ground_truth_tform.topLeftCorner<3, 3> () = Eigen::AngleAxisf (0.3f, Eigen::Vector3f (0.2f, -0.5f, 1.0f).normalized ()).toRotationMatrix ();
+  ground_truth_tform.block<3, 1> (0, 3) = Eigen::Vector3f (0.1f, -0.2f, 0.3f);
+
+  PointCloud<PointNormal>::Ptr tgt (new PointCloud<PointNormal>);
+  transformPointCloudWithNormals (*src, *tgt, ground_truth_tform);
+
+  // Gauss-Newton iterations recover the transformation exactly
+  registration::TransformationEstimationPointToPlaneIRLS<PointNormal, PointNormal> tform_est;
+  tform_est.setMaximumIterations (20);
+  Eigen::Matrix4f estimated_tform;
+  tform_est.estimateRigidTransformation (*src, *tgt, estimated_tform);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (estimated_tform (i, j), ground_truth_tform (i, j), 1e-4);
+
+  // So does the symmetric objective, with more threads
+  tform_est.setSymmetric (true);
+  tform_est.setNumberOfThreads (4);
+  tform_est.estimateRigidTransformation (*src, *tgt, estimated_tform);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (estimated_tform (i, j), ground_truth_tform (i, j), 1e-4);
+  tform_est.setSymmetric (false);
+
+  // Corrupt 10% of the correspondences
+  std::vector<int> indices_src (src->points.size ()), indices_tgt (src->points.size ());
+  for (size_t i = 0; i < src->points.size (); ++i)
+  {
+    indices_src[i] = static_cast<int> (i);
+    indices_tgt[i] = static_cast<int> (i % 10 == 0 ? (i * 7) % src->points.size () : i);
+  }
+
+  tform_est.estimateRigidTransformation (*src, indices_src, *tgt, indices_tgt, estimated_tform);
+  const float plain_error = (estimated_tform - ground_truth_tform).norm ();
+  EXPECT_GT (plain_error, 1e-2);
+
+  // Robust kernels ignore the wrong correspondences
+  tform_est.setRobustKernel (registration::TransformationEstimationPointToPlaneIRLS<PointNormal, PointNormal>::HUBER, 0.01);
+  tform_est.estimateRigidTransformation (*src, indices_src, *tgt, indices_tgt, estimated_tform);
+  EXPECT_LT ((estimated_tform - ground_truth_tform).norm (), 0.1 * plain_error);
+
+  tform_est.setRobustKernel (registration::TransformationEstimationPointToPlaneIRLS<PointNormal, PointNormal>::CAUCHY, 0.01);
+  tform_est.estimateRigidTransformation (*src, indices_src, *tgt, indices_tgt, estimated_tform);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (estimated_tform (i, j), ground_truth_tform (i, j), 1e-3);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, SampleConsensusInitialAlignment)
 {
@@ -427,9 +772,40 @@ TEST (PCL, SampleConsensusInitialAlignment)
   reg.setTargetFeatures (features_target.makeShared ());
 
   // Register
+  srand (12345);
   reg.align (cloud_reg);
   EXPECT_EQ (int (cloud_reg.points.size ()), int (cloud_source.points.size ()));
   EXPECT_EQ (reg.getFitnessScore () < 0.0005, true);
+  EXPECT_EQ (reg.getNumberOfHypotheses (), 1000);
+
+  // Generating the hypotheses in parallel gives the same alignment
+  const Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+  srand (12345);
+  reg.setNumberOfThreads (4);
+  reg.align (cloud_reg);
+  EXPECT_TRUE (reg.getFinalTransformation () == transformation);
+
+  // Relaxing an unreachable minimum sample distance is done per hypothesis, and does not change the setting
+  reg.setMinSampleDistance (0.2f);
+  reg.setMaximumIterations (100);
+  reg.setNumberOfThreads (1);
+  srand (12345);
+  reg.align (cloud_reg);
+  const Eigen::Matrix4f relaxed_transformation = reg.getFinalTransformation ();
+  EXPECT_EQ (reg.getMinSampleDistance (), 0.2f);
+  reg.setNumberOfThreads (4);
+  srand (12345);
+  reg.align (cloud_reg);
+  EXPECT_TRUE (reg.getFinalTransformation () == relaxed_transformation);
+  reg.setMinSampleDistance (0.05f);
+  reg.setMaximumIterations (1000);
+
+  // A time budget stops drawing hypotheses, but one is always scored
+  reg.setMaximumComputationTime (1e-6);
+  reg.align (cloud_reg);
+  EXPECT_GE (reg.getNumberOfHypotheses (), 1);
+  EXPECT_LT (reg.getNumberOfHypotheses (), 1000);
+  EXPECT_EQ (int (cloud_reg.points.size ()), int (cloud_source.points.size ()));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -514,6 +890,121 @@ TEST (PCL, PyramidFeatureHistogram)
   EXPECT_NEAR (similarity_value3, 0.87623238563537598, 1e-3);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PPFHashMapSearch)
+{
+  // Compute the PPFSignature features of the model
+  PointCloud<PointXYZ>::Ptr cloud_source_ptr = cloud_source.makeShared ();
+  NormalEstimation<PointXYZ, Normal> normal_estimation;
+  search::KdTree<PointXYZ>::Ptr search_tree (new search::KdTree<PointXYZ> ());
+  normal_estimation.setSearchMethod (search_tree);
+  normal_estimation.setRadiusSearch (0.05);
+  normal_estimation.setInputCloud (cloud_source_ptr);
+  PointCloud<Normal>::Ptr normals_source (new PointCloud<Normal> ());
+  normal_estimation.compute (*normals_source);
+
+  PPFEstimation<PointXYZ, Normal, PPFSignature> ppf_estimator;
+  PointCloud<PPFSignature>::Ptr features_source (new PointCloud<PPFSignature> ());
+  ppf_estimator.setInputCloud (cloud_source_ptr);
+  ppf_estimator.setInputNormals (normals_source);
+  ppf_estimator.compute (*features_source);
+
+  const float angle_step = 15.0f / 180.0f * static_cast<float> (M_PI), distance_step = 0.01f;
+  PPFHashMapSearch::Ptr hash_map_search (new PPFHashMapSearch (angle_step, distance_step));
+  hash_map_search->setInputFeatureCloud (features_source);
+  const size_t n = cloud_source.points.size ();
+  EXPECT_EQ (hash_map_search->getNumberOfModelPoints (), n);
+
+  // Every valid pair is stored once, in the bin of its discretized feature
+  size_t nr_valid = 0;
+  float max_dist = -1.0f;
+  for (size_t k = 0; k < features_source->points.size (); ++k)
+  {
+    const PPFSignature &f = features_source->points[k];
+    if (pcl_isfinite (f.f1) && pcl_isfinite (f.f2) && pcl_isfinite (f.f3) && pcl_isfinite (f.f4) && pcl_isfinite (f.alpha_m))
+      ++nr_valid;
+    if (max_dist < f.f4)
+      max_dist = f.f4;
+  }
+  EXPECT_EQ (hash_map_search->getNumberOfPairs (), nr_valid);
+  EXPECT_EQ (hash_map_search->getModelDiameter (), max_dist);
+
+  PPFHashMapSearch::Ptr threaded_search (new PPFHashMapSearch (angle_step, distance_step));
+  threaded_search->setNumberOfThreads (3);
+  threaded_search->setInputFeatureCloud (features_source);
+  EXPECT_EQ (threaded_search->getNumberOfBins (), hash_map_search->getNumberOfBins ());
+
+  std::vector<std::pair<size_t, size_t> > indices, threaded_indices;
+  for (size_t k = 1; k < features_source->points.size (); k += 101)
+  {
+    PPFSignature f = features_source->points[k];
+    if (!pcl_isfinite (f.f1) || !pcl_isfinite (f.alpha_m))
+      continue;
+    hash_map_search->nearestNeighborSearch (f.f1, f.f2, f.f3, f.f4, indices);
+    EXPECT_EQ (std::count (indices.begin (), indices.end (), std::make_pair (k / n, k % n)), 1);
+    for (size_t i = 0; i < indices.size (); ++i)
+    {
+      const PPFSignature &g = features_source->points[indices[i].first * n + indices[i].second];
+      EXPECT_EQ (floor (g.f1 / angle_step), floor (f.f1 / angle_step));
+      EXPECT_EQ (floor (g.f4 / distance_step), floor (f.f4 / distance_step));
+    }
+
+    // The table does not depend on the number of threads it was built with
+    threaded_search->nearestNeighborSearch (f.f1, f.f2, f.f3, f.f4, threaded_indices);
+    EXPECT_TRUE (indices == threaded_indices);
+  }
+
+  // Save and load the table
+  EXPECT_TRUE (hash_map_search->saveHashMap ("test_ppf_hash_map.bin"));
+  PPFHashMapSearch::Ptr loaded_search (new PPFHashMapSearch ());
+  EXPECT_TRUE (loaded_search->loadHashMap ("test_ppf_hash_map.bin"));
+  remove ("test_ppf_hash_map.bin");
+  EXPECT_EQ (loaded_search->getAngleDiscretizationStep (), angle_step);
+  EXPECT_EQ (loaded_search->getDistanceDiscretizationStep (), distance_step);
+  EXPECT_EQ (loaded_search->getModelDiameter (), max_dist);
+  EXPECT_EQ (loaded_search->getNumberOfPairs (), nr_valid);
+  EXPECT_EQ (loaded_search->alpha_m_[3][5], hash_map_search->alpha_m_[3][5]);
+  for (size_t k = 1; k < features_source->points.size (); k += 101)
+  {
+    PPFSignature f = features_source->points[k];
+    if (!pcl_isfinite (f.f1) || !pcl_isfinite (f.alpha_m))
+      continue;
+    hash_map_search->nearestNeighborSearch (f.f1, f.f2, f.f3, f.f4, indices);
+    loaded_search->nearestNeighborSearch (f.f1, f.f2, f.f3, f.f4, threaded_indices);
+    EXPECT_TRUE (indices == threaded_indices);
+  }
+  EXPECT_FALSE (loaded_search->loadHashMap ("test_ppf_hash_map.bin"));
+
+  // Find the model in a transformed copy of itself
+  PointCloud<PointNormal>::Ptr cloud_source_with_normals (new PointCloud<PointNormal> ()),
+      cloud_scene (new PointCloud<PointNormal> ());
+  concatenateFields (cloud_source, *normals_source, *cloud_source_with_normals);
+  const Eigen::Affine3f ground_truth = Eigen::Translation3f (0.05f, -0.02f, 0.03f) * 
+                                       Eigen::AngleAxisf (0.5f, Eigen::Vector3f (0.3f, 1.0f, 0.2f).normalized ());
+  transformPointCloudWithNormals (*cloud_source_with_normals, *cloud_scene, ground_truth);
+
+  PPFRegistration<PointNormal, PointNormal> ppf_registration;
+  ppf_registration.setSceneReferencePointSamplingRate (10);
+  ppf_registration.setPositionClusteringThreshold (0.02f);
+  ppf_registration.setRotationClusteringThreshold (30.0f / 180.0f * static_cast<float> (M_PI));
+  ppf_registration.setSearchMethod (hash_map_search);
+  ppf_registration.setInputCloud (cloud_source_with_normals);
+  ppf_registration.setInputTarget (cloud_scene);
+  PointCloud<PointNormal> cloud_output;
+  ppf_registration.align (cloud_output);
+  const Eigen::Matrix4f transformation = ppf_registration.getFinalTransformation ();
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (transformation (i, j), ground_truth (i, j), 0.05);
+
+  // Voting in parallel gives the same pose
+
+  ppf_registration.setNumberOfThreads (4);
+  ppf_registration.setSearchMethod (loaded_search);
+  ppf_registration.align (cloud_output);
+  EXPECT_TRUE (ppf_registration.getFinalTransformation () == transformation);
+}
+
 // Suat G: disabled, since the transformation does not look correct.
 // ToDo: update transformation from the ground truth.
 #if 0
@@ -50,9 +50,11 @@
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
 #include <pcl/registration/correspondence_rejection_trimmed.h>
 #include <pcl/registration/correspondence_rejection_var_trimmed.h>
+#include <pcl/registration/correspondence_rejection_chain.h>
 #include <pcl/registration/transformation_estimation_lm.h>
 #include <pcl/registration/transformation_estimation_svd.h>
 #include <pcl/features/normal_3d.h>
+#include <pcl/common/transforms.h>
 
 #include "test_registration_api_data.h"
 
@@ -102,6 +104,118 @@ TEST (PCL, CorrespondenceEstimationReciprocal)
       EXPECT_EQ ((*correspondences)[i].index_match, correspondences_reciprocal[i][1]);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CorrespondenceEstimationParallel)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source (new pcl::PointCloud<pcl::PointXYZ>(cloud_source));
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>(cloud_target));
+
+  // Moving the source by a transformation is the same as transforming the cloud
+  Eigen::Matrix4f transform = Eigen::Matrix4f::Identity ();
+  transform.topLeftCorner<3, 3> () = Eigen::AngleAxisf (0.1f, Eigen::Vector3f::UnitZ ()).toRotationMatrix ();
+  transform (0, 3) = 0.01f;
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source_moved (new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::transformPointCloud (*source, *source_moved, transform);
+
+  pcl::Correspondences serial, parallel, moved;
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> corr_est;
+  corr_est.setInputCloud (source_moved);
+  corr_est.setInputTarget (target);
+  corr_est.determineCorrespondences (serial, 0.005f);
+  corr_est.setNumberOfThreads (4);
+  corr_est.determineCorrespondences (parallel, 0.005f);
+  ASSERT_EQ (serial.size (), parallel.size ());
+  EXPECT_GT (serial.size (), 0u);
+  EXPECT_LT (serial.size (), source->points.size ());
+  for (size_t i = 0; i < serial.size (); ++i)
+  {
+    EXPECT_EQ (serial[i].index_query, parallel[i].index_query);
+    EXPECT_EQ (serial[i].index_match, parallel[i].index_match);
+    if (i > 0)
+      EXPECT_LT (parallel[i - 1].index_query, parallel[i].index_query);
+  }
+
+  corr_est.setInputCloud (source);
+  corr_est.setSourceTransformation (transform);
+  corr_est.determineCorrespondences (moved, 0.005f);
+  ASSERT_EQ (serial.size (), moved.size ());
+  for (size_t i = 0; i < serial.size (); ++i)
+  {
+    EXPECT_EQ (serial[i].index_query, moved[i].index_query);
+    EXPECT_EQ (serial[i].index_match, moved[i].index_match);
+    EXPECT_NEAR (serial[i].distance, moved[i].distance, 1e-6);
+  }
+
+  // The reciprocal source tree is built once and reused when only the transformation changes
+  corr_est.setSourceTransformation (Eigen::Matrix4f::Identity ());
+  corr_est.determineReciprocalCorrespondences (moved);
+  EXPECT_EQ (int (moved.size ()), nr_reciprocal_correspondences);
+  corr_est.setSourceTransformation (transform);
+  corr_est.determineReciprocalCorrespondences (moved);
+
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> corr_est_moved;
+  corr_est_moved.setInputCloud (source_moved);
+  corr_est_moved.setInputTarget (target);
+  corr_est_moved.determineReciprocalCorrespondences (serial);
+  ASSERT_EQ (serial.size (), moved.size ());
+  for (size_t i = 0; i < serial.size (); ++i)
+  {
+    EXPECT_EQ (serial[i].index_query, moved[i].index_query);
+    EXPECT_EQ (serial[i].index_match, moved[i].index_match);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CorrespondenceEstimationIndices)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source (new pcl::PointCloud<pcl::PointXYZ>(cloud_source));
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>(cloud_target));
+
+  // Every other source point
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < int (source->points.size ()); i += 2)
+    indices->push_back (i);
+
+  // Both variants report the query index in the source cloud, not in the indices
+  pcl::Correspondences direct, reciprocal;
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> corr_est;
+  corr_est.setInputCloud (source);
+  corr_est.setIndices (indices);
+  corr_est.setInputTarget (target);
+  corr_est.determineCorrespondences (direct);
+  ASSERT_EQ (direct.size (), indices->size ());
+  for (size_t i = 0; i < direct.size (); ++i)
+  {
+    EXPECT_EQ (direct[i].index_query, (*indices)[i]);
+    EXPECT_EQ (direct[i].index_match, correspondences_original[(*indices)[i]][1]);
+  }
+  corr_est.determineReciprocalCorrespondences (reciprocal);
+  EXPECT_GT (reciprocal.size (), 0u);
+  for (size_t i = 0; i < reciprocal.size (); ++i)
+    EXPECT_EQ (reciprocal[i].index_query % 2, 0);
+
+  // Indices edited in place rebuild the reciprocal source tree
+  for (size_t i = 0; i < indices->size (); ++i)
+    (*indices)[i] += 1;
+  if (indices->back () >= int (source->points.size ()))
+    indices->pop_back ();
+  corr_est.determineReciprocalCorrespondences (reciprocal);
+
+  pcl::Correspondences fresh;
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> corr_est_fresh;
+  corr_est_fresh.setInputCloud (source);
+  corr_est_fresh.setIndices (boost::shared_ptr<std::vector<int> > (new std::vector<int> (*indices)));
+  corr_est_fresh.setInputTarget (target);
+  corr_est_fresh.determineReciprocalCorrespondences (fresh);
+  ASSERT_EQ (fresh.size (), reciprocal.size ());
+  for (size_t i = 0; i < fresh.size (); ++i)
+  {
+    EXPECT_EQ (fresh[i].index_query, reciprocal[i].index_query);
+    EXPECT_EQ (fresh[i].index_query % 2, 1);
+    EXPECT_EQ (fresh[i].index_match, reciprocal[i].index_match);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, CorrespondenceRejectorDistance)
 {
@@ -321,6 +435,67 @@ TEST (PCL, CorrespondenceRejectorVarTrimmed)
       EXPECT_EQ ((*correspondences_result_rej_var_trimmed_dist)[i].index_match, correspondences_dist[i][1]);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CorrespondenceRejectorChain)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source (new pcl::PointCloud<pcl::PointXYZ>(cloud_source));
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>(cloud_target));
+
+  // re-do correspondence estimation
+  boost::shared_ptr<pcl::Correspondences> correspondences (new pcl::Correspondences);
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> corr_est;
+  corr_est.setInputCloud (source);
+  corr_est.setInputTarget (target);
+  corr_est.determineCorrespondences (*correspondences);
+
+  // two fused distance tests, followed by rejectors that need the whole set
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorDistance> corr_rej_dist (new pcl::registration::CorrespondenceRejectorDistance);
+  corr_rej_dist->setMaximumDistance (rej_dist_max_dist);
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorDistance> corr_rej_dist_xyz (new pcl::registration::CorrespondenceRejectorDistance);
+  corr_rej_dist_xyz->setMaximumDistance (0.8f * rej_dist_max_dist);
+  corr_rej_dist_xyz->setInputCloud<pcl::PointXYZ> (source);
+  corr_rej_dist_xyz->setInputTarget<pcl::PointXYZ> (target);
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorMedianDistance> corr_rej_median_dist (new pcl::registration::CorrespondenceRejectorMedianDistance);
+  corr_rej_median_dist->setMedianFactor (2.0);
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorOneToOne> corr_rej_one_to_one (new pcl::registration::CorrespondenceRejectorOneToOne);
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorTrimmed> corr_rej_trimmed (new pcl::registration::CorrespondenceRejectorTrimmed);
+  corr_rej_trimmed->setOverlapRadio (rej_trimmed_overlap);
+
+  pcl::registration::CorrespondenceRejectorChain corr_rej_chain;
+  corr_rej_chain.addRejector (corr_rej_dist);
+  corr_rej_chain.addRejector (corr_rej_dist_xyz);
+  corr_rej_chain.addRejector (corr_rej_median_dist);
+  corr_rej_chain.addRejector (corr_rej_one_to_one);
+  corr_rej_chain.addRejector (corr_rej_trimmed);
+  EXPECT_EQ (corr_rej_chain.getNumberOfRejectors (), 5u);
+
+  // the same rejectors applied one after the other
+  pcl::Correspondences in (*correspondences), out;
+  corr_rej_dist->getRemainingCorrespondences (in, out); in.swap (out);
+  corr_rej_dist_xyz->getRemainingCorrespondences (in, out); in.swap (out);
+  corr_rej_median_dist->getRemainingCorrespondences (in, out); in.swap (out);
+  corr_rej_one_to_one->getRemainingCorrespondences (in, out); in.swap (out);
+  corr_rej_trimmed->getRemainingCorrespondences (in, out);
+  EXPECT_GT (out.size (), 0u);
+  EXPECT_LT (out.size (), correspondences->size ());
+
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads *= 2)
+  {
+    pcl::Correspondences correspondences_result_rej_chain;
+    corr_rej_chain.setNumberOfThreads (nr_threads);
+    corr_rej_chain.setInputCorrespondences (correspondences);
+    corr_rej_chain.getCorrespondences (correspondences_result_rej_chain);
+
+    EXPECT_EQ (correspondences_result_rej_chain.size (), out.size ());
+    if (correspondences_result_rej_chain.size () == out.size ())
+      for (size_t i = 0; i < out.size (); ++i)
+      {
+        EXPECT_EQ (correspondences_result_rej_chain[i].index_query, out[i].index_query);
+        EXPECT_EQ (correspondences_result_rej_chain[i].index_match, out[i].index_match);
+      }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, TransformationEstimationSVD)
 {
@@ -394,6 +394,10 @@ testRadiusSearch (typename PointCloud<PointT>::ConstPtr point_cloud, vector<sear
       for (int sIdx = 0; sIdx < static_cast<int> (search_methods.size ()); ++sIdx)
       {
         search_methods [sIdx]->radiusSearch (point_cloud->points[*qIt], radius, indices [sIdx], distances [sIdx], 0);
+        // the count-only search has to agree with the full one, also when stopped early
+        int count = search_methods [sIdx]->radiusSearchCount (point_cloud->points[*qIt], radius);
+        int bounded_count = search_methods [sIdx]->radiusSearchCount (point_cloud->points[*qIt], radius, 3);
+        passed [sIdx] = passed [sIdx] && count == static_cast<int> (indices [sIdx].size ()) && bounded_count == std::min (count, 3);
         passed [sIdx] = passed [sIdx] && testUniqueness (indices [sIdx], search_methods [sIdx]->getName ());
         passed [sIdx] = passed [sIdx] && testOrder (distances [sIdx], search_methods [sIdx]->getName ());
         passed [sIdx] = passed [sIdx] && testResultValidity<PointT>(point_cloud, indices_mask, nan_mask, indices [sIdx], input_indices, search_methods [sIdx]->getName ());
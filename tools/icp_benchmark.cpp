@@ -0,0 +1,303 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/common/angles.h>
+#include <pcl/common/transforms.h>
+#include <pcl/registration/correspondence_estimation.h>
+#include <pcl/registration/icp.h>
+#include <pcl/registration/multi_resolution_registration.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace pcl::console;
+
+typedef PointXYZ PointT;
+typedef PointCloud<PointT> Cloud;
+
+double default_angle = 5.0;
+double default_translation = 0.01;
+double default_distance = 0.05;
+int    default_iterations = 30;
+int    default_repetitions = 5;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s source.pcd [target.pcd] <options>\n", argv[0]);
+  print_info ("  If no target is given, the target is the source moved by -angle and -translation.\n");
+  print_info ("  where options are:\n");
+  print_info ("                     -threads n1,n2,... = the thread counts to try (default: 1,2,4)\n");
+  print_info ("                     -angle X           = the rotation applied to create the target, in degrees (default: ");
+  print_value ("%f", default_angle); print_info (")\n");
+  print_info ("                     -translation X     = the translation applied to create the target (default: ");
+  print_value ("%f", default_translation); print_info (")\n");
+  print_info ("                     -d X               = the ICP maximum correspondence distance (default: ");
+  print_value ("%f", default_distance); print_info (")\n");
+  print_info ("                     -i X               = the ICP maximum number of iterations (default: ");
+  print_value ("%d", default_iterations); print_info (")\n");
+  print_info ("                     -r X               = the number of repetitions of the correspondence search (default: ");
+  print_value ("%d", default_repetitions); print_info (")\n");
+  print_info ("                     -levels l1,l2,...  = also time a coarse to fine ICP on VoxelGrid levels with these leaf sizes,\n");
+  print_info ("                                          followed by a full resolution level\n");
+}
+
+/** \brief A small rigid motion of the source, different for every repetition. */
+Eigen::Matrix4f
+poseStep (int repetition)
+{
+  Eigen::Affine3f step (Eigen::AngleAxisf (static_cast<float> (pcl::deg2rad (0.5 * repetition)), Eigen::Vector3f::UnitZ ()));
+  step.translation () = Eigen::Vector3f (0.001f, 0.0f, 0.0f) * static_cast<float> (repetition);
+  return (step.matrix ());
+}
+
+/** \brief Time the correspondence search of \a repetitions poses, moving the source either by transforming the cloud
+  * or through setSourceTransformation, which keeps the reciprocal source tree.
+  */
+void
+timeCorrespondences (const Cloud::ConstPtr &source, const Cloud::ConstPtr &target, int threads, int repetitions)
+{
+  registration::CorrespondenceEstimation<PointT, PointT> estimation;
+  estimation.setInputTarget (target);
+  estimation.setNumberOfThreads (threads);
+  Correspondences correspondences;
+  TicToc tt;
+
+  // Plain correspondences
+  estimation.setInputCloud (source);
+  tt.tic ();
+  for (int r = 0; r < repetitions; ++r)
+    estimation.determineCorrespondences (correspondences);
+  const double plain_time = tt.toc () / repetitions;
+
+  // Reciprocal correspondences on a transformed copy of the source, rebuilding the source tree for every pose
+  Cloud::Ptr moved (new Cloud);
+  tt.tic ();
+  for (int r = 0; r < repetitions; ++r)
+  {
+    const Eigen::Matrix4f step = poseStep (r);
+    transformPointCloud (*source, *moved, step);
+    estimation.setInputCloud (moved);
+    estimation.determineReciprocalCorrespondences (correspondences);
+  }
+  const double rebuild_time = tt.toc () / repetitions;
+  const size_t nr_rebuild = correspondences.size ();
+
+  // Reciprocal correspondences with the source pose passed along, reusing the source tree
+  estimation.setInputCloud (source);
+  tt.tic ();
+  for (int r = 0; r < repetitions; ++r)
+  {
+    const Eigen::Matrix4f step = poseStep (r);
+    estimation.setSourceTransformation (step);
+    estimation.determineReciprocalCorrespondences (correspondences);
+  }
+  const double reuse_time = tt.toc () / repetitions;
+
+  print_info ("%8d %14.2f %16.2f %16.2f %10d %10d\n", threads, plain_time, rebuild_time, reuse_time,
+              static_cast<int> (nr_rebuild), static_cast<int> (correspondences.size ()));
+}
+
+/** \brief Time a complete ICP alignment of the source to the target. */
+void
+timeICP (const Cloud::ConstPtr &source, const Cloud::ConstPtr &target, const Eigen::Matrix4f &pose, bool known_pose,
+         int threads, double distance, int iterations)
+{
+  TicToc tt;
+  tt.tic ();
+  IterativeClosestPoint<PointT, PointT> icp;
+  icp.setMaximumIterations (iterations);
+  icp.setTransformationEpsilon (1e-6);
+  icp.setMaxCorrespondenceDistance (distance);
+  icp.setNumberOfThreads (threads);
+  icp.setInputTarget (target);
+  icp.setInputCloud (source);
+  Cloud aligned;
+  icp.align (aligned);
+  const double icp_time = tt.toc ();
+
+  print_info ("%8d %10.2f %5s", threads, icp_time, icp.hasConverged () ? "yes" : "no");
+  if (!known_pose)
+  {
+    print_info ("\n");
+    return;
+  }
+
+  // The estimated transformation should match the one the target was created with
+  const Eigen::Matrix4f error = pose.inverse () * icp.getFinalTransformation ();
+  const Eigen::AngleAxisf rotation_error (Eigen::Matrix3f (error.block<3, 3> (0, 0)));
+  print_info (" %12.6f %12.6f\n", pcl::rad2deg (rotation_error.angle ()), error.block<3, 1> (0, 3).norm ());
+}
+
+/** \brief Time a coarse to fine ICP alignment of the source to the target, running \a iterations at every level. */
+void
+timeMultiResolutionICP (const Cloud::ConstPtr &source, const Cloud::ConstPtr &target, const Eigen::Matrix4f &pose, 
+                        bool known_pose, int threads, double distance, int iterations, const std::vector<double> &leaf_sizes)
+{
+  TicToc tt;
+  tt.tic ();
+  MultiResolutionRegistration<PointT, PointT> pyramid;
+  for (size_t l = 0; l <= leaf_sizes.size (); ++l)
+  {
+    const float leaf_size = l < leaf_sizes.size () ? static_cast<float> (leaf_sizes[l]) : 0.0f;
+    boost::shared_ptr<IterativeClosestPoint<PointT, PointT> > icp (new IterativeClosestPoint<PointT, PointT>);
+    icp->setMaximumIterations (iterations);
+    icp->setTransformationEpsilon (1e-6);
+    // Coarse levels need to reach at least the neighboring voxels
+    icp->setMaxCorrespondenceDistance (std::max (distance, 2.0 * leaf_size));
+    icp->setNumberOfThreads (threads);
+    pyramid.addLevel (icp, leaf_size);
+  }
+  pyramid.setInputTarget (target);
+  pyramid.setInputCloud (source);
+  Cloud aligned;
+  pyramid.align (aligned);
+  const double pyramid_time = tt.toc ();
+
+  print_info ("%8d %10.2f %5s", threads, pyramid_time, pyramid.hasConverged () ? "yes" : "no");
+  if (known_pose)
+  {
+    const Eigen::Matrix4f error = pose.inverse () * pyramid.getFinalTransformation ();
+    const Eigen::AngleAxisf rotation_error (Eigen::Matrix3f (error.block<3, 3> (0, 0)));
+    print_info (" %12.6f %12.6f", pcl::rad2deg (rotation_error.angle ()), error.block<3, 1> (0, 3).norm ());
+  }
+  print_info ("\n");
+
+  const std::vector<MultiResolutionRegistration<PointT, PointT>::LevelStatistics> &stats = pyramid.getLevelStatistics ();
+  for (size_t l = 0; l < stats.size (); ++l)
+    print_info ("%8s level %d: leaf %g, %d/%d points, %.2f ms target, %.2f ms alignment\n", "", static_cast<int> (l), 
+                stats[l].leaf_size, static_cast<int> (stats[l].nr_source_points), static_cast<int> (stats[l].nr_target_points),
+                stats[l].target_time, stats[l].time);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Time the correspondence search and the complete ICP alignment for several thread counts. For more information, use: %s -h\n", argv[0]);
+
+  if (argc < 2)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  std::vector<int> p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.empty () || p_file_indices.size () > 2)
+  {
+    print_error ("Need one or two input PCD files to continue.\n");
+    return (-1);
+  }
+
+  // Command line parsing
+  std::vector<int> thread_counts;
+  parse_x_arguments (argc, argv, "-threads", thread_counts);
+  if (thread_counts.empty ())
+  {
+    thread_counts.push_back (1);
+    thread_counts.push_back (2);
+    thread_counts.push_back (4);
+  }
+  double angle = default_angle;
+  parse_argument (argc, argv, "-angle", angle);
+  double translation = default_translation;
+  parse_argument (argc, argv, "-translation", translation);
+  double distance = default_distance;
+  parse_argument (argc, argv, "-d", distance);
+  int iterations = default_iterations;
+  parse_argument (argc, argv, "-i", iterations);
+  int repetitions = default_repetitions;
+  parse_argument (argc, argv, "-r", repetitions);
+  repetitions = std::max (repetitions, 1);
+  std::vector<double> leaf_sizes;
+  parse_x_arguments (argc, argv, "-levels", leaf_sizes);
+
+  Cloud::Ptr source (new Cloud);
+  if (loadPCDFile (argv[p_file_indices[0]], *source) < 0)
+  {
+    print_error ("Could not read %s.\n", argv[p_file_indices[0]]);
+    return (-1);
+  }
+
+  // Without a target, the target is the source moved by a known transformation
+  Eigen::Matrix4f pose = Eigen::Matrix4f::Identity ();
+  Cloud::Ptr target (new Cloud);
+  if (p_file_indices.size () == 2)
+  {
+    if (loadPCDFile (argv[p_file_indices[1]], *target) < 0)
+    {
+      print_error ("Could not read %s.\n", argv[p_file_indices[1]]);
+      return (-1);
+    }
+  }
+  else
+  {
+    Eigen::Affine3f perturbation (Eigen::AngleAxisf (static_cast<float> (pcl::deg2rad (angle)),
+                                                     Eigen::Vector3f (1.0f, 1.0f, 1.0f).normalized ()));
+    perturbation.translation () = Eigen::Vector3f (1.0f, -1.0f, 0.5f).normalized () * static_cast<float> (translation);
+    pose = perturbation.matrix ();
+    transformPointCloud (*source, *target, perturbation);
+  }
+  print_info ("Source: "); print_value ("%d", static_cast<int> (source->points.size ()));
+  print_info (" points, target: "); print_value ("%d", static_cast<int> (target->points.size ())); print_info (" points\n");
+
+  print_highlight ("Correspondence search, average ms per call over %d poses\n", repetitions);
+  print_info ("%8s %14s %16s %16s %10s %10s\n", "threads", "plain", "reciprocal copy", "reciprocal pose", "nr copy", "nr pose");
+  for (size_t t = 0; t < thread_counts.size (); ++t)
+    timeCorrespondences (source, target, thread_counts[t], repetitions);
+
+  print_highlight ("ICP alignment\n");
+  print_info ("%8s %10s %5s %12s %12s\n", "threads", "icp ms", "conv", "rot err deg", "trans err");
+  for (size_t t = 0; t < thread_counts.size (); ++t)
+    timeICP (source, target, pose, p_file_indices.size () == 1, thread_counts[t], distance, iterations);
+
+  if (!leaf_sizes.empty ())
+  {
+    print_highlight ("Multi-resolution ICP alignment, %d iterations per level\n", iterations);
+    print_info ("%8s %10s %5s %12s %12s\n", "threads", "total ms", "conv", "rot err deg", "trans err");
+    for (size_t t = 0; t < thread_counts.size (); ++t)
+      timeMultiResolutionICP (source, target, pose, p_file_indices.size () == 1, thread_counts[t], distance, iterations, leaf_sizes);
+  }
+
+  return (0);
+}
+/* ]--- */
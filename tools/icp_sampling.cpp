@@ -0,0 +1,251 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/common/angles.h>
+#include <pcl/common/io.h>
+#include <pcl/common/transforms.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/filters/random_sample.h>
+#include <pcl/filters/normal_space.h>
+#include <pcl/filters/covariance_sampling.h>
+#include <pcl/registration/icp.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace pcl::console;
+
+typedef PointNormal PointT;
+typedef PointCloud<PointT> Cloud;
+
+double default_radius = 0.01;
+double default_angle = 10.0;
+double default_translation = 0.02;
+double default_distance = 0.05;
+int    default_iterations = 50;
+int    default_bins = 4;
+int    default_seed = 0;
+int    default_threads = 1;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s input.pcd <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -samples n1,n2,... = the sample sizes to try (default: 100,300,1000,3000)\n");
+  print_info ("                     -radius X          = the radius used to estimate the normals (default: ");
+  print_value ("%f", default_radius); print_info (")\n");
+  print_info ("                     -angle X           = the rotation applied to the cloud, in degrees (default: ");
+  print_value ("%f", default_angle); print_info (")\n");
+  print_info ("                     -translation X     = the translation applied to the cloud (default: ");
+  print_value ("%f", default_translation); print_info (")\n");
+  print_info ("                     -d X               = the ICP maximum correspondence distance (default: ");
+  print_value ("%f", default_distance); print_info (")\n");
+  print_info ("                     -i X               = the ICP maximum number of iterations (default: ");
+  print_value ("%d", default_iterations); print_info (")\n");
+  print_info ("                     -bins X            = the number of bins per axis of NormalSpaceSampling (default: ");
+  print_value ("%d", default_bins); print_info (")\n");
+  print_info ("                     -seed X            = the seed of the random samplers (default: ");
+  print_value ("%d", default_seed); print_info (")\n");
+  print_info ("                     -threads X         = the number of threads used by the samplers (default: ");
+  print_value ("%d", default_threads); print_info (")\n");
+}
+
+void
+estimateNormals (const PointCloud<PointXYZ>::ConstPtr &input, double radius, Cloud &output)
+{
+  TicToc tt;
+  tt.tic ();
+  print_highlight ("Estimating normals ");
+
+  NormalEstimation<PointXYZ, Normal> ne;
+  ne.setInputCloud (input);
+  ne.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ>));
+  ne.setRadiusSearch (radius);
+  PointCloud<Normal> normals;
+  ne.compute (normals);
+  concatenateFields (*input, normals, output);
+
+  // The samplers and ICP need valid normals
+  std::vector<int> valid;
+  for (size_t i = 0; i < output.points.size (); ++i)
+    if (pcl_isfinite (output.points[i].normal_x))
+      valid.push_back (static_cast<int> (i));
+  Cloud valid_output;
+  copyPointCloud (output, valid, valid_output);
+  output = valid_output;
+
+  print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%d", static_cast<int> (output.points.size ())); print_info (" points]\n");
+}
+
+/** \brief Align a sample of the source cloud to the target, and print the error of the estimated transformation. */
+void
+alignSample (const std::string &method, const Cloud::ConstPtr &source, const std::vector<int> &sample, double sampling_time,
+             const Cloud::ConstPtr &target, const Eigen::Matrix4f &perturbation, double distance, int iterations)
+{
+  Cloud::Ptr sampled (new Cloud);
+  copyPointCloud (*source, sample, *sampled);
+
+  TicToc tt;
+  tt.tic ();
+  IterativeClosestPoint<PointT, PointT> icp;
+  icp.setMaximumIterations (iterations);
+  icp.setMaxCorrespondenceDistance (distance);
+  icp.setInputTarget (target);
+  icp.setInputCloud (sampled);
+  Cloud aligned;
+  icp.align (aligned);
+  const double icp_time = tt.toc ();
+
+  // The estimated transformation should undo the perturbation
+  const Eigen::Matrix4f error = icp.getFinalTransformation () * perturbation;
+  const Eigen::AngleAxisf rotation_error (Eigen::Matrix3f (error.block<3, 3> (0, 0)));
+  const float translation_error = error.block<3, 1> (0, 3).norm ();
+
+  print_info ("%-12s %8d %10.2f %10.2f %5s %12.6f %12.6f\n", method.c_str (), static_cast<int> (sample.size ()),
+              sampling_time, icp_time, icp.hasConverged () ? "yes" : "no",
+              pcl::rad2deg (rotation_error.angle ()), translation_error);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Compare the convergence of ICP on samples of a cloud drawn with RandomSample, NormalSpaceSampling and CovarianceSampling. For more information, use: %s -h\n", argv[0]);
+
+  if (argc < 2)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  std::vector<int> p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.size () != 1)
+  {
+    print_error ("Need one input PCD file to continue.\n");
+    return (-1);
+  }
+
+  // Command line parsing
+  std::vector<int> sample_sizes;
+  parse_x_arguments (argc, argv, "-samples", sample_sizes);
+  if (sample_sizes.empty ())
+  {
+    sample_sizes.push_back (100);
+    sample_sizes.push_back (300);
+    sample_sizes.push_back (1000);
+    sample_sizes.push_back (3000);
+  }
+  double radius = default_radius;
+  parse_argument (argc, argv, "-radius", radius);
+  double angle = default_angle;
+  parse_argument (argc, argv, "-angle", angle);
+  double translation = default_translation;
+  parse_argument (argc, argv, "-translation", translation);
+  double distance = default_distance;
+  parse_argument (argc, argv, "-d", distance);
+  int iterations = default_iterations;
+  parse_argument (argc, argv, "-i", iterations);
+  int bins = default_bins;
+  parse_argument (argc, argv, "-bins", bins);
+  int seed = default_seed;
+  parse_argument (argc, argv, "-seed", seed);
+  int threads = default_threads;
+  parse_argument (argc, argv, "-threads", threads);
+
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  if (loadPCDFile (argv[p_file_indices[0]], *input) < 0)
+  {
+    print_error ("Could not read %s.\n", argv[p_file_indices[0]]);
+    return (-1);
+  }
+  Cloud::Ptr target (new Cloud);
+  estimateNormals (input, radius, *target);
+
+  // The source is the target moved by a known transformation
+  Eigen::Affine3f perturbation (Eigen::AngleAxisf (static_cast<float> (pcl::deg2rad (angle)),
+                                                   Eigen::Vector3f (1.0f, 1.0f, 1.0f).normalized ()));
+  perturbation.translation () = Eigen::Vector3f (1.0f, -1.0f, 0.5f).normalized () * static_cast<float> (translation);
+  Cloud::Ptr source (new Cloud);
+  transformPointCloudWithNormals (*target, *source, perturbation);
+
+  RandomSample<PointT> random_sample;
+  random_sample.setInputCloud (source);
+  random_sample.setSeed (seed);
+
+  NormalSpaceSampling<PointT, PointT> normal_space;
+  normal_space.setInputCloud (source);
+  normal_space.setNormals (source);
+  normal_space.setBins (bins, bins, bins);
+  normal_space.setSeed (seed);
+  normal_space.setNumberOfThreads (threads);
+
+  CovarianceSampling<PointT, PointT> covariance;
+  covariance.setInputCloud (source);
+  covariance.setNormals (source);
+  covariance.setNumberOfThreads (threads);
+
+  print_info ("%-12s %8s %10s %10s %5s %12s %12s\n", "method", "samples", "sample ms", "icp ms", "conv", "rot err deg", "trans err");
+  for (size_t s = 0; s < sample_sizes.size (); ++s)
+  {
+    std::vector<int> sample;
+    TicToc tt;
+
+    tt.tic ();
+    random_sample.setSample (sample_sizes[s]);
+    random_sample.filter (sample);
+    alignSample ("random", source, sample, tt.toc (), target, perturbation.matrix (), distance, iterations);
+
+    tt.tic ();
+    normal_space.setSample (sample_sizes[s]);
+    normal_space.filter (sample);
+    alignSample ("normal", source, sample, tt.toc (), target, perturbation.matrix (), distance, iterations);
+
+    tt.tic ();
+    covariance.setNumberOfSamples (sample_sizes[s]);
+    covariance.filter (sample);
+    alignSample ("covariance", source, sample, tt.toc (), target, perturbation.matrix (), distance, iterations);
+  }
+
+  return (0);
+}
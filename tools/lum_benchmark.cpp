@@ -0,0 +1,196 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2011-2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <pcl/point_types.h>
+#include <pcl/common/transforms.h>
+#include <pcl/registration/lum.h>
+#include <pcl/registration/impl/lum.hpp>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+using namespace pcl;
+using namespace pcl::console;
+
+typedef PointXYZ PointT;
+typedef PointCloud<PointT> Cloud;
+
+int default_points = 50;
+int default_loop_stride = 10;
+int default_iterations = 3;
+int default_threads = 1;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s <options>\n", argv[0]);
+  print_info ("  Builds synthetic SLAM graphs of scans of a random scene along a circle, with edges between consecutive\n");
+  print_info ("  scans and between every scan and the one a stride further, and times LUM on them.\n");
+  print_info ("  where options are:\n");
+  print_info ("                     -scans n1,n2,... = the graph sizes to try (default: 100,200,500,1000,2000,5000)\n");
+  print_info ("                     -points X        = the number of correspondences per edge (default: ");
+  print_value ("%d", default_points); print_info (")\n");
+  print_info ("                     -stride X        = the distance between the scans of the extra edges, 0 disables them (default: ");
+  print_value ("%d", default_loop_stride); print_info (")\n");
+  print_info ("                     -i X             = the number of LUM iterations (default: ");
+  print_value ("%d", default_iterations); print_info (")\n");
+  print_info ("                     -threads X       = the number of threads used by LUM (default: ");
+  print_value ("%d", default_threads); print_info (")\n");
+}
+
+/** \brief The ground truth pose of a scan on a circle of nr_scans scans. */
+Eigen::Vector6f
+scanPose (int scan, int nr_scans)
+{
+  const float angle = 2.0f * static_cast<float> (M_PI) * static_cast<float> (scan) / static_cast<float> (nr_scans);
+  const float radius = 0.5f * static_cast<float> (nr_scans) / static_cast<float> (M_PI);
+  Eigen::Vector6f pose;
+  pose << radius * (cosf (angle) - 1.0f), radius * sinf (angle), 0.1f * sinf (3.0f * angle), 0.0f, 0.0f, angle;
+  return (pose);
+}
+
+/** \brief Build a graph of nr_scans scans and time LUM on it. */
+void
+benchmark (int nr_scans, int nr_points, int stride, int iterations, int threads)
+{
+  TicToc tt;
+  tt.tic ();
+
+  // Every scan sees the same local scene up to some noise
+  Cloud scene;
+  srand (0);
+  for (int i = 0; i < nr_points; ++i)
+    scene.push_back (PointT (static_cast<float> (rand ()) / RAND_MAX, static_cast<float> (rand ()) / RAND_MAX,
+                             static_cast<float> (rand ()) / RAND_MAX));
+  CorrespondencesPtr corrs (new Correspondences);
+  for (int i = 0; i < nr_points; ++i)
+    corrs->push_back (Correspondence (i, i, 0.0f));
+
+  registration::LUM<PointT> lum;
+  lum.setMaxIterations (iterations);
+  lum.setNumberOfThreads (threads);
+  for (int k = 0; k < nr_scans; ++k)
+  {
+    const Eigen::Vector6f pose = scanPose (k, nr_scans);
+    Cloud::Ptr scan (new Cloud);
+    transformPointCloud (scene, *scan, getTransformation (pose (0), pose (1), pose (2), pose (3), pose (4), pose (5)).inverse ());
+    for (size_t i = 0; i < scan->points.size (); ++i)
+      scan->points[i].getVector3fMap () += 0.001f * Eigen::Vector3f::Random ();
+
+    // Disturb the initial estimates
+    Eigen::Vector6f estimate = pose;
+    if (k > 0)
+    {
+      estimate (0) += 0.01f * static_cast<float> (k % 7 - 3);
+      estimate (5) += 0.002f * static_cast<float> (k % 5 - 2);
+    }
+    lum.addPointCloud (scan, estimate);
+  }
+
+  // All scans see the same scene in their own frame, so the point indices match between any two scans
+  int nr_edges = 0;
+  for (int k = 0; k < nr_scans; ++k)
+  {
+    lum.setCorrespondences (k, (k + 1) % nr_scans, corrs);
+    ++nr_edges;
+    if (stride > 1 && nr_scans > 2 * stride)
+    {
+      lum.setCorrespondences (k, (k + stride) % nr_scans, corrs);
+      ++nr_edges;
+    }
+  }
+  const double build_time = tt.toc ();
+
+  tt.tic ();
+  lum.compute ();
+  const double compute_time = tt.toc ();
+
+  // Largest error of the estimated relative poses of consecutive scans against the ground truth
+  float error = 0.0f;
+  for (int k = 0; k + 1 < nr_scans; ++k)
+  {
+    const Eigen::Vector6f pose = scanPose (k, nr_scans), next_pose = scanPose (k + 1, nr_scans);
+    const Eigen::Affine3f truth = getTransformation (pose (0), pose (1), pose (2), pose (3), pose (4), pose (5)).inverse () *
+                                  getTransformation (next_pose (0), next_pose (1), next_pose (2), next_pose (3), next_pose (4), next_pose (5));
+    const Eigen::Affine3f estimate = lum.getTransformation (k).inverse () * lum.getTransformation (k + 1);
+    error = std::max (error, (truth.translation () - estimate.translation ()).norm ());
+  }
+
+  print_info ("%8d %8d %12.2f %12.2f %12.6f\n", nr_scans, nr_edges, build_time, compute_time, error);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Time LUM on synthetic SLAM graphs of growing size. For more information, use: %s -h\n", argv[0]);
+
+  if (find_switch (argc, argv, "-h"))
+  {
+    printHelp (argc, argv);
+    return (0);
+  }
+
+  // Command line parsing
+  std::vector<int> scan_counts;
+  parse_x_arguments (argc, argv, "-scans", scan_counts);
+  if (scan_counts.empty ())
+  {
+    scan_counts.push_back (100);
+    scan_counts.push_back (200);
+    scan_counts.push_back (500);
+    scan_counts.push_back (1000);
+    scan_counts.push_back (2000);
+    scan_counts.push_back (5000);
+  }
+  int nr_points = default_points;
+  parse_argument (argc, argv, "-points", nr_points);
+  int stride = default_loop_stride;
+  parse_argument (argc, argv, "-stride", stride);
+  int iterations = default_iterations;
+  parse_argument (argc, argv, "-i", iterations);
+  int threads = default_threads;
+  parse_argument (argc, argv, "-threads", threads);
+
+  print_info ("%8s %8s %12s %12s %12s\n", "scans", "edges", "build ms", "compute ms", "max rel err");
+  for (size_t s = 0; s < scan_counts.size (); ++s)
+    benchmark (scan_counts[s], nr_points, stride, iterations, threads);
+
+  return (0);
+}
+/* ]--- */
@@ -41,8 +41,8 @@
 #include <pcl/console/print.h>
 #include <pcl/console/parse.h>
 #include <pcl/console/time.h>
-#include <pcl/filters/radius_outlier_removal.h>
-#include <pcl/filters/statistical_outlier_removal.h>
+#include <pcl/filters/radius_outlier_removal_omp.h>
+#include <pcl/filters/statistical_outlier_removal_omp.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -57,6 +57,10 @@ int default_negative = 1;
 double default_radius = 0.0;
 int default_min_pts = 0;
 
+std::string default_search = "tree";
+double default_grid_leaf = 0.0;
+int default_threads = 1;
+
 void
 printHelp (int, char **argv)
 {
@@ -74,6 +78,13 @@ printHelp (int, char **argv)
   print_value ("%f", default_std_dev_mul); print_info (")\n");
   print_info ("                     -inliers X = (StatisticalOutlierRemoval only) decides whether the inliers should be returned (1), or the outliers (0). (default: ");
   print_value ("%d", default_negative); print_info (")\n");
+  print_info ("                     -search X = the neighbor search to be used (options: tree / grid) (default: ");
+  print_value ("%s", default_search.c_str ()); print_info (")\n");
+  print_info ("                     -grid_leaf X = (StatisticalOutlierRemoval only) the grid cell size for the grid search (default: ");
+  print_value ("%f", default_grid_leaf); print_info (")\n");
+  print_info ("                     -threads X = the number of threads to be used (default: ");
+  print_value ("%d", default_threads); print_info (")\n");
+  print_info ("                     -benchmark = (RadiusOutlierRemoval only) time the tree and grid searches for a range of radii around -radius\n");
 }
 
 bool
@@ -91,11 +102,43 @@ loadCloud (const std::string &filename, sensor_msgs::PointCloud2 &cloud)
   return (true);
 }
 
+void
+benchmark (const PointCloud<PointXYZ>::ConstPtr &cloud, int min_pts, double radius, int threads)
+{
+  // The tree search is best for small radii and sparse clouds, the grid search once a neighborhood
+  // holds many points: report both over a range of radii to show where they cross over
+  print_info ("%10s %12s %12s %10s %10s\n", "radius", "tree [ms]", "grid [ms]", "tree pts", "grid pts");
+  const double scales[] = {0.25, 0.5, 1.0, 2.0, 4.0};
+  for (size_t s = 0; s < sizeof (scales) / sizeof (scales[0]); ++s)
+  {
+    RadiusOutlierRemovalOMP<PointXYZ> filter;
+    filter.setNumberOfThreads (threads);
+    filter.setInputCloud (cloud);
+    filter.setRadiusSearch (radius * scales[s]);
+    filter.setMinNeighborsInRadius (min_pts);
+
+    PointCloud<PointXYZ> tree_output, grid_output;
+    TicToc tt;
+    tt.tic ();
+    filter.filter (tree_output);
+    double tree_time = tt.toc ();
+
+    filter.setSearchMode (RadiusOutlierRemoval<PointXYZ>::SEARCH_MODE_GRID);
+    tt.tic ();
+    filter.filter (grid_output);
+    double grid_time = tt.toc ();
+
+    print_info ("%10f %12g %12g %10d %10d\n", radius * scales[s], tree_time, grid_time,
+                static_cast<int> (tree_output.points.size ()), static_cast<int> (grid_output.points.size ()));
+  }
+}
+
 void
 compute (const sensor_msgs::PointCloud2::ConstPtr &input, sensor_msgs::PointCloud2 &output,
          std::string method,
          int min_pts, double radius,
-         int mean_k, double std_dev_mul, bool negative)
+         int mean_k, double std_dev_mul, bool negative,
+         std::string search, double grid_leaf, int threads)
 {
 
   PointCloud<PointXYZ>::Ptr xyz_cloud_pre (new pcl::PointCloud<PointXYZ> ()),
@@ -106,25 +149,40 @@ compute (const sensor_msgs::PointCloud2::ConstPtr &input, sensor_msgs::PointClou
   removeNaNFromPointCloud<PointXYZ> (*xyz_cloud_pre, *xyz_cloud, index_vector);
 
       
+  if (search != "tree" && search != "grid")
+  {
+    PCL_ERROR ("%s is not a valid search name! Quitting!\n", search.c_str ());
+    return;
+  }
+
   TicToc tt;
   tt.tic ();
   PointCloud<PointXYZ>::Ptr xyz_cloud_filtered (new PointCloud<PointXYZ> ());
   if (method == "statistical")
   {
-    StatisticalOutlierRemoval<PointXYZ> filter;
+    StatisticalOutlierRemovalOMP<PointXYZ> filter;
+    filter.setNumberOfThreads (threads);
     filter.setInputCloud (xyz_cloud);
     filter.setMeanK (mean_k);
     filter.setStddevMulThresh (std_dev_mul);
     filter.setNegative (negative);
+    if (search == "grid")
+    {
+      filter.setSearchMode (StatisticalOutlierRemoval<PointXYZ>::SEARCH_MODE_GRID);
+      filter.setGridLeafSize (grid_leaf);
+    }
     PCL_INFO ("Computing filtered cloud with mean_k %d, std_dev_mul %f, inliers %d\n", filter.getMeanK (), filter.getStddevMulThresh (), filter.getNegative ());
     filter.filter (*xyz_cloud_filtered);
   }
   else if (method == "radius")
   {
-    RadiusOutlierRemoval<PointXYZ> filter;
+    RadiusOutlierRemovalOMP<PointXYZ> filter;
+    filter.setNumberOfThreads (threads);
     filter.setInputCloud (xyz_cloud);
     filter.setRadiusSearch (radius);
     filter.setMinNeighborsInRadius (min_pts);
+    if (search == "grid")
+      filter.setSearchMode (RadiusOutlierRemoval<PointXYZ>::SEARCH_MODE_GRID);
     PCL_INFO ("Computing filtered cloud with radius %f, min_pts %d\n", radius, min_pts);
     filter.filter (*xyz_cloud_filtered);
   }
@@ -181,7 +239,9 @@ main (int argc, char** argv)
   int mean_k = default_mean_k;
   double std_dev_mul = default_std_dev_mul;
   int negative = default_negative;
-  
+  std::string search = default_search;
+  double grid_leaf = default_grid_leaf;
+  int threads = default_threads;
 
   parse_argument (argc, argv, "-method", method);
   parse_argument (argc, argv, "-radius", radius);
@@ -189,6 +249,10 @@ main (int argc, char** argv)
   parse_argument (argc, argv, "-mean_k", mean_k);
   parse_argument (argc, argv, "-std_dev_mul", std_dev_mul);
   parse_argument (argc, argv, "-inliers", negative);
+  parse_argument (argc, argv, "-search", search);
+  parse_argument (argc, argv, "-grid_leaf", grid_leaf);
+  parse_argument (argc, argv, "-threads", threads);
+  bool run_benchmark = find_switch (argc, argv, "-benchmark");
   
   
 
@@ -197,9 +261,16 @@ main (int argc, char** argv)
   if (!loadCloud (argv[p_file_indices[0]], *cloud))
     return (-1);
 
+  if (run_benchmark)
+  {
+    PointCloud<PointXYZ>::Ptr xyz_cloud (new PointCloud<PointXYZ>);
+    fromROSMsg (*cloud, *xyz_cloud);
+    benchmark (xyz_cloud, min_pts, radius, threads);
+  }
+
   // Do the smoothing
   sensor_msgs::PointCloud2 output;
-  compute (cloud, output, method, min_pts, radius, mean_k, std_dev_mul, negative);
+  compute (cloud, output, method, min_pts, radius, mean_k, std_dev_mul, negative, search, grid_leaf, threads);
 
   // Save into the second file
   saveCloud (argv[p_file_indices[1]], output);
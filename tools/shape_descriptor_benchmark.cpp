@@ -0,0 +1,240 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/features/normal_3d_omp.h>
+#include <pcl/features/spin_image.h>
+#include <pcl/features/spin_image_omp.h>
+#include <pcl/features/3dsc.h>
+#include <pcl/features/3dsc_omp.h>
+#include <pcl/features/usc.h>
+#include <pcl/features/usc_omp.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace pcl::console;
+
+typedef PointXYZ PointT;
+typedef PointCloud<PointT> Cloud;
+typedef search::KdTree<PointT> Tree;
+typedef Histogram<153> SpinImage;
+
+double default_radius = 0.05;
+int    default_normal_k = 10;
+int    default_step = 1;
+int    default_repetitions = 3;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s input.pcd <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -threads n1,n2,... = the thread counts to try (default: 1,2,4)\n");
+  print_info ("                     -radius X          = the support radius of the descriptors (default: ");
+  print_value ("%f", default_radius); print_info (")\n");
+  print_info ("                     -normal_k X        = the number of neighbors used to estimate the normals (default: ");
+  print_value ("%d", default_normal_k); print_info (")\n");
+  print_info ("                     -step X            = use every X-th point as a keypoint, the full cloud being the search surface (default: ");
+  print_value ("%d", default_step); print_info (")\n");
+  print_info ("                     -r X               = the number of repetitions, the fastest one is reported (default: ");
+  print_value ("%d", default_repetitions); print_info (")\n");
+}
+
+/** \brief Set up an estimator on the keypoints of the cloud, searching the full cloud, and return the fastest of
+  * \a repetitions calls to compute (), in ms.
+  */
+template <typename EstimatorT, typename PointOutT> double
+timeEstimator (EstimatorT &estimator, const Cloud::ConstPtr &cloud, const IndicesPtr &keypoints,
+               const Tree::Ptr &tree, double radius, int repetitions, PointCloud<PointOutT> &output)
+{
+  estimator.setInputCloud (cloud);
+  estimator.setIndices (keypoints);
+  estimator.setSearchMethod (tree);
+  estimator.setRadiusSearch (radius);
+
+  TicToc tt;
+  double best_time = std::numeric_limits<double>::max ();
+  for (int r = 0; r < repetitions; ++r)
+  {
+    tt.tic ();
+    estimator.compute (output);
+    best_time = std::min (best_time, tt.toc ());
+  }
+  return (best_time);
+}
+
+/** \brief Print one line of the table: the time of a thread count and its speedup over the serial estimator. */
+void
+printTiming (const char *name, int threads, double time, double serial_time, size_t nr_descriptors)
+{
+  if (threads == 0)
+    print_info ("%-24s %8s %12.2f %8s %10d\n", name, "serial", time, "", static_cast<int> (nr_descriptors));
+  else
+    print_info ("%-24s %8d %12.2f %8.2f %10d\n", name, threads, time, serial_time / time, static_cast<int> (nr_descriptors));
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Time the spin image, 3D shape context and unique shape context estimators, serial and with OpenMP. For more information, use: %s -h\n", argv[0]);
+
+  if (argc < 2)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  std::vector<int> p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.size () != 1)
+  {
+    print_error ("Need one input PCD file to continue.\n");
+    return (-1);
+  }
+
+  // Command line parsing
+  std::vector<int> thread_counts;
+  parse_x_arguments (argc, argv, "-threads", thread_counts);
+  if (thread_counts.empty ())
+  {
+    thread_counts.push_back (1);
+    thread_counts.push_back (2);
+    thread_counts.push_back (4);
+  }
+  double radius = default_radius;
+  parse_argument (argc, argv, "-radius", radius);
+  int normal_k = default_normal_k;
+  parse_argument (argc, argv, "-normal_k", normal_k);
+  int step = default_step;
+  parse_argument (argc, argv, "-step", step);
+  step = std::max (step, 1);
+  int repetitions = default_repetitions;
+  parse_argument (argc, argv, "-r", repetitions);
+  repetitions = std::max (repetitions, 1);
+
+  Cloud::Ptr cloud (new Cloud);
+  if (loadPCDFile (argv[p_file_indices[0]], *cloud) < 0)
+  {
+    print_error ("Could not read %s.\n", argv[p_file_indices[0]]);
+    return (-1);
+  }
+
+  IndicesPtr keypoints (new std::vector<int>);
+  for (int i = 0; i < static_cast<int> (cloud->points.size ()); i += step)
+    keypoints->push_back (i);
+  print_info ("Cloud: "); print_value ("%d", static_cast<int> (cloud->points.size ()));
+  print_info (" points, keypoints: "); print_value ("%d", static_cast<int> (keypoints->size ()));
+  print_info (", support radius: "); print_value ("%g", radius); print_info ("\n");
+
+  // The search tree and the normals are shared by all estimators
+  Tree::Ptr tree (new Tree (false));
+  tree->setInputCloud (cloud);
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  NormalEstimationOMP<PointT, Normal> normal_estimation (thread_counts.back ());
+  normal_estimation.setInputCloud (cloud);
+  normal_estimation.setSearchMethod (tree);
+  normal_estimation.setKSearch (normal_k);
+  normal_estimation.compute (*normals);
+
+  print_highlight ("Fastest of %d runs\n", repetitions);
+  print_info ("%-24s %8s %12s %8s %10s\n", "estimator", "threads", "ms", "speedup", "nr");
+
+  // Spin images
+  {
+    PointCloud<SpinImage> output;
+    SpinImageEstimation<PointT, Normal, SpinImage> serial (8, 0.5, 0);
+    serial.setInputNormals (normals);
+    const double serial_time = timeEstimator (serial, cloud, keypoints, tree, radius, repetitions, output);
+    printTiming ("SpinImageEstimation", 0, serial_time, serial_time, output.points.size ());
+    for (size_t t = 0; t < thread_counts.size (); ++t)
+    {
+      SpinImageEstimationOMP<PointT, Normal, SpinImage> omp (8, 0.5, 0, thread_counts[t]);
+      omp.setInputNormals (normals);
+      const double time = timeEstimator (omp, cloud, keypoints, tree, radius, repetitions, output);
+      printTiming ("SpinImageEstimationOMP", thread_counts[t], time, serial_time, output.points.size ());
+    }
+  }
+
+  // 3D shape contexts
+  {
+    PointCloud<SHOT> output;
+    ShapeContext3DEstimation<PointT, Normal, SHOT> serial;
+    serial.setInputNormals (normals);
+    serial.setMinimalRadius (radius / 10.0);
+    serial.setPointDensityRadius (radius / 5.0);
+    const double serial_time = timeEstimator (serial, cloud, keypoints, tree, radius, repetitions, output);
+    printTiming ("ShapeContext3D", 0, serial_time, serial_time, output.points.size ());
+    for (size_t t = 0; t < thread_counts.size (); ++t)
+    {
+      ShapeContext3DEstimationOMP<PointT, Normal, SHOT> omp (false, thread_counts[t]);
+      omp.setInputNormals (normals);
+      omp.setMinimalRadius (radius / 10.0);
+      omp.setPointDensityRadius (radius / 5.0);
+      const double time = timeEstimator (omp, cloud, keypoints, tree, radius, repetitions, output);
+      printTiming ("ShapeContext3DOMP", thread_counts[t], time, serial_time, output.points.size ());
+    }
+  }
+
+  // Unique shape contexts
+  {
+    PointCloud<SHOT> output;
+    UniqueShapeContext<PointT, SHOT> serial;
+    serial.setMinimalRadius (radius / 10.0);
+    serial.setPointDensityRadius (radius / 5.0);
+    serial.setLocalRadius (radius);
+    const double serial_time = timeEstimator (serial, cloud, keypoints, tree, radius, repetitions, output);
+    printTiming ("UniqueShapeContext", 0, serial_time, serial_time, output.points.size ());
+    for (size_t t = 0; t < thread_counts.size (); ++t)
+    {
+      UniqueShapeContextOMP<PointT, SHOT> omp (thread_counts[t]);
+      omp.setMinimalRadius (radius / 10.0);
+      omp.setPointDensityRadius (radius / 5.0);
+      omp.setLocalRadius (radius);
+      const double time = timeEstimator (omp, cloud, keypoints, tree, radius, repetitions, output);
+      printTiming ("UniqueShapeContextOMP", thread_counts[t], time, serial_time, output.points.size ());
+    }
+  }
+
+  return (0);
+}
+/* ]--- */